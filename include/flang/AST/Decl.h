@@ -727,7 +727,9 @@ public:
 
   enum Attributes {
     NoAttributes = 0,
-    Recursive = 1
+    Recursive = 1,
+    Pure = 2,
+    Elemental = 4
   };
 
 private:
@@ -743,6 +745,8 @@ private:
       DeclContext(DK), ArgumentCount(0), Arguments(nullptr),
       Result(nullptr), Body((Stmt*)nullptr) {
       CustomBoolAttr1 = (Attr & Recursive) != 0;
+      CustomBoolAttr2 = (Attr & Pure) != 0;
+      CustomBoolAttr3 = (Attr & Elemental) != 0;
       SubDeclKind = FK;
     }
 public:
@@ -764,6 +768,15 @@ public:
 
   bool isRecursive() const { return CustomBoolAttr1 != 0; }
 
+  /// isPure - Returns true if the procedure has no side effects,
+  /// which is also the case for the elemental procedures.
+  bool isPure() const { return CustomBoolAttr2 != 0 || isElemental(); }
+
+  /// isElemental - Returns true if the procedure is defined for
+  /// scalar arguments, and is applied to each element of the
+  /// array arguments.
+  bool isElemental() const { return CustomBoolAttr3 != 0; }
+
   ArrayRef<VarDecl*> getArguments() const {
     return ArrayRef<VarDecl*>(Arguments, ArgumentCount);
   }
@@ -516,11 +516,19 @@ public:
 
 //===----------------------------------------------------------------------===//
 /// ImplicitArrayPackExpr - packs a strided array into one contiguos array.
+/// The packed array is unpacked back into the strided array after the
+/// call, unless the argument is INTENT(IN).
 class ImplicitArrayPackExpr : public ImplicitArrayOperationExpr {
+  bool Unpacked;
 
-  ImplicitArrayPackExpr(SourceLocation Loc, Expr *E);
+  ImplicitArrayPackExpr(SourceLocation Loc, Expr *E, bool Unpack);
 public:
-  static ImplicitArrayPackExpr *Create(ASTContext &C, Expr *E);
+  static ImplicitArrayPackExpr *Create(ASTContext &C, Expr *E,
+                                       bool Unpack = true);
+
+  bool isUnpacked() const {
+    return Unpacked;
+  }
 
   static bool classof(const Expr *E) {
     return E->getExprClass() == ImplicitArrayPackExprClass;
@@ -958,6 +966,7 @@ public:
 };
 
 /// ImpliedDoExpr - represents an implied do in a DATA statement
+/// or in an array constructor.
 class ImpliedDoExpr : public Expr {
   VarDecl *DoVar;
   MultiArgumentExpr DoList;
@@ -966,12 +975,15 @@ class ImpliedDoExpr : public Expr {
   ImpliedDoExpr(ASTContext &C, SourceLocation Loc,
                 VarDecl *Var, ArrayRef<Expr*> Body,
                 Expr *InitialParam, Expr *TerminalParam,
-                Expr *IncrementationParam);
+                Expr *IncrementationParam, QualType Ty);
 public:
+  /// \brief Creates an implied do. The implied do in an array
+  /// constructor has the type of the array which it produces.
   static ImpliedDoExpr *Create(ASTContext &C, SourceLocation Loc,
                                VarDecl *DoVar, ArrayRef<Expr*> Body,
                                Expr *InitialParam, Expr *TerminalParam,
-                               Expr *IncrementationParam);
+                               Expr *IncrementationParam,
+                               QualType Ty = QualType());
 
   VarDecl *getVarDecl() const { return DoVar; }
   ArrayRef<Expr*> getBody() const { return DoList.getArguments(); }
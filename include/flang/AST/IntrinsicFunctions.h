@@ -26,6 +26,11 @@ enum FunctionArgumentCountKind {
   ArgumentCount2,
   ArgumentCount3,
   ArgumentCount1or2,
+  ArgumentCount1to3,
+  ArgumentCount1to4,
+  ArgumentCount2or3,
+  ArgumentCount2to4,
+  ArgumentCount2to5,
   ArgumentCount2orMore
 };
 
@@ -824,11 +824,76 @@ public:
   }
 };
 
+/// LoopHints - the optimization hints for a DO loop or an array
+/// assignment which are given by the directives that precede it,
+/// e.g. !DIR$ IVDEP or !DIR$ UNROLL(4).
+class LoopHints {
+public:
+  enum DirectiveKind {
+    IVDep,
+    VectorAlways,
+    NoVector,
+    Unroll,
+    NoUnroll
+  };
+
+  enum VectorizeKind {
+    VectorizeDefault,
+    VectorizeAlways,
+    VectorizeNever
+  };
+
+  /// Prefetch - the element of an array which is prefetched
+  /// on every iteration of the loop.
+  struct Prefetch {
+    Expr *Element;
+    /// Locality - the temporal locality of the prefetched data,
+    /// from 0 (no locality) to 3 (keep in all caches).
+    unsigned Locality;
+  };
+
+private:
+  SourceLocation Loc;
+  bool IsIVDep;
+  VectorizeKind Vectorize;
+  /// UnrollCount - 0 if the loop isn't hinted, 1 if the loop
+  /// shouldn't be unrolled, and the unroll factor otherwise.
+  /// UnrollWithoutCount is used when the factor isn't given.
+  unsigned UnrollCount;
+  ArrayRef<Prefetch> Prefetches;
+
+  LoopHints(SourceLocation L, bool IVDep, VectorizeKind V,
+            unsigned Unroll, ArrayRef<Prefetch> P)
+    : Loc(L), IsIVDep(IVDep), Vectorize(V), UnrollCount(Unroll),
+      Prefetches(P) {}
+public:
+  enum {
+    UnrollNone = 0,
+    UnrollDisabled = 1,
+    UnrollWithoutCount = ~0u
+  };
+
+  static LoopHints *Create(ASTContext &C, SourceLocation Loc, bool IVDep,
+                           VectorizeKind Vectorize, unsigned UnrollCount,
+                           ArrayRef<Prefetch> Prefetches);
+
+  /// \brief Returns the location of the first directive.
+  SourceLocation getLocation() const { return Loc; }
+
+  /// \brief Returns true if the iterations of the loop can be
+  /// assumed to have no memory dependencies.
+  bool isIVDep() const { return IsIVDep; }
+  VectorizeKind getVectorize() const { return Vectorize; }
+  unsigned getUnrollCount() const { return UnrollCount; }
+  ArrayRef<Prefetch> getPrefetches() const { return Prefetches; }
+};
+
 /// DoStmt
 class DoStmt : public CFBlockStmt {
   StmtLabelReference TerminatingStmt;
   VarExpr *DoVar;
   Expr *Init, *Terminate, *Increment;
+  LoopHints *Hints;
 
   DoStmt(SourceLocation Loc, StmtLabelReference TermStmt, VarExpr *DoVariable,
          Expr *InitialParam, Expr *TerminalParam,
@@ -845,6 +910,8 @@ public:
   Expr *getInitialParameter() const { return Init; }
   Expr *getTerminalParameter() const { return Terminate; }
   Expr *getIncrementationParameter() const { return Increment; }
+  LoopHints *getLoopHints() const { return Hints; }
+  void setLoopHints(LoopHints *H) { Hints = H; }
 
   static bool classof(const DoStmt*) { return true; }
   static bool classof(const Stmt *S) {
@@ -1096,10 +1163,53 @@ public:
   static bool classof(const CallStmt *) { return true; }
 };
 
+/// AllocateStmt - Allocates the allocatable arrays, using the
+/// explicit shape specifications that follow each array.
+class AllocateStmt : public ListStmt<ArraySpec*>, protected MultiArgumentExpr {
+  AllocateStmt(ASTContext &C, SourceLocation Loc, ArrayRef<Expr*> Objects,
+               ArrayRef<ArraySpec*> Shapes, Expr *StmtLabel);
+public:
+  static AllocateStmt *Create(ASTContext &C, SourceLocation Loc,
+                              ArrayRef<Expr*> Objects,
+                              ArrayRef<ArraySpec*> Shapes,
+                              Expr *StmtLabel);
+
+  ArrayRef<Expr*> getObjects() const {
+    return getArguments();
+  }
+
+  /// getObjectShape - Returns the shape of the I-th allocated array.
+  ArrayRef<ArraySpec*> getObjectShape(size_t I) const;
+
+  static bool classof(const AllocateStmt*) { return true; }
+  static bool classof(const Stmt *S) {
+    return S->getStmtClass() == AllocateStmtClass;
+  }
+};
+
+/// DeallocateStmt - Deallocates the allocatable arrays.
+class DeallocateStmt : public Stmt, protected MultiArgumentExpr {
+  DeallocateStmt(ASTContext &C, SourceLocation Loc, ArrayRef<Expr*> Objects,
+                 Expr *StmtLabel);
+public:
+  static DeallocateStmt *Create(ASTContext &C, SourceLocation Loc,
+                                ArrayRef<Expr*> Objects, Expr *StmtLabel);
+
+  ArrayRef<Expr*> getObjects() const {
+    return getArguments();
+  }
+
+  static bool classof(const DeallocateStmt*) { return true; }
+  static bool classof(const Stmt *S) {
+    return S->getStmtClass() == DeallocateStmtClass;
+  }
+};
+
 /// AssignmentStmt
 class AssignmentStmt : public Stmt {
   Expr *LHS;
   Expr *RHS;
+  LoopHints *Hints;
 
   AssignmentStmt(SourceLocation Loc, Expr *lhs, Expr *rhs, Expr *StmtLabel);
 public:
@@ -1109,6 +1219,10 @@ public:
   Expr *getLHS() const { return LHS; }
   Expr *getRHS() const { return RHS; }
 
+  /// \brief Returns the hints for the loops of an array assignment.
+  LoopHints *getLoopHints() const { return Hints; }
+  void setLoopHints(LoopHints *H) { Hints = H; }
+
   static bool classof(const AssignmentStmt*) { return true; }
   static bool classof(const Stmt *S) {
     return S->getStmtClass() == AssignmentStmtClass;
@@ -753,6 +753,14 @@ public:
   /// EvaluateSize - Return true if the size of this array is a constant.
   bool EvaluateSize(uint64_t &Result, const ASTContext &Ctx) const;
 
+  /// isAssumedShape - Return true if this is an assumed-shape array,
+  /// which takes its shape from the actual argument.
+  bool isAssumedShape() const;
+
+  /// isAllocatable - Return true if this is an allocatable array,
+  /// which takes its shape from an ALLOCATE statement.
+  bool isAllocatable() const;
+
   void Profile(llvm::FoldingSetNodeID &ID) const {
   }
 
@@ -14,6 +14,8 @@
 
 namespace llvm {
   class Module;
+  class TargetLibraryInfoImpl;
+  class Triple;
 }
 
 namespace flang {
@@ -35,6 +37,13 @@ namespace flang {
                         const TargetOptions &TOpts, const LangOptions &LOpts,
                         StringRef TDesc, llvm::Module *M, BackendAction Action,
                         raw_pwrite_stream *OS);
+
+  /// \brief Creates the information about the library functions of the
+  /// target, which includes the vector functions of the -fveclib library.
+  llvm::TargetLibraryInfoImpl *
+  CreateTargetLibraryInfo(const llvm::Triple &TargetTriple,
+                          const CodeGenOptions &CGOpts,
+                          const TargetOptions &TOpts);
 }
 
 #endif
@@ -72,6 +72,18 @@ public:
     FPC_Fast        // Aggressively fuse FP ops (E.g. FMA).
   };
 
+  enum ComplexArithmeticKind {
+    CAK_Full,       // Smith's division and ABS using hypot.
+    CAK_Improved,   // Smith's division and an inline scaled ABS.
+    CAK_Fast        // The textbook formulas without any scaling.
+  };
+
+  enum VectorLibrary {
+    NoLibrary,      // Don't use any vector library.
+    Accelerate,     // Use the Accelerate framework on Darwin.
+    Libflang        // Use the vector math functions of the runtime library.
+  };
+
   enum StructReturnConventionKind {
     SRCK_Default,  // No special option was passed.
     SRCK_OnStack,  // Small structs on the stack (-fpcc-struct-return).
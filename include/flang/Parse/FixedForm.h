@@ -86,7 +86,7 @@ public:
 /// CommonAmbiguities - contains the matchers for the common ambiguous
 /// identifiers.
 class CommonAmbiguities {
-  KeywordMatcher MatcherForKeywordsAfterRECURSIVE;
+  KeywordMatcher MatcherForKeywordsAfterPrefix;
   KeywordMatcher MatcherForKeywordsAfterIF;
   KeywordMatcher MatcherForTopLevel;
   KeywordMatcher MatcherForSpecStmts, MatcherForExecStmts;
@@ -94,11 +94,11 @@ public:
   CommonAmbiguities();
 
   /// \brief Returns the matcher for the keywords that come after
-  /// RECURSIVE keyword.
-  /// NB: This matcher must be used only for when RECURSIVE is used
+  /// the RECURSIVE, PURE and ELEMENTAL keywords.
+  /// NB: This matcher must be used only for when these keywords are used
   /// before the function's type.
-  const KeywordMatcher &getMatcherForKeywordsAfterRECURSIVE() const {
-    return MatcherForKeywordsAfterRECURSIVE;
+  const KeywordMatcher &getMatcherForKeywordsAfterPrefix() const {
+    return MatcherForKeywordsAfterPrefix;
   }
 
   /// \brief Returns the matcher for the keywords that come after
@@ -306,6 +306,10 @@ public:
   /// getBufferPtr - Get a pointer to the next line to be lexed.
   const char* getBufferPtr() const { return Text.GetBufferPtr(); }
 
+  /// isAtStartOfLine - Returns true if only whitespace precedes the given
+  /// location in the line of text that is being lexed.
+  bool isAtStartOfLine(SourceLocation Loc) const;
+
   void setBuffer(const llvm::MemoryBuffer *buf, const char *ptr = 0,
                  bool AtLineStart = true);
 
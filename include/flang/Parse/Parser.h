@@ -131,6 +131,11 @@ private:
   /// etc.
   bool DontResolveIdentifiersInSubExpressions;
 
+  /// InArrayConstructor - if set, the parenthesized expressions
+  /// are parsed as an implied do when they are followed by
+  /// the implied do control.
+  bool InArrayConstructor;
+
   /// LexFORMATTokens - if set,
   /// The lexer will lex the format descriptor tokens instead
   /// of normal tokens.
@@ -144,6 +149,40 @@ private:
   /// was select case and a case or an end select statement is expected.
   bool PrevStmtWasSelectCase;
 
+  /// LoopDirective - a loop optimization directive which was found
+  /// in a comment, e.g. !DIR$ UNROLL(4).
+  struct LoopDirective {
+    SourceLocation Loc;
+    LoopHints::DirectiveKind Kind;
+    unsigned Count;
+    /// The prefetched array, the locality hint and the distance
+    /// for the PREFETCH directive. The array is null for the
+    /// other directives.
+    const IdentifierInfo *Var;
+    unsigned Hint;
+    int64_t Distance;
+  };
+
+  /// DirectiveHandler - Parses the directives in the comments.
+  class DirectiveHandler : public CommentHandler {
+    Parser &P;
+  public:
+    DirectiveHandler(Parser &parser) : P(parser) {}
+    bool HandleComment(Lexer &L, const SourceLocation &Loc,
+                       const llvm::StringRef &Comment);
+  };
+  DirectiveHandler Directives;
+
+  /// PendingLoopDirectives - The directives which will be applied to the
+  /// next executable statement. The comments are lexed ahead of the
+  /// statement that precedes them, so they are passed to Sema only
+  /// when the following statement is parsed.
+  SmallVector<LoopDirective, 4> PendingLoopDirectives;
+
+  /// LastDirectiveLoc - the location of the last directive, which makes
+  /// sure that the directives are parsed once when the text is relexed.
+  SourceLocation LastDirectiveLoc;
+
 private:
 
   /// getIdentifierInfo - Return information about the specified identifier
@@ -360,7 +399,8 @@ private:
   bool ParseExternalSubprogram();
   bool ParseExternalSubprogram(DeclSpec &ReturnType, int Attr);
   bool ParseTypedExternalSubprogram(int Attr);
-  bool ParseRecursiveExternalSubprogram();
+  bool ParsePrefixedExternalSubprogram();
+  tok::TokenKind ParsePrefixSpec(int &Attr);
   bool ParseExecutableSubprogramBody(tok::TokenKind EndKw);
   bool ParseModule();
   bool ParseBlockData();
@@ -378,6 +418,8 @@ private:
   bool ParseDeclarationConstruct();
   bool ParseForAllConstruct();
   void CheckStmtOrder(SourceLocation Loc, StmtResult SR);
+  void ParseDirective(SourceLocation Loc, StringRef Text);
+  void ActOnPendingLoopDirectives();
   StmtResult ParseExecutableConstruct();
 
   bool ParseTypeDeclarationStmt(SmallVectorImpl<DeclResult> &Decls);
@@ -531,6 +573,8 @@ private:
   ExprResult ParseRecursiveCallExpression(SourceRange IDRange);
   ExprResult ParseCallExpression(SourceLocation IDLoc, FunctionDecl *Function);
   ExprResult ParseArrayConstructor();
+  ExprResult ParseArrayConstructorImpliedDo(SourceLocation Loc,
+                                            SmallVectorImpl<ExprResult> &Body);
   ExprResult ParseTypeConstructor(SourceLocation IDLoc, RecordDecl *Record);
 
   /// \brief Looks at the next token to see if it's an expression
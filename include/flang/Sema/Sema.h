@@ -88,6 +88,39 @@ class Sema {
     }
   }
 
+  /// \brief The loop optimization hints given by the directives which
+  /// precede the current statement. The location is invalid when
+  /// there are no hints.
+  struct PendingLoopHints {
+    struct PrefetchDirective {
+      SourceLocation Loc;
+      const IdentifierInfo *IDInfo;
+      unsigned Hint;
+      int64_t Distance;
+    };
+
+    SourceLocation Loc;
+    bool IVDep;
+    LoopHints::VectorizeKind Vectorize;
+    unsigned UnrollCount;
+    SmallVector<PrefetchDirective, 2> Prefetches;
+
+    PendingLoopHints() { clear(); }
+    void clear() {
+      Loc = SourceLocation();
+      IVDep = false;
+      Vectorize = LoopHints::VectorizeDefault;
+      UnrollCount = LoopHints::UnrollNone;
+      Prefetches.clear();
+    }
+  };
+  PendingLoopHints CurLoopHints;
+
+  /// \brief Returns the hints for the loop which is about to be created
+  /// and clears the pending hints. The prefetched elements are indexed
+  /// by the given DO variable, or are dropped when it's null.
+  LoopHints *TakeLoopHints(ASTContext &C, VarExpr *DoVar);
+
   /// \brief The mapping
   intrinsic::FunctionMapping IntrinsicFunctionMapping;
 
@@ -145,6 +178,7 @@ public:
   void PopDeclContext();
 
   bool IsInsideFunctionOrSubroutine() const;
+  bool IsInsidePureSubprogram() const;
   FunctionDecl *CurrentContextAsFunction() const;
 
   void PushExecutableProgramUnit(ExecutableProgramUnitScope &Scope);
@@ -472,6 +506,20 @@ public:
   StmtResult ActOnEndIfStmt(ASTContext &C, SourceLocation Loc,
                             ConstructName Name, Expr *StmtLabel);
 
+  /// ActOnLoopDirective - Records a directive which gives an optimization
+  /// hint for the loop created by the next statement, e.g. !DIR$ IVDEP.
+  void ActOnLoopDirective(SourceLocation Loc, LoopHints::DirectiveKind Kind,
+                          unsigned Count);
+
+  /// ActOnPrefetchDirective - Records a !DIR$ PREFETCH directive for
+  /// the array with the given name.
+  void ActOnPrefetchDirective(SourceLocation Loc, const IdentifierInfo *IDInfo,
+                              unsigned Hint, int64_t Distance);
+
+  /// DiscardLoopHints - Reports the hints which weren't used by the
+  /// statement that followed them.
+  void DiscardLoopHints();
+
   StmtResult ActOnDoStmt(ASTContext &C, SourceLocation Loc, SourceLocation EqualLoc,
                          ExprResult TerminatingStmt,
                          VarExpr *DoVar, ExprResult E1, ExprResult E2,
@@ -512,6 +560,9 @@ public:
 
   StmtResult ActOnElseWhereStmt(ASTContext &C, SourceLocation Loc, Expr *StmtLabel);
 
+  StmtResult ActOnElseWhereStmt(ASTContext &C, SourceLocation Loc,
+                                ExprResult Mask, Expr *StmtLabel);
+
   StmtResult ActOnEndWhereStmt(ASTContext &C, SourceLocation Loc, Expr *StmtLabel);
 
   StmtResult ActOnContinueStmt(ASTContext &C, SourceLocation Loc, Expr *StmtLabel);
@@ -525,6 +576,25 @@ public:
                            const IdentifierInfo *IDInfo,
                            llvm::MutableArrayRef<Expr *> Arguments, Expr *StmtLabel);
 
+  /// ActOnAllocateObject - Returns the allocatable array which is
+  /// allocated or deallocated by an ALLOCATE or a DEALLOCATE statement.
+  ExprResult ActOnAllocateObject(ASTContext &C, SourceLocation IDLoc,
+                                 const IdentifierInfo *IDInfo);
+
+  /// ActOnAllocation - Checks the shape of an allocatable array in
+  /// an ALLOCATE statement and returns the allocated array.
+  ExprResult ActOnAllocation(ASTContext &C, SourceLocation IDLoc,
+                             const IdentifierInfo *IDInfo,
+                             ArrayRef<ArraySpec*> Shape);
+
+  StmtResult ActOnAllocateStmt(ASTContext &C, SourceLocation Loc,
+                               ArrayRef<Expr*> Objects,
+                               ArrayRef<ArraySpec*> Shapes,
+                               Expr *StmtLabel);
+
+  StmtResult ActOnDeallocateStmt(ASTContext &C, SourceLocation Loc,
+                                 ArrayRef<Expr*> Objects, Expr *StmtLabel);
+
   StmtResult ActOnPrintStmt(ASTContext &C, SourceLocation Loc, FormatSpec *FS,
                             ArrayRef<ExprResult> OutputItemList,
                             Expr *StmtLabel);
@@ -594,6 +664,13 @@ public:
   ExprResult ActOnArrayConstructorExpr(ASTContext &C, SourceLocation Loc,
                                        SourceLocation RParenLoc, ArrayRef<Expr*> Elements);
 
+  ExprResult ActOnArrayConstructorImpliedDoExpr(ASTContext &C, SourceLocation Loc,
+                                                SourceLocation IDLoc,
+                                                const IdentifierInfo *IDInfo,
+                                                ArrayRef<ExprResult> Body,
+                                                ExprResult E1, ExprResult E2,
+                                                ExprResult E3);
+
   ExprResult ActOnTypeConstructorExpr(ASTContext &C, SourceLocation Loc, SourceLocation LParenLoc,
                                       SourceLocation RParenLoc, RecordDecl *Record,
                                       ArrayRef<Expr*> Arguments);
@@ -931,6 +1008,10 @@ public:
   /// a complex argument.
   bool CheckIntegerOrRealOrComplexArgument(const Expr *E, bool AllowArrays = false);
 
+  /// Returns false if the argument has an integer or a real or
+  /// a complex array type.
+  bool CheckIntegerOrRealOrComplexArrayArgument(const Expr *E, StringRef ArgName);
+
   /// Returns false if the argument has a real or
   /// a complex argument.
   bool CheckRealOrComplexArgument(const Expr *E, bool AllowArrays = false);
@@ -938,9 +1019,22 @@ public:
   /// Returns true if the given expression is a logical array.
   bool IsLogicalArray(const Expr *E);
 
+  /// Returns false if the argument has a logical type, or a logical
+  /// array type when arrays are allowed.
+  bool CheckLogicalArgument(const Expr *E, bool AllowArrays,
+                            StringRef ArgName);
+
   /// Returns false if the argument has a logical array type.
   bool CheckLogicalArrayArgument(const Expr *E, StringRef ArgName);
 
+  /// Returns false if the argument is a one dimensional
+  /// numeric or logical array.
+  bool CheckVectorArgument(const Expr *E, StringRef ArgName);
+
+  /// Returns false if the argument is a one or two dimensional
+  /// numeric or logical array.
+  bool CheckMatrixArgument(const Expr *E, StringRef ArgName);
+
   /// Returns false if the argument is an integer or a logical array.
   bool CheckIntegerArgumentOrLogicalArrayArgument(const Expr *E, StringRef ArgName1,
                                                   StringRef ArgName2);
@@ -1062,12 +1156,43 @@ public:
   /// Returns true if the given statement can be part of a where construct.
   bool CheckValidWhereStmtPart(Stmt *S);
 
+  /// Returns true if the array arguments of a call to an elemental
+  /// procedure have the same shape.
+  bool CheckElementalCallArguments(FunctionDecl *Function,
+                                   ArrayRef<Expr*> Arguments,
+                                   SourceLocation Loc);
+
+  /// Reports the array dummy arguments of an elemental procedure.
+  void CheckElementalSubprogram(const FunctionDecl *Function);
+
+  /// Reports the dummy arguments and the local variables of a pure
+  /// procedure which allow it to have side effects.
+  void CheckPureSubprogram(const FunctionDecl *Function);
+
+  /// Returns true if the variable designated by the given expression
+  /// can be modified by the current pure procedure.
+  bool CheckPureDefinition(const Expr *E);
+
+  /// Returns true if the given procedure can be called by the
+  /// current pure procedure.
+  bool CheckPureCall(const FunctionDecl *Function, SourceLocation Loc);
+
+  /// Returns true if the given statement is allowed in the current
+  /// procedure, reporting it if the procedure is pure.
+  bool CheckPureStmt(const char *StmtString, SourceLocation Loc);
+
   /// Returns true if the current function/subroutine is recursive.
   bool CheckRecursiveFunction(SourceLocation Loc);
 
   /// Returns a vector of elements with a given size.
   QualType GetSingleDimArrayType(QualType ElTy, int Size);
 
+  /// Returns the type of an array reduction like SUM, which is
+  /// a scalar, or an array without the reduced dimension when
+  /// the dimension is given.
+  QualType GetArrayReductionReturnType(QualType ElementType, const Expr *Array,
+                                       const Expr *Dim);
+
 };
 
 } // end flang namespace
@@ -92,6 +92,8 @@ public:
   void VisitStopStmt(const StopStmt *S);
   void VisitReturnStmt(const ReturnStmt *S);
   void VisitCallStmt(const CallStmt *S);
+  void VisitAllocateStmt(const AllocateStmt *S);
+  void VisitDeallocateStmt(const DeallocateStmt *S);
   void VisitAssignmentStmt(const AssignmentStmt *S);
   void VisitPrintStmt(const PrintStmt *S);
   void VisitWriteStmt(const WriteStmt *S);
@@ -134,6 +136,7 @@ public:
 
   // array specification
   void dumpArraySpec(const ArraySpec *S);
+  void dumpLoopHints(const LoopHints *Hints);
 
 };
 
@@ -525,6 +528,8 @@ void ASTDumper::VisitIfStmt(const IfStmt* S) {
 }
 
 void ASTDumper::VisitDoStmt(const DoStmt *S) {
+  if(S->getLoopHints())
+    dumpLoopHints(S->getLoopHints());
   dumpConstructNamePrefix(S->getName());
   OS<<"do ";
   if(S->getTerminatingStmt().Statement) {
@@ -627,7 +632,32 @@ void ASTDumper::VisitCallStmt(const CallStmt *S) {
   OS << ")\n";
 }
 
+void ASTDumper::VisitAllocateStmt(const AllocateStmt *S) {
+  OS << "allocate(";
+  auto Objects = S->getObjects();
+  for(size_t I = 0; I < Objects.size(); ++I) {
+    if(I) OS << ", ";
+    dumpExpr(Objects[I]);
+    OS << '(';
+    auto Shape = S->getObjectShape(I);
+    for(size_t J = 0; J < Shape.size(); ++J) {
+      if(J) OS << ", ";
+      dumpArraySpec(Shape[J]);
+    }
+    OS << ')';
+  }
+  OS << ")\n";
+}
+
+void ASTDumper::VisitDeallocateStmt(const DeallocateStmt *S) {
+  OS << "deallocate(";
+  dumpExprList(S->getObjects());
+  OS << ")\n";
+}
+
 void ASTDumper::VisitAssignmentStmt(const AssignmentStmt *S) {
+  if(S->getLoopHints())
+    dumpLoopHints(S->getLoopHints());
   dumpExprOrNull(S->getLHS());
   OS << " = ";
   dumpExprOrNull(S->getRHS());
@@ -895,7 +925,36 @@ void ASTDumper::dumpArraySpec(const ArraySpec *S) {
       OS << ':';
     }
     OS << '*';
-  } else OS << "<unknown array spec>";
+  } else if(auto Assumed = dyn_cast<AssumedShapeSpec>(S)) {
+    if(Assumed->getLowerBound())
+      dumpExpr(Assumed->getLowerBound());
+    OS << ':';
+  } else if(isa<DeferredShapeSpec>(S))
+    OS << ':';
+  else OS << "<unknown array spec>";
+}
+
+void ASTDumper::dumpLoopHints(const LoopHints *Hints) {
+  OS << "!dir$";
+  if(Hints->isIVDep())
+    OS << " ivdep";
+  if(Hints->getVectorize() == LoopHints::VectorizeAlways)
+    OS << " vector always";
+  else if(Hints->getVectorize() == LoopHints::VectorizeNever)
+    OS << " novector";
+  auto UnrollCount = Hints->getUnrollCount();
+  if(UnrollCount == LoopHints::UnrollDisabled)
+    OS << " nounroll";
+  else if(UnrollCount == LoopHints::UnrollWithoutCount)
+    OS << " unroll";
+  else if(UnrollCount != LoopHints::UnrollNone)
+    OS << " unroll(" << UnrollCount << ")";
+  for(auto Prefetch : Hints->getPrefetches()) {
+    OS << " prefetch ";
+    dumpExpr(Prefetch.Element);
+  }
+  OS << "\n";
+  dumpIndent();
 }
 
 namespace flang {
@@ -274,12 +274,15 @@ SourceLocation ImplicitArrayOperationExpr::getLocEnd() const {
   return E->getLocEnd();
 }
 
-ImplicitArrayPackExpr::ImplicitArrayPackExpr(SourceLocation Loc, Expr *E)
-  : ImplicitArrayOperationExpr(ImplicitArrayPackExprClass, Loc, E) {
+ImplicitArrayPackExpr::ImplicitArrayPackExpr(SourceLocation Loc, Expr *E,
+                                             bool Unpack)
+  : ImplicitArrayOperationExpr(ImplicitArrayPackExprClass, Loc, E),
+    Unpacked(Unpack) {
 }
 
-ImplicitArrayPackExpr *ImplicitArrayPackExpr::Create(ASTContext &C, Expr *E) {
-  return new(C) ImplicitArrayPackExpr(E->getLocation(), E);
+ImplicitArrayPackExpr *ImplicitArrayPackExpr::Create(ASTContext &C, Expr *E,
+                                                     bool Unpack) {
+  return new(C) ImplicitArrayPackExpr(E->getLocation(), E, Unpack);
 }
 
 ImplicitTempArrayExpr::ImplicitTempArrayExpr(SourceLocation Loc, Expr *E)
@@ -435,8 +438,8 @@ SourceLocation IntrinsicCallExpr::getLocEnd() const {
 ImpliedDoExpr::ImpliedDoExpr(ASTContext &C, SourceLocation Loc,
                              VarDecl *Var, ArrayRef<Expr*> Body,
                              Expr *InitialParam, Expr *TerminalParam,
-                             Expr *IncrementationParam)
-  : Expr(ImpliedDoExprClass, QualType(), Loc), DoVar(Var),
+                             Expr *IncrementationParam, QualType Ty)
+  : Expr(ImpliedDoExprClass, Ty, Loc), DoVar(Var),
     DoList(C, Body), Init(InitialParam), Terminate(TerminalParam),
     Increment(IncrementationParam) {
 }
@@ -444,9 +447,10 @@ ImpliedDoExpr::ImpliedDoExpr(ASTContext &C, SourceLocation Loc,
 ImpliedDoExpr *ImpliedDoExpr::Create(ASTContext &C, SourceLocation Loc,
                                      VarDecl *DoVar, ArrayRef<Expr*> Body,
                                      Expr *InitialParam, Expr *TerminalParam,
-                                     Expr *IncrementationParam) {
+                                     Expr *IncrementationParam,
+                                     QualType Ty) {
   return new(C) ImpliedDoExpr(C, Loc, DoVar, Body, InitialParam,
-                              TerminalParam, IncrementationParam);
+                              TerminalParam, IncrementationParam, Ty);
 }
 
 SourceLocation ImpliedDoExpr::getLocEnd() const {
@@ -18,7 +18,7 @@ class ContiguousArrayChecker
 public:
 
   bool VisitArraySectionExpr(const ArraySectionExpr *E) {
-    if(!E->getTarget())
+    if(!E->getTarget() || !Visit(E->getTarget()))
       return false;
     auto Subs = E->getSubscripts();
 
@@ -67,7 +67,9 @@ public:
   }
 
   bool VisitVarExpr(const VarExpr *E) {
-    return true;
+    // The actual argument of an assumed-shape array may be strided.
+    auto ATy = E->getType()->asArrayType();
+    return !ATy || !ATy->isAssumedShape();
   }
 };
 
@@ -353,7 +353,7 @@ bool ExplicitShapeSpec::Evaluate(EvaluatedArraySpec &Spec, const ASTContext &Ctx
   if(!getUpperBound()->EvaluateAsInt(Spec.UpperBound, Ctx))
     return false;
   auto Sz = Spec.UpperBound - Spec.LowerBound + 1;
-  assert(Sz > 0);
+  assert(Sz >= 0);
   Spec.Size = uint64_t(Sz);
   return true;
 }
@@ -65,6 +65,11 @@ static FunctionArgumentCountKind FunctionArgCounts[] = {
   #define NUM_ARGS_2 ArgumentCount2
   #define NUM_ARGS_3 ArgumentCount3
   #define NUM_ARGS_1_OR_2 ArgumentCount1or2
+  #define NUM_ARGS_1_TO_3 ArgumentCount1to3
+  #define NUM_ARGS_1_TO_4 ArgumentCount1to4
+  #define NUM_ARGS_2_OR_3 ArgumentCount2or3
+  #define NUM_ARGS_2_TO_4 ArgumentCount2to4
+  #define NUM_ARGS_2_TO_5 ArgumentCount2to5
   #define NUM_ARGS_2_OR_MORE ArgumentCount2orMore
   #define INTRINSIC_FUNCTION(NAME, GENERICNAME, NUMARGS, VERSION) NUMARGS,
   #include "flang/AST/IntrinsicFunctions.def"
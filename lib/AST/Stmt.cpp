@@ -486,6 +486,23 @@ void CFBlockStmt::setBody(Stmt *Body) {
   this->Body = Body;
 }
 
+//===----------------------------------------------------------------------===//
+// Loop Hints
+//===----------------------------------------------------------------------===//
+
+LoopHints *LoopHints::Create(ASTContext &C, SourceLocation Loc, bool IVDep,
+                             VectorizeKind Vectorize, unsigned UnrollCount,
+                             ArrayRef<Prefetch> Prefetches) {
+  Prefetch *PrefetchList = nullptr;
+  if(!Prefetches.empty()) {
+    PrefetchList = new (C) Prefetch [Prefetches.size()];
+    for(size_t I = 0; I < Prefetches.size(); ++I)
+      PrefetchList[I] = Prefetches[I];
+  }
+  return new (C) LoopHints(Loc, IVDep, Vectorize, UnrollCount,
+                           ArrayRef<Prefetch>(PrefetchList, Prefetches.size()));
+}
+
 //===----------------------------------------------------------------------===//
 // Do Statement
 //===----------------------------------------------------------------------===//
@@ -495,7 +512,8 @@ DoStmt::DoStmt(SourceLocation Loc, StmtLabelReference TermStmt,
                Expr *TerminalParam, Expr *IncrementationParam,
                Expr *StmtLabel, ConstructName Name)
   : CFBlockStmt(DoStmtClass, Loc, StmtLabel, Name), TerminatingStmt(TermStmt), DoVar(DoVariable),
-    Init(InitialParam), Terminate(TerminalParam), Increment(IncrementationParam) {
+    Init(InitialParam), Terminate(TerminalParam), Increment(IncrementationParam),
+    Hints(nullptr) {
 }
 
 DoStmt *DoStmt::Create(ASTContext &C, SourceLocation Loc, StmtLabelReference TermStmt,
@@ -687,13 +705,56 @@ CallStmt *CallStmt::Create(ASTContext &C, SourceLocation Loc,
   return new(C) CallStmt(C, Loc, Func, Args, StmtLabel);
 }
 
+//===----------------------------------------------------------------------===//
+// Allocate Statement
+//===----------------------------------------------------------------------===//
+
+AllocateStmt::AllocateStmt(ASTContext &C, SourceLocation Loc,
+                           ArrayRef<Expr*> Objects, ArrayRef<ArraySpec*> Shapes,
+                           Expr *StmtLabel)
+  : ListStmt(C, AllocateStmtClass, Loc, Shapes, StmtLabel),
+    MultiArgumentExpr(C, Objects) {
+}
+
+AllocateStmt *AllocateStmt::Create(ASTContext &C, SourceLocation Loc,
+                                   ArrayRef<Expr*> Objects,
+                                   ArrayRef<ArraySpec*> Shapes,
+                                   Expr *StmtLabel) {
+  return new(C) AllocateStmt(C, Loc, Objects, Shapes, StmtLabel);
+}
+
+ArrayRef<ArraySpec*> AllocateStmt::getObjectShape(size_t I) const {
+  auto Objects = getObjects();
+  size_t Offset = 0;
+  for(size_t J = 0; J < I; ++J)
+    Offset += Objects[J]->getType()->asArrayType()->getDimensionCount();
+  return getIDList().slice(Offset,
+                           Objects[I]->getType()->asArrayType()->getDimensionCount());
+}
+
+//===----------------------------------------------------------------------===//
+// Deallocate Statement
+//===----------------------------------------------------------------------===//
+
+DeallocateStmt::DeallocateStmt(ASTContext &C, SourceLocation Loc,
+                               ArrayRef<Expr*> Objects, Expr *StmtLabel)
+  : Stmt(DeallocateStmtClass, Loc, StmtLabel), MultiArgumentExpr(C, Objects) {
+}
+
+DeallocateStmt *DeallocateStmt::Create(ASTContext &C, SourceLocation Loc,
+                                       ArrayRef<Expr*> Objects,
+                                       Expr *StmtLabel) {
+  return new(C) DeallocateStmt(C, Loc, Objects, StmtLabel);
+}
+
 //===----------------------------------------------------------------------===//
 // Assignment Statement
 //===----------------------------------------------------------------------===//
 
 AssignmentStmt::AssignmentStmt(SourceLocation Loc, Expr *lhs, Expr *rhs,
                                Expr *StmtLabel)
-  : Stmt(AssignmentStmtClass, Loc, StmtLabel), LHS(lhs), RHS(rhs)
+  : Stmt(AssignmentStmtClass, Loc, StmtLabel), LHS(lhs), RHS(rhs),
+    Hints(nullptr)
 {}
 
 AssignmentStmt *AssignmentStmt::Create(ASTContext &C, SourceLocation Loc, Expr *LHS,
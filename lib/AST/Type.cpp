@@ -62,6 +62,15 @@ bool ArrayType::EvaluateSize(uint64_t &Result, const ASTContext &Ctx) const {
   return true;
 }
 
+bool ArrayType::isAssumedShape() const {
+  return DimCount && isa<AssumedShapeSpec>(Dims[0]);
+}
+
+bool ArrayType::isAllocatable() const {
+  return DimCount && isa<DeferredShapeSpec>(Dims[0]) &&
+         getElementType().hasAttributeSpec(Qualifiers::AS_allocatable);
+}
+
 FunctionType *FunctionType::Create(ASTContext &C, QualType ResultType,
                                    const FunctionDecl *Prototype) {
   return new(C, TypeAlignment) FunctionType(Function, QualType(), ResultType, Prototype);
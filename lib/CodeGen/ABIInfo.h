@@ -53,7 +53,13 @@ public:
     ExpandCharacterPutLengthToAdditionalArgsAsInt,
 
     /// Passes a complex by value using a vector type.
-    ComplexValueAsVector
+    ComplexValueAsVector,
+
+    /// Passes an assumed-shape array as a pointer
+    /// to a descriptor with the base address, the
+    /// element size and the lower bound, extent and
+    /// byte stride of every dimension.
+    ArrayDescriptor
   };
 
 private:
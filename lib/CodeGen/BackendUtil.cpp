@@ -26,6 +26,7 @@
 #include "llvm/IR/Verifier.h"
 #include "llvm/MC/SubtargetFeature.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Host.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/Timer.h"
@@ -154,6 +155,78 @@ static void addBoundsCheckingPass(const PassManagerBuilder &Builder,
   PM.add(createBoundsCheckingPass());
 }
 
+// The vector math functions of the runtime library for every vector width,
+// which replace the C library functions and the LLVM intrinsics.
+#define VECTOR_MATH_FUNCTION(Name, FloatLanes, DoubleLanes)                  \
+  { #Name "f", "libflang_v" #Name "f" #FloatLanes, FloatLanes },             \
+  { #Name, "libflang_v" #Name #DoubleLanes, DoubleLanes }
+#define VECTOR_MATH_INTRINSIC(Name, FloatLanes, DoubleLanes)                 \
+  VECTOR_MATH_FUNCTION(Name, FloatLanes, DoubleLanes),                       \
+  { "llvm." #Name ".f32", "libflang_v" #Name "f" #FloatLanes, FloatLanes },  \
+  { "llvm." #Name ".f64", "libflang_v" #Name #DoubleLanes, DoubleLanes }
+#define VECTOR_MATH_FUNCTIONS(FloatLanes, DoubleLanes) {                     \
+  VECTOR_MATH_INTRINSIC(sin, FloatLanes, DoubleLanes),                       \
+  VECTOR_MATH_INTRINSIC(cos, FloatLanes, DoubleLanes),                       \
+  VECTOR_MATH_FUNCTION(tan, FloatLanes, DoubleLanes),                        \
+  VECTOR_MATH_INTRINSIC(exp, FloatLanes, DoubleLanes),                       \
+  VECTOR_MATH_INTRINSIC(log, FloatLanes, DoubleLanes),                       \
+  VECTOR_MATH_FUNCTION(atan2, FloatLanes, DoubleLanes)                       \
+}
+
+static const VecDesc SSE2VectorMathFunctions[] = VECTOR_MATH_FUNCTIONS(4, 2);
+static const VecDesc AVX2VectorMathFunctions[] = VECTOR_MATH_FUNCTIONS(8, 4);
+static const VecDesc AVX512VectorMathFunctions[] = VECTOR_MATH_FUNCTIONS(16, 8);
+
+#undef VECTOR_MATH_FUNCTIONS
+#undef VECTOR_MATH_INTRINSIC
+#undef VECTOR_MATH_FUNCTION
+
+/// \brief Adds the vector math functions of the runtime library for the
+/// vector widths which are supported by the target. A function can't be
+/// called when the target lacks its instruction set, as its vector
+/// arguments are passed in the registers of that instruction set.
+static void AddLibflangVectorFunctions(TargetLibraryInfoImpl &TLII,
+                                       const llvm::Triple &TargetTriple,
+                                       const flang::TargetOptions &TargetOpts) {
+  if (TargetTriple.getArch() != llvm::Triple::x86_64)
+    return;
+
+  // The driver targets the host CPU, so its features are used unless
+  // they are overridden by the target options.
+  StringMap<bool> Features;
+  if (TargetOpts.CPU == sys::getHostCPUName())
+    sys::getHostCPUFeatures(Features);
+  for (auto &Feature : TargetOpts.Features)
+    Features[StringRef(Feature).substr(1)] = Feature[0] == '+';
+
+  TLII.addVectorizableFunctions(SSE2VectorMathFunctions);
+  if (Features.lookup("avx2") && Features.lookup("fma"))
+    TLII.addVectorizableFunctions(AVX2VectorMathFunctions);
+  if (Features.lookup("avx512f"))
+    TLII.addVectorizableFunctions(AVX512VectorMathFunctions);
+}
+
+TargetLibraryInfoImpl *
+flang::CreateTargetLibraryInfo(const llvm::Triple &TargetTriple,
+                               const CodeGenOptions &CodeGenOpts,
+                               const flang::TargetOptions &TargetOpts) {
+  TargetLibraryInfoImpl *TLII = new TargetLibraryInfoImpl(TargetTriple);
+  if (!CodeGenOpts.SimplifyLibCalls)
+    TLII->disableAllFunctions();
+
+  switch (CodeGenOpts.getVecLib()) {
+  case CodeGenOptions::Accelerate:
+    TLII->addVectorizableFunctionsFromVecLib(TargetLibraryInfoImpl::Accelerate);
+    break;
+  case CodeGenOptions::Libflang:
+    AddLibflangVectorFunctions(*TLII, TargetTriple, TargetOpts);
+    break;
+  default:
+    break;
+  }
+  return TLII;
+}
+
 void EmitAssemblyHelper::CreatePasses() {
   unsigned OptLevel = CodeGenOpts.OptimizationLevel;
   CodeGenOptions::InliningMethod Inlining = CodeGenOpts.getInlining();
@@ -177,9 +250,8 @@ void EmitAssemblyHelper::CreatePasses() {
 
   // Figure out TargetLibraryInfo.
   Triple TargetTriple(TheModule->getTargetTriple());
-  PMBuilder.LibraryInfo = new TargetLibraryInfoImpl(TargetTriple);
-  if (!CodeGenOpts.SimplifyLibCalls)
-    PMBuilder.LibraryInfo->disableAllFunctions();
+  PMBuilder.LibraryInfo = CreateTargetLibraryInfo(TargetTriple, CodeGenOpts,
+                                                  TargetOpts);
   
   switch (Inlining) {
   case CodeGenOptions::NoInlining: break;
@@ -405,9 +477,9 @@ bool EmitAssemblyHelper::AddEmitPasses(BackendAction Action,
 
   // Add LibraryInfo.
   llvm::Triple TargetTriple(TheModule->getTargetTriple());
-  TargetLibraryInfoImpl *TLII = new TargetLibraryInfoImpl(TargetTriple);
-  if (!CodeGenOpts.SimplifyLibCalls)
-    TLII->disableAllFunctions();
+  TargetLibraryInfoImpl *TLII = CreateTargetLibraryInfo(TargetTriple,
+                                                        CodeGenOpts,
+                                                        TargetOpts);
   PM->add(new TargetLibraryInfoWrapperPass(*TLII));
 
   // Add Target specific analysis passes.
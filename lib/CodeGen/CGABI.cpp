@@ -17,6 +17,9 @@ ABIArgInfo FortranABI::GetArgABI(QualType ArgType) {
     return ABIArgInfo(ABIArgInfo::ExpandCharacterPutLengthToAdditionalArgsAsInt);
   else if(ArgType->isFunctionType())
     return ABIArgInfo(ABIArgInfo::Value);
+  else if(ArgType->isArrayType() &&
+          ArgType->asArrayType()->isAssumedShape())
+    return ABIArgInfo(ABIArgInfo::ArrayDescriptor);
 
   return ABIArgInfo(ABIArgInfo::Reference);
 }
@@ -14,12 +14,15 @@
 #include "CodeGenFunction.h"
 #include "CodeGenModule.h"
 #include "CGArray.h"
+#include "CGSystemRuntime.h"
 #include "flang/AST/ASTContext.h"
 #include "flang/AST/ExprVisitor.h"
 #include "flang/AST/StmtVisitor.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/Function.h"
+#include "llvm/Support/raw_ostream.h"
 
 namespace flang {
 namespace CodeGen {
@@ -34,6 +37,14 @@ llvm::Type *CodeGenTypes::ConvertArrayType(const ArrayType *T) {
   return llvm::PointerType::get(ConvertTypeForMem(T->getElementType()), 0);
 }
 
+llvm::StructType *CodeGenTypes::GetArrayDescriptorType(const ArrayType *T) {
+  auto DimensionType = llvm::ArrayType::get(CGM.SizeTy, 3);
+  llvm::Type *Fields[] = { ConvertArrayType(T), CGM.SizeTy,
+                           llvm::ArrayType::get(DimensionType,
+                                                T->getDimensionCount()) };
+  return llvm::StructType::get(CGM.getLLVMContext(), Fields);
+}
+
 llvm::ArrayType *CodeGenTypes::ConvertArrayTypeForMem(const ArrayType *T) {
   uint64_t ArraySize;
   if(T->EvaluateSize(ArraySize, Context))
@@ -49,15 +60,219 @@ llvm::Value *CodeGenFunction::CreateArrayAlloca(QualType T,
   uint64_t ArraySize;
   if(ATy->EvaluateSize(ArraySize, getContext())) {
     auto Ty = getTypes().GetFixedSizeArrayType(ATy, ArraySize);
+    if(CGM.getDataLayout().getTypeAllocSize(Ty) > CGM.getCodeGenOpts().MaxStackVarSize)
+      return nullptr;
     if(IsTemp)
       return CreateTempAlloca(Ty, Name);
     else
       return Builder.CreateAlloca(Ty, nullptr, Name);
   }
-  // FIXME variable size stack/heap allocation
   return nullptr;
 }
 
+/// The alignment of the arrays in the heap pool.
+static const uint64_t AutomaticArrayAlignment = 16;
+
+void CodeGenFunction::EmitAutomaticArrays() {
+  auto Zero = llvm::ConstantInt::get(CGM.SizeTy, 0);
+  auto MaxStackSize = llvm::ConstantInt::get(CGM.SizeTy,
+                                             CGM.getCodeGenOpts().MaxStackVarSize);
+  SmallVector<llvm::Value*, 4> StackPtrs, IsOnStack, Offsets;
+  llvm::Value *PoolSize = Zero;
+  for(auto D : AutomaticArrays) {
+    auto ETy = ConvertTypeForMem(D->getType()->asArrayType()->getElementType());
+    SmallVector<ArrayDimensionValueTy, 8> Dims;
+    GetArrayDimensionsInfo(D->getType(), Dims);
+    // An empty dimension gives an empty array.
+    llvm::Value *Count = nullptr;
+    for(auto Dim : Dims) {
+      auto DimSize = EmitDimSize(Dim);
+      DimSize = Builder.CreateSelect(Builder.CreateICmpSLT(DimSize, Zero), Zero, DimSize);
+      Count = Count? Builder.CreateMul(Count, DimSize) : DimSize;
+    }
+    auto Size = Builder.CreateMul(Count, llvm::ConstantInt::get(CGM.SizeTy,
+                                           CGM.getDataLayout().getTypeAllocSize(ETy)));
+    auto AlignedSize = Builder.CreateAnd(Builder.CreateAdd(Size,
+                                           llvm::ConstantInt::get(CGM.SizeTy, AutomaticArrayAlignment - 1)),
+                                         llvm::ConstantInt::get(CGM.SizeTy, ~(AutomaticArrayAlignment - 1)));
+    Offsets.push_back(PoolSize);
+
+    // The arrays with a constant size are here only when they are too
+    // large for the stack.
+    if(isa<llvm::ConstantInt>(Count)) {
+      StackPtrs.push_back(nullptr);
+      IsOnStack.push_back(nullptr);
+      PoolSize = Builder.CreateAdd(PoolSize, AlignedSize);
+      continue;
+    }
+    auto OnStack = Builder.CreateICmpULE(Size, MaxStackSize);
+    StackPtrs.push_back(Builder.CreateAlloca(ETy, Builder.CreateSelect(OnStack, Count, Zero),
+                                             D->getName()));
+    IsOnStack.push_back(OnStack);
+    PoolSize = Builder.CreateAdd(PoolSize, Builder.CreateSelect(OnStack, Zero, AlignedSize));
+  }
+
+  // The heap pool is allocated only when it's needed.
+  llvm::Value *Pool;
+  if(auto ConstantSize = dyn_cast<llvm::ConstantInt>(PoolSize)) {
+    Pool = ConstantSize->isZero()? nullptr : CreateTempHeapAlloca(PoolSize);
+  } else {
+    auto EntryBB = Builder.GetInsertBlock();
+    auto HeapBB = createBasicBlock("automatic-arrays-heap");
+    auto EndBB = createBasicBlock("automatic-arrays-end");
+    Builder.CreateCondBr(Builder.CreateICmpEQ(PoolSize, Zero), EndBB, HeapBB);
+    EmitBlock(HeapBB);
+    auto HeapPtr = CGM.getSystemRuntime().EmitMalloc(*this, PoolSize);
+    EmitBranch(EndBB);
+    EmitBlock(EndBB);
+    auto Phi = Builder.CreatePHI(HeapPtr->getType(), 2, "automatic-arrays");
+    Phi->addIncoming(llvm::Constant::getNullValue(HeapPtr->getType()), EntryBB);
+    Phi->addIncoming(HeapPtr, HeapBB);
+    TempHeapAllocations.push_back(Phi);
+    Pool = Phi;
+  }
+
+  for(size_t I = 0; I < AutomaticArrays.size(); ++I) {
+    auto D = AutomaticArrays[I];
+    llvm::Value *Ptr = nullptr;
+    if(Pool)
+      Ptr = Builder.CreateGEP(Pool, Offsets[I]);
+    if(!StackPtrs[I]) {
+      // Keep the type of the fixed size arrays.
+      Ptr = Builder.CreateBitCast(Ptr, llvm::PointerType::get(ConvertTypeForMem(D->getType()), 0),
+                                  D->getName());
+    } else if(Ptr) {
+      Ptr = Builder.CreateSelect(IsOnStack[I], StackPtrs[I],
+                                 Builder.CreateBitCast(Ptr, StackPtrs[I]->getType()),
+                                 D->getName());
+    } else
+      Ptr = StackPtrs[I];
+    LocalVariables.insert(std::make_pair(D, Ptr));
+  }
+}
+
+void CodeGenFunction::EmitAllocatableArray(const VarDecl *D) {
+  auto DescriptorType = getTypes().GetArrayDescriptorType(D->getType()->asArrayType());
+  llvm::Value *Descriptor;
+  if(D->getType().hasAttributeSpec(Qualifiers::AS_save) && !IsMainProgram) {
+    Descriptor = CGM.EmitGlobalVariable(GetSavedVariablePrefix(), D->getName(),
+                                        DescriptorType,
+                                        llvm::Constant::getNullValue(DescriptorType));
+  } else {
+    Descriptor = Builder.CreateAlloca(DescriptorType, nullptr, D->getName());
+    DecorateAccessWithTBAA(Builder.CreateStore(llvm::Constant::getNullValue(DescriptorType->getElementType(0)),
+                                               Builder.CreateStructGEP(nullptr, Descriptor, 0)),
+                           CGM.getTBAADescriptorInfo());
+    AllocatableArrays.push_back(D);
+  }
+  LocalVariables.insert(std::make_pair(D, Descriptor));
+}
+
+void CodeGenFunction::GetAllocatableArrayDimensions(const VarDecl *D,
+                                                    SmallVectorImpl<ArrayDimensionValueTy> &Dims) {
+  auto DimsPtr = Builder.CreateStructGEP(nullptr, GetVarPtr(D), 2);
+  auto One = llvm::ConstantInt::get(CGM.SizeTy, 1);
+  auto Rank = D->getType()->asArrayType()->getDimensionCount();
+  llvm::Value *Stride = nullptr;
+  for(size_t I = 0; I < Rank; ++I) {
+    llvm::Value *LowerBoundIdx[] = { Builder.getInt32(0), Builder.getInt32(I), Builder.getInt32(0) };
+    llvm::Value *ExtentIdx[] = { Builder.getInt32(0), Builder.getInt32(I), Builder.getInt32(1) };
+    auto LB = Builder.CreateLoad(Builder.CreateInBoundsGEP(DimsPtr, LowerBoundIdx));
+    auto Extent = Builder.CreateLoad(Builder.CreateInBoundsGEP(DimsPtr, ExtentIdx));
+    DecorateAccessWithTBAA(LB, CGM.getTBAADescriptorInfo());
+    DecorateAccessWithTBAA(Extent, CGM.getTBAADescriptorInfo());
+    Dims.push_back(ArrayDimensionValueTy(LB, Builder.CreateSub(Builder.CreateAdd(LB, Extent), One),
+                                         Stride));
+    Stride = Stride? Builder.CreateMul(Stride, Extent) : Extent;
+  }
+}
+
+llvm::Value *CodeGenFunction::EmitAllocatableArrayPtr(const VarDecl *D) {
+  auto Ptr = Builder.CreateLoad(Builder.CreateStructGEP(nullptr, GetVarPtr(D), 0),
+                                D->getName());
+  DecorateAccessWithTBAA(Ptr, CGM.getTBAADescriptorInfo());
+  return Ptr;
+}
+
+void CodeGenFunction::EmitAllocateStmt(const AllocateStmt *S) {
+  auto Zero = llvm::ConstantInt::get(CGM.SizeTy, 0);
+  auto One = llvm::ConstantInt::get(CGM.SizeTy, 1);
+  auto Objects = S->getObjects();
+  for(size_t I = 0; I < Objects.size(); ++I) {
+    auto D = cast<VarExpr>(Objects[I])->getVarDecl();
+    auto ATy = D->getType()->asArrayType();
+    auto Descriptor = GetVarPtr(D);
+    auto DimsPtr = Builder.CreateStructGEP(nullptr, Descriptor, 2);
+    auto ElementSize = llvm::ConstantInt::get(CGM.SizeTy,
+                         CGM.getDataLayout().getTypeStoreSize(ConvertTypeForMem(ATy->getElementType())));
+
+    // The array is contiguous, so after the last dimension
+    // the byte stride is the size of the whole array.
+    auto Shape = S->getObjectShape(I);
+    llvm::Value *ByteStride = ElementSize;
+    for(size_t J = 0; J < Shape.size(); ++J) {
+      auto Explicit = cast<ExplicitShapeSpec>(Shape[J]);
+      auto LB = Explicit->hasLowerBound()? EmitSizeIntExpr(Explicit->getLowerBound()) : One;
+      auto UB = EmitSizeIntExpr(Explicit->getUpperBound());
+      // An empty dimension gives an empty array.
+      auto Extent = Builder.CreateAdd(Builder.CreateSub(UB, LB), One);
+      Extent = Builder.CreateSelect(Builder.CreateICmpSLT(Extent, Zero), Zero, Extent);
+      llvm::Value *Fields[] = { LB, Extent, ByteStride };
+      for(unsigned K = 0; K < 3; ++K) {
+        llvm::Value *Idx[] = { Builder.getInt32(0), Builder.getInt32(J), Builder.getInt32(K) };
+        DecorateAccessWithTBAA(Builder.CreateStore(Fields[K], Builder.CreateInBoundsGEP(DimsPtr, Idx)),
+                               CGM.getTBAADescriptorInfo());
+      }
+      ByteStride = Builder.CreateMul(ByteStride, Extent);
+    }
+
+    auto Ptr = CGM.getSystemRuntime().EmitAllocate(*this, ByteStride);
+    DecorateAccessWithTBAA(Builder.CreateStore(Builder.CreateBitCast(Ptr, getTypes().ConvertArrayType(ATy)),
+                                               Builder.CreateStructGEP(nullptr, Descriptor, 0)),
+                           CGM.getTBAADescriptorInfo());
+    DecorateAccessWithTBAA(Builder.CreateStore(ElementSize, Builder.CreateStructGEP(nullptr, Descriptor, 1)),
+                           CGM.getTBAADescriptorInfo());
+  }
+}
+
+void CodeGenFunction::EmitArrayDeallocation(const VarDecl *D) {
+  // The size of the array is the extent of the last
+  // dimension multiplied by its byte stride.
+  auto Descriptor = GetVarPtr(D);
+  auto Last = D->getType()->asArrayType()->getDimensionCount() - 1;
+  auto DimsPtr = Builder.CreateStructGEP(nullptr, Descriptor, 2);
+  llvm::Value *ExtentIdx[] = { Builder.getInt32(0), Builder.getInt32(Last), Builder.getInt32(1) };
+  llvm::Value *StrideIdx[] = { Builder.getInt32(0), Builder.getInt32(Last), Builder.getInt32(2) };
+  auto Extent = Builder.CreateLoad(Builder.CreateInBoundsGEP(DimsPtr, ExtentIdx));
+  auto ByteStride = Builder.CreateLoad(Builder.CreateInBoundsGEP(DimsPtr, StrideIdx));
+  DecorateAccessWithTBAA(Extent, CGM.getTBAADescriptorInfo());
+  DecorateAccessWithTBAA(ByteStride, CGM.getTBAADescriptorInfo());
+  auto Size = Builder.CreateMul(Extent, ByteStride);
+  auto PtrField = Builder.CreateStructGEP(nullptr, Descriptor, 0);
+  auto Ptr = Builder.CreateLoad(PtrField);
+  DecorateAccessWithTBAA(Ptr, CGM.getTBAADescriptorInfo());
+  CGM.getSystemRuntime().EmitDeallocate(*this, Ptr, Size);
+  DecorateAccessWithTBAA(Builder.CreateStore(llvm::Constant::getNullValue(Ptr->getType()), PtrField),
+                         CGM.getTBAADescriptorInfo());
+}
+
+void CodeGenFunction::EmitDeallocateStmt(const DeallocateStmt *S) {
+  for(auto E : S->getObjects())
+    EmitArrayDeallocation(cast<VarExpr>(E)->getVarDecl());
+}
+
+void CodeGenFunction::EmitAllocatableArraysCleanup() {
+  for(auto D : AllocatableArrays) {
+    auto DeallocateBB = createBasicBlock("deallocate");
+    auto EndBB = createBasicBlock("deallocate-end");
+    Builder.CreateCondBr(Builder.CreateIsNull(EmitAllocatableArrayPtr(D)),
+                         EndBB, DeallocateBB);
+    EmitBlock(DeallocateBB);
+    EmitArrayDeallocation(D);
+    EmitBlock(EndBB);
+  }
+}
+
 llvm::Value *CodeGenFunction::CreateTempHeapArrayAlloca(QualType T,
                                                         llvm::Value *Size) {
   auto ETy = getTypes().ConvertTypeForMem(T.getSelfOrArrayElementType());
@@ -237,9 +452,22 @@ void ArrayValueExprEmitter::VisitVarExpr(const VarExpr *E) {
   if(VD->isParameter())
     return EmitExpr(VD->getInit());
 
-  CGF.GetArrayDimensionsInfo(VD->getType(), Dims);
+  auto ATy = VD->getType()->asArrayType();
+  if(ATy->isAllocatable()) {
+    CGF.GetAllocatableArrayDimensions(VD, Dims);
+    if(GetPointer)
+      Ptr = CGF.EmitAllocatableArrayPtr(VD);
+    EmitSections();
+    return;
+  }
+  if(VD->isArgument() && ATy->isAssumedShape())
+    CGF.GetAssumedShapeArgDimensions(VD, Dims);
+  else
+    CGF.GetArrayDimensionsInfo(VD->getType(), Dims);
   if(GetPointer) {
-    if(VD->isArgument())
+    // The automatic arrays are stored as pointers to the first element.
+    if(VD->isArgument() ||
+       !CGF.GetVarPtr(VD)->getType()->getPointerElementType()->isArrayTy())
       Ptr = CGF.GetVarPtr(VD);
     else
       Ptr = Builder.CreateConstInBoundsGEP2_32(
@@ -251,8 +479,13 @@ void ArrayValueExprEmitter::VisitVarExpr(const VarExpr *E) {
 
 void ArrayValueExprEmitter::VisitArrayConstructorExpr(const ArrayConstructorExpr *E) {
   if(!GetPointer) {
-    // FIXME
-    CGF.GetArrayDimensionsInfo(E->getType(), Dims);
+    auto ATy = E->getType()->asArrayType();
+    uint64_t Size;
+    if(ATy->EvaluateSize(Size, CGF.getContext()))
+      CGF.GetArrayDimensionsInfo(E->getType(), Dims);
+    else
+      Dims.push_back(ArrayDimensionValueTy(nullptr,
+        ArrayConstructorEmitter(CGF, ATy->getElementType()).EmitSize(E->getItems())));
     EmitSections();
     return;
   }
@@ -266,6 +499,19 @@ void ArrayValueExprEmitter::VisitArrayConstructorExpr(const ArrayConstructorExpr
   EmitSections();
 }
 
+void ArrayValueExprEmitter::VisitIntrinsicCallExpr(const IntrinsicCallExpr *E) {
+  // PACK, UNPACK and the locations in the whole array
+  // are computed in a temporary array.
+  if(ArrayLocationEmitter::isLocationArray(E)) {
+    Ptr = ArrayLocationEmitter(CGF, intrinsic::getGenericFunctionKind(E->getIntrinsicFunction()),
+                               E->getArguments()).EmitLocationArray(Dims);
+  } else {
+    assert(PackEmitter::isPack(E));
+    Ptr = PackEmitter(CGF, E).EmitTemporary(Dims);
+  }
+  EmitSections();
+}
+
 void ArrayValueExprEmitter::IncrementOffset(llvm::Value *OffsetDelta) {
   Offset = Offset? Builder.CreateAdd(Offset, OffsetDelta) : OffsetDelta;
 }
@@ -335,10 +581,26 @@ void StandaloneArrayValueSectionGatherer::VisitImplicitCastExpr(const ImplicitCa
 }
 
 void StandaloneArrayValueSectionGatherer::VisitIntrinsicCallExpr(const IntrinsicCallExpr *E) {
+  if(ArrayReductionEmitter::isArrayReduction(E) || MatmulEmitter::isMatmul(E) ||
+     ArrayViewEmitter::isView(E) || PackEmitter::isPack(E) ||
+     ArrayLocationEmitter::isLocationArray(E)) {
+    GatherSections(E);
+    return;
+  }
+  if(intrinsic::getGenericFunctionKind(E->getIntrinsicFunction()) == intrinsic::MERGE) {
+    for(auto Arg : E->getArguments())
+      EmitExpr(Arg);
+    return;
+  }
   // FIXME
   EmitExpr(E->getArguments()[0]);
 }
 
+void StandaloneArrayValueSectionGatherer::VisitCallExpr(const CallExpr *E) {
+  for(auto Arg : E->getArguments())
+    EmitExpr(Arg);
+}
+
 void StandaloneArrayValueSectionGatherer::VisitArraySectionExpr(const ArraySectionExpr *E) {
   GatherSections(E);
 }
@@ -369,6 +631,113 @@ void ArrayOperation::EmitArraySections(CodeGenFunction &CGF, const Expr *E) {
 
   for(auto D : EV.getDimensions())
     Dims.push_back(D);
+
+  if(auto Call = dyn_cast<IntrinsicCallExpr>(E)) {
+    if(PackEmitter::isPack(Call))
+      Temporaries.push_back(ArrayValue.Ptr);
+  }
+}
+
+void ArrayOperation::FreeTemporaries(CodeGenFunction &CGF) {
+  for(auto Ptr : Temporaries)
+    CGF.FreeTempHeapAlloca(Ptr);
+  Temporaries.clear();
+}
+
+void ArrayOperation::EmitReducedArraySections(const Expr *E, const Expr *Source,
+                                              unsigned Dim) {
+  if(Arrays.find(E) != Arrays.end())
+    return;
+
+  auto SourceValue = getArrayValue(Source);
+  SmallVector<ArrayDimensionValueTy, 8> SourceDims(SourceValue.Dimensions.begin(),
+                                                   SourceValue.Dimensions.end());
+  ReducedDimensions[E] = SourceDims[Dim];
+
+  // The result is only used to determine the shape of the operation.
+  StoredArrayValue ArrayValue;
+  ArrayValue.DataOffset = Dims.size();
+  ArrayValue.Ptr = nullptr;
+  ArrayValue.Offset = nullptr;
+  Arrays[E] = ArrayValue;
+
+  for(size_t I = 0; I < SourceDims.size(); ++I) {
+    if(I != Dim)
+      Dims.push_back(SourceDims[I]);
+  }
+}
+
+void ArrayOperation::EmitMatmulArraySections(const Expr *E, const Expr *MatrixA,
+                                             const Expr *MatrixB) {
+  if(Arrays.find(E) != Arrays.end())
+    return;
+
+  auto A = getArrayValue(MatrixA);
+  auto B = getArrayValue(MatrixB);
+  SmallVector<ArrayDimensionValueTy, 2> ResultDims;
+  if(A.Dimensions.size() == 2)
+    ResultDims.push_back(A.Dimensions[0]);
+  if(B.Dimensions.size() == 2)
+    ResultDims.push_back(B.Dimensions[1]);
+  ReducedDimensions[E] = A.Dimensions.back();
+
+  // The result is only used to determine the shape of the operation.
+  StoredArrayValue ArrayValue;
+  ArrayValue.DataOffset = Dims.size();
+  ArrayValue.Ptr = nullptr;
+  ArrayValue.Offset = nullptr;
+  Arrays[E] = ArrayValue;
+
+  for(auto D : ResultDims)
+    Dims.push_back(D);
+}
+
+void ArrayOperation::EmitViewArraySections(CodeGenFunction &CGF,
+                                           const IntrinsicCallExpr *E,
+                                           const Expr *Source) {
+  if(Arrays.find(E) != Arrays.end())
+    return;
+
+  SmallVector<ArrayDimensionValueTy, 8> SourceDims;
+  if(Source) {
+    auto SourceValue = getArrayValue(Source);
+    SourceDims.append(SourceValue.Dimensions.begin(), SourceValue.Dimensions.end());
+  }
+  SmallVector<ArrayDimensionValueTy, 8> ViewDims;
+  ArrayViewEmitter View(CGF, E);
+  View.EmitDimensions(SourceDims, ViewDims);
+  ViewSources[E] = Source;
+  if(ArrayViewEmitter::isShift(E))
+    ShiftOffsets[E] = View.EmitShiftOffset(SourceDims);
+
+  // The view is only used to determine the shape of the operation.
+  StoredArrayValue ArrayValue;
+  ArrayValue.DataOffset = Dims.size();
+  ArrayValue.Ptr = nullptr;
+  ArrayValue.Offset = nullptr;
+  Arrays[E] = ArrayValue;
+
+  for(auto D : ViewDims)
+    Dims.push_back(D);
+}
+
+void ArrayOperation::EmitFusedArrayConstructorSections(CodeGenFunction &CGF,
+                                                       const ArrayConstructorExpr *E) {
+  if(Arrays.find(E) != Arrays.end())
+    return;
+
+  ArrayConstructorEmitter Constructor(CGF, E->getType()->asArrayType()->getElementType());
+  auto ImpliedDo = Constructor.EmitImpliedDoValue(cast<ImpliedDoExpr>(E->getItems()[0]));
+  FusedImpliedDos[E] = ImpliedDo;
+
+  // The elements are computed in the loop.
+  StoredArrayValue ArrayValue;
+  ArrayValue.DataOffset = Dims.size();
+  ArrayValue.Ptr = nullptr;
+  ArrayValue.Offset = nullptr;
+  Arrays[E] = ArrayValue;
+
+  Dims.push_back(ArrayDimensionValueTy(nullptr, ImpliedDo.IterationCount));
 }
 
 RValueTy ArrayOperation::getScalarValue(const Expr *E) {
@@ -386,10 +755,17 @@ class ScalarEmitterAndSectionGatherer : public ConstExprVisitor<ScalarEmitterAnd
   CodeGenFunction &CGF;
   ArrayOperation &ArrayOp;
   const Expr *LastArrayEmmitted;
+
+  /// Elemental - set when the implied do array constructors can be
+  /// fused into the operation's loop. It is cleared for the arguments
+  /// of a transformational intrinsic, whose elements aren't accessed
+  /// in the current iteration of the loop.
+  bool Elemental;
 public:
 
   ScalarEmitterAndSectionGatherer(CodeGenFunction &cgf, ArrayOperation &ArrOp)
-    : CGF(cgf), ArrayOp(ArrOp), LastArrayEmmitted(nullptr) {}
+    : CGF(cgf), ArrayOp(ArrOp), LastArrayEmmitted(nullptr),
+      Elemental(ArrOp.FuseArrayConstructors) {}
 
   void Emit(const Expr *E);
   void VisitVarExpr(const VarExpr *E);
@@ -399,6 +775,7 @@ public:
   void VisitArrayConstructorExpr(const ArrayConstructorExpr *E);
   void VisitArraySectionExpr(const ArraySectionExpr *E);
   void VisitIntrinsicCallExpr(const IntrinsicCallExpr *E);
+  void VisitCallExpr(const CallExpr *E);
 
   const Expr *getLastEmmittedArray() const {
     return LastArrayEmmitted;
@@ -430,7 +807,10 @@ void ScalarEmitterAndSectionGatherer::VisitBinaryExpr(const BinaryExpr *E) {
 }
 
 void ScalarEmitterAndSectionGatherer::VisitArrayConstructorExpr(const ArrayConstructorExpr *E) {
-  ArrayOp.EmitArraySections(CGF, E);
+  if(Elemental && ArrayConstructorEmitter::isFusible(E))
+    ArrayOp.EmitFusedArrayConstructorSections(CGF, E);
+  else
+    ArrayOp.EmitArraySections(CGF, E);
   LastArrayEmmitted = E;
 }
 
@@ -441,6 +821,56 @@ void ScalarEmitterAndSectionGatherer::VisitArraySectionExpr(const ArraySectionEx
 }
 
 void ScalarEmitterAndSectionGatherer::VisitIntrinsicCallExpr(const IntrinsicCallExpr *E) {
+  if(PackEmitter::isPack(E) || ArrayLocationEmitter::isLocationArray(E)) {
+    ArrayOp.EmitArraySections(CGF, E);
+    LastArrayEmmitted = E;
+    return;
+  }
+  auto SavedElemental = Elemental;
+  if(ArrayReductionEmitter::isArrayReduction(E)) {
+    auto Args = E->getArguments();
+    Elemental = false;
+    Emit(Args[0]);
+    auto Source = LastArrayEmmitted;
+    for(auto I : Args.slice(1))
+      Emit(I);
+    Elemental = SavedElemental;
+    ArrayOp.EmitReducedArraySections(E, Source,
+      ArrayReductionEmitter::getReducedDimension(CGF.getContext(), E));
+    LastArrayEmmitted = E;
+    return;
+  }
+  if(MatmulEmitter::isMatmul(E)) {
+    auto Args = E->getArguments();
+    Elemental = false;
+    Emit(Args[0]);
+    auto MatrixA = LastArrayEmmitted;
+    Emit(Args[1]);
+    Elemental = SavedElemental;
+    ArrayOp.EmitMatmulArraySections(E, MatrixA, LastArrayEmmitted);
+    LastArrayEmmitted = E;
+    return;
+  }
+  if(ArrayViewEmitter::isView(E)) {
+    // The other arguments are used to determine the shape of the view.
+    auto Source = E->getArguments()[0];
+    Elemental = false;
+    Emit(Source);
+    if(auto Boundary = ArrayViewEmitter::getBoundary(E))
+      Emit(Boundary);
+    Elemental = SavedElemental;
+    ArrayOp.EmitViewArraySections(CGF, E, Source->getType()->isArrayType()?
+                                            LastArrayEmmitted : nullptr);
+    LastArrayEmmitted = E;
+    return;
+  }
+  for(auto I : E->getArguments())
+    Emit(I);
+}
+
+void ScalarEmitterAndSectionGatherer::VisitCallExpr(const CallExpr *E) {
+  // The scalar arguments of an elemental function
+  // are evaluated once before the loop.
   for(auto I : E->getArguments())
     Emit(I);
 }
@@ -460,46 +890,81 @@ ArrayValueRef ArrayOperation::EmitArrayExpr(CodeGenFunction &CGF, const Expr *E)
 // Foreach element in given sections loop emmitter for array operations
 //
 
-ArrayLoopEmitter::ArrayLoopEmitter(CodeGenFunction &cgf)
-  : CGF(cgf), Builder(cgf.getBuilder())
+ArrayLoopEmitter::ArrayLoopEmitter(CodeGenFunction &cgf, const char *name)
+  : CGF(cgf), Builder(cgf.getBuilder()), Name(name), Hints(nullptr)
 { }
 
 void ArrayLoopEmitter::EmitArrayIterationBegin(const ArrayValueRef &Array) {
-  auto IndexType = CGF.getModule().SizeTy;
-
-  auto Dimensions = Array.Dimensions;
-  Elements.resize(Dimensions.size());
-  Loops.resize(Dimensions.size());
-
   // Foreach section from back to front (column major
   // order for efficient memory access).
-  for(auto I = Dimensions.size(); I!=0;) {
-    --I;
-    auto Var = CGF.CreateTempAlloca(IndexType,"array-dim-loop-counter");
-    Builder.CreateStore(llvm::ConstantInt::get(IndexType, 0), Var);
-    auto LoopCond = CGF.createBasicBlock("array-dim-loop");
-    auto LoopBody = CGF.createBasicBlock("array-dim-loop-body");
-    auto LoopEnd = CGF.createBasicBlock("array-dim-loop-end");
-    CGF.EmitBlock(LoopCond);
-    Builder.CreateCondBr(Builder.CreateICmpULT(Builder.CreateLoad(Var), CGF.EmitSectionSize(Array, I)),
-                         LoopBody, LoopEnd);
-    CGF.EmitBlock(LoopBody);
-    Elements[I] = Builder.CreateLoad(Var);
+  for(auto I = Array.Dimensions.size(); I!=0;)
+    EmitDimensionIterationBegin(Array, --I);
+}
+
+void ArrayLoopEmitter::EmitDimensionIterationBegin(const ArrayValueRef &Array,
+                                                   size_t I) {
+  EmitDimensionIterationBegin(Array, I,
+                              llvm::ConstantInt::get(CGF.getModule().SizeTy, 0),
+                              CGF.EmitSectionSize(Array, I));
+}
 
-    Loops[I].EndBlock = LoopEnd;
-    Loops[I].TestBlock = LoopCond;
-    Loops[I].Counter = Var;
+void ArrayLoopEmitter::EmitDimensionIterationBegin(const ArrayValueRef &Array,
+                                                   size_t I, llvm::Value *Begin,
+                                                   llvm::Value *End) {
+  auto IndexType = CGF.getModule().SizeTy;
+  if(Elements.size() < Array.Dimensions.size()) {
+    Elements.resize(Array.Dimensions.size());
+    Loops.resize(Array.Dimensions.size());
+  }
+
+  auto Var = CGF.CreateTempAlloca(IndexType, llvm::Twine(Name) + "-counter");
+  Builder.CreateStore(Begin, Var);
+  auto LoopCond = CGF.createBasicBlock(Name);
+  auto LoopBody = CGF.createBasicBlock(llvm::Twine(Name) + "-body");
+  auto LoopEnd = CGF.createBasicBlock(llvm::Twine(Name) + "-end");
+  CGF.EmitBlock(LoopCond);
+  Builder.CreateCondBr(Builder.CreateICmpULT(Builder.CreateLoad(Var), End),
+                       LoopBody, LoopEnd);
+  CGF.EmitBlock(LoopBody);
+  Elements[I] = Builder.CreateLoad(Var);
+
+  Loops[I].EndBlock = LoopEnd;
+  Loops[I].TestBlock = LoopCond;
+  Loops[I].Counter = Var;
+}
+
+void ArrayLoopEmitter::setElement(size_t I, llvm::Value *Index) {
+  if(Elements.size() <= I) {
+    Elements.resize(I + 1);
+    Loops.resize(I + 1);
   }
+  Elements[I] = Index;
+}
+
+void ArrayLoopEmitter::EmitDimensionIterationEnd(size_t I) {
+  auto &Loop = Loops[I];
+  Builder.CreateStore(Builder.CreateAdd(Builder.CreateLoad(Loop.Counter),
+                        llvm::ConstantInt::get(CGF.getModule().SizeTy, 1)),
+                      Loop.Counter);
+  CGF.EmitBranch(Loop.TestBlock);
+  CGF.EmitBlock(Loop.EndBlock);
+  Loop.EndBlock = nullptr;
 }
 
 void ArrayLoopEmitter::EmitArrayIterationEnd() {
   // foreach loop from front to back.
+  bool IsInnermost = true;
   for(auto Loop : Loops) {
     if(Loop.EndBlock) {
       Builder.CreateStore(Builder.CreateAdd(Builder.CreateLoad(Loop.Counter),
                             llvm::ConstantInt::get(CGF.getModule().SizeTy, 1)),
                           Loop.Counter);
+      auto Latch = Builder.GetInsertBlock();
       CGF.EmitBranch(Loop.TestBlock);
+      if(IsInnermost && Hints && Latch)
+        CGF.EmitLoopHints(Hints, Loop.TestBlock, Loop.EndBlock,
+                          cast<llvm::BranchInst>(Latch->getTerminator()));
+      IsInnermost = false;
       CGF.EmitBlock(Loop.EndBlock);
     }
   }
@@ -546,6 +1011,8 @@ RValueTy ArrayOperationEmitter::Emit(const Expr *E) {
 }
 
 RValueTy ArrayOperationEmitter::VisitVarExpr(const VarExpr *E) {
+  if(Operation.hasElementValue(E->getVarDecl()))
+    return Operation.getElementValue(E->getVarDecl());
   return CGF.EmitLoad(Looper.EmitElementPointer(Operation.getArrayValue(E)), ElementType(E));
 }
 
@@ -562,6 +1029,9 @@ RValueTy ArrayOperationEmitter::VisitBinaryExpr(const BinaryExpr *E) {
 }
 
 RValueTy ArrayOperationEmitter::VisitArrayConstructorExpr(const ArrayConstructorExpr *E) {
+  if(Operation.isFusedArrayConstructor(E))
+    return ArrayConstructorEmitter(CGF, ElementType(E)).EmitFusedElement(
+             Operation.getFusedImpliedDo(E), Looper.getElement(0));
   return CGF.EmitLoad(Looper.EmitElementPointer(Operation.getArrayValue(E)), ElementType(E));
 }
 
@@ -613,12 +1083,37 @@ RValueTy ArrayOperationEmitter::VisitIntrinsicCallExpr(const IntrinsicCallExpr *
              Args.size() > 1? Emit(Args[1]).asScalar() : nullptr,
              Args.size() > 2? Emit(Args[2]).asScalar() : nullptr);
   }
+
+  case GROUP_ARRAY:
+    if(Func == MERGE) {
+      auto Mask = Emit(Args[2]).asScalar();
+      if(Mask->getType() != CGF.getModule().Int1Ty)
+        Mask = CGF.ConvertLogicalValueToInt1(Mask);
+      return CGF.EmitMergeIntrinsic(ElementType(E), Mask, Emit(Args[0]), Emit(Args[1]));
+    }
+    if(PackEmitter::isPack(E) || ArrayLocationEmitter::isLocationArray(E))
+      return CGF.EmitLoad(Looper.EmitElementPointer(Operation.getArrayValue(E)), ElementType(E));
+    if(ArrayLocationEmitter::isLocation(Func))
+      return ArrayLocationEmitter(CGF, Func, Args).EmitResultElement(Operation, Looper, E);
+    if(Func == MATMUL)
+      return MatmulEmitter(CGF, Args).EmitResultElement(Operation, Looper, E);
+    if(ArrayViewEmitter::isView(E))
+      return ArrayViewEmitter(CGF, E).EmitElement(Operation, Looper);
+    return ArrayReductionEmitter(CGF, Func, Args).EmitResultElement(Operation,
+                                                                    Looper, E);
   default:
     llvm_unreachable("invalid intrinsic group");
   }
   return RValueTy();
 }
 
+RValueTy ArrayOperationEmitter::VisitCallExpr(const CallExpr *E) {
+  SmallVector<RValueTy, 8> Args;
+  for(auto Arg : E->getArguments())
+    Args.push_back(Emit(Arg));
+  return CGF.EmitElementalCall(E->getFunction(), Args);
+}
+
 LValueTy ArrayOperationEmitter::EmitLValue(const Expr *E) {
   return Looper.EmitElementPointer(Operation.getArrayValue(E));
 }
@@ -662,29 +1157,184 @@ llvm::Value *CodeGenFunction::EmitArrayElementPtr(const Expr *Target,
   return EmitArrayElementPtr(Subs, EV.getResult());
 }
 
+/// \brief Gets the dimensions of a contiguous array
+/// with the same shape as the given array.
+static void GetContiguousDimensions(CodeGenFunction &CGF,
+                                    ArrayRef<ArrayDimensionValueTy> Source,
+                                    SmallVectorImpl<ArrayDimensionValueTy> &Dims) {
+  auto &Builder = CGF.getBuilder();
+  llvm::Value *Stride = nullptr;
+  for(auto Dim : Source) {
+    auto Size = CGF.EmitDimSize(Dim);
+    Dims.push_back(ArrayDimensionValueTy(nullptr, Size, Stride));
+    Stride = Stride? Builder.CreateMul(Stride, Size) : Size;
+  }
+}
+
+/// \brief Evaluates the array expression into a
+/// temporary array which is passed as an argument.
+static llvm::Value *EmitTempArrayArgument(CodeGenFunction &CGF,
+                                          const ImplicitTempArrayExpr *Temp,
+                                          SmallVectorImpl<ArrayDimensionValueTy> &Dims) {
+  auto E = Temp->getExpression();
+  ArrayOperation OP;
+  StandaloneArrayValueSectionGatherer EV(CGF, OP);
+  EV.EmitExpr(E);
+  auto Value = EV.getResult();
+  auto DestPtr = CGF.CreateTempHeapArrayAlloca(E->getType(), Value);
+  GetContiguousDimensions(CGF, Value.Dimensions, Dims);
+  auto Dest = ArrayValueRef(Dims, DestPtr);
+  OP.EmitAllScalarValuesAndArraySections(CGF, E);
+  ArrayLoopEmitter Looper(CGF);
+  Looper.EmitArrayIterationBegin(Value);
+  CodeGen::EmitArrayAssignment(CGF, OP, Looper, Dest, E);
+  Looper.EmitArrayIterationEnd();
+  OP.FreeTemporaries(CGF);
+  return DestPtr;
+}
+
 llvm::Value *CodeGenFunction::EmitArrayArgumentPointerValueABI(const Expr *E) {
   if(auto Temp = dyn_cast<ImplicitTempArrayExpr>(E)) {
-    E = Temp->getExpression();
-    ArrayOperation OP;
-    StandaloneArrayValueSectionGatherer EV(*this, OP);
+    SmallVector<ArrayDimensionValueTy, 8> Dims;
+    return EmitTempArrayArgument(*this, Temp, Dims);
+  }
+  assert(!isa<ImplicitArrayPackExpr>(E) &&
+         "strided array arguments are packed by EmitArrayArgumentPackABI");
+
+  ArrayValueExprEmitter EV(*this);
+  EV.EmitExpr(E);
+  return EV.getPointer();
+}
+
+llvm::Value *CodeGenFunction::EmitArrayArgumentDescriptorABI(const Expr *E) {
+  // An allocatable array already has a contiguous descriptor.
+  if(auto Var = dyn_cast<VarExpr>(E)) {
+    auto ATy = Var->getType()->asArrayType();
+    if(ATy && ATy->isAllocatable())
+      return GetVarPtr(Var->getVarDecl());
+  }
+
+  SmallVector<ArrayDimensionValueTy, 8> Dims;
+  llvm::Value *Ptr;
+  if(auto Temp = dyn_cast<ImplicitTempArrayExpr>(E))
+    Ptr = EmitTempArrayArgument(*this, Temp, Dims);
+  else {
+    ArrayValueExprEmitter EV(*this);
     EV.EmitExpr(E);
     auto Value = EV.getResult();
-    auto DestPtr = CreateTempHeapArrayAlloca(E->getType(), Value);
-    auto Dest = ArrayValueRef(Value.Dimensions, DestPtr);
-    OP.EmitAllScalarValuesAndArraySections(*this, E);
-    ArrayLoopEmitter Looper(*this);
-    Looper.EmitArrayIterationBegin(Value);
-    CodeGen::EmitArrayAssignment(*this, OP, Looper, Dest, E);
-    Looper.EmitArrayIterationEnd();
-    return DestPtr;
+    Dims.append(Value.Dimensions.begin(), Value.Dimensions.end());
+    Ptr = Value.Ptr;
   }
-  else if(auto Pack = dyn_cast<ImplicitArrayPackExpr>(E)) {
-    // FIXME strided array - allocate memory and pack / unpack
+
+  // The sections are described in place, so the callee
+  // can access the strided elements without a copy.
+  auto ATy = E->getType()->asArrayType();
+  auto ElementSize = llvm::ConstantInt::get(CGM.SizeTy,
+                       CGM.getDataLayout().getTypeStoreSize(ConvertTypeForMem(ATy->getElementType())));
+  auto Descriptor = CreateTempAlloca(getTypes().GetArrayDescriptorType(ATy),
+                                     "array-descriptor");
+  DecorateAccessWithTBAA(Builder.CreateStore(Ptr, Builder.CreateStructGEP(nullptr, Descriptor, 0)),
+                         CGM.getTBAADescriptorInfo());
+  DecorateAccessWithTBAA(Builder.CreateStore(ElementSize, Builder.CreateStructGEP(nullptr, Descriptor, 1)),
+                         CGM.getTBAADescriptorInfo());
+  auto DimsPtr = Builder.CreateStructGEP(nullptr, Descriptor, 2);
+  auto One = llvm::ConstantInt::get(CGM.SizeTy, 1);
+  for(size_t I = 0; I < Dims.size(); ++I) {
+    llvm::Value *Fields[] = { One, EmitDimSize(Dims[I]),
+                              Builder.CreateMul(Dims[I].hasStride()? Dims[I].Stride : One,
+                                                ElementSize) };
+    for(unsigned J = 0; J < 3; ++J) {
+      llvm::Value *Idx[] = { Builder.getInt32(0), Builder.getInt32(I), Builder.getInt32(J) };
+      DecorateAccessWithTBAA(Builder.CreateStore(Fields[J], Builder.CreateInBoundsGEP(DimsPtr, Idx)),
+                             CGM.getTBAADescriptorInfo());
+    }
   }
+  return Descriptor;
+}
+
+/// \brief Copies the elements of a strided array section into a
+/// contiguous array with the same shape, or back when unpacking.
+static void EmitPackedArrayCopy(CodeGenFunction &CGF, const ArrayValueRef &Section,
+                                llvm::Value *Packed, QualType ElementType,
+                                bool Unpack) {
+  SmallVector<ArrayDimensionValueTy, 8> PackedDims;
+  GetContiguousDimensions(CGF, Section.Dimensions, PackedDims);
+  ArrayValueRef PackedArray(PackedDims, Packed);
+
+  // The packed array is traversed with a unit stride, which
+  // lets the innermost loop be vectorized.
+  ArrayLoopEmitter Looper(CGF);
+  Looper.EmitArrayIterationBegin(Section);
+  auto SectionPtr = Looper.EmitElementPointer(Section);
+  auto PackedPtr = Looper.EmitElementPointer(PackedArray);
+  if(ElementType->isCharacterType()) {
+    // The characters of an element are copied as one block of bytes.
+    auto Size = CGF.getModule().getDataLayout().getTypeStoreSize(
+                  CGF.getTypes().ConvertTypeForMem(ElementType));
+    if(Unpack)
+      CGF.getBuilder().CreateMemCpy(SectionPtr, PackedPtr, Size, 1);
+    else
+      CGF.getBuilder().CreateMemCpy(PackedPtr, SectionPtr, Size, 1);
+  } else if(Unpack)
+    CGF.EmitStore(CGF.EmitLoad(PackedPtr, ElementType), SectionPtr, ElementType);
+  else
+    CGF.EmitStore(CGF.EmitLoad(SectionPtr, ElementType), PackedPtr, ElementType);
+  Looper.EmitArrayIterationEnd();
+}
 
+llvm::Value *CodeGenFunction::EmitArrayArgumentPackABI(CallArgList &Args,
+                                                       const ImplicitArrayPackExpr *E) {
   ArrayValueExprEmitter EV(*this);
-  EV.EmitExpr(E);
-  return EV.getPointer();
+  EV.EmitExpr(E->getExpression());
+  auto Value = EV.getResult();
+  auto ElementType = E->getType()->asArrayType()->getElementType();
+
+  // The sections like A(I:J, K) or A(:, J:J) are often contiguous,
+  // and are passed without a copy.
+  CallArgList::ArrayWriteback Writeback;
+  Writeback.Dimensions.append(Value.Dimensions.begin(), Value.Dimensions.end());
+  Writeback.Ptr = Value.Ptr;
+  Writeback.IsContiguous = EmitArrayIsContiguous(Value);
+  Writeback.ElementType = ElementType;
+  Writeback.Unpack = E->isUnpacked();
+
+  auto ContiguousBB = Builder.GetInsertBlock();
+  auto PackBB = createBasicBlock("pack-argument");
+  auto EndBB = createBasicBlock("pack-argument-end");
+  Builder.CreateCondBr(Writeback.IsContiguous, EndBB, PackBB);
+  EmitBlock(PackBB);
+  auto ETy = getTypes().ConvertTypeForMem(ElementType);
+  auto Size = Builder.CreateMul(EmitArraySize(Value),
+                                llvm::ConstantInt::get(CGM.SizeTy,
+                                                       CGM.getDataLayout().getTypeStoreSize(ETy)));
+  auto Temp = CGM.getSystemRuntime().EmitMalloc(*this, llvm::PointerType::get(ETy, 0), Size);
+  EmitPackedArrayCopy(*this, Value, Temp, ElementType, false);
+  auto PackEndBB = Builder.GetInsertBlock();
+  EmitBranch(EndBB);
+  EmitBlock(EndBB);
+
+  auto Ptr = Builder.CreatePHI(Temp->getType(), 2, "packed-argument");
+  Ptr->addIncoming(Value.Ptr, ContiguousBB);
+  Ptr->addIncoming(Temp, PackEndBB);
+  Writeback.Temp = Ptr;
+  Args.addWriteback(Writeback);
+  return Ptr;
+}
+
+void CodeGenFunction::EmitArrayArgumentWritebacks(const CallArgList &Args) {
+  for(auto &Writeback : Args.getWritebacks()) {
+    auto UnpackBB = createBasicBlock("unpack-argument");
+    auto EndBB = createBasicBlock("unpack-argument-end");
+    Builder.CreateCondBr(Writeback.IsContiguous, EndBB, UnpackBB);
+    EmitBlock(UnpackBB);
+    // INTENT(IN) arguments can't be modified by the call.
+    if(Writeback.Unpack)
+      EmitPackedArrayCopy(*this, Writeback.getSection(), Writeback.Temp,
+                          Writeback.ElementType, true);
+    CGM.getSystemRuntime().EmitFree(*this, Writeback.Temp);
+    EmitBranch(EndBB);
+    EmitBlock(EndBB);
+  }
 }
 
 llvm::Constant *CodeGenFunction::EmitConstantArrayExpr(const ArrayConstructorExpr *E) {
@@ -712,51 +1362,24 @@ llvm::Value *CodeGenFunction::EmitConstantArrayConstructor(const ArrayConstructo
 }
 
 ArrayVectorValueTy CodeGenFunction::EmitTempArrayConstructor(const ArrayConstructorExpr *E) {
-  // FIXME: implied-do
-
-  auto Items = E->getItems();
   auto ATy = E->getType()->asArrayType();
-  auto ETy = ATy->getElementType();
-  llvm::Value *Ptr;
-  ArrayDimensionValueTy Dim;
-  uint64_t Size;
-
-  if(ATy->EvaluateSize(Size, getContext())) {
-    // FIXME: better stack/heap heuristics?
-    if(Size <= 32)
-      Ptr = Builder.CreateConstGEP2_64(CreateTempAlloca(
-                                         getTypes().ConvertArrayTypeForMem(ATy),
-                                         "array-constructor-temp"), 0, 0);
-    else
-      Ptr = CreateTempHeapArrayAlloca(E->getType(), llvm::ConstantInt::get(CGM.SizeTy, Size));
-
-    Dim = GetVectorDimensionInfo(E->getType());
-    uint64_t I = 0;
-    for(auto Item : Items) {
-      if(Item->getType()->isArrayType()) {
-        auto SubATy = Item->getType()->asArrayType();
-        uint64_t SubSize;
-        SubATy->EvaluateSize(SubSize, getContext());
-        ArrayValueExprEmitter EV(*this);
-        EV.EmitExpr(Item);
-        // FIXME: multi dimensional and strided items
-        for(uint64_t J = 0; J < SubSize; ++J,++I) {
-          auto Dest = Builder.CreateConstInBoundsGEP1_64(Ptr, I);
-          EmitStore(EmitLoad(Builder.CreateConstInBoundsGEP1_64(EV.getPointer(), J), ETy),
-                    LValueTy(Dest), ETy);
-        }
-      } else {
-        auto Dest = Builder.CreateConstInBoundsGEP1_64(Ptr, I);
-        EmitStore(EmitRValue(Item), LValueTy(Dest), ETy);
-        ++I;
-      }
-    }
+  ArrayConstructorEmitter Constructor(*this, ATy->getElementType());
+  llvm::Value *Ptr, *Size;
+  uint64_t ConstantSize;
+
+  // FIXME: better stack/heap heuristics?
+  if(ATy->EvaluateSize(ConstantSize, getContext()) && ConstantSize <= 32) {
+    Size = llvm::ConstantInt::get(CGM.SizeTy, ConstantSize);
+    Ptr = Builder.CreateConstGEP2_64(CreateTempAlloca(
+                                       getTypes().ConvertArrayTypeForMem(ATy),
+                                       "array-constructor-temp"), 0, 0);
   } else {
-    // FIXME: compute array size.
-    Ptr = nullptr;
-    assert(false && "FIXME");
+    Size = Constructor.EmitSize(E->getItems());
+    Ptr = CreateTempHeapArrayAlloca(E->getType(), Size);
   }
 
+  ArrayDimensionValueTy Dim(nullptr, Size);
+  Constructor.EmitItems(ArrayValueRef(Dim, Ptr), E->getItems());
   return ArrayVectorValueTy(Dim, Ptr);
 }
 
@@ -767,90 +1390,1212 @@ ArrayVectorValueTy CodeGenFunction::EmitArrayConstructor(const ArrayConstructorE
   return EmitTempArrayConstructor(E);
 }
 
-void CodeGenFunction::EmitArrayAssignment(const Expr *LHS, const Expr *RHS) {  
+llvm::Value *CodeGenFunction::EmitArrayIsContiguous(const ArrayValueRef &Value) {
+  // Stride[I] == Size[0] * ... * Size[I-1] for all dimensions.
+  llvm::Value *Result = nullptr;
+  llvm::Value *Size = llvm::ConstantInt::get(CGM.SizeTy, 1);
+  for(size_t I = 0; I < Value.Dimensions.size(); ++I) {
+    auto Dim = Value.Dimensions[I];
+    if(Dim.hasStride()) {
+      auto Cond = Builder.CreateICmpEQ(Dim.Stride, Size);
+      Result = Result? Builder.CreateAnd(Result, Cond) : Cond;
+    }
+    if(I != Value.Dimensions.size() - 1)
+      Size = Builder.CreateMul(Size, EmitDimSize(Dim));
+  }
+  return Result? Result : Builder.getTrue();
+}
+
+/// Whole arrays and array constructors are always contiguous,
+/// unless the array is a strided assumed-shape argument.
+llvm::Value *CodeGenFunction::EmitArrayOperandIsContiguous(const Expr *E,
+                                                           const ArrayValueRef &Value) {
+  if(auto Var = dyn_cast<VarExpr>(E)) {
+    if(!IsStridedArrayArg(Var->getVarDecl()))
+      return Builder.getTrue();
+  } else if(isa<ArrayConstructorExpr>(E))
+    return Builder.getTrue();
+  return EmitArrayIsContiguous(Value);
+}
+
+/// \brief Returns the byte which can be used to fill an array
+/// with the given scalar value using memset, or null.
+static llvm::Value *GetArrayFillByte(CodeGenFunction &CGF, RValueTy Val,
+                                     QualType ElementType) {
+  auto &Builder = CGF.getBuilder();
+  if(Val.isComplex()) {
+    auto Re = dyn_cast<llvm::Constant>(Val.asComplex().Re);
+    auto Im = dyn_cast<llvm::Constant>(Val.asComplex().Im);
+    if(Re && Im && Re->isNullValue() && Im->isNullValue())
+      return Builder.getInt8(0);
+    return nullptr;
+  }
+  if(!Val.isScalar())
+    return nullptr;
+  auto Scalar = Val.asScalar();
+  if(Scalar->getType() == CGF.getModule().Int1Ty)
+    Scalar = CGF.ConvertLogicalValueToLogicalMemoryValue(Scalar, ElementType);
+  auto C = dyn_cast<llvm::Constant>(Scalar);
+  if(!C)
+    return nullptr;
+  if(C->isNullValue())
+    return Builder.getInt8(0);
+  if(C->getType() == CGF.getModule().Int8Ty)
+    return C;
+  return nullptr;
+}
+
+/// \brief Returns the variable whose storage is used by the given array.
+static const VarDecl *GetArrayBaseVar(const Expr *E) {
+  if(auto Section = dyn_cast<ArraySectionExpr>(E))
+    E = Section->getTarget();
+  if(auto Var = dyn_cast<VarExpr>(E))
+    return Var->getVarDecl();
+  return nullptr;
+}
+
+static bool IsEquivalenced(const VarDecl *VD) {
+  return VD->hasStorageSet() && isa<EquivalenceSet>(VD->getStorageSet());
+}
+
+/// \brief Returns true if the two variables may occupy the same memory.
+/// A variable which is both in a COMMON block and in an EQUIVALENCE
+/// set has only one of them as its storage set, so any equivalenced
+/// variable is assumed to share storage with any other variable that
+/// has a storage set.
+static bool MayShareStorage(const VarDecl *A, const VarDecl *B) {
+  if(A == B)
+    return true;
+  if(!A->hasStorageSet() || !B->hasStorageSet())
+    return false;
+  return IsEquivalenced(A) || IsEquivalenced(B) ||
+         A->getStorageSet() == B->getStorageSet();
+}
+
+/// \brief Returns true if the memory used by the two arrays may overlap.
+static bool MayArraysOverlap(const Expr *LHS, const Expr *RHS) {
+  if(isa<ArrayConstructorExpr>(RHS))
+    return false;
+  auto LHSVar = GetArrayBaseVar(LHS);
+  auto RHSVar = GetArrayBaseVar(RHS);
+  if(!LHSVar || !RHSVar || LHSVar == RHSVar)
+    return true;
+  return IsEquivalenced(LHSVar) || IsEquivalenced(RHSVar);
+}
+
+//
+// Array constructor emitter
+//
+
+/// ArrayConstructorReadChecker - Checks if the items of an array
+/// constructor may read the elements of the given array.
+class ArrayConstructorReadChecker
+  : public ConstExprVisitor<ArrayConstructorReadChecker, bool> {
+  const Expr *Array;
+public:
+
+  ArrayConstructorReadChecker(const Expr *array)
+    : Array(array) {}
+
+  bool Check(const Expr *E) {
+    return E && Visit(E);
+  }
+
+  bool VisitExpr(const Expr *E) {
+    return true;
+  }
+  bool VisitConstantExpr(const ConstantExpr *E) {
+    return false;
+  }
+  bool VisitVarExpr(const VarExpr *E) {
+    return MayArraysOverlap(Array, E);
+  }
+  bool VisitUnaryExpr(const UnaryExpr *E) {
+    return Check(E->getExpression());
+  }
+  bool VisitBinaryExpr(const BinaryExpr *E) {
+    return Check(E->getLHS()) || Check(E->getRHS());
+  }
+  bool VisitImplicitCastExpr(const ImplicitCastExpr *E) {
+    return Check(E->getExpression());
+  }
+  bool VisitIntrinsicCallExpr(const IntrinsicCallExpr *E) {
+    for(auto Arg : E->getArguments()) {
+      if(Check(Arg)) return true;
+    }
+    return false;
+  }
+  bool VisitArrayElementExpr(const ArrayElementExpr *E) {
+    if(Check(E->getTarget())) return true;
+    for(auto Sub : E->getSubscripts()) {
+      if(Check(Sub)) return true;
+    }
+    return false;
+  }
+  bool VisitArraySectionExpr(const ArraySectionExpr *E) {
+    if(Check(E->getTarget())) return true;
+    for(auto Sub : E->getSubscripts()) {
+      if(Check(Sub)) return true;
+    }
+    return false;
+  }
+  bool VisitRangeExpr(const RangeExpr *E) {
+    return Check(E->getFirstExpr()) || Check(E->getSecondExpr());
+  }
+  bool VisitStridedRangeExpr(const StridedRangeExpr *E) {
+    return VisitRangeExpr(E) || Check(E->getStride());
+  }
+  bool VisitImpliedDoExpr(const ImpliedDoExpr *E) {
+    if(Check(E->getInitialParameter()) || Check(E->getTerminalParameter()) ||
+       Check(E->getIncrementationParameter()))
+      return true;
+    for(auto Item : E->getBody()) {
+      if(Check(Item)) return true;
+    }
+    return false;
+  }
+  bool VisitArrayConstructorExpr(const ArrayConstructorExpr *E) {
+    for(auto Item : E->getItems()) {
+      if(Check(Item)) return true;
+    }
+    return false;
+  }
+};
+
+ArrayConstructorEmitter::ArrayConstructorEmitter(CodeGenFunction &cgf,
+                                                 QualType ElemType)
+  : CGF(cgf), Builder(cgf.getBuilder()), ElementType(ElemType),
+    DestPtr(nullptr), DestStride(nullptr), Index(nullptr) {}
+
+bool ArrayConstructorEmitter::isFusible(const ArrayConstructorExpr *E) {
+  auto Items = E->getItems();
+  if(Items.size() != 1)
+    return false;
+  auto ImpliedDo = dyn_cast<ImpliedDoExpr>(Items[0]);
+  if(!ImpliedDo || ImpliedDo->getBody().size() != 1)
+    return false;
+  auto Body = ImpliedDo->getBody()[0];
+  return !Body->getType()->isArrayType() &&
+         !Body->getType()->isCharacterType();
+}
+
+bool ArrayConstructorEmitter::MayReadArray(const ArrayConstructorExpr *E,
+                                           const Expr *Array) {
+  return ArrayConstructorReadChecker(Array).Check(E);
+}
+
+ImpliedDoValueTy ArrayConstructorEmitter::EmitImpliedDoValue(const ImpliedDoExpr *E) {
+  ImpliedDoValueTy Value;
+  Value.E = E;
+  Value.VarPtr = CGF.CreateTempAlloca(CGF.ConvertTypeForMem(E->getVarDecl()->getType()),
+                                      E->getVarDecl()->getName());
+  Value.Init = CGF.EmitScalarExpr(E->getInitialParameter());
+  auto End = CGF.EmitScalarExpr(E->getTerminalParameter());
+  Value.Increment = E->hasIncrementationParameter()?
+                      CGF.EmitScalarExpr(E->getIncrementationParameter()) :
+                      llvm::ConstantInt::get(Value.Init->getType(), 1);
+
+  // IterationCount = MAX((End - Init + Increment) / Increment, 0)
+  auto Count = Builder.CreateSDiv(Builder.CreateAdd(Builder.CreateSub(End, Value.Init),
+                                                    Value.Increment),
+                                  Value.Increment);
+  Count = Builder.CreateSExtOrTrunc(Count, CGF.getModule().SizeTy);
+  auto Zero = llvm::ConstantInt::get(CGF.getModule().SizeTy, 0);
+  Value.IterationCount = Builder.CreateSelect(Builder.CreateICmpSGT(Count, Zero),
+                                              Count, Zero, "max");
+  return Value;
+}
+
+void ArrayConstructorEmitter::EmitImpliedDoVar(const ImpliedDoValueTy &Value,
+                                               llvm::Value *Iteration) {
+  // Var = Init + Iteration * Increment
+  Iteration = Builder.CreateSExtOrTrunc(Iteration, Value.Init->getType());
+  Builder.CreateStore(Builder.CreateAdd(Value.Init,
+                                        Builder.CreateMul(Iteration, Value.Increment)),
+                      Value.VarPtr);
+}
+
+void ArrayConstructorEmitter::EmitImpliedDoBegin(const ImpliedDoExpr *E,
+                                                 ImpliedDoLoop &Loop) {
+  auto SizeTy = CGF.getModule().SizeTy;
+  Loop.Value = EmitImpliedDoValue(E);
+  Loop.Counter = CGF.CreateTempAlloca(SizeTy, "implied-do-counter");
+  Builder.CreateStore(llvm::ConstantInt::get(SizeTy, 0), Loop.Counter);
+  Loop.TestBlock = CGF.createBasicBlock("implied-do");
+  auto BodyBlock = CGF.createBasicBlock("implied-do-body");
+  Loop.EndBlock = CGF.createBasicBlock("implied-do-end");
+  CGF.EmitBlock(Loop.TestBlock);
+  Builder.CreateCondBr(Builder.CreateICmpULT(Builder.CreateLoad(Loop.Counter),
+                                             Loop.Value.IterationCount),
+                       BodyBlock, Loop.EndBlock);
+  CGF.EmitBlock(BodyBlock);
+  EmitImpliedDoVar(Loop.Value, Builder.CreateLoad(Loop.Counter));
+  Loop.PrevVarPtr = CGF.SetVarPtr(E->getVarDecl(), Loop.Value.VarPtr);
+}
+
+void ArrayConstructorEmitter::EmitImpliedDoEnd(ImpliedDoLoop &Loop) {
+  CGF.SetVarPtr(Loop.Value.E->getVarDecl(), Loop.PrevVarPtr);
+  Builder.CreateStore(Builder.CreateAdd(Builder.CreateLoad(Loop.Counter),
+                        llvm::ConstantInt::get(CGF.getModule().SizeTy, 1)),
+                      Loop.Counter);
+  CGF.EmitBranch(Loop.TestBlock);
+  CGF.EmitBlock(Loop.EndBlock);
+}
+
+RValueTy ArrayConstructorEmitter::EmitFusedElement(const ImpliedDoValueTy &Value,
+                                                   llvm::Value *Iteration) {
+  EmitImpliedDoVar(Value, Iteration);
+  auto VD = Value.E->getVarDecl();
+  auto PrevVarPtr = CGF.SetVarPtr(VD, Value.VarPtr);
+  auto Result = CGF.EmitRValue(Value.E->getBody()[0]);
+  CGF.SetVarPtr(VD, PrevVarPtr);
+  return Result;
+}
+
+/// \brief Evaluates the number of elements in the given items.
+static bool EvaluateItemsSize(const ASTContext &Ctx, ArrayRef<Expr*> Items,
+                              uint64_t &Result) {
+  Result = 0;
+  for(auto Item : Items) {
+    uint64_t Size = 1;
+    if(Item->getType()->isArrayType() &&
+       !Item->getType()->asArrayType()->EvaluateSize(Size, Ctx))
+      return false;
+    Result += Size;
+  }
+  return true;
+}
+
+llvm::Value *ArrayConstructorEmitter::EmitSize(ArrayRef<Expr*> Items) {
+  auto SizeTy = CGF.getModule().SizeTy;
+  uint64_t ConstantSize = 0;
+  llvm::Value *Size = nullptr;
+  for(auto Item : Items) {
+    uint64_t ItemSize;
+    if(EvaluateItemsSize(CGF.getContext(), Item, ItemSize))
+      ConstantSize += ItemSize;
+    else {
+      auto DynamicSize = EmitItemSize(Item);
+      Size = Size? Builder.CreateAdd(Size, DynamicSize) : DynamicSize;
+    }
+  }
+  if(!Size)
+    return llvm::ConstantInt::get(SizeTy, ConstantSize);
+  if(ConstantSize)
+    return Builder.CreateAdd(Size, llvm::ConstantInt::get(SizeTy, ConstantSize));
+  return Size;
+}
+
+llvm::Value *ArrayConstructorEmitter::EmitItemSize(const Expr *E) {
+  auto ImpliedDo = dyn_cast<ImpliedDoExpr>(E);
+  if(!ImpliedDo) {
+    ArrayOperation OP;
+    auto Size = CGF.EmitArraySize(OP.EmitArrayExpr(CGF, E));
+    OP.FreeTemporaries(CGF);
+    return Size;
+  }
+
+  // IterationCount * BodySize when the size of the body doesn't
+  // depend on the do variable.
+  uint64_t BodySize;
+  if(EvaluateItemsSize(CGF.getContext(), ImpliedDo->getBody(), BodySize))
+    return Builder.CreateMul(EmitImpliedDoValue(ImpliedDo).IterationCount,
+                             llvm::ConstantInt::get(CGF.getModule().SizeTy, BodySize));
+
+  auto Size = CGF.CreateTempAlloca(CGF.getModule().SizeTy, "implied-do-size");
+  Builder.CreateStore(llvm::ConstantInt::get(CGF.getModule().SizeTy, 0), Size);
+  ImpliedDoLoop Loop;
+  EmitImpliedDoBegin(ImpliedDo, Loop);
+  Builder.CreateStore(Builder.CreateAdd(Builder.CreateLoad(Size),
+                                        EmitSize(ImpliedDo->getBody())),
+                      Size);
+  EmitImpliedDoEnd(Loop);
+  return Builder.CreateLoad(Size);
+}
+
+void ArrayConstructorEmitter::EmitItems(const ArrayValueRef &Dest,
+                                        ArrayRef<Expr*> Items) {
+  assert(Dest.Dimensions.size() == 1);
+  DestPtr = Dest.Ptr;
+  DestStride = Dest.Dimensions[0].Stride;
+  Index = CGF.CreateTempAlloca(CGF.getModule().SizeTy, "array-constructor-index");
+  Builder.CreateStore(llvm::ConstantInt::get(CGF.getModule().SizeTy, 0), Index);
+  for(auto Item : Items)
+    EmitItem(Item);
+}
+
+void ArrayConstructorEmitter::EmitItem(const Expr *E) {
+  if(auto ImpliedDo = dyn_cast<ImpliedDoExpr>(E)) {
+    ImpliedDoLoop Loop;
+    EmitImpliedDoBegin(ImpliedDo, Loop);
+    for(auto Item : ImpliedDo->getBody())
+      EmitItem(Item);
+    EmitImpliedDoEnd(Loop);
+    return;
+  }
+  if(!E->getType()->isArrayType()) {
+    EmitElement(CGF.EmitRValue(E));
+    return;
+  }
+
+  // The elements of the array item are stored in a loop.
   ArrayOperation OP;
+  auto Value = OP.EmitArrayExpr(CGF, E);
+  ArrayLoopEmitter Looper(CGF);
+  Looper.EmitArrayIterationBegin(Value);
+  ArrayOperationEmitter EV(CGF, OP, Looper);
+  EmitElement(EV.Emit(E));
+  Looper.EmitArrayIterationEnd();
+  OP.FreeTemporaries(CGF);
+}
+
+void ArrayConstructorEmitter::EmitElement(RValueTy Value) {
+  auto I = Builder.CreateLoad(Index);
+  auto Dest = Builder.CreateGEP(DestPtr, DestStride? Builder.CreateMul(I, DestStride) : I);
+  CGF.EmitStore(Value, LValueTy(Dest), ElementType);
+  Builder.CreateStore(Builder.CreateAdd(I, llvm::ConstantInt::get(CGF.getModule().SizeTy, 1)),
+                      Index);
+}
+
+/// \brief Emits a contiguous array copy or fill using
+/// llvm.memcpy / llvm.memmove / llvm.memset.
+static void EmitArrayMemIntrinsic(CodeGenFunction &CGF, ArrayOperation &Op,
+                                  const Expr *LHS, const ArrayValueRef &LHSArray,
+                                  const Expr *RHS, llvm::Value *FillByte) {
+  auto &Builder = CGF.getBuilder();
+  auto &DL = CGF.getModule().getDataLayout();
+  auto ETy = CGF.getTypes().ConvertTypeForMem(LHS->getType().getSelfOrArrayElementType());
+  auto Size = Builder.CreateMul(CGF.EmitArraySize(LHSArray),
+                                llvm::ConstantInt::get(CGF.getModule().SizeTy,
+                                                       DL.getTypeAllocSize(ETy)));
+  auto Align = DL.getABITypeAlignment(ETy);
+  if(FillByte)
+    Builder.CreateMemSet(LHSArray.Ptr, FillByte, Size, Align);
+  else if(MayArraysOverlap(LHS, RHS))
+    Builder.CreateMemMove(LHSArray.Ptr, Op.getArrayValue(RHS).Ptr, Size, Align);
+  else
+    Builder.CreateMemCpy(LHSArray.Ptr, Op.getArrayValue(RHS).Ptr, Size, Align);
+}
+
+/// ArrayTransformationalReadChecker - Checks if an array expression
+/// reads the elements of an array which may overlap the assigned array
+/// in MATMUL, an array reduction or an array view, which use the
+/// elements other than the one that is assigned in the current iteration.
+/// When transformational is true, every read of the array is checked.
+class ArrayTransformationalReadChecker
+  : public ConstExprVisitor<ArrayTransformationalReadChecker, bool> {
+  const Expr *LHS;
+  bool Transformational;
+public:
+
+  ArrayTransformationalReadChecker(const Expr *lhs, bool transformational = false)
+    : LHS(lhs), Transformational(transformational) {}
+
+  /// \brief Returns true if the given expression reads the
+  /// assigned array. The scalars are evaluated before the loop.
+  bool Check(const Expr *E) {
+    return E->getType()->isArrayType() && Visit(E);
+  }
+
+  bool VisitExpr(const Expr *E) {
+    return false;
+  }
+  bool VisitVarExpr(const VarExpr *E) {
+    return Transformational && MayArraysOverlap(LHS, E);
+  }
+  bool VisitArraySectionExpr(const ArraySectionExpr *E) {
+    return Transformational && MayArraysOverlap(LHS, E);
+  }
+  bool VisitUnaryExpr(const UnaryExpr *E) {
+    return Check(E->getExpression());
+  }
+  bool VisitBinaryExpr(const BinaryExpr *E) {
+    return Check(E->getLHS()) || Check(E->getRHS());
+  }
+  bool VisitImplicitCastExpr(const ImplicitCastExpr *E) {
+    return Check(E->getExpression());
+  }
+  bool VisitArrayConstructorExpr(const ArrayConstructorExpr *E) {
+    // The elements of a fused implied do are computed in the loop.
+    return ArrayConstructorEmitter::isFusible(E) &&
+           ArrayConstructorEmitter::MayReadArray(E, LHS);
+  }
+  bool VisitIntrinsicCallExpr(const IntrinsicCallExpr *E) {
+    // PACK, UNPACK and the locations in the whole array
+    // are computed before the assignment.
+    if(PackEmitter::isPack(E) || ArrayLocationEmitter::isLocationArray(E))
+      return false;
+    auto Saved = Transformational;
+    if(MatmulEmitter::isMatmul(E) || ArrayReductionEmitter::isArrayReduction(E) ||
+       ArrayViewEmitter::isView(E))
+      Transformational = true;
+    bool Result = false;
+    for(auto Arg : E->getArguments()) {
+      if(Check(Arg)) {
+        Result = true;
+        break;
+      }
+    }
+    Transformational = Saved;
+    return Result;
+  }
+  bool VisitCallExpr(const CallExpr *E) {
+    // An elemental function can also read the array
+    // when it's in a common block.
+    auto LHSVar = GetArrayBaseVar(LHS);
+    if(!LHSVar || LHSVar->hasStorageSet())
+      return true;
+    for(auto Arg : E->getArguments()) {
+      if(Check(Arg)) return true;
+    }
+    return false;
+  }
+};
+
+/// ShiftViewCollector - Collects the CSHIFT and EOSHIFT views
+/// whose elements are used for the current element of the array
+/// in an elemental array expression.
+class ShiftViewCollector : public ConstExprVisitor<ShiftViewCollector> {
+  SmallVectorImpl<const IntrinsicCallExpr*> &Shifts;
+public:
+
+  ShiftViewCollector(SmallVectorImpl<const IntrinsicCallExpr*> &shifts)
+    : Shifts(shifts) {}
+
+  void VisitUnaryExpr(const UnaryExpr *E) {
+    Visit(E->getExpression());
+  }
+  void VisitBinaryExpr(const BinaryExpr *E) {
+    Visit(E->getLHS());
+    Visit(E->getRHS());
+  }
+  void VisitImplicitCastExpr(const ImplicitCastExpr *E) {
+    Visit(E->getExpression());
+  }
+  void VisitIntrinsicCallExpr(const IntrinsicCallExpr *E) {
+    using namespace intrinsic;
+    if(ArrayViewEmitter::isShift(E)) {
+      Shifts.push_back(E);
+      return;
+    }
+    auto Func = getGenericFunctionKind(E->getIntrinsicFunction());
+    if(getFunctionGroup(Func) == GROUP_ARRAY && Func != MERGE)
+      return;
+    for(auto Arg : E->getArguments())
+      Visit(Arg);
+  }
+};
+
+static llvm::Value *EmitSignedMax(CGBuilderTy &Builder, llvm::Value *X, llvm::Value *Y) {
+  return Builder.CreateSelect(Builder.CreateICmpSGT(X, Y), X, Y);
+}
+
+static llvm::Value *EmitSignedMin(CGBuilderTy &Builder, llvm::Value *X, llvm::Value *Y) {
+  return Builder.CreateSelect(Builder.CreateICmpSLT(X, Y), X, Y);
+}
+
+namespace {
+
+/// ShiftedDimension - a dimension of the array assignment which is
+/// shifted by some of the CSHIFT and EOSHIFT views, and the interior
+/// part of its loop, where none of these views uses the boundary or
+/// wraps the index around.
+struct ShiftedDimension {
+  size_t Dim;
+  llvm::Value *Size, *Begin, *End;
+  SmallVector<const IntrinsicCallExpr*, 4> Shifts;
+};
+
+} // end anonymous namespace
+
+/// \brief Emits the loops over the dimensions [0, I) of a shifted array
+/// assignment. The loop over a shifted dimension is split into the edge
+/// parts and the interior part, and the shifts along this dimension are
+/// marked as interior ones inside of the interior part.
+static void EmitShiftedDimensionLoops(CodeGenFunction &CGF, ArrayOperation &Op,
+                                      ArrayLoopEmitter &Looper,
+                                      const Expr *LHS, const ArrayValueRef &LHSArray,
+                                      const Expr *RHS,
+                                      ArrayRef<ShiftedDimension> ShiftedDims,
+                                      size_t I) {
+  if(I == 0) {
+    EmitArrayAssignment(CGF, Op, Looper, LHS, RHS);
+    return;
+  }
+  --I;
+  const ShiftedDimension *Shifted = nullptr;
+  for(auto &D : ShiftedDims) {
+    if(D.Dim == I)
+      Shifted = &D;
+  }
+  if(!Shifted) {
+    Looper.EmitDimensionIterationBegin(LHSArray, I);
+    EmitShiftedDimensionLoops(CGF, Op, Looper, LHS, LHSArray, RHS, ShiftedDims, I);
+    Looper.EmitDimensionIterationEnd(I);
+    return;
+  }
+
+  struct Part {
+    llvm::Value *Begin, *End;
+    bool Interior;
+  };
+  auto Zero = llvm::ConstantInt::get(CGF.getModule().SizeTy, 0);
+  Part Parts[] = { { Zero, Shifted->Begin, false },
+                   { Shifted->Begin, Shifted->End, true },
+                   { Shifted->End, Shifted->Size, false } };
+  for(auto P : Parts) {
+    for(auto Shift : Shifted->Shifts)
+      Op.setInteriorShift(Shift, P.Interior);
+    Looper.EmitDimensionIterationBegin(LHSArray, I, P.Begin, P.End);
+    EmitShiftedDimensionLoops(CGF, Op, Looper, LHS, LHSArray, RHS, ShiftedDims, I);
+    Looper.EmitDimensionIterationEnd(I);
+  }
+  for(auto Shift : Shifted->Shifts)
+    Op.setInteriorShift(Shift, false);
+}
+
+/// \brief Emits an array assignment which uses CSHIFT or EOSHIFT. The loop
+/// over every shifted dimension is split into the interior part, where the
+/// shifted elements are inside of the source and are accessed with a plain
+/// offset, and the parts at the edges, where the indices wrap around or
+/// where the boundary is used.
+static void EmitShiftedArrayAssignment(CodeGenFunction &CGF, ArrayOperation &Op,
+                                       const Expr *LHS, const ArrayValueRef &LHSArray,
+                                       const Expr *RHS,
+                                       ArrayRef<const IntrinsicCallExpr*> Shifts) {
+  auto &Builder = CGF.getBuilder();
+  auto Zero = llvm::ConstantInt::get(CGF.getModule().SizeTy, 0);
+
+  SmallVector<ShiftedDimension, 4> ShiftedDims;
+  for(auto Shift : Shifts) {
+    auto Dim = ArrayViewEmitter::getShiftDimension(CGF.getContext(), Shift);
+    ShiftedDimension *Shifted = nullptr;
+    for(auto &D : ShiftedDims) {
+      if(D.Dim == Dim)
+        Shifted = &D;
+    }
+    if(!Shifted) {
+      ShiftedDims.push_back(ShiftedDimension());
+      Shifted = &ShiftedDims.back();
+      Shifted->Dim = Dim;
+      Shifted->Size = CGF.EmitSectionSize(LHSArray, Dim);
+      Shifted->Begin = Zero;
+      Shifted->End = Shifted->Size;
+    }
+    Shifted->Shifts.push_back(Shift);
+  }
+
+  // The element J + Shift is inside of the source when J is in [-Shift, Size - Shift).
+  for(auto &D : ShiftedDims) {
+    auto Size = D.Size;
+    for(auto Shift : D.Shifts) {
+      auto Offset = Op.getShiftOffset(Shift);
+      auto ShiftBegin = Builder.CreateNeg(Offset);
+      auto ShiftEnd = Builder.CreateSub(Size, Offset);
+      D.Begin = EmitSignedMax(Builder, D.Begin, EmitSignedMin(Builder, ShiftBegin, Size));
+      D.End = EmitSignedMin(Builder, D.End, EmitSignedMax(Builder, ShiftEnd, Zero));
+    }
+    D.End = EmitSignedMax(Builder, D.End, D.Begin);
+  }
+
+  ArrayLoopEmitter Looper(CGF);
+  EmitShiftedDimensionLoops(CGF, Op, Looper, LHS, LHSArray, RHS, ShiftedDims,
+                            LHSArray.Dimensions.size());
+}
+
+void CodeGenFunction::EmitArrayAssignment(const Expr *LHS, const Expr *RHS,
+                                          const LoopHints *Hints) {
+  // Array = MATMUL(A, B) is computed directly in the array.
+  if(auto Call = dyn_cast<IntrinsicCallExpr>(RHS)) {
+    if(MatmulEmitter::isMatmul(Call)) {
+      auto Args = Call->getArguments();
+      if(MatmulEmitter(*this, Args).EmitAssignment(LHS, MayArraysOverlap(LHS, Args[0]) ||
+                                                        MayArraysOverlap(LHS, Args[1])))
+        return;
+    }
+    // Array = PACK(...) / UNPACK(...) is stored directly in the array
+    // when the array isn't one of the arguments.
+    if(PackEmitter::isPack(Call)) {
+      bool MayOverlap = false;
+      for(auto Arg : Call->getArguments()) {
+        if(ArrayTransformationalReadChecker(LHS, true).Check(Arg))
+          MayOverlap = true;
+      }
+      if(!MayOverlap) {
+        PackEmitter(*this, Call).EmitAssignment(LHS);
+        return;
+      }
+    }
+  }
+
+  // Array = (/ ... /) stores the items directly into the array
+  // when the items don't read the array.
+  if(auto Constructor = dyn_cast<ArrayConstructorExpr>(RHS)) {
+    auto ElementType = Constructor->getType()->asArrayType()->getElementType();
+    if(!Constructor->isEvaluatable(getContext()) &&
+       !ElementType->isCharacterType() &&
+       LHS->getType()->asArrayType()->getDimensionCount() == 1 &&
+       !ArrayConstructorEmitter::MayReadArray(Constructor, LHS)) {
+      ArrayOperation OP;
+      ArrayConstructorEmitter(*this, ElementType).EmitItems(OP.EmitArrayExpr(*this, LHS),
+                                                            Constructor->getItems());
+      return;
+    }
+  }
+
+  ArrayOperation OP(true);
   auto LHSArray = OP.EmitArrayExpr(*this, LHS);
   OP.EmitAllScalarValuesAndArraySections(*this, RHS);
-  ArrayLoopEmitter Looper(*this);
+
+  // Array = array / constant can be emitted as a memory intrinsic
+  // when the arrays are contiguous. When the contiguity is only known
+  // at runtime, the loop is used as a fallback for strided arrays.
+  auto ElementType = LHS->getType().getSelfOrArrayElementType();
+  llvm::Value *FillByte = nullptr;
+  bool IsCopy = false;
+  if(!ElementType->isCharacterType()) {
+    if(RHS->getType()->isArrayType())
+      IsCopy = (isa<VarExpr>(RHS) || isa<ArraySectionExpr>(RHS) ||
+                (isa<ArrayConstructorExpr>(RHS) && !OP.isFusedArrayConstructor(RHS))) &&
+               getTypes().ConvertTypeForMem(RHS->getType().getSelfOrArrayElementType()) ==
+               getTypes().ConvertTypeForMem(ElementType);
+    else
+      FillByte = GetArrayFillByte(*this, OP.getScalarValue(RHS), ElementType);
+  }
+  llvm::BasicBlock *EndBB = nullptr;
+  if(IsCopy || FillByte) {
+    auto Contiguous = EmitArrayOperandIsContiguous(LHS, LHSArray);
+    if(IsCopy) {
+      auto RHSContiguous = EmitArrayOperandIsContiguous(RHS, OP.getArrayValue(RHS));
+      if(isa<llvm::ConstantInt>(Contiguous))
+        std::swap(Contiguous, RHSContiguous);
+      Contiguous = Builder.CreateAnd(Contiguous, RHSContiguous);
+    }
+    if(auto C = dyn_cast<llvm::ConstantInt>(Contiguous)) {
+      if(C->isOne()) {
+        EmitArrayMemIntrinsic(*this, OP, LHS, LHSArray, RHS, FillByte);
+        return;
+      }
+    } else {
+      auto ContiguousBB = createBasicBlock("array-contiguous");
+      auto StridedBB = createBasicBlock("array-strided");
+      EndBB = createBasicBlock("array-assignment-end");
+      Builder.CreateCondBr(Contiguous, ContiguousBB, StridedBB);
+      EmitBlock(ContiguousBB);
+      EmitArrayMemIntrinsic(*this, OP, LHS, LHSArray, RHS, FillByte);
+      EmitBranch(EndBB);
+      EmitBlock(StridedBB);
+    }
+  }
+
+  // The result is computed in a temporary array when the elements
+  // of the array are also read for the other elements of the result.
+  if(ArrayTransformationalReadChecker(LHS).Check(RHS)) {
+    SmallVector<ArrayDimensionValueTy, 8> TempDims;
+    llvm::Value *Stride = nullptr;
+    for(auto Dim : LHSArray.Dimensions) {
+      auto Size = EmitDimSize(Dim);
+      TempDims.push_back(ArrayDimensionValueTy(nullptr, Size, Stride));
+      Stride = Stride? Builder.CreateMul(Stride, Size) : Size;
+    }
+    auto TempPtr = CreateTempHeapArrayAlloca(LHS->getType(), LHSArray);
+    ArrayValueRef Temp(TempDims, TempPtr);
+    ArrayLoopEmitter TempLooper(*this);
+    TempLooper.EmitArrayIterationBegin(LHSArray);
+    CodeGen::EmitArrayAssignment(*this, OP, TempLooper, Temp, RHS);
+    TempLooper.EmitArrayIterationEnd();
+
+    ArrayLoopEmitter Looper(*this);
+    Looper.EmitArrayIterationBegin(LHSArray);
+    EmitStore(EmitLoad(Looper.EmitElementPointer(Temp), ElementType),
+              Looper.EmitElementPointer(LHSArray), ElementType);
+    Looper.EmitArrayIterationEnd();
+    FreeTempHeapAlloca(TempPtr);
+  } else {
+    SmallVector<const IntrinsicCallExpr*, 4> Shifts;
+    ShiftViewCollector(Shifts).Visit(RHS);
+    if(!Shifts.empty())
+      EmitShiftedArrayAssignment(*this, OP, LHS, LHSArray, RHS, Shifts);
+    else {
+      ArrayLoopEmitter Looper(*this);
+      Looper.setLoopHints(Hints);
+      Looper.EmitArrayIterationBegin(LHSArray);
+      // Array = array / scalar
+      CodeGen::EmitArrayAssignment(*this, OP, Looper, LHS, RHS);
+      Looper.EmitArrayIterationEnd();
+    }
+  }
+  if(EndBB)
+    EmitBlock(EndBB);
+  OP.FreeTemporaries(*this);
+}
+
+//
+// Array statement fusion
+//
+
+/// ArrayFusionChecker - Checks that an expression can be evaluated inside
+/// a fused loop nest, i.e. that the arrays which are assigned by the fused
+/// statements are only accessed at the element of the current iteration.
+class ArrayFusionChecker : public ConstExprVisitor<ArrayFusionChecker, bool> {
+  const llvm::SmallPtrSetImpl<const VarDecl*> &Assigned;
+  bool Elemental;
+public:
+
+  ArrayFusionChecker(const llvm::SmallPtrSetImpl<const VarDecl*> &assigned)
+    : Assigned(assigned), Elemental(true) {}
+
+  /// \brief Returns true if the given expression can be fused. The
+  /// expression is elemental when it's evaluated for each element
+  /// in the loop, and not once before the loop.
+  bool Check(const Expr *E, bool IsElemental) {
+    if(!E) return true;
+    auto Saved = Elemental;
+    Elemental = IsElemental && E->getType()->isArrayType();
+    auto Result = Visit(E);
+    Elemental = Saved;
+    return Result;
+  }
+  bool Check(const Expr *E) {
+    return Check(E, Elemental);
+  }
+
+  bool VisitExpr(const Expr *E) {
+    return false;
+  }
+  bool VisitConstantExpr(const ConstantExpr *E) {
+    return true;
+  }
+  bool VisitVarExpr(const VarExpr *E) {
+    auto VD = E->getVarDecl();
+    if(Assigned.count(VD))
+      return Elemental;
+    // An array which shares its storage with an assigned array would
+    // be read at a different element through the other name.
+    for(auto AssignedVD : Assigned) {
+      if(MayShareStorage(VD, AssignedVD))
+        return false;
+    }
+    return true;
+  }
+  bool VisitUnaryExpr(const UnaryExpr *E) {
+    return Check(E->getExpression());
+  }
+  bool VisitBinaryExpr(const BinaryExpr *E) {
+    return Check(E->getLHS()) && Check(E->getRHS());
+  }
+  bool VisitImplicitCastExpr(const ImplicitCastExpr *E) {
+    return Check(E->getExpression());
+  }
+  bool VisitIntrinsicCallExpr(const IntrinsicCallExpr *E) {
+    using namespace intrinsic;
+    if(E->getType()->isArrayType()) {
+      auto Func = getGenericFunctionKind(E->getIntrinsicFunction());
+      switch(getFunctionGroup(Func)) {
+      case GROUP_CONVERSION: case GROUP_COMPLEX:
+      case GROUP_MATHS: case GROUP_BITOPS:
+        break;
+      case GROUP_ARRAY:
+        if(Func == MERGE)
+          break;
+        return false;
+      default:
+        return false;
+      }
+    }
+    for(auto Arg : E->getArguments()) {
+      if(!Check(Arg)) return false;
+    }
+    return true;
+  }
+  bool VisitArrayElementExpr(const ArrayElementExpr *E) {
+    if(!Check(E->getTarget(), false)) return false;
+    for(auto Sub : E->getSubscripts()) {
+      if(!Check(Sub, false)) return false;
+    }
+    return true;
+  }
+  bool VisitArraySectionExpr(const ArraySectionExpr *E) {
+    if(!Check(E->getTarget(), false)) return false;
+    for(auto Sub : E->getSubscripts()) {
+      if(!Check(Sub, false)) return false;
+    }
+    return true;
+  }
+  bool VisitRangeExpr(const RangeExpr *E) {
+    return Check(E->getFirstExpr(), false) && Check(E->getSecondExpr(), false);
+  }
+  bool VisitStridedRangeExpr(const StridedRangeExpr *E) {
+    return VisitRangeExpr(E) && Check(E->getStride(), false);
+  }
+  bool VisitArrayConstructorExpr(const ArrayConstructorExpr *E) {
+    for(auto Item : E->getItems()) {
+      if(!Check(Item, false)) return false;
+    }
+    return true;
+  }
+};
+
+/// \brief Evaluates the extent of each dimension of the given array type.
+static bool EvaluateArrayShape(const ASTContext &Ctx, QualType T,
+                               SmallVectorImpl<uint64_t> &Shape) {
+  for(auto Dim : T->asArrayType()->getDimensions()) {
+    EvaluatedArraySpec Spec;
+    if(!Dim->Evaluate(Spec, Ctx))
+      return false;
+    Shape.push_back(Spec.Size);
+  }
+  return true;
+}
+
+static bool CanFuseArrayAssignments(ArrayRef<const AssignmentStmt*> Stmts,
+                                    const llvm::SmallPtrSetImpl<const VarDecl*> &Assigned) {
+  ArrayFusionChecker Checker(Assigned);
+  for(auto S : Stmts) {
+    if(!Checker.Check(S->getRHS(), true))
+      return false;
+  }
+  return true;
+}
+
+size_t CodeGenFunction::EmitFusedArrayAssignments(ArrayRef<Stmt*> Stmts) {
+  // Gather the leading whole array assignments which have the same
+  // constant shape. The arrays assigned in the group can be read only
+  // at the current element, so that the fused loop preserves the
+  // statement by statement semantics.
+  SmallVector<const AssignmentStmt*, 8> Group;
+  llvm::SmallPtrSet<const VarDecl*, 8> Assigned;
+  SmallVector<uint64_t, 8> Shape;
+  for(auto S : Stmts) {
+    auto Assignment = dyn_cast<AssignmentStmt>(S);
+    if(!Assignment || (!Group.empty() && S->getStmtLabel()))
+      break;
+    auto LHS = dyn_cast<VarExpr>(Assignment->getLHS());
+    if(!LHS || !LHS->getType()->isArrayType() ||
+       LHS->getType().getSelfOrArrayElementType()->isCharacterType() ||
+       IsEquivalenced(LHS->getVarDecl()))
+      break;
+    SmallVector<uint64_t, 8> LHSShape;
+    if(!EvaluateArrayShape(getContext(), LHS->getType(), LHSShape))
+      break;
+    if(Group.empty())
+      Shape = LHSShape;
+    else if(Shape != LHSShape)
+      break;
+
+    bool IsNew = Assigned.insert(LHS->getVarDecl()).second;
+    Group.push_back(Assignment);
+    if(!CanFuseArrayAssignments(Group, Assigned)) {
+      Group.pop_back();
+      if(IsNew)
+        Assigned.erase(LHS->getVarDecl());
+      break;
+    }
+  }
+  if(Group.size() < 2)
+    return 0;
+
+  if(Stmts.front()->getStmtLabel())
+    EmitStmtLabel(Stmts.front());
+  ArrayOperation OP;
+  auto LHSArray = OP.EmitArrayExpr(*this, Group.front()->getLHS());
+  for(auto S : Group) {
+    OP.EmitAllScalarValuesAndArraySections(*this, S->getLHS());
+    OP.EmitAllScalarValuesAndArraySections(*this, S->getRHS());
+  }
+
+  auto PreheaderBB = Builder.GetInsertBlock();
+  ArrayLoopEmitter Looper(*this, "fused-array-dim-loop");
   Looper.EmitArrayIterationBegin(LHSArray);
-  // Array = array / scalar
-  CodeGen::EmitArrayAssignment(*this, OP, Looper, LHS, RHS);
+  ArrayOperationEmitter EV(*this, OP, Looper);
+  for(auto S : Group) {
+    auto Val = EV.Emit(S->getRHS());
+    EmitStore(Val, EV.EmitLValue(S->getLHS()), S->getRHS()->getType());
+    // The following statements reuse the assigned value
+    // instead of loading it again.
+    if(Val.isScalar() && Val.asScalar()->getType() == CGM.Int1Ty)
+      Val = ConvertLogicalValueToLogicalMemoryValue(Val.asScalar(),
+              S->getLHS()->getType().getSelfOrArrayElementType());
+    OP.setElementValue(cast<VarExpr>(S->getLHS())->getVarDecl(), Val);
+  }
   Looper.EmitArrayIterationEnd();
+  if(CGM.getCodeGenOpts().DumpArrayFusion)
+    DumpFusedArrayLoops(Group.size(), Shape, PreheaderBB,
+                        Builder.GetInsertBlock());
+  OP.FreeTemporaries(*this);
+  return Group.size();
+}
+
+void CodeGenFunction::DumpFusedArrayLoops(size_t Count, ArrayRef<uint64_t> Shape,
+                                          llvm::BasicBlock *PreheaderBB,
+                                          llvm::BasicBlock *EndBB) {
+  auto &OS = llvm::errs();
+  OS << "; " << CurFn->getName() << ": fused " << Count
+     << " array assignments into a loop nest of shape ";
+  for(size_t I = 0; I < Shape.size(); ++I)
+    OS << (I? "x" : "") << Shape[I];
+  OS << "\n";
+  if(!PreheaderBB)
+    return;
+  // The blocks of the nest are placed right after the block which
+  // precedes the loops.
+  llvm::Function::iterator I(PreheaderBB), End(EndBB);
+  for(++I; I != End; ++I)
+    I->print(OS);
+  OS << "\n";
 }
 
 //
 // Masked array assignment emmitter
 //
 
-class WhereBodyPreOperationEmmitter : public ConstStmtVisitor<WhereBodyPreOperationEmmitter> {
-  CodeGenFunction &CGF;
-  ArrayOperation  &Operation;
+/// WhereSpeculationChecker - Checks if the right side of a masked
+/// assignment can be evaluated for the masked out elements, so that
+/// the assignment can be emitted using a select instead of a branch.
+class WhereSpeculationChecker
+  : public ConstExprVisitor<WhereSpeculationChecker, bool> {
 public:
 
-  WhereBodyPreOperationEmmitter(CodeGenFunction &cgf, ArrayOperation &Op)
-    : CGF(cgf), Operation(Op) {}
+  bool Check(const Expr *E) {
+    // Scalars and array sections are evaluated once before the loop.
+    if(!E->getType()->isArrayType())
+      return true;
+    return Visit(E);
+  }
 
-  void VisitBlockStmt(const BlockStmt *S) {
-    for(auto I : S->getStatements())
-      Visit(I);
+  bool VisitExpr(const Expr *E) {
+    return false;
   }
-  void VisitAssignmentStmt(const AssignmentStmt *S) {
-    Operation.EmitAllScalarValuesAndArraySections(CGF, S->getLHS());
-    Operation.EmitAllScalarValuesAndArraySections(CGF, S->getRHS());
+  bool VisitVarExpr(const VarExpr *E) {
+    return true;
   }
-  void VisitConstructPartStmt(const ConstructPartStmt*) {}
-  void VisitStmt(const Stmt*) {
-    llvm_unreachable("invalid where statement!");
+  bool VisitArraySectionExpr(const ArraySectionExpr *E) {
+    return true;
+  }
+  bool VisitArrayConstructorExpr(const ArrayConstructorExpr *E) {
+    // The elements of a fused implied do are computed in the loop.
+    return !ArrayConstructorEmitter::isFusible(E);
+  }
+  bool VisitImplicitCastExpr(const ImplicitCastExpr *E) {
+    return Check(E->getExpression());
+  }
+  bool VisitUnaryExpr(const UnaryExpr *E) {
+    return Check(E->getExpression());
+  }
+  bool VisitBinaryExpr(const BinaryExpr *E) {
+    // Integer division by zero traps.
+    if(E->getOperator() == BinaryExpr::Divide &&
+       E->getType().getSelfOrArrayElementType()->isIntegerType())
+      return false;
+    return Check(E->getLHS()) && Check(E->getRHS());
+  }
+  bool VisitIntrinsicCallExpr(const IntrinsicCallExpr *E) {
+    using namespace intrinsic;
+    switch(getFunctionGroup(getGenericFunctionKind(E->getIntrinsicFunction()))) {
+    case GROUP_CONVERSION: case GROUP_COMPLEX:
+      break;
+    case GROUP_MATHS:
+      // Integer MOD traps.
+      if(E->getType().getSelfOrArrayElementType()->isIntegerType())
+        return false;
+      break;
+    default:
+      return false;
+    }
+    for(auto Arg : E->getArguments()) {
+      if(!Check(Arg)) return false;
+    }
+    return true;
   }
 };
 
-class WhereBodyEmmitter : public ConstStmtVisitor<WhereBodyEmmitter> {
+/// WhereConstructEmitter - Emits a where construct.
+/// The masks are evaluated once into byte masks, and every masked
+/// assignment is emitted in its own loop which stores a select
+/// between the new and the old element, so that it can be vectorized.
+class WhereConstructEmitter {
   CodeGenFunction &CGF;
-  ArrayOperation  &Operation;
-  ArrayLoopEmitter &Looper;
+  CGBuilderTy &Builder;
+
+  /// MaskDims - the dimensions of a contiguous byte mask.
+  SmallVector<ArrayDimensionValueTy, 8> MaskDims;
+  llvm::Value *MaskSize;
+  SmallVector<llvm::Value*, 4> HeapMasks;
+
+  llvm::Value *CreateMask();
+  ArrayValueRef getMaskValue(llvm::Value *Mask) const {
+    return ArrayValueRef(MaskDims, Mask);
+  }
+  llvm::Value *EmitMaskElement(ArrayLoopEmitter &Looper, llvm::Value *Mask);
+  void EmitMaskedAssignment(ArrayOperation &Op, ArrayLoopEmitter &Looper,
+                            const AssignmentStmt *S, llvm::Value *Cond);
+  void EmitWhere(const WhereStmt *S, ArrayOperation &Op, llvm::Value *Control);
+  void EmitBody(const Stmt *S, llvm::Value *Control);
 public:
 
-  WhereBodyEmmitter(CodeGenFunction &cgf, ArrayOperation &Op,
-                    ArrayLoopEmitter &Loop)
-    : CGF(cgf), Operation(Op), Looper(Loop) {}
+  WhereConstructEmitter(CodeGenFunction &cgf)
+    : CGF(cgf), Builder(cgf.getBuilder()), MaskSize(nullptr) {}
+
+  void Emit(const WhereStmt *S);
+};
 
-  void VisitBlockStmt(const BlockStmt *S) {
-    for(auto I : S->getStatements())
-      Visit(I);
+llvm::Value *WhereConstructEmitter::CreateMask() {
+  auto &CGM = CGF.getModule();
+  // FIXME: better stack/heap heuristics?
+  if(auto Size = dyn_cast<llvm::ConstantInt>(MaskSize)) {
+    if(Size->getZExtValue() <= 4096)
+      return Builder.CreateConstGEP2_64(CGF.CreateTempAlloca(
+                                          llvm::ArrayType::get(CGM.Int8Ty, Size->getZExtValue()),
+                                          "where-mask"), 0, 0);
   }
-  void VisitAssignmentStmt(const AssignmentStmt *S) {
-    EmitArrayAssignment(CGF, Operation, Looper, S->getLHS(), S->getRHS());
+  auto Mask = CGM.getSystemRuntime().EmitMalloc(CGF, CGM.Int8PtrTy, MaskSize);
+  HeapMasks.push_back(Mask);
+  return Mask;
+}
+
+llvm::Value *WhereConstructEmitter::EmitMaskElement(ArrayLoopEmitter &Looper,
+                                                    llvm::Value *Mask) {
+  return Builder.CreateICmpNE(Builder.CreateLoad(Looper.EmitElementPointer(getMaskValue(Mask))),
+                              Builder.getInt8(0));
+}
+
+void WhereConstructEmitter::EmitMaskedAssignment(ArrayOperation &Op, ArrayLoopEmitter &Looper,
+                                                 const AssignmentStmt *S, llvm::Value *Cond) {
+  auto LHS = S->getLHS();
+  auto RHS = S->getRHS();
+  auto ElementType = LHS->getType().getSelfOrArrayElementType();
+  if(ElementType->isCharacterType() || !WhereSpeculationChecker().Check(RHS)) {
+    auto ThenBB = CGF.createBasicBlock("where-true");
+    auto EndBB  = CGF.createBasicBlock("where-end");
+    Builder.CreateCondBr(Cond, ThenBB, EndBB);
+    CGF.EmitBlock(ThenBB);
+    EmitArrayAssignment(CGF, Op, Looper, LHS, RHS);
+    CGF.EmitBlock(EndBB);
+    return;
   }
-};
 
-void CodeGenFunction::EmitWhereStmt(const WhereStmt *S) {
-  // FIXME: evaluate the mask array before the loop (only if required?)
-  // FIXME: evaluation of else scalars and sections must strictly follow the then body?
+  // LHS = mask? RHS : LHS
+  ArrayOperationEmitter EV(CGF, Op, Looper);
+  auto Dest = EV.EmitLValue(LHS);
+  auto Val = EV.Emit(RHS);
+  auto Old = CGF.EmitLoad(Dest.getPointer(), ElementType);
+  if(Val.isComplex()) {
+    auto C = Val.asComplex(), OldC = Old.asComplex();
+    Val = ComplexValueTy(Builder.CreateSelect(Cond, C.Re, OldC.Re),
+                         Builder.CreateSelect(Cond, C.Im, OldC.Im));
+  } else {
+    auto V = Val.asScalar();
+    if(V->getType() == CGF.getModule().Int1Ty)
+      V = CGF.ConvertLogicalValueToLogicalMemoryValue(V, ElementType);
+    Val = Builder.CreateSelect(Cond, V, Old.asScalar());
+  }
+  CGF.EmitStore(Val, Dest, RHS->getType());
+}
+
+void WhereConstructEmitter::EmitWhere(const WhereStmt *S, ArrayOperation &Op,
+                                      llvm::Value *Control) {
+  // Evaluate the mask and the mask of the else part once.
+  auto Mask = CreateMask();
+  auto ElseMask = S->hasElseStmt()? CreateMask() : nullptr;
+  ArrayLoopEmitter Looper(CGF);
+  Looper.EmitArrayIterationBegin(getMaskValue(Mask));
+  auto Cond = EmitArrayConditional(CGF, Op, Looper, S->getMask());
+  auto ControlCond = Control? EmitMaskElement(Looper, Control) : nullptr;
+  Builder.CreateStore(Builder.CreateZExt(ControlCond? Builder.CreateAnd(ControlCond, Cond) : Cond,
+                                         CGF.getModule().Int8Ty),
+                      Looper.EmitElementPointer(getMaskValue(Mask)));
+  if(ElseMask) {
+    auto ElseCond = Builder.CreateNot(Cond);
+    Builder.CreateStore(Builder.CreateZExt(ControlCond? Builder.CreateAnd(ControlCond, ElseCond) : ElseCond,
+                                           CGF.getModule().Int8Ty),
+                        Looper.EmitElementPointer(getMaskValue(ElseMask)));
+  }
+  Looper.EmitArrayIterationEnd();
+
+  EmitBody(S->getThenStmt(), Mask);
+  if(ElseMask)
+    EmitBody(S->getElseStmt(), ElseMask);
+}
+
+void WhereConstructEmitter::EmitBody(const Stmt *S, llvm::Value *Control) {
+  if(auto Block = dyn_cast<BlockStmt>(S)) {
+    for(auto I : Block->getStatements())
+      EmitBody(I, Control);
+  } else if(auto Assignment = dyn_cast<AssignmentStmt>(S)) {
+    ArrayOperation OP;
+    OP.EmitAllScalarValuesAndArraySections(CGF, Assignment->getLHS());
+    OP.EmitAllScalarValuesAndArraySections(CGF, Assignment->getRHS());
+    ArrayLoopEmitter Looper(CGF);
+    Looper.EmitArrayIterationBegin(getMaskValue(Control));
+    EmitMaskedAssignment(OP, Looper, Assignment, EmitMaskElement(Looper, Control));
+    Looper.EmitArrayIterationEnd();
+    OP.FreeTemporaries(CGF);
+  } else if(auto Where = dyn_cast<WhereStmt>(S)) {
+    ArrayOperation OP;
+    OP.EmitAllScalarValuesAndArraySections(CGF, Where->getMask());
+    EmitWhere(Where, OP, Control);
+    OP.FreeTemporaries(CGF);
+  } else if(!isa<ConstructPartStmt>(S))
+    llvm_unreachable("invalid where statement!");
+}
+
+/// \brief Returns the assignment if it's the only statement in the given body.
+static const AssignmentStmt *GetSingleAssignment(const Stmt *S) {
+  auto Block = dyn_cast<BlockStmt>(S);
+  if(!Block)
+    return dyn_cast<AssignmentStmt>(S);
+  const AssignmentStmt *Result = nullptr;
+  for(auto I : Block->getStatements()) {
+    if(isa<ConstructPartStmt>(I))
+      continue;
+    if(Result || !isa<AssignmentStmt>(I))
+      return nullptr;
+    Result = cast<AssignmentStmt>(I);
+  }
+  return Result;
+}
 
+void WhereConstructEmitter::Emit(const WhereStmt *S) {
   ArrayOperation OP;
-  auto MaskArray = OP.EmitArrayExpr(*this, S->getMask());
-  WhereBodyPreOperationEmmitter BodyPreEmmitter(*this, OP);
-  BodyPreEmmitter.Visit(S->getThenStmt());
-  if(S->getElseStmt())
-    BodyPreEmmitter.Visit(S->getElseStmt());
-
-  ArrayLoopEmitter Looper(*this);
-  Looper.EmitArrayIterationBegin(MaskArray);
-  auto ThenBB = createBasicBlock("where-true");
-  auto EndBB  = createBasicBlock("where-end");
-  auto ElseBB = S->hasElseStmt()? createBasicBlock("where-else") : EndBB;
-  Builder.CreateCondBr(EmitArrayConditional(*this, OP, Looper, S->getMask()), ThenBB, ElseBB);
-  WhereBodyEmmitter BodyEmmitter(*this, OP, Looper);
-  EmitBlock(ThenBB);
-  BodyEmmitter.Visit(S->getThenStmt());
-  EmitBranch(EndBB);
-  if(S->hasElseStmt()) {
-    EmitBlock(ElseBB);
-    BodyEmmitter.Visit(S->getElseStmt());
-    EmitBranch(EndBB);
+  auto MaskArray = OP.EmitArrayExpr(CGF, S->getMask());
+
+  // A single assignment which doesn't modify the mask
+  // can evaluate the mask in its own loop.
+  auto Assignment = S->hasElseStmt()? nullptr : GetSingleAssignment(S->getThenStmt());
+  if(Assignment) {
+    if(auto LHS = dyn_cast<VarExpr>(Assignment->getLHS())) {
+      llvm::SmallPtrSet<const VarDecl*, 1> Assigned;
+      Assigned.insert(LHS->getVarDecl());
+      if(ArrayFusionChecker(Assigned).Check(S->getMask(), true)) {
+        OP.EmitAllScalarValuesAndArraySections(CGF, Assignment->getLHS());
+        OP.EmitAllScalarValuesAndArraySections(CGF, Assignment->getRHS());
+        ArrayLoopEmitter Looper(CGF);
+        Looper.EmitArrayIterationBegin(MaskArray);
+        EmitMaskedAssignment(OP, Looper, Assignment,
+                             EmitArrayConditional(CGF, OP, Looper, S->getMask()));
+        Looper.EmitArrayIterationEnd();
+        OP.FreeTemporaries(CGF);
+        return;
+      }
+    }
   }
-  EmitBlock(EndBB);
-  Looper.EmitArrayIterationEnd();
+
+  llvm::Value *Stride = nullptr;
+  for(size_t I = 0; I < MaskArray.Dimensions.size(); ++I) {
+    auto Size = CGF.EmitSectionSize(MaskArray, I);
+    MaskDims.push_back(ArrayDimensionValueTy(nullptr, Size, Stride));
+    Stride = Stride? Builder.CreateMul(Stride, Size) : Size;
+  }
+  MaskSize = Stride;
+
+  EmitWhere(S, OP, nullptr);
+  for(auto Mask : HeapMasks)
+    CGF.getModule().getSystemRuntime().EmitFree(CGF, Mask);
+  OP.FreeTemporaries(CGF);
+}
+
+void CodeGenFunction::EmitWhereStmt(const WhereStmt *S) {
+  WhereConstructEmitter(*this).Emit(S);
 }
 
 }
@@ -14,6 +14,7 @@
 #include "CodeGenFunction.h"
 #include "flang/AST/ExprVisitor.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/DenseMap.h"
 
 namespace flang {
@@ -41,6 +42,7 @@ public:
   void VisitVarExpr(const VarExpr *E);
   void VisitArrayConstructorExpr(const ArrayConstructorExpr *E);
   void VisitArraySectionExpr(const ArraySectionExpr *E);
+  void VisitIntrinsicCallExpr(const IntrinsicCallExpr *E);
 
   ArrayRef<ArrayDimensionValueTy> getDimensions() const {
     return Dims;
@@ -53,6 +55,20 @@ public:
   }
 };
 
+/// ImpliedDoValueTy - the parameters of an implied do in an array
+/// constructor, which are evaluated before the loop of the implied do.
+struct ImpliedDoValueTy {
+  const ImpliedDoExpr *E;
+  llvm::Value *VarPtr;
+  llvm::Value *Init;
+  llvm::Value *Increment;
+  llvm::Value *IterationCount;
+
+  ImpliedDoValueTy()
+    : E(nullptr), VarPtr(nullptr), Init(nullptr), Increment(nullptr),
+      IterationCount(nullptr) {}
+};
+
 /// ArrayOperation - Represents an array expression / statement.
 /// Stores the array sections and scalars used in the array operation.
 class ArrayOperation {
@@ -64,6 +80,40 @@ class ArrayOperation {
   llvm::SmallDenseMap<const Expr*, StoredArrayValue, 8> Arrays;
   llvm::SmallDenseMap<const Expr*, RValueTy, 8> Scalars;
 
+  /// ElementValues - the values which were assigned to the current
+  /// element of the arrays by the earlier statements in a fused operation.
+  llvm::SmallDenseMap<const VarDecl*, RValueTy, 4> ElementValues;
+
+  /// ReducedDimensions - the dimensions of the source arrays which
+  /// are reduced by the array reductions with a DIM argument, or
+  /// by the inner products in MATMUL.
+  llvm::SmallDenseMap<const Expr*, ArrayDimensionValueTy, 4> ReducedDimensions;
+
+  /// ViewSources - the arrays which give the shape of the
+  /// sources of the array views like TRANSPOSE.
+  llvm::SmallDenseMap<const Expr*, const Expr*, 4> ViewSources;
+
+  /// ShiftOffsets - the offsets which are added to the indices
+  /// by the CSHIFT and EOSHIFT views.
+  llvm::SmallDenseMap<const Expr*, llvm::Value*, 4> ShiftOffsets;
+
+  /// InteriorShifts - the shift views whose elements are known
+  /// to be inside of the source in the current part of the loop.
+  llvm::SmallPtrSet<const Expr*, 4> InteriorShifts;
+
+  /// FusedImpliedDos - the implied do array constructors whose
+  /// elements are computed in the loop of the array operation.
+  llvm::SmallDenseMap<const Expr*, ImpliedDoValueTy, 4> FusedImpliedDos;
+
+  /// FuseArrayConstructors - if set, the elements of the elemental
+  /// operands which are implied do array constructors are computed
+  /// in the loop of the array operation.
+  bool FuseArrayConstructors;
+
+  /// Temporaries - the heap arrays which hold the results of
+  /// PACK and UNPACK until the operation is done.
+  SmallVector<llvm::Value*, 2> Temporaries;
+
   SmallVector<ArrayDimensionValueTy, 32> Dims;
 
 protected:
@@ -74,15 +124,94 @@ protected:
   /// \brief Emits the array sections used for the given expression.
   void EmitArraySections(CodeGenFunction &CGF, const Expr *E);
 
+  /// \brief Emits the array sections for the result of the given array
+  /// reduction, which reduces the given dimension of the source array.
+  void EmitReducedArraySections(const Expr *E, const Expr *Source, unsigned Dim);
+
+  /// \brief Emits the array sections for the result of MATMUL
+  /// with the two given matrices.
+  void EmitMatmulArraySections(const Expr *E, const Expr *MatrixA,
+                               const Expr *MatrixB);
+
+  /// \brief Emits the array sections for the given array view of the
+  /// source array, which is null when the source is a scalar.
+  void EmitViewArraySections(CodeGenFunction &CGF, const IntrinsicCallExpr *E,
+                             const Expr *Source);
+
+  /// \brief Emits the array sections for the given array constructor,
+  /// whose elements are computed in the loop of the array operation.
+  void EmitFusedArrayConstructorSections(CodeGenFunction &CGF,
+                                         const ArrayConstructorExpr *E);
+
   friend class ScalarEmitterAndSectionGatherer;
 public:
 
+  ArrayOperation(bool FuseConstructors = false)
+    : FuseArrayConstructors(FuseConstructors) {}
+
   /// \brief Returns the array value used for the given expression.
   ArrayValueRef getArrayValue(const Expr *E);
 
   /// \brief Returns the value used for the given scalar expression.
   RValueTy getScalarValue(const Expr *E);
 
+  /// \brief Returns the dimension of the source array which
+  /// is reduced by the given array reduction.
+  ArrayDimensionValueTy getReducedDimension(const Expr *E) {
+    return ReducedDimensions[E];
+  }
+
+  /// \brief Returns the array which gives the shape
+  /// of the source of the given array view.
+  const Expr *getViewSource(const Expr *E) {
+    return ViewSources[E];
+  }
+
+  /// \brief Returns the offset which is added to the
+  /// indices by the given shift view.
+  llvm::Value *getShiftOffset(const Expr *E) {
+    return ShiftOffsets[E];
+  }
+
+  /// \brief Marks the given shift view as one whose elements are
+  /// inside of the source, so that its indices don't wrap around
+  /// and the boundary isn't used.
+  void setInteriorShift(const Expr *E, bool Interior) {
+    if(Interior)
+      InteriorShifts.insert(E);
+    else
+      InteriorShifts.erase(E);
+  }
+
+  bool isInteriorShift(const Expr *E) const {
+    return InteriorShifts.count(E) != 0;
+  }
+
+  bool isFusedArrayConstructor(const Expr *E) const {
+    return FusedImpliedDos.count(E) != 0;
+  }
+
+  /// \brief Returns the implied do of the given
+  /// array constructor which is fused into the loop.
+  ImpliedDoValueTy getFusedImpliedDo(const Expr *E) {
+    return FusedImpliedDos[E];
+  }
+
+  /// \brief Records the value which was assigned to the current element
+  /// of the given array, so that it isn't reloaded by the following
+  /// statements in a fused array operation.
+  void setElementValue(const VarDecl *VD, RValueTy Value) {
+    ElementValues[VD] = Value;
+  }
+
+  bool hasElementValue(const VarDecl *VD) const {
+    return ElementValues.count(VD) != 0;
+  }
+
+  RValueTy getElementValue(const VarDecl *VD) {
+    return ElementValues[VD];
+  }
+
   /// \brief Emits the array section used on the left side of an assignment
   /// in a multidimensional loop.
   ArrayValueRef EmitArrayExpr(CodeGenFunction &CGF, const Expr *E);
@@ -93,6 +222,11 @@ public:
   /// and also by emmitting the array sections which are used to access the array
   /// elements inside the operation's loop.
   void EmitAllScalarValuesAndArraySections(CodeGenFunction &CGF, const Expr *E);
+
+  /// \brief Frees the temporary arrays which were allocated for the
+  /// operands of this operation. This is called once the operation
+  /// is emitted, so that the temporaries don't accumulate in a loop.
+  void FreeTemporaries(CodeGenFunction &CGF);
 };
 
 /// StandaloneArrayValueSectionGatherer - Gathers the array sections
@@ -117,6 +251,7 @@ public:
   void VisitUnaryExpr(const UnaryExpr *E);
   void VisitImplicitCastExpr(const ImplicitCastExpr *E);
   void VisitIntrinsicCallExpr(const IntrinsicCallExpr *E);
+  void VisitCallExpr(const CallExpr *E);
   void VisitArraySectionExpr(const ArraySectionExpr *E);
 
   ArrayValueRef getResult() const {
@@ -137,15 +272,19 @@ private:
 
   CodeGenFunction &CGF;
   CGBuilderTy &Builder;
+  const char *Name;
 
   /// ElementInfo - stores the current loop index for all
   /// dimensions, or null if the loop index doesn't apply
   /// (i.e. element section).
   SmallVector<llvm::Value *, 8> Elements;
   SmallVector<Loop, 8> Loops;
+
+  /// Hints - the directive hints for the innermost loop.
+  const LoopHints *Hints;
 public:
 
-  ArrayLoopEmitter(CodeGenFunction &cgf);
+  ArrayLoopEmitter(CodeGenFunction &cgf, const char *name = "array-dim-loop");
 
   /// EmitSectionIndex - computes the index of the element during
   /// the current iteration of the multidimensional loop
@@ -169,9 +308,38 @@ public:
   /// multidimensional loop which iterates over the given array section.
   void EmitArrayIterationBegin(const ArrayValueRef &Array);
 
+  /// EmitDimensionIterationBegin - Emits the beginning of a loop
+  /// which iterates over one dimension of the given array section.
+  /// The loops for the outer dimensions must be emitted first.
+  void EmitDimensionIterationBegin(const ArrayValueRef &Array, size_t I);
+
+  /// EmitDimensionIterationBegin - Emits the beginning of a loop which
+  /// iterates over the given part [Begin, End) of one dimension.
+  void EmitDimensionIterationBegin(const ArrayValueRef &Array, size_t I,
+                                   llvm::Value *Begin, llvm::Value *End);
+
+  /// EmitDimensionIterationEnd - Emits the end of the loop
+  /// which iterates over the given dimension.
+  void EmitDimensionIterationEnd(size_t I);
+
   /// EmitArrayIterationEnd - Emits the end of a
   /// multidimensional loop which iterates over the given array section.
   void EmitArrayIterationEnd();
+
+  /// getElement - returns the current loop index for the given dimension.
+  llvm::Value *getElement(size_t I) const {
+    return Elements[I];
+  }
+
+  /// setElement - sets the index for the given dimension, which
+  /// is used when the dimension isn't iterated over by this emitter.
+  void setElement(size_t I, llvm::Value *Index);
+
+  /// setLoopHints - sets the directive hints which are applied to the
+  /// innermost loop by EmitArrayIterationEnd.
+  void setLoopHints(const LoopHints *H) {
+    Hints = H;
+  }
 };
 
 /// ArrayOperationEmitter - Emits the array expression for the current
@@ -194,6 +362,7 @@ public:
   RValueTy VisitArrayConstructorExpr(const ArrayConstructorExpr *E);
   RValueTy VisitArraySectionExpr(const ArraySectionExpr *E);
   RValueTy VisitIntrinsicCallExpr(const IntrinsicCallExpr *E);
+  RValueTy VisitCallExpr(const CallExpr *E);
 
   static QualType ElementType(const Expr *E) {
     return cast<ArrayType>(E->getType().getTypePtr())->getElementType();
@@ -202,6 +371,336 @@ public:
   LValueTy EmitLValue(const Expr *E);
 };
 
+/// ArrayConstructorEmitter - Stores the items of an array constructor
+/// into a one dimensional array, using loops for the implied do
+/// and the array items.
+class ArrayConstructorEmitter {
+  CodeGenFunction &CGF;
+  CGBuilderTy &Builder;
+  QualType ElementType;
+
+  /// DestPtr and DestStride - the array which stores the items.
+  llvm::Value *DestPtr;
+  llvm::Value *DestStride;
+
+  /// Index - the variable with the index of the next item.
+  llvm::Value *Index;
+
+  /// ImpliedDoLoop - stores some information about an implied do loop.
+  struct ImpliedDoLoop {
+    ImpliedDoValueTy Value;
+    llvm::Value *Counter;
+    llvm::Value *PrevVarPtr;
+    llvm::BasicBlock *TestBlock;
+    llvm::BasicBlock *EndBlock;
+  };
+
+  void EmitImpliedDoBegin(const ImpliedDoExpr *E, ImpliedDoLoop &Loop);
+  void EmitImpliedDoEnd(ImpliedDoLoop &Loop);
+  void EmitImpliedDoVar(const ImpliedDoValueTy &Value, llvm::Value *Iteration);
+
+  llvm::Value *EmitItemSize(const Expr *E);
+  void EmitItem(const Expr *E);
+  void EmitElement(RValueTy Value);
+public:
+
+  ArrayConstructorEmitter(CodeGenFunction &cgf, QualType ElementType);
+
+  /// \brief Returns true if the array constructor is an implied do
+  /// with a scalar body, whose elements can be computed in the loop
+  /// of an elemental array operation.
+  static bool isFusible(const ArrayConstructorExpr *E);
+
+  /// \brief Returns true if the items of the array constructor
+  /// may read the elements of the given array.
+  static bool MayReadArray(const ArrayConstructorExpr *E, const Expr *Array);
+
+  /// \brief Emits the number of elements in the given items.
+  llvm::Value *EmitSize(ArrayRef<Expr*> Items);
+
+  /// \brief Stores the given items into the given one dimensional array.
+  void EmitItems(const ArrayValueRef &Dest, ArrayRef<Expr*> Items);
+
+  /// \brief Evaluates the parameters of the given implied do.
+  ImpliedDoValueTy EmitImpliedDoValue(const ImpliedDoExpr *E);
+
+  /// \brief Emits the element of a fused implied do
+  /// for the given iteration.
+  RValueTy EmitFusedElement(const ImpliedDoValueTy &Value,
+                            llvm::Value *Iteration);
+};
+
+/// ArrayReductionEmitter - Emits the array reduction intrinsics
+/// like SUM or ANY, either for the whole array or for an element
+/// of the result when the reduced dimension is given.
+class ArrayReductionEmitter {
+  CodeGenFunction &CGF;
+  CGBuilderTy &Builder;
+  intrinsic::FunctionKind Func;
+  const Expr *Array;
+  const Expr *Vector;
+  const Expr *Mask;
+  QualType ElementType;
+
+  /// Accumulators - the partial results of the reduction.
+  SmallVector<llvm::Value*, 4> Accumulators;
+
+  /// ExitBlock - the block that is reached when the result
+  /// of ANY or ALL is known before the end of the array.
+  llvm::BasicBlock *ExitBlock;
+
+  bool isEarlyExit() const;
+  bool isReassociable() const;
+  RValueTy GetIdentityValue();
+  RValueTy EmitAccumulatorLoad(llvm::Value *Acc);
+  void EmitAccumulatorStore(RValueTy Value, llvm::Value *Acc);
+  RValueTy EmitCombine(RValueTy Acc, RValueTy Value);
+
+  void EmitReductionBegin(unsigned AccumulatorCount);
+  void EmitElement(ArrayOperation &Op, ArrayLoopEmitter &Looper,
+                   unsigned Accumulator);
+  void EmitDimensionReduction(ArrayOperation &Op, ArrayLoopEmitter &Looper,
+                              const ArrayDimensionValueTy &Dim, size_t I);
+  RValueTy EmitReductionEnd();
+public:
+
+  ArrayReductionEmitter(CodeGenFunction &cgf, intrinsic::FunctionKind func,
+                        ArrayRef<Expr*> Arguments);
+
+  /// \brief Returns true if the given function is an array reduction.
+  static bool isReduction(intrinsic::FunctionKind Func);
+
+  /// \brief Returns true if the given intrinsic call is an array reduction
+  /// which returns an array, including MAXLOC, MINLOC and FINDLOC
+  /// with the DIM argument.
+  static bool isArrayReduction(const IntrinsicCallExpr *E);
+
+  /// \brief Returns the DIM argument, or null if it isn't given.
+  static const Expr *getDimArgument(intrinsic::FunctionKind Func,
+                                    ArrayRef<Expr*> Arguments);
+
+  /// \brief Returns the (zero based) dimension which is reduced by
+  /// the given array reduction.
+  static unsigned getReducedDimension(const ASTContext &C,
+                                      const IntrinsicCallExpr *E);
+
+  /// \brief Emits the reduction of all the elements in the array.
+  RValueTy Emit();
+
+  /// \brief Emits the reduction of all the elements in the given source
+  /// array, whose sections are already gathered in the given operation.
+  RValueTy EmitReduction(ArrayOperation &Op, const ArrayValueRef &Source);
+
+  /// \brief Emits the current element of the result of the given array
+  /// reduction in the multidimensional loop.
+  RValueTy EmitResultElement(ArrayOperation &Op, ArrayLoopEmitter &Looper,
+                             const IntrinsicCallExpr *E);
+};
+
+/// ArrayLocationEmitter - Emits MAXLOC, MINLOC and FINDLOC. The search
+/// is done in two phases - the value to locate is found first (using the
+/// MAXVAL or MINVAL reduction for MAXLOC and MINLOC), and then the
+/// elements are compared with this value until the first match.
+class ArrayLocationEmitter {
+  CodeGenFunction &CGF;
+  CGBuilderTy &Builder;
+  intrinsic::FunctionKind Func;
+  Expr *Array;
+  const Expr *Value;
+  const Expr *Dim;
+  Expr *Mask;
+  const Expr *Back;
+  QualType ElementType;
+
+  void EmitArguments(ArrayOperation &Op);
+  ArrayReductionEmitter getExtremumReduction() const;
+  llvm::Value *EmitBack(ArrayOperation &Op);
+  llvm::Value *EmitIndex(llvm::Value *Back, llvm::Value *Index,
+                         llvm::Value *Size);
+  llvm::Value *EmitIsFound(ArrayOperation &Op, ArrayLoopEmitter &Looper,
+                           RValueTy Target);
+  llvm::Value *EmitDimensionSearch(ArrayOperation &Op, ArrayLoopEmitter &Looper,
+                                   RValueTy Target, llvm::Value *Back,
+                                   const ArrayDimensionValueTy &Dim, size_t I);
+public:
+
+  ArrayLocationEmitter(CodeGenFunction &cgf, intrinsic::FunctionKind func,
+                       ArrayRef<Expr*> Arguments);
+
+  /// \brief Returns true if the given function is MAXLOC, MINLOC or FINDLOC.
+  static bool isLocation(intrinsic::FunctionKind Func);
+
+  /// \brief Returns true if the given intrinsic call returns the location
+  /// of an element in the whole array, i.e. the DIM argument isn't given.
+  static bool isLocationArray(const IntrinsicCallExpr *E);
+
+  /// \brief Returns the DIM argument, or null if it isn't given.
+  static const Expr *getDimArgument(intrinsic::FunctionKind Func,
+                                    ArrayRef<Expr*> Arguments);
+
+  /// \brief Emits the location in a one dimensional array along
+  /// the first dimension.
+  RValueTy Emit();
+
+  /// \brief Emits the current element of the result of the given location
+  /// intrinsic with the DIM argument in the multidimensional loop.
+  RValueTy EmitResultElement(ArrayOperation &Op, ArrayLoopEmitter &Looper,
+                             const IntrinsicCallExpr *E);
+
+  /// \brief Emits the location in the whole array into a temporary array
+  /// on the stack (the size of the result is the rank of the array), and
+  /// returns the pointer to it and its dimension.
+  llvm::Value *EmitLocationArray(SmallVectorImpl<ArrayDimensionValueTy> &Dims);
+};
+
+/// ArrayViewEmitter - Emits the intrinsics like TRANSPOSE, RESHAPE
+/// and SPREAD, which only change the indices used to access the
+/// elements of the source, so that the source is read in place
+/// without a temporary array.
+class ArrayViewEmitter {
+  CodeGenFunction &CGF;
+  CGBuilderTy &Builder;
+  const IntrinsicCallExpr *E;
+  intrinsic::FunctionKind Func;
+  const Expr *Source;
+public:
+
+  ArrayViewEmitter(CodeGenFunction &cgf, const IntrinsicCallExpr *e);
+
+  /// \brief Returns true if the given intrinsic call is an array view.
+  static bool isView(const IntrinsicCallExpr *E);
+
+  /// \brief Returns the (zero based) dimension which is added by SPREAD.
+  static unsigned getSpreadDimension(const ASTContext &C,
+                                     const IntrinsicCallExpr *E);
+
+  /// \brief Returns true if the given intrinsic call is CSHIFT or EOSHIFT.
+  static bool isShift(const IntrinsicCallExpr *E);
+
+  /// \brief Returns the (zero based) dimension which is shifted.
+  static unsigned getShiftDimension(const ASTContext &C,
+                                    const IntrinsicCallExpr *E);
+
+  /// \brief Returns the BOUNDARY argument of EOSHIFT, or null.
+  static const Expr *getBoundary(const IntrinsicCallExpr *E);
+
+  /// \brief Emits the offset which is added to the indices
+  /// in the shifted dimension.
+  llvm::Value *EmitShiftOffset(ArrayRef<ArrayDimensionValueTy> SourceDims);
+
+  /// \brief Emits the dimensions of the view, using the
+  /// dimensions of the source.
+  void EmitDimensions(ArrayRef<ArrayDimensionValueTy> SourceDims,
+                      SmallVectorImpl<ArrayDimensionValueTy> &Dims);
+
+  /// \brief Emits the current element of the view in the
+  /// multidimensional loop.
+  RValueTy EmitElement(ArrayOperation &Op, ArrayLoopEmitter &Looper);
+
+private:
+  RValueTy EmitShiftElement(ArrayOperation &Op, ArrayLoopEmitter &Looper,
+                            ArrayLoopEmitter &SourceLooper);
+  RValueTy GetBoundaryValue(ArrayOperation &Op);
+};
+
+/// MatmulEmitter - Emits the MATMUL intrinsic, either for an element
+/// of the result in the multidimensional loop, or for the whole
+/// result when it's assigned to an array.
+class MatmulEmitter {
+  CodeGenFunction &CGF;
+  CGBuilderTy &Builder;
+  const Expr *MatrixA;
+  const Expr *MatrixB;
+  QualType ElementType;
+
+  /// VectorA, VectorB - true when the first matrix is a row
+  /// vector, or when the second matrix is a column vector.
+  bool VectorA, VectorB;
+
+  /// Loop - a counted loop emitted by the matrix multiplication.
+  struct Loop {
+    llvm::Value *Counter;
+    llvm::BasicBlock *TestBlock;
+    llvm::BasicBlock *EndBlock;
+  };
+
+  llvm::Value *EmitLoopBegin(Loop &L, llvm::Value *Begin, llvm::Value *End,
+                             const char *Name);
+  void EmitLoopEnd(Loop &L, llvm::Value *Step);
+
+  RValueTy GetZeroValue();
+  RValueTy EmitProduct(RValueTy A, RValueTy B);
+  RValueTy EmitSum(RValueTy X, RValueTy Y);
+
+  bool EvaluateShape(uint64_t &N, uint64_t &M, uint64_t &K);
+  void EmitUnrolled(ArrayOperation &Op, const ArrayValueRef &Dest,
+                    uint64_t N, uint64_t M, uint64_t K);
+  void EmitBlocked(ArrayOperation &Op, const ArrayValueRef &Dest);
+  bool EmitRuntimeCall(ArrayOperation &Op, const ArrayValueRef &Dest);
+public:
+
+  MatmulEmitter(CodeGenFunction &cgf, ArrayRef<Expr*> Arguments);
+
+  /// \brief Returns true if the given intrinsic call is MATMUL.
+  static bool isMatmul(const IntrinsicCallExpr *E);
+
+  /// \brief Emits the current element of the result in the
+  /// multidimensional loop as the inner product of a row of the first
+  /// matrix and a column of the second matrix.
+  RValueTy EmitResultElement(ArrayOperation &Op, ArrayLoopEmitter &Looper,
+                             const IntrinsicCallExpr *E);
+
+  /// \brief Emits the assignment of the result to the given array,
+  /// which may share memory with the matrices when MayOverlap is true.
+  /// Returns false when the assignment has to be done elementwise.
+  bool EmitAssignment(const Expr *LHS, bool MayOverlap);
+};
+
+/// PackEmitter - Emits the PACK and UNPACK intrinsics, which gather
+/// the elements selected by the mask into a vector, or scatter the
+/// elements of a vector into the elements selected by the mask. The
+/// position in the vector is counted while the mask is traversed
+/// in the array element order. Contiguous arrays of 4 and 8 byte
+/// elements with a default LOGICAL mask are packed by the runtime
+/// library.
+class PackEmitter {
+  CodeGenFunction &CGF;
+  CGBuilderTy &Builder;
+  const IntrinsicCallExpr *E;
+  intrinsic::FunctionKind Func;
+  QualType ElementType;
+  llvm::BasicBlock *LoopBB, *EndBB;
+
+  void EmitArguments(ArrayOperation &Op);
+  llvm::Value *EmitMaskElement(ArrayOperation &Op, ArrayLoopEmitter &Looper);
+  bool HasKernelMask();
+  unsigned GetKernelElementSize();
+  llvm::Value *EmitKernelCondition(ArrayOperation &Op,
+                                   ArrayRef<const Expr*> Operands);
+  bool EmitKernelBegin(llvm::Value *Contiguous);
+  bool EmitKernelEnd();
+  void EmitLoopEnd();
+  llvm::Value *EmitCount(ArrayOperation &Op, const ArrayValueRef &Shape);
+  void EmitPack(ArrayOperation &Op, const ArrayValueRef &Shape,
+                const ArrayValueRef &Dest, const Expr *DestExpr);
+  void EmitUnpack(ArrayOperation &Op, const ArrayValueRef &Shape,
+                  const ArrayValueRef &Dest, const Expr *DestExpr);
+public:
+
+  PackEmitter(CodeGenFunction &cgf, const IntrinsicCallExpr *e);
+
+  /// \brief Returns true if the given intrinsic call is PACK or UNPACK.
+  static bool isPack(const IntrinsicCallExpr *E);
+
+  /// \brief Emits the result into a temporary array, and
+  /// returns the pointer to it and its dimensions.
+  llvm::Value *EmitTemporary(SmallVectorImpl<ArrayDimensionValueTy> &Dims);
+
+  /// \brief Emits the assignment of the result to the given
+  /// array, which doesn't share memory with the arguments.
+  void EmitAssignment(const Expr *LHS);
+};
+
 }
 }  // end namespace flang
 
@@ -24,79 +24,1482 @@
 namespace flang {
 namespace CodeGen {
 
-RValueTy CodeGenFunction::
-EmitVectorDimReturningScalarArrayIntrinsic(intrinsic::FunctionKind Func,
-                                           Expr *Arr) {
+RValueTy CodeGenFunction::EmitArrayIntrinsic(intrinsic::FunctionKind Func,
+                                             ArrayRef<Expr*> Arguments) {
   using namespace intrinsic;
-  auto ElementType = Arr->getType()->asArrayType()->getElementType();
 
   switch(Func) {
   case MAXLOC:
-  case MINLOC: {
-    auto Result = CreateTempAlloca(CGM.SizeTy, "maxminloc-result");
-    auto MaxMinVar = CreateTempAlloca(ConvertTypeForMem(ElementType), "maxminloc-var");
-    Builder.CreateStore(llvm::ConstantInt::get(CGM.SizeTy, 0), Result);
-    if(Func == MAXLOC)
-      Builder.CreateStore(GetConstantScalarMinValue(ElementType), MaxMinVar);
-    else
-      Builder.CreateStore(GetConstantScalarMaxValue(ElementType), MaxMinVar);
-
-    ArrayOperation OP;
-    StandaloneArrayValueSectionGatherer Gatherer(*this, OP);
-    Gatherer.EmitExpr(Arr);
-    OP.EmitAllScalarValuesAndArraySections(*this, Arr);
-    ArrayLoopEmitter Looper(*this);
-    Looper.EmitArrayIterationBegin(Gatherer.getResult());
-    ArrayOperationEmitter EV(*this, OP, Looper);
-
-    auto ElementValue = EV.Emit(Arr).asScalar();
-    auto ResultValue = Builder.CreateLoad(MaxMinVar);
-    auto ThenBlock = createBasicBlock("maxminloc-then");
-    auto EndBlock = createBasicBlock("maxminloc-end");
-    Builder.CreateCondBr(EmitScalarBinaryExpr(Func == MAXLOC? BinaryExpr::GreaterThan : BinaryExpr::LessThan,
-                                              ElementValue, ResultValue),
-                         ThenBlock, EndBlock);
-    EmitBlock(ThenBlock);
-    Builder.CreateStore(ElementValue, MaxMinVar);
-    Builder.CreateStore(Looper.EmitElementOneDimensionalIndex(Gatherer.getResult()), Result);
-    EmitBranch(EndBlock);
-    EmitBlock(EndBlock);
+  case MINLOC:
+  case FINDLOC:
+    // The indices of the element, or an array of the indices
+    // along the given dimension.
+    return ArrayLocationEmitter(*this, Func, Arguments).Emit();
 
-    Looper.EmitArrayIterationEnd();
-    return EmitScalarToScalarConversion(Builder.CreateLoad(Result),
-                                        getContext().IntegerTy);
-  }
+  case SUM:
+  case PRODUCT:
+  case MAXVAL:
+  case MINVAL:
+  case COUNT:
+  case ANY:
+  case ALL:
+  case DOT_PRODUCT:
+    return ArrayReductionEmitter(*this, Func, Arguments).Emit();
+
+  case MERGE:
+    return EmitMergeIntrinsic(Arguments[0]->getType(),
+                              EmitLogicalConditionExpr(Arguments[2]),
+                              EmitRValue(Arguments[0]), EmitRValue(Arguments[1]));
 
   default:
     llvm_unreachable("invalid intrinsic");
     break;
   }
+
   return RValueTy();
 }
 
-RValueTy CodeGenFunction::EmitArrayIntrinsic(intrinsic::FunctionKind Func,
-                                             ArrayRef<Expr*> Arguments) {
+//
+// Array reductions.
+//
+
+ArrayReductionEmitter::ArrayReductionEmitter(CodeGenFunction &cgf,
+                                             intrinsic::FunctionKind func,
+                                             ArrayRef<Expr*> Arguments)
+  : CGF(cgf), Builder(cgf.getBuilder()), Func(func), Array(Arguments[0]),
+    Vector(nullptr), Mask(nullptr), ExitBlock(nullptr) {
   using namespace intrinsic;
 
   switch(Func) {
-  case MAXLOC:
-  case MINLOC:
-    if(Arguments.size() == 2 &&
-       Arguments[0]->getType()->asArrayType()->getDimensionCount() == 1 &&
-       Arguments[1]->getType()->isIntegerType()) {
-      // Vector, dim -> return scalar
-      return EmitVectorDimReturningScalarArrayIntrinsic(Func,
-                                                        Arguments.front());
-    }
-    llvm_unreachable("FIXME: add codegen for the rest");
+  case SUM:
+  case PRODUCT:
+  case MAXVAL:
+  case MINVAL:
+    // (array, dim, mask) or (array, mask)
+    if(Arguments.size() == 3)
+      Mask = Arguments[2];
+    else if(Arguments.size() == 2 && Arguments[1]->getType()->isArrayType())
+      Mask = Arguments[1];
     break;
+  case DOT_PRODUCT:
+    Vector = Arguments[1];
+    break;
+  default:
+    break;
+  }
+  ElementType = Func == COUNT? CGF.getContext().IntegerTy :
+                               Array->getType()->asArrayType()->getElementType();
+}
 
+bool ArrayReductionEmitter::isReduction(intrinsic::FunctionKind Func) {
+  using namespace intrinsic;
+  switch(Func) {
+  case SUM: case PRODUCT: case MAXVAL: case MINVAL:
+  case COUNT: case ANY: case ALL: case DOT_PRODUCT:
+    return true;
   default:
-    llvm_unreachable("invalid intrinsic");
+    return false;
+  }
+}
+
+bool ArrayReductionEmitter::isArrayReduction(const IntrinsicCallExpr *E) {
+  auto Func = intrinsic::getGenericFunctionKind(E->getIntrinsicFunction());
+  if(ArrayLocationEmitter::isLocation(Func))
+    return E->getType()->isArrayType() && getDimArgument(Func, E->getArguments());
+  return isReduction(Func) && E->getType()->isArrayType();
+}
+
+const Expr *ArrayReductionEmitter::getDimArgument(intrinsic::FunctionKind Func,
+                                                  ArrayRef<Expr*> Arguments) {
+  if(ArrayLocationEmitter::isLocation(Func))
+    return ArrayLocationEmitter::getDimArgument(Func, Arguments);
+  if(Func == intrinsic::DOT_PRODUCT || Arguments.size() < 2 ||
+     !Arguments[1]->getType()->isIntegerType())
+    return nullptr;
+  return Arguments[1];
+}
+
+unsigned ArrayReductionEmitter::getReducedDimension(const ASTContext &C,
+                                                    const IntrinsicCallExpr *E) {
+  int64_t Dim;
+  auto Arg = getDimArgument(intrinsic::getGenericFunctionKind(E->getIntrinsicFunction()),
+                            E->getArguments());
+  if(!Arg || !Arg->EvaluateAsInt(Dim, C))
+    llvm_unreachable("the reduced dimension must be constant");
+  return unsigned(Dim - 1);
+}
+
+/// ANY and ALL (and DOT_PRODUCT for logical vectors) stop
+/// as soon as the result is known.
+bool ArrayReductionEmitter::isEarlyExit() const {
+  return Func == intrinsic::ANY || Func == intrinsic::ALL ||
+         (Func == intrinsic::DOT_PRODUCT && ElementType->isLogicalType());
+}
+
+/// Integer reductions can always be split into several partial
+/// reductions, but the floating point ones change the rounding.
+bool ArrayReductionEmitter::isReassociable() const {
+  if(isEarlyExit())
+    return false;
+  if(ElementType->isIntegerType())
+    return true;
+  return CGF.getModule().getCodeGenOpts().ReassociateReductions;
+}
+
+RValueTy ArrayReductionEmitter::GetIdentityValue() {
+  using namespace intrinsic;
+
+  if(isEarlyExit())
+    return Func == ALL? Builder.getTrue() : Builder.getFalse();
+  if(ElementType->isComplexType()) {
+    auto T = CGF.getContext().getComplexTypeElementType(ElementType);
+    return ComplexValueTy(Func == PRODUCT? CGF.GetConstantOne(T) : CGF.GetConstantZero(T),
+                          CGF.GetConstantZero(T));
+  }
+
+  switch(Func) {
+  case PRODUCT:
+    return CGF.GetConstantOne(ElementType);
+  case MAXVAL:
+  case MINVAL: {
+    // The result for an empty array is the negative (for MAXVAL) or
+    // the positive (for MINVAL) number with the largest magnitude.
+    auto Type = CGF.ConvertType(ElementType);
+    if(Type->isIntegerTy()) {
+      auto Bits = Type->getIntegerBitWidth();
+      return llvm::ConstantInt::get(Type, Func == MAXVAL? llvm::APInt::getSignedMinValue(Bits) :
+                                                          llvm::APInt::getSignedMaxValue(Bits));
+    }
+    auto Huge = CGF.GetConstantScalarMaxValue(ElementType);
+    return Func == MAXVAL? Builder.CreateFNeg(Huge) : Huge;
+  }
+  default:
+    return CGF.GetConstantZero(ElementType);
+  }
+}
+
+RValueTy ArrayReductionEmitter::EmitAccumulatorLoad(llvm::Value *Acc) {
+  if(ElementType->isComplexType())
+    return CGF.EmitLoad(Acc, ElementType);
+  return Builder.CreateLoad(Acc);
+}
+
+void ArrayReductionEmitter::EmitAccumulatorStore(RValueTy Value, llvm::Value *Acc) {
+  if(Value.isComplex())
+    CGF.EmitStore(Value, Acc, ElementType);
+  else
+    Builder.CreateStore(Value.asScalar(), Acc);
+}
+
+RValueTy ArrayReductionEmitter::EmitCombine(RValueTy Acc, RValueTy Value) {
+  using namespace intrinsic;
+
+  switch(Func) {
+  case PRODUCT:
+    return CGF.EmitBinaryExpr(BinaryExpr::Multiply, Acc, Value);
+  case MAXVAL:
+  case MINVAL: {
+    auto Cond = CGF.EmitScalarBinaryExpr(Func == MAXVAL? BinaryExpr::GreaterThan :
+                                                         BinaryExpr::LessThan,
+                                         Value.asScalar(), Acc.asScalar());
+    return Builder.CreateSelect(Cond, Value.asScalar(), Acc.asScalar());
+  }
+  default:
+    return CGF.EmitBinaryExpr(BinaryExpr::Plus, Acc, Value);
+  }
+}
+
+static llvm::Value *EmitLogicalElement(CodeGenFunction &CGF, RValueTy Value) {
+  auto Val = Value.asScalar();
+  if(Val->getType() != CGF.getModule().Int1Ty)
+    return CGF.ConvertLogicalValueToInt1(Val);
+  return Val;
+}
+
+static RValueTy EmitSelect(CGBuilderTy &Builder, llvm::Value *Cond,
+                           RValueTy TrueVal, RValueTy FalseVal) {
+  if(TrueVal.isComplex())
+    return ComplexValueTy(Builder.CreateSelect(Cond, TrueVal.asComplex().Re,
+                                               FalseVal.asComplex().Re),
+                          Builder.CreateSelect(Cond, TrueVal.asComplex().Im,
+                                               FalseVal.asComplex().Im));
+  return Builder.CreateSelect(Cond, TrueVal.asScalar(), FalseVal.asScalar());
+}
+
+RValueTy CodeGenFunction::EmitMergeIntrinsic(QualType ElementType, llvm::Value *Mask,
+                                             RValueTy TSource, RValueTy FSource) {
+  if(ElementType->isCharacterType()) {
+    auto TrueVal = TSource.asCharacter();
+    auto FalseVal = FSource.asCharacter();
+    return CharacterValueTy(Builder.CreateSelect(Mask, TrueVal.Ptr, FalseVal.Ptr),
+                            Builder.CreateSelect(Mask, TrueVal.Len, FalseVal.Len));
+  }
+  if(ElementType->isLogicalType())
+    return Builder.CreateSelect(Mask, EmitLogicalElement(*this, TSource),
+                                EmitLogicalElement(*this, FSource));
+  return EmitSelect(Builder, Mask, TSource, FSource);
+}
+
+void ArrayReductionEmitter::EmitReductionBegin(unsigned AccumulatorCount) {
+  auto Identity = GetIdentityValue();
+  auto Type = Identity.isComplex()? CGF.ConvertTypeForMem(ElementType) :
+                                    Identity.asScalar()->getType();
+  Accumulators.clear();
+  for(unsigned I = 0; I < AccumulatorCount; ++I) {
+    auto Acc = CGF.CreateTempAlloca(Type, "reduction-accumulator");
+    EmitAccumulatorStore(Identity, Acc);
+    Accumulators.push_back(Acc);
+  }
+  if(isEarlyExit())
+    ExitBlock = CGF.createBasicBlock("reduction-exit");
+}
+
+void ArrayReductionEmitter::EmitElement(ArrayOperation &Op, ArrayLoopEmitter &Looper,
+                                        unsigned Accumulator) {
+  ArrayOperationEmitter EV(CGF, Op, Looper);
+  auto Acc = Accumulators[Accumulator];
+
+  if(isEarlyExit()) {
+    auto Value = EmitLogicalElement(CGF, EV.Emit(Array));
+    if(Vector)
+      Value = Builder.CreateAnd(Value, EmitLogicalElement(CGF, EV.Emit(Vector)));
+    // ALL exits on the first false element, the others on the first true one.
+    auto ContinueBlock = CGF.createBasicBlock("reduction-continue");
+    if(Func == intrinsic::ALL)
+      Builder.CreateCondBr(Value, ContinueBlock, ExitBlock);
+    else
+      Builder.CreateCondBr(Value, ExitBlock, ContinueBlock);
+    CGF.EmitBlock(ContinueBlock);
+    return;
+  }
+
+  RValueTy Value;
+  if(Func == intrinsic::COUNT)
+    Value = Builder.CreateZExt(EmitLogicalElement(CGF, EV.Emit(Array)),
+                               CGF.ConvertType(ElementType));
+  else if(Vector) {
+    auto A = EV.Emit(Array);
+    if(A.isComplex())
+      A = CGF.EmitIntrinsicCallComplex(intrinsic::CONJG, A.asComplex());
+    Value = CGF.EmitBinaryExpr(BinaryExpr::Multiply, A, EV.Emit(Vector));
+  } else {
+    // The masked out elements are replaced by the identity value,
+    // so that the loop body doesn't need a branch.
+    Value = EV.Emit(Array);
+    if(Mask)
+      Value = EmitSelect(Builder, EmitLogicalElement(CGF, EV.Emit(Mask)),
+                         Value, GetIdentityValue());
+  }
+  EmitAccumulatorStore(EmitCombine(EmitAccumulatorLoad(Acc), Value), Acc);
+}
+
+void ArrayReductionEmitter::EmitDimensionReduction(ArrayOperation &Op, ArrayLoopEmitter &Looper,
+                                                   const ArrayDimensionValueTy &Dim, size_t I) {
+  auto IndexType = CGF.getModule().SizeTy;
+  auto Size = CGF.EmitDimSize(Dim);
+  auto Counter = CGF.CreateTempAlloca(IndexType, "reduction-counter");
+  Builder.CreateStore(llvm::ConstantInt::get(IndexType, 0), Counter);
+
+  // Each accumulator reduces every Nth element, which breaks
+  // the dependency between the consecutive iterations.
+  auto Count = Accumulators.size();
+  if(Count > 1) {
+    auto Step = llvm::ConstantInt::get(IndexType, Count);
+    auto LoopCond = CGF.createBasicBlock("reduction-unrolled-loop");
+    auto LoopBody = CGF.createBasicBlock("reduction-unrolled-loop-body");
+    auto LoopEnd = CGF.createBasicBlock("reduction-unrolled-loop-end");
+    CGF.EmitBlock(LoopCond);
+    Builder.CreateCondBr(Builder.CreateICmpULE(Builder.CreateAdd(Builder.CreateLoad(Counter), Step),
+                                               Size),
+                         LoopBody, LoopEnd);
+    CGF.EmitBlock(LoopBody);
+    auto Index = Builder.CreateLoad(Counter);
+    for(unsigned K = 0; K < Count; ++K) {
+      Looper.setElement(I, K == 0? Index :
+                          Builder.CreateAdd(Index, llvm::ConstantInt::get(IndexType, K)));
+      EmitElement(Op, Looper, K);
+    }
+    Builder.CreateStore(Builder.CreateAdd(Index, Step), Counter);
+    CGF.EmitBranch(LoopCond);
+    CGF.EmitBlock(LoopEnd);
+  }
+
+  auto LoopCond = CGF.createBasicBlock("reduction-loop");
+  auto LoopBody = CGF.createBasicBlock("reduction-loop-body");
+  auto LoopEnd = CGF.createBasicBlock("reduction-loop-end");
+  CGF.EmitBlock(LoopCond);
+  Builder.CreateCondBr(Builder.CreateICmpULT(Builder.CreateLoad(Counter), Size),
+                       LoopBody, LoopEnd);
+  CGF.EmitBlock(LoopBody);
+  auto Index = Builder.CreateLoad(Counter);
+  Looper.setElement(I, Index);
+  EmitElement(Op, Looper, 0);
+  Builder.CreateStore(Builder.CreateAdd(Index, llvm::ConstantInt::get(IndexType, 1)),
+                      Counter);
+  CGF.EmitBranch(LoopCond);
+  CGF.EmitBlock(LoopEnd);
+}
+
+RValueTy ArrayReductionEmitter::EmitReductionEnd() {
+  if(isEarlyExit()) {
+    auto EndBlock = CGF.createBasicBlock("reduction-end");
+    CGF.EmitBranch(EndBlock);
+    CGF.EmitBlock(ExitBlock);
+    Builder.CreateStore(Func == intrinsic::ALL? Builder.getFalse() : Builder.getTrue(),
+                        Accumulators[0]);
+    CGF.EmitBranch(EndBlock);
+    CGF.EmitBlock(EndBlock);
+    return Builder.CreateLoad(Accumulators[0]);
+  }
+
+  auto Result = EmitAccumulatorLoad(Accumulators[0]);
+  for(size_t I = 1; I < Accumulators.size(); ++I)
+    Result = EmitCombine(Result, EmitAccumulatorLoad(Accumulators[I]));
+  return Result;
+}
+
+RValueTy ArrayReductionEmitter::Emit() {
+  ArrayOperation OP;
+  StandaloneArrayValueSectionGatherer Gatherer(CGF, OP);
+  Gatherer.EmitExpr(Array);
+  OP.EmitAllScalarValuesAndArraySections(CGF, Array);
+  if(Vector)
+    OP.EmitAllScalarValuesAndArraySections(CGF, Vector);
+  if(Mask)
+    OP.EmitAllScalarValuesAndArraySections(CGF, Mask);
+  auto Result = EmitReduction(OP, Gatherer.getResult());
+  OP.FreeTemporaries(CGF);
+  return Result;
+}
+
+RValueTy ArrayReductionEmitter::EmitReduction(ArrayOperation &Op,
+                                              const ArrayValueRef &Source) {
+  EmitReductionBegin(isReassociable()? 4 : 1);
+  // Loop over the outer dimensions, and reduce
+  // the first (innermost) dimension.
+  ArrayLoopEmitter Looper(CGF);
+  for(auto I = Source.Dimensions.size(); I > 1;)
+    Looper.EmitDimensionIterationBegin(Source, --I);
+  EmitDimensionReduction(Op, Looper, Source.Dimensions[0], 0);
+  Looper.EmitArrayIterationEnd();
+  return EmitReductionEnd();
+}
+
+RValueTy ArrayReductionEmitter::EmitResultElement(ArrayOperation &Op, ArrayLoopEmitter &Looper,
+                                                  const IntrinsicCallExpr *E) {
+  assert(isArrayReduction(E));
+  auto Dim = getReducedDimension(CGF.getContext(), E);
+  auto Rank = Array->getType()->asArrayType()->getDimensionCount();
+
+  // The indices of the current result element select
+  // the elements in the other dimensions.
+  ArrayLoopEmitter Reduction(CGF);
+  for(size_t I = 0, J = 0; I < Rank; ++I) {
+    if(I != Dim)
+      Reduction.setElement(I, Looper.getElement(J++));
+  }
+  EmitReductionBegin(isReassociable()? 4 : 1);
+  EmitDimensionReduction(Op, Reduction, Op.getReducedDimension(E), Dim);
+  return EmitReductionEnd();
+}
+
+//
+// Array element locations.
+//
+
+ArrayLocationEmitter::ArrayLocationEmitter(CodeGenFunction &cgf,
+                                           intrinsic::FunctionKind func,
+                                           ArrayRef<Expr*> Arguments)
+  : CGF(cgf), Builder(cgf.getBuilder()), Func(func), Array(Arguments[0]),
+    Value(nullptr), Dim(nullptr), Mask(nullptr), Back(nullptr) {
+  // (array, [dim], [mask], [back]) or (array, value, [dim], [mask], [back]),
+  // the optional arguments are distinguished by their types.
+  auto Optional = Arguments.slice(1);
+  if(Func == intrinsic::FINDLOC) {
+    Value = Arguments[1];
+    Optional = Arguments.slice(2);
+  }
+  for(auto Arg : Optional) {
+    if(Arg->getType()->isIntegerType())
+      Dim = Arg;
+    else if(Arg->getType()->isArrayType())
+      Mask = Arg;
+    else
+      Back = Arg;
+  }
+  ElementType = Array->getType()->asArrayType()->getElementType();
+}
+
+bool ArrayLocationEmitter::isLocation(intrinsic::FunctionKind Func) {
+  return Func == intrinsic::MAXLOC || Func == intrinsic::MINLOC ||
+         Func == intrinsic::FINDLOC;
+}
+
+bool ArrayLocationEmitter::isLocationArray(const IntrinsicCallExpr *E) {
+  auto Func = intrinsic::getGenericFunctionKind(E->getIntrinsicFunction());
+  return isLocation(Func) && !getDimArgument(Func, E->getArguments());
+}
+
+const Expr *ArrayLocationEmitter::getDimArgument(intrinsic::FunctionKind Func,
+                                                 ArrayRef<Expr*> Arguments) {
+  size_t I = Func == intrinsic::FINDLOC? 2 : 1;
+  if(Arguments.size() <= I || !Arguments[I]->getType()->isIntegerType())
+    return nullptr;
+  return Arguments[I];
+}
+
+void ArrayLocationEmitter::EmitArguments(ArrayOperation &Op) {
+  Op.EmitAllScalarValuesAndArraySections(CGF, Array);
+  if(Value)
+    Op.EmitAllScalarValuesAndArraySections(CGF, Value);
+  if(Mask)
+    Op.EmitAllScalarValuesAndArraySections(CGF, Mask);
+  if(Back)
+    Op.EmitAllScalarValuesAndArraySections(CGF, Back);
+}
+
+/// MAXLOC and MINLOC locate the result of MAXVAL or MINVAL,
+/// which uses several accumulators and doesn't branch.
+ArrayReductionEmitter ArrayLocationEmitter::getExtremumReduction() const {
+  Expr *Args[] = { Array, Mask };
+  return ArrayReductionEmitter(CGF, Func == intrinsic::MAXLOC? intrinsic::MAXVAL :
+                                                               intrinsic::MINVAL,
+                               ArrayRef<Expr*>(Args, Mask? 2 : 1));
+}
+
+llvm::Value *ArrayLocationEmitter::EmitBack(ArrayOperation &Op) {
+  if(!Back)
+    return nullptr;
+  return EmitLogicalElement(CGF, Op.getScalarValue(Back));
+}
+
+/// When BACK is true, the elements are visited in the reverse order.
+llvm::Value *ArrayLocationEmitter::EmitIndex(llvm::Value *Back, llvm::Value *Index,
+                                             llvm::Value *Size) {
+  if(!Back)
+    return Index;
+  auto Last = Builder.CreateSub(Size, llvm::ConstantInt::get(Size->getType(), 1));
+  return Builder.CreateSelect(Back, Builder.CreateSub(Last, Index), Index);
+}
+
+llvm::Value *ArrayLocationEmitter::EmitIsFound(ArrayOperation &Op, ArrayLoopEmitter &Looper,
+                                               RValueTy Target) {
+  ArrayOperationEmitter EV(CGF, Op, Looper);
+  llvm::Value *Found;
+  assert(!ElementType->isCharacterType() &&
+         "character arrays can't be searched");
+  if(ElementType->isLogicalType())
+    Found = Builder.CreateICmpEQ(EmitLogicalElement(CGF, EV.Emit(Array)),
+                                 EmitLogicalElement(CGF, Target));
+  else
+    Found = CGF.EmitBinaryExpr(BinaryExpr::Equal, EV.Emit(Array), Target).asScalar();
+  if(Mask)
+    Found = Builder.CreateAnd(Found, EmitLogicalElement(CGF, EV.Emit(Mask)));
+  return Found;
+}
+
+llvm::Value *ArrayLocationEmitter::EmitDimensionSearch(ArrayOperation &Op, ArrayLoopEmitter &Looper,
+                                                       RValueTy Target, llvm::Value *Back,
+                                                       const ArrayDimensionValueTy &Dim, size_t I) {
+  auto IndexType = CGF.getModule().SizeTy;
+  auto Size = CGF.EmitDimSize(Dim);
+  auto Result = CGF.CreateTempAlloca(IndexType, "location-result");
+  Builder.CreateStore(llvm::ConstantInt::get(IndexType, 0), Result);
+  auto Counter = CGF.CreateTempAlloca(IndexType, "location-counter");
+  Builder.CreateStore(llvm::ConstantInt::get(IndexType, 0), Counter);
+
+  auto LoopCond = CGF.createBasicBlock("location-loop");
+  auto LoopBody = CGF.createBasicBlock("location-loop-body");
+  auto FoundBlock = CGF.createBasicBlock("location-found");
+  auto ContinueBlock = CGF.createBasicBlock("location-continue");
+  auto LoopEnd = CGF.createBasicBlock("location-loop-end");
+  CGF.EmitBlock(LoopCond);
+  Builder.CreateCondBr(Builder.CreateICmpULT(Builder.CreateLoad(Counter), Size),
+                       LoopBody, LoopEnd);
+  CGF.EmitBlock(LoopBody);
+  auto Counted = Builder.CreateLoad(Counter);
+  auto Index = EmitIndex(Back, Counted, Size);
+  Looper.setElement(I, Index);
+  Builder.CreateCondBr(EmitIsFound(Op, Looper, Target), FoundBlock, ContinueBlock);
+  CGF.EmitBlock(FoundBlock);
+  Builder.CreateStore(Builder.CreateAdd(Index, llvm::ConstantInt::get(IndexType, 1)),
+                      Result);
+  CGF.EmitBranch(LoopEnd);
+  CGF.EmitBlock(ContinueBlock);
+  Builder.CreateStore(Builder.CreateAdd(Counted, llvm::ConstantInt::get(IndexType, 1)),
+                      Counter);
+  CGF.EmitBranch(LoopCond);
+  CGF.EmitBlock(LoopEnd);
+  return Builder.CreateLoad(Result);
+}
+
+RValueTy ArrayLocationEmitter::Emit() {
+  ArrayOperation OP;
+  StandaloneArrayValueSectionGatherer Gatherer(CGF, OP);
+  Gatherer.EmitExpr(Array);
+  EmitArguments(OP);
+  auto Source = Gatherer.getResult();
+
+  auto Target = Value? OP.getScalarValue(Value) :
+                       getExtremumReduction().EmitReduction(OP, Source);
+  ArrayLoopEmitter Looper(CGF);
+  auto Result = EmitDimensionSearch(OP, Looper, Target, EmitBack(OP),
+                                    Source.Dimensions[0], 0);
+  OP.FreeTemporaries(CGF);
+  return CGF.EmitScalarToScalarConversion(Result, CGF.getContext().IntegerTy);
+}
+
+RValueTy ArrayLocationEmitter::EmitResultElement(ArrayOperation &Op, ArrayLoopEmitter &Looper,
+                                                 const IntrinsicCallExpr *E) {
+  assert(ArrayReductionEmitter::isArrayReduction(E));
+  auto Dim = ArrayReductionEmitter::getReducedDimension(CGF.getContext(), E);
+  auto Rank = Array->getType()->asArrayType()->getDimensionCount();
+
+  auto Target = Value? Op.getScalarValue(Value) :
+                       getExtremumReduction().EmitResultElement(Op, Looper, E);
+  ArrayLoopEmitter Search(CGF);
+  for(size_t I = 0, J = 0; I < Rank; ++I) {
+    if(I != Dim)
+      Search.setElement(I, Looper.getElement(J++));
+  }
+  auto Result = EmitDimensionSearch(Op, Search, Target, EmitBack(Op),
+                                    Op.getReducedDimension(E), Dim);
+  return CGF.EmitScalarToScalarConversion(Result, CGF.getContext().IntegerTy);
+}
+
+llvm::Value *ArrayLocationEmitter::EmitLocationArray(SmallVectorImpl<ArrayDimensionValueTy> &Dims) {
+  ArrayOperation OP;
+  StandaloneArrayValueSectionGatherer Gatherer(CGF, OP);
+  Gatherer.EmitExpr(Array);
+  EmitArguments(OP);
+  auto Source = Gatherer.getResult();
+  auto Rank = Source.Dimensions.size();
+
+  // The result has a constant size, so it doesn't need the heap.
+  auto IndexType = CGF.getModule().SizeTy;
+  auto ResultType = CGF.ConvertTypeForMem(CGF.getContext().IntegerTy);
+  auto Temp = CGF.CreateTempAlloca(llvm::ArrayType::get(ResultType, Rank), "location");
+  auto Ptr = Builder.CreateConstInBoundsGEP2_32(Temp->getType()->getArrayElementType(),
+                                                Temp, 0, 0);
+  for(size_t I = 0; I < Rank; ++I)
+    Builder.CreateStore(llvm::ConstantInt::get(ResultType, 0),
+                        Builder.CreateConstInBoundsGEP1_64(Ptr, I));
+
+  auto Target = Value? OP.getScalarValue(Value) :
+                       getExtremumReduction().EmitReduction(OP, Source);
+  auto BackValue = EmitBack(OP);
+
+  auto FoundBlock = CGF.createBasicBlock("location-found");
+  auto ContinueBlock = CGF.createBasicBlock("location-continue");
+  auto EndBlock = CGF.createBasicBlock("location-end");
+  ArrayLoopEmitter Looper(CGF);
+  Looper.EmitArrayIterationBegin(Source);
+  ArrayLoopEmitter Element(CGF);
+  SmallVector<llvm::Value*, 8> Indices;
+  for(size_t I = 0; I < Rank; ++I) {
+    Indices.push_back(EmitIndex(BackValue, Looper.getElement(I),
+                                CGF.EmitDimSize(Source.Dimensions[I])));
+    Element.setElement(I, Indices.back());
+  }
+  Builder.CreateCondBr(EmitIsFound(OP, Element, Target), FoundBlock, ContinueBlock);
+  CGF.EmitBlock(FoundBlock);
+  for(size_t I = 0; I < Rank; ++I)
+    Builder.CreateStore(Builder.CreateZExtOrTrunc(Builder.CreateAdd(Indices[I],
+                          llvm::ConstantInt::get(IndexType, 1)), ResultType),
+                        Builder.CreateConstInBoundsGEP1_64(Ptr, I));
+  CGF.EmitBranch(EndBlock);
+  CGF.EmitBlock(ContinueBlock);
+  Looper.EmitArrayIterationEnd();
+  CGF.EmitBranch(EndBlock);
+  CGF.EmitBlock(EndBlock);
+  OP.FreeTemporaries(CGF);
+
+  Dims.push_back(ArrayDimensionValueTy(nullptr, llvm::ConstantInt::get(IndexType, Rank)));
+  return Ptr;
+}
+
+//
+// Array views.
+//
+
+ArrayViewEmitter::ArrayViewEmitter(CodeGenFunction &cgf,
+                                   const IntrinsicCallExpr *e)
+  : CGF(cgf), Builder(cgf.getBuilder()), E(e),
+    Func(intrinsic::getGenericFunctionKind(e->getIntrinsicFunction())),
+    Source(e->getArguments()[0]) {
+}
+
+bool ArrayViewEmitter::isView(const IntrinsicCallExpr *E) {
+  using namespace intrinsic;
+  switch(getGenericFunctionKind(E->getIntrinsicFunction())) {
+  case TRANSPOSE: case RESHAPE: case SPREAD:
+  case CSHIFT: case EOSHIFT:
+    return true;
+  default:
+    return false;
+  }
+}
+
+unsigned ArrayViewEmitter::getSpreadDimension(const ASTContext &C,
+                                              const IntrinsicCallExpr *E) {
+  int64_t Dim;
+  if(!E->getArguments()[1]->EvaluateAsInt(Dim, C))
+    llvm_unreachable("the spread dimension must be constant");
+  return unsigned(Dim - 1);
+}
+
+bool ArrayViewEmitter::isShift(const IntrinsicCallExpr *E) {
+  using namespace intrinsic;
+  switch(getGenericFunctionKind(E->getIntrinsicFunction())) {
+  case CSHIFT: case EOSHIFT:
+    return true;
+  default:
+    return false;
+  }
+}
+
+unsigned ArrayViewEmitter::getShiftDimension(const ASTContext &C,
+                                             const IntrinsicCallExpr *E) {
+  auto Args = E->getArguments();
+  size_t DimArg = intrinsic::getGenericFunctionKind(E->getIntrinsicFunction()) ==
+                    intrinsic::CSHIFT? 2 : 3;
+  if(Args.size() <= DimArg)
+    return 0;
+  int64_t Dim;
+  if(!Args[DimArg]->EvaluateAsInt(Dim, C))
+    llvm_unreachable("the shift dimension must be constant");
+  return unsigned(Dim - 1);
+}
+
+const Expr *ArrayViewEmitter::getBoundary(const IntrinsicCallExpr *E) {
+  auto Args = E->getArguments();
+  if(intrinsic::getGenericFunctionKind(E->getIntrinsicFunction()) == intrinsic::EOSHIFT &&
+     Args.size() >= 3)
+    return Args[2];
+  return nullptr;
+}
+
+llvm::Value *ArrayViewEmitter::EmitShiftOffset(ArrayRef<ArrayDimensionValueTy> SourceDims) {
+  auto Shift = CGF.EmitSizeIntExpr(E->getArguments()[1]);
+  if(Func != intrinsic::CSHIFT)
+    return Shift;
+  // The circular shift is reduced to (-N, N), so that the
+  // shifted index wraps around at most once.
+  auto Size = CGF.EmitDimSize(SourceDims[getShiftDimension(CGF.getContext(), E)]);
+  auto Zero = llvm::ConstantInt::get(Size->getType(), 0);
+  auto One = llvm::ConstantInt::get(Size->getType(), 1);
+  Size = Builder.CreateSelect(Builder.CreateICmpEQ(Size, Zero), One, Size);
+  return Builder.CreateSRem(Shift, Size);
+}
+
+void ArrayViewEmitter::EmitDimensions(ArrayRef<ArrayDimensionValueTy> SourceDims,
+                                      SmallVectorImpl<ArrayDimensionValueTy> &Dims) {
+  using namespace intrinsic;
+
+  switch(Func) {
+  case TRANSPOSE:
+    Dims.push_back(SourceDims[1]);
+    Dims.push_back(SourceDims[0]);
+    break;
+  case RESHAPE:
+    CGF.GetArrayDimensionsInfo(E->getType(), Dims);
+    break;
+  case SPREAD: {
+    // The extent of the added dimension is MAX(NCOPIES, 0),
+    // so that a negative number of copies gives an empty array.
+    auto Dim = getSpreadDimension(CGF.getContext(), E);
+    auto Spec = cast<ExplicitShapeSpec>(E->getType()->asArrayType()->getDimensions()[Dim]);
+    auto Copies = CGF.EmitSizeIntExpr(Spec->getUpperBound());
+    Dims.append(SourceDims.begin(), SourceDims.end());
+    Dims.insert(Dims.begin() + Dim, ArrayDimensionValueTy(nullptr, Copies));
+    break;
+  }
+  case CSHIFT: case EOSHIFT:
+    Dims.append(SourceDims.begin(), SourceDims.end());
     break;
+  default:
+    llvm_unreachable("invalid array view");
   }
+}
 
-  return RValueTy();
+RValueTy ArrayViewEmitter::EmitElement(ArrayOperation &Op, ArrayLoopEmitter &Looper) {
+  using namespace intrinsic;
+
+  // The source is evaluated using the indices of its
+  // element which is used for the current element of the view.
+  ArrayLoopEmitter SourceLooper(CGF);
+  switch(Func) {
+  case TRANSPOSE:
+    SourceLooper.setElement(0, Looper.getElement(1));
+    SourceLooper.setElement(1, Looper.getElement(0));
+    break;
+  case SPREAD: {
+    auto Dim = getSpreadDimension(CGF.getContext(), E);
+    auto Rank = E->getType()->asArrayType()->getDimensionCount();
+    for(size_t I = 0, J = 0; I < Rank; ++I) {
+      if(I != Dim)
+        SourceLooper.setElement(J++, Looper.getElement(I));
+    }
+    break;
+  }
+  case RESHAPE: {
+    // The elements are taken in the array element order, so the index
+    // of the element in the view is linearized and then split using
+    // the extents of the source.
+    auto ViewDims = Op.getArrayValue(E).Dimensions;
+    auto Index = Looper.getElement(0);
+    llvm::Value *Size = nullptr;
+    for(size_t I = 1; I < ViewDims.size(); ++I) {
+      auto DimSize = CGF.EmitDimSize(ViewDims[I - 1]);
+      Size = Size? Builder.CreateMul(Size, DimSize) : DimSize;
+      Index = Builder.CreateAdd(Index, Builder.CreateMul(Looper.getElement(I), Size));
+    }
+    auto SourceDims = Op.getArrayValue(Op.getViewSource(E)).Dimensions;
+    for(size_t I = 0; I < SourceDims.size() - 1; ++I) {
+      auto DimSize = CGF.EmitDimSize(SourceDims[I]);
+      SourceLooper.setElement(I, Builder.CreateURem(Index, DimSize));
+      Index = Builder.CreateUDiv(Index, DimSize);
+    }
+    SourceLooper.setElement(SourceDims.size() - 1, Index);
+    break;
+  }
+  case CSHIFT: case EOSHIFT:
+    return EmitShiftElement(Op, Looper, SourceLooper);
+  default:
+    llvm_unreachable("invalid array view");
+  }
+  return ArrayOperationEmitter(CGF, Op, SourceLooper).Emit(Source);
+}
+
+RValueTy ArrayViewEmitter::EmitShiftElement(ArrayOperation &Op, ArrayLoopEmitter &Looper,
+                                            ArrayLoopEmitter &SourceLooper) {
+  auto Dim = getShiftDimension(CGF.getContext(), E);
+  auto Rank = E->getType()->asArrayType()->getDimensionCount();
+  for(size_t I = 0; I < Rank; ++I)
+    SourceLooper.setElement(I, Looper.getElement(I));
+  auto Index = Builder.CreateAdd(Looper.getElement(Dim), Op.getShiftOffset(E));
+
+  // The loop over the interior of the shifted dimension
+  // doesn't need any wraparound or boundary checks.
+  if(Op.isInteriorShift(E)) {
+    SourceLooper.setElement(Dim, Index);
+    return ArrayOperationEmitter(CGF, Op, SourceLooper).Emit(Source);
+  }
+
+  auto SourceDims = Op.getArrayValue(Op.getViewSource(E)).Dimensions;
+  auto Size = CGF.EmitDimSize(SourceDims[Dim]);
+  auto Zero = llvm::ConstantInt::get(Size->getType(), 0);
+  if(Func == intrinsic::CSHIFT) {
+    Index = Builder.CreateSelect(Builder.CreateICmpSLT(Index, Zero),
+                                 Builder.CreateAdd(Index, Size), Index);
+    Index = Builder.CreateSelect(Builder.CreateICmpSGE(Index, Size),
+                                 Builder.CreateSub(Index, Size), Index);
+    SourceLooper.setElement(Dim, Index);
+    return ArrayOperationEmitter(CGF, Op, SourceLooper).Emit(Source);
+  }
+
+  // The elements which are shifted in from outside of the
+  // source are replaced by the boundary. The index is clamped
+  // so that the source is never read out of bounds.
+  auto Inside = Builder.CreateAnd(Builder.CreateICmpSGE(Index, Zero),
+                                  Builder.CreateICmpSLT(Index, Size));
+  SourceLooper.setElement(Dim, Builder.CreateSelect(Inside, Index, Zero));
+  auto Value = ArrayOperationEmitter(CGF, Op, SourceLooper).Emit(Source);
+  auto Boundary = GetBoundaryValue(Op);
+  if(E->getType()->asArrayType()->getElementType()->isLogicalType())
+    return Builder.CreateSelect(Inside, EmitLogicalElement(CGF, Value),
+                                EmitLogicalElement(CGF, Boundary));
+  return EmitSelect(Builder, Inside, Value, Boundary);
+}
+
+RValueTy ArrayViewEmitter::GetBoundaryValue(ArrayOperation &Op) {
+  if(auto Boundary = getBoundary(E))
+    return Op.getScalarValue(Boundary);
+  auto ElementType = E->getType()->asArrayType()->getElementType();
+  if(ElementType->isLogicalType())
+    return Builder.getFalse();
+  if(ElementType->isComplexType()) {
+    auto T = CGF.getContext().getComplexTypeElementType(ElementType);
+    return ComplexValueTy(CGF.GetConstantZero(T), CGF.GetConstantZero(T));
+  }
+  assert(!ElementType->isCharacterType() &&
+         "character arrays can't be shifted");
+  return CGF.GetConstantZero(ElementType);
+}
+
+//
+// Matrix multiplication.
+//
+
+/// MatmulMaxUnrolledExtent - the largest extent of the matrices
+/// which are multiplied using fully unrolled code.
+static const uint64_t MatmulMaxUnrolledExtent = 8;
+
+/// MatmulBlockSize - the number of rows, columns and inner products
+/// in a block of the blocked matrix multiplication.
+static const uint64_t MatmulBlockSize = 64;
+
+MatmulEmitter::MatmulEmitter(CodeGenFunction &cgf, ArrayRef<Expr*> Arguments)
+  : CGF(cgf), Builder(cgf.getBuilder()), MatrixA(Arguments[0]),
+    MatrixB(Arguments[1]) {
+  auto ATy = MatrixA->getType()->asArrayType();
+  ElementType = ATy->getElementType();
+  VectorA = ATy->getDimensionCount() == 1;
+  VectorB = MatrixB->getType()->asArrayType()->getDimensionCount() == 1;
+}
+
+bool MatmulEmitter::isMatmul(const IntrinsicCallExpr *E) {
+  return intrinsic::getGenericFunctionKind(E->getIntrinsicFunction()) ==
+           intrinsic::MATMUL;
+}
+
+llvm::Value *MatmulEmitter::EmitLoopBegin(Loop &L, llvm::Value *Begin,
+                                          llvm::Value *End, const char *Name) {
+  L.Counter = CGF.CreateTempAlloca(CGF.getModule().SizeTy,
+                                   llvm::Twine(Name) + "-counter");
+  Builder.CreateStore(Begin, L.Counter);
+  L.TestBlock = CGF.createBasicBlock(Name);
+  auto BodyBlock = CGF.createBasicBlock(llvm::Twine(Name) + "-body");
+  L.EndBlock = CGF.createBasicBlock(llvm::Twine(Name) + "-end");
+  CGF.EmitBlock(L.TestBlock);
+  Builder.CreateCondBr(Builder.CreateICmpULT(Builder.CreateLoad(L.Counter), End),
+                       BodyBlock, L.EndBlock);
+  CGF.EmitBlock(BodyBlock);
+  return Builder.CreateLoad(L.Counter);
+}
+
+void MatmulEmitter::EmitLoopEnd(Loop &L, llvm::Value *Step) {
+  Builder.CreateStore(Builder.CreateAdd(Builder.CreateLoad(L.Counter), Step),
+                      L.Counter);
+  CGF.EmitBranch(L.TestBlock);
+  CGF.EmitBlock(L.EndBlock);
+}
+
+RValueTy MatmulEmitter::GetZeroValue() {
+  if(ElementType->isLogicalType())
+    return Builder.getFalse();
+  if(ElementType->isComplexType()) {
+    auto T = CGF.getContext().getComplexTypeElementType(ElementType);
+    return ComplexValueTy(CGF.GetConstantZero(T), CGF.GetConstantZero(T));
+  }
+  return CGF.GetConstantZero(ElementType);
+}
+
+RValueTy MatmulEmitter::EmitProduct(RValueTy A, RValueTy B) {
+  if(ElementType->isLogicalType())
+    return Builder.CreateAnd(EmitLogicalElement(CGF, A),
+                             EmitLogicalElement(CGF, B));
+  return CGF.EmitBinaryExpr(BinaryExpr::Multiply, A, B);
+}
+
+RValueTy MatmulEmitter::EmitSum(RValueTy X, RValueTy Y) {
+  if(ElementType->isLogicalType())
+    return Builder.CreateOr(EmitLogicalElement(CGF, X),
+                            EmitLogicalElement(CGF, Y));
+  return CGF.EmitBinaryExpr(BinaryExpr::Plus, X, Y);
+}
+
+/// Selects the element (Row, Column) of a matrix. The first matrix
+/// is treated as a single row when it's a vector, and the second one
+/// as a single column, so the vectors are only given one of the indices.
+static void SetMatrixElement(ArrayLoopEmitter &Looper, llvm::Value *Row,
+                             llvm::Value *Column) {
+  size_t I = 0;
+  if(Row)
+    Looper.setElement(I++, Row);
+  if(Column)
+    Looper.setElement(I++, Column);
+}
+
+/// Returns the end of the block which starts at the given index.
+static llvm::Value *EmitBlockEnd(CGBuilderTy &Builder, llvm::Value *Begin,
+                                 llvm::Value *End) {
+  auto BlockEnd = Builder.CreateAdd(Begin, llvm::ConstantInt::get(Begin->getType(),
+                                                                  MatmulBlockSize));
+  return Builder.CreateSelect(Builder.CreateICmpULT(BlockEnd, End), BlockEnd, End);
+}
+
+/// Evaluates the shape (N, M) x (M, K) of the multiplied matrices.
+bool MatmulEmitter::EvaluateShape(uint64_t &N, uint64_t &M, uint64_t &K) {
+  auto &Ctx = CGF.getContext();
+  auto DimsA = MatrixA->getType()->asArrayType()->getDimensions();
+  auto DimsB = MatrixB->getType()->asArrayType()->getDimensions();
+  EvaluatedArraySpec Spec;
+
+  N = K = 1;
+  if(!VectorA) {
+    if(!DimsA.front()->Evaluate(Spec, Ctx))
+      return false;
+    N = Spec.Size;
+  }
+  if(!DimsA.back()->Evaluate(Spec, Ctx))
+    return false;
+  M = Spec.Size;
+  if(!VectorB) {
+    if(!DimsB.back()->Evaluate(Spec, Ctx))
+      return false;
+    K = Spec.Size;
+  }
+  return true;
+}
+
+RValueTy MatmulEmitter::EmitResultElement(ArrayOperation &Op, ArrayLoopEmitter &Looper,
+                                          const IntrinsicCallExpr *E) {
+  auto IndexType = CGF.getModule().SizeTy;
+  size_t Dim = 0;
+  auto Row = VectorA? nullptr : Looper.getElement(Dim++);
+  auto Column = VectorB? nullptr : Looper.getElement(Dim++);
+
+  auto Acc = CGF.CreateTempAlloca(CGF.ConvertTypeForMem(ElementType),
+                                  "matmul-accumulator");
+  CGF.EmitStore(GetZeroValue(), Acc, ElementType);
+  Loop InnerLoop;
+  auto Index = EmitLoopBegin(InnerLoop, llvm::ConstantInt::get(IndexType, 0),
+                             CGF.EmitDimSize(Op.getReducedDimension(E)),
+                             "matmul-inner-loop");
+  ArrayLoopEmitter LooperA(CGF), LooperB(CGF);
+  SetMatrixElement(LooperA, Row, Index);
+  SetMatrixElement(LooperB, Index, Column);
+  ArrayOperationEmitter EVA(CGF, Op, LooperA);
+  ArrayOperationEmitter EVB(CGF, Op, LooperB);
+  CGF.EmitStore(EmitSum(CGF.EmitLoad(Acc, ElementType),
+                        EmitProduct(EVA.Emit(MatrixA), EVB.Emit(MatrixB))),
+                Acc, ElementType);
+  EmitLoopEnd(InnerLoop, llvm::ConstantInt::get(IndexType, 1));
+  return CGF.EmitLoad(Acc, ElementType);
+}
+
+/// Multiplies the small matrices with a constant shape without any loops.
+/// All the elements are loaded before the result is stored, so the
+/// destination can share memory with the matrices.
+void MatmulEmitter::EmitUnrolled(ArrayOperation &Op, const ArrayValueRef &Dest,
+                                 uint64_t N, uint64_t M, uint64_t K) {
+  auto IndexType = CGF.getModule().SizeTy;
+  SmallVector<RValueTy, 64> ValuesA, ValuesB;
+
+  ArrayLoopEmitter LooperA(CGF);
+  ArrayOperationEmitter EVA(CGF, Op, LooperA);
+  for(uint64_t L = 0; L < M; ++L) {
+    for(uint64_t I = 0; I < N; ++I) {
+      SetMatrixElement(LooperA, VectorA? nullptr : llvm::ConstantInt::get(IndexType, I),
+                       llvm::ConstantInt::get(IndexType, L));
+      ValuesA.push_back(EVA.Emit(MatrixA));
+    }
+  }
+  ArrayLoopEmitter LooperB(CGF);
+  ArrayOperationEmitter EVB(CGF, Op, LooperB);
+  for(uint64_t J = 0; J < K; ++J) {
+    for(uint64_t L = 0; L < M; ++L) {
+      SetMatrixElement(LooperB, llvm::ConstantInt::get(IndexType, L),
+                       VectorB? nullptr : llvm::ConstantInt::get(IndexType, J));
+      ValuesB.push_back(EVB.Emit(MatrixB));
+    }
+  }
+
+  SmallVector<RValueTy, 64> Results;
+  for(uint64_t J = 0; J < K; ++J) {
+    for(uint64_t I = 0; I < N; ++I) {
+      if(!M) {
+        Results.push_back(GetZeroValue());
+        continue;
+      }
+      auto Acc = EmitProduct(ValuesA[I], ValuesB[J * M]);
+      for(uint64_t L = 1; L < M; ++L)
+        Acc = EmitSum(Acc, EmitProduct(ValuesA[I + L * N], ValuesB[L + J * M]));
+      Results.push_back(Acc);
+    }
+  }
+
+  ArrayLoopEmitter LooperC(CGF);
+  for(uint64_t J = 0; J < K; ++J) {
+    for(uint64_t I = 0; I < N; ++I) {
+      SetMatrixElement(LooperC, VectorA? nullptr : llvm::ConstantInt::get(IndexType, I),
+                       VectorB? nullptr : llvm::ConstantInt::get(IndexType, J));
+      CGF.EmitStore(Results[I + J * N], LooperC.EmitElementPointer(Dest), ElementType);
+    }
+  }
+}
+
+/// Multiplies the matrices using C(i,j) += A(i,l) * B(l,j). The loops
+/// over the columns, the inner products and the rows are split into
+/// blocks, so that a block of the first matrix stays in the cache while
+/// it's used for all the columns of a block of the second matrix. The
+/// innermost loop goes down the columns of the first matrix and the result.
+void MatmulEmitter::EmitBlocked(ArrayOperation &Op, const ArrayValueRef &Dest) {
+  auto IndexType = CGF.getModule().SizeTy;
+  auto Zero = llvm::ConstantInt::get(IndexType, 0);
+  auto One = llvm::ConstantInt::get(IndexType, 1);
+  auto BlockSize = llvm::ConstantInt::get(IndexType, MatmulBlockSize);
+  auto A = Op.getArrayValue(MatrixA);
+  auto N = VectorA? One : CGF.EmitDimSize(A.Dimensions.front());
+  auto M = CGF.EmitDimSize(A.Dimensions.back());
+  auto K = VectorB? One : CGF.EmitDimSize(Op.getArrayValue(MatrixB).Dimensions.back());
+
+  ArrayLoopEmitter Looper(CGF);
+  Looper.EmitArrayIterationBegin(Dest);
+  CGF.EmitStore(GetZeroValue(), Looper.EmitElementPointer(Dest), ElementType);
+  Looper.EmitArrayIterationEnd();
+
+  Loop ColumnBlock, InnerBlock, RowBlock, ColumnLoop, InnerLoop, RowLoop;
+  auto JJ = EmitLoopBegin(ColumnBlock, Zero, K, "matmul-column-block");
+  auto LL = EmitLoopBegin(InnerBlock, Zero, M, "matmul-inner-block");
+  auto II = EmitLoopBegin(RowBlock, Zero, N, "matmul-row-block");
+  auto J = EmitLoopBegin(ColumnLoop, JJ, EmitBlockEnd(Builder, JJ, K),
+                         "matmul-column-loop");
+  auto L = EmitLoopBegin(InnerLoop, LL, EmitBlockEnd(Builder, LL, M),
+                         "matmul-inner-loop");
+
+  // B(l,j) doesn't change in the innermost loop.
+  ArrayLoopEmitter LooperB(CGF);
+  SetMatrixElement(LooperB, L, VectorB? nullptr : J);
+  ArrayOperationEmitter EVB(CGF, Op, LooperB);
+  auto ValueB = EVB.Emit(MatrixB);
+
+  auto I = EmitLoopBegin(RowLoop, II, EmitBlockEnd(Builder, II, N),
+                         "matmul-row-loop");
+  ArrayLoopEmitter LooperA(CGF), LooperC(CGF);
+  SetMatrixElement(LooperA, VectorA? nullptr : I, L);
+  SetMatrixElement(LooperC, VectorA? nullptr : I, VectorB? nullptr : J);
+  ArrayOperationEmitter EVA(CGF, Op, LooperA);
+  auto Ptr = LooperC.EmitElementPointer(Dest);
+  CGF.EmitStore(EmitSum(CGF.EmitLoad(Ptr, ElementType),
+                        EmitProduct(EVA.Emit(MatrixA), ValueB)),
+                Ptr, ElementType);
+
+  EmitLoopEnd(RowLoop, One);
+  EmitLoopEnd(InnerLoop, One);
+  EmitLoopEnd(ColumnLoop, One);
+  EmitLoopEnd(RowBlock, BlockSize);
+  EmitLoopEnd(InnerBlock, BlockSize);
+  EmitLoopEnd(ColumnBlock, BlockSize);
+}
+
+/// Multiplies the REAL matrices whose columns are contiguous using the
+/// packed matrix multiplication of the runtime library. Returns false
+/// when the matrices have to be multiplied by the inline code.
+bool MatmulEmitter::EmitRuntimeCall(ArrayOperation &Op, const ArrayValueRef &Dest) {
+  if(!ElementType->isRealType() || isa<ArrayConstructorExpr>(MatrixA) ||
+     isa<ArrayConstructorExpr>(MatrixB))
+    return false;
+  auto ValueType = CGF.ConvertTypeForMem(ElementType);
+  if(!ValueType->isFloatTy() && !ValueType->isDoubleTy())
+    return false;
+  auto A = Op.getArrayValue(MatrixA);
+  auto B = Op.getArrayValue(MatrixB);
+  if(A.Dimensions.front().hasStride() || B.Dimensions.front().hasStride() ||
+     Dest.Dimensions.front().hasStride())
+    return false;
+
+  // A row vector is a matrix whose columns have one element,
+  // and the distance between the columns of a column vector
+  // doesn't matter.
+  auto IndexType = CGF.getModule().SizeTy;
+  auto One = llvm::ConstantInt::get(IndexType, 1);
+  auto N = VectorA? One : CGF.EmitDimSize(A.Dimensions.front());
+  auto M = CGF.EmitDimSize(A.Dimensions.back());
+  auto K = VectorB? One : CGF.EmitDimSize(B.Dimensions.back());
+  auto LDA = VectorA? One : A.Dimensions[1].Stride;
+  auto LDB = VectorB? M : B.Dimensions[1].Stride;
+  auto LDC = VectorA? One : VectorB? N : Dest.Dimensions[1].Stride;
+
+  auto PtrType = llvm::PointerType::get(ValueType, 0);
+  llvm::Type *ArgTypes[] = { PtrType, IndexType, PtrType, IndexType,
+                             PtrType, IndexType, IndexType, IndexType,
+                             IndexType };
+  auto Func = CGF.getModule().GetRuntimeFunction(ValueType->isFloatTy()?
+                                                   "matmul_f4" : "matmul_f8",
+                                                 ArgTypes);
+  llvm::Value *Args[] = { Builder.CreateBitCast(Dest.Ptr, PtrType), LDC,
+                          Builder.CreateBitCast(A.Ptr, PtrType), LDA,
+                          Builder.CreateBitCast(B.Ptr, PtrType), LDB,
+                          N, M, K };
+  CGF.EmitRuntimeCall(Func, Args);
+  return true;
+}
+
+/// Returns true if the elements of the given matrix
+/// can be accessed directly.
+static bool IsMatrixOperand(const Expr *E) {
+  return isa<VarExpr>(E) || isa<ArraySectionExpr>(E) ||
+         isa<ArrayConstructorExpr>(E);
+}
+
+bool MatmulEmitter::EmitAssignment(const Expr *LHS, bool MayOverlap) {
+  if(!IsMatrixOperand(MatrixA) || !IsMatrixOperand(MatrixB))
+    return false;
+
+  ArrayOperation OP;
+  OP.EmitArrayExpr(CGF, LHS);
+  OP.EmitAllScalarValuesAndArraySections(CGF, MatrixA);
+  OP.EmitAllScalarValuesAndArraySections(CGF, MatrixB);
+  auto Dest = OP.getArrayValue(LHS);
+
+  uint64_t N, M, K;
+  if(EvaluateShape(N, M, K) && N <= MatmulMaxUnrolledExtent &&
+     M <= MatmulMaxUnrolledExtent && K <= MatmulMaxUnrolledExtent) {
+    EmitUnrolled(OP, Dest, N, M, K);
+    OP.FreeTemporaries(CGF);
+    return true;
+  }
+  if(!MayOverlap) {
+    if(!EmitRuntimeCall(OP, Dest))
+      EmitBlocked(OP, Dest);
+    OP.FreeTemporaries(CGF);
+    return true;
+  }
+
+  // The result is computed in a temporary array
+  // when the destination may overlap the matrices.
+  SmallVector<ArrayDimensionValueTy, 2> TempDims;
+  llvm::Value *Stride = nullptr;
+  for(auto Dim : Dest.Dimensions) {
+    auto Size = CGF.EmitDimSize(Dim);
+    TempDims.push_back(ArrayDimensionValueTy(nullptr, Size, Stride));
+    Stride = Size;
+  }
+  auto TempPtr = CGF.CreateTempHeapArrayAlloca(LHS->getType(), Dest);
+  ArrayValueRef Temp(TempDims, TempPtr);
+  if(!EmitRuntimeCall(OP, Temp))
+    EmitBlocked(OP, Temp);
+
+  ArrayLoopEmitter Looper(CGF);
+  Looper.EmitArrayIterationBegin(Dest);
+  CGF.EmitStore(CGF.EmitLoad(Looper.EmitElementPointer(Temp), ElementType),
+                Looper.EmitElementPointer(Dest), ElementType);
+  Looper.EmitArrayIterationEnd();
+  CGF.FreeTempHeapAlloca(TempPtr);
+  OP.FreeTemporaries(CGF);
+  return true;
+}
+
+//
+// Array packing.
+//
+
+PackEmitter::PackEmitter(CodeGenFunction &cgf, const IntrinsicCallExpr *e)
+  : CGF(cgf), Builder(cgf.getBuilder()), E(e),
+    Func(intrinsic::getGenericFunctionKind(e->getIntrinsicFunction())),
+    ElementType(e->getType().getSelfOrArrayElementType()),
+    LoopBB(nullptr), EndBB(nullptr) {
+}
+
+bool PackEmitter::isPack(const IntrinsicCallExpr *E) {
+  using namespace intrinsic;
+  switch(getGenericFunctionKind(E->getIntrinsicFunction())) {
+  case PACK: case UNPACK:
+    return true;
+  default:
+    return false;
+  }
+}
+
+void PackEmitter::EmitArguments(ArrayOperation &Op) {
+  for(auto Arg : E->getArguments())
+    Op.EmitAllScalarValuesAndArraySections(CGF, Arg);
+}
+
+llvm::Value *PackEmitter::EmitMaskElement(ArrayOperation &Op, ArrayLoopEmitter &Looper) {
+  return EmitLogicalElement(CGF, ArrayOperationEmitter(CGF, Op, Looper).
+                                   Emit(E->getArguments()[1]));
+}
+
+/// Returns true if the mask is an array of default LOGICAL values,
+/// which can be read by the runtime library.
+bool PackEmitter::HasKernelMask() {
+  auto Mask = E->getArguments()[1];
+  return Mask->getType()->isArrayType() &&
+         (isa<VarExpr>(Mask) || isa<ArraySectionExpr>(Mask)) &&
+         CGF.ConvertTypeForMem(Mask->getType().getSelfOrArrayElementType()) ==
+           CGF.getModule().Int32Ty;
+}
+
+/// Returns the size of the elements when they can be
+/// moved by the runtime library, or zero.
+unsigned PackEmitter::GetKernelElementSize() {
+  if(ElementType->isCharacterType())
+    return 0;
+  auto Size = CGF.getModule().getDataLayout().getTypeAllocSize(
+                CGF.ConvertTypeForMem(ElementType));
+  return Size == 4 || Size == 8? unsigned(Size) : 0;
+}
+
+/// Returns the condition under which the given operands are contiguous,
+/// or null when they never are or when they aren't stored in memory.
+/// The null operands are ignored.
+llvm::Value *PackEmitter::EmitKernelCondition(ArrayOperation &Op,
+                                              ArrayRef<const Expr*> Operands) {
+  llvm::Value *Result = Builder.getTrue();
+  for(auto Operand : Operands) {
+    if(!Operand || !Operand->getType()->isArrayType())
+      continue;
+    if(!isa<VarExpr>(Operand) && !isa<ArraySectionExpr>(Operand))
+      return nullptr;
+    auto Contiguous = CGF.EmitArrayOperandIsContiguous(Operand,
+                                                       Op.getArrayValue(Operand));
+    if(isa<llvm::ConstantInt>(Result))
+      std::swap(Result, Contiguous);
+    Result = Builder.CreateAnd(Result, Contiguous);
+  }
+  if(auto C = dyn_cast<llvm::ConstantInt>(Result)) {
+    if(C->isZero())
+      return nullptr;
+  }
+  return Result;
+}
+
+/// Begins the call to the runtime library, which is only made when
+/// the operands are contiguous. Returns false when they never are.
+bool PackEmitter::EmitKernelBegin(llvm::Value *Contiguous) {
+  LoopBB = EndBB = nullptr;
+  if(!Contiguous)
+    return false;
+  if(isa<llvm::ConstantInt>(Contiguous))
+    return true;
+  auto KernelBB = CGF.createBasicBlock("pack-kernel");
+  LoopBB = CGF.createBasicBlock("pack-loop");
+  EndBB = CGF.createBasicBlock("pack-end");
+  Builder.CreateCondBr(Contiguous, KernelBB, LoopBB);
+  CGF.EmitBlock(KernelBB);
+  return true;
+}
+
+/// Ends the call to the runtime library, and returns true when
+/// the loop has to be emitted for the strided operands.
+bool PackEmitter::EmitKernelEnd() {
+  if(!LoopBB)
+    return false;
+  CGF.EmitBranch(EndBB);
+  CGF.EmitBlock(LoopBB);
+  return true;
+}
+
+void PackEmitter::EmitLoopEnd() {
+  if(!EndBB)
+    return;
+  CGF.EmitBranch(EndBB);
+  CGF.EmitBlock(EndBB);
+  LoopBB = EndBB = nullptr;
+}
+
+/// \brief Emits a call to the packing function of the runtime library.
+static llvm::Value *EmitPackRuntimeCall(CodeGenFunction &CGF, StringRef Name,
+                                        ArrayRef<llvm::Value*> Args,
+                                        llvm::Type *ReturnType = nullptr) {
+  SmallVector<llvm::Type*, 6> ArgTypes;
+  for(auto Arg : Args)
+    ArgTypes.push_back(Arg->getType());
+  return CGF.EmitRuntimeCall(CGF.getModule().GetRuntimeFunction(Name, ArgTypes,
+                                                                 ReturnType),
+                             Args);
+}
+
+/// \brief Returns the pointer to the elements of a default LOGICAL mask.
+static llvm::Value *GetMaskPointer(CodeGenFunction &CGF,
+                                   const ArrayValueRef &Mask) {
+  return CGF.getBuilder().CreateBitCast(Mask.Ptr,
+           llvm::PointerType::get(CGF.getModule().Int32Ty, 0));
+}
+
+llvm::Value *PackEmitter::EmitCount(ArrayOperation &Op, const ArrayValueRef &Shape) {
+  auto Zero = llvm::ConstantInt::get(CGF.getModule().SizeTy, 0);
+  const Expr *Mask = E->getArguments()[1];
+  if(!Mask->getType()->isArrayType())
+    return Builder.CreateSelect(EmitLogicalElement(CGF, Op.getScalarValue(Mask)),
+                                CGF.EmitArraySize(Shape), Zero);
+
+  auto Counter = CGF.CreateTempAlloca(CGF.getModule().SizeTy, "pack-count");
+  Builder.CreateStore(Zero, Counter);
+  bool EmitLoop = true;
+  if(HasKernelMask() && EmitKernelBegin(EmitKernelCondition(Op, Mask))) {
+    auto MaskValue = Op.getArrayValue(Mask);
+    llvm::Value *Args[] = { GetMaskPointer(CGF, MaskValue),
+                            CGF.EmitArraySize(MaskValue) };
+    Builder.CreateStore(EmitPackRuntimeCall(CGF, "pack_count", Args,
+                                            CGF.getModule().SizeTy),
+                        Counter);
+    EmitLoop = EmitKernelEnd();
+  }
+  if(EmitLoop) {
+    ArrayLoopEmitter Looper(CGF);
+    Looper.EmitArrayIterationBegin(Shape);
+    Builder.CreateStore(Builder.CreateAdd(Builder.CreateLoad(Counter),
+                          Builder.CreateZExt(EmitMaskElement(Op, Looper),
+                                             CGF.getModule().SizeTy)),
+                        Counter);
+    Looper.EmitArrayIterationEnd();
+  }
+  EmitLoopEnd();
+  return Builder.CreateLoad(Counter);
+}
+
+void PackEmitter::EmitPack(ArrayOperation &Op, const ArrayValueRef &Shape,
+                           const ArrayValueRef &Dest, const Expr *DestExpr) {
+  auto Args = E->getArguments();
+  auto Counter = CGF.CreateTempAlloca(CGF.getModule().SizeTy, "pack-counter");
+  Builder.CreateStore(llvm::ConstantInt::get(CGF.getModule().SizeTy, 0), Counter);
+
+  // The contiguous arrays are packed by the runtime library,
+  // which returns the number of the selected elements.
+  bool EmitLoop = true;
+  auto ElementSize = GetKernelElementSize();
+  const Expr *Operands[] = { DestExpr, Args[0], Args[1] };
+  if(ElementSize && HasKernelMask() &&
+     EmitKernelBegin(EmitKernelCondition(Op, Operands))) {
+    llvm::Value *CallArgs[] = {
+      Builder.CreateBitCast(Dest.Ptr, CGF.getModule().Int8PtrTy),
+      Builder.CreateBitCast(Shape.Ptr, CGF.getModule().Int8PtrTy),
+      GetMaskPointer(CGF, Op.getArrayValue(Args[1])),
+      CGF.EmitArraySize(Shape)
+    };
+    Builder.CreateStore(EmitPackRuntimeCall(CGF, ElementSize == 4? "pack_4" : "pack_8",
+                                            CallArgs, CGF.getModule().SizeTy),
+                        Counter);
+    EmitLoop = EmitKernelEnd();
+  }
+
+  // The selected elements are stored at the counter.
+  if(EmitLoop) {
+    ArrayLoopEmitter Looper(CGF);
+    Looper.EmitArrayIterationBegin(Shape);
+    auto StoreBlock = CGF.createBasicBlock("pack-store");
+    auto NextBlock = CGF.createBasicBlock("pack-next");
+    Builder.CreateCondBr(EmitMaskElement(Op, Looper), StoreBlock, NextBlock);
+    CGF.EmitBlock(StoreBlock);
+    auto Index = Builder.CreateLoad(Counter);
+    ArrayLoopEmitter DestLooper(CGF);
+    DestLooper.setElement(0, Index);
+    CGF.EmitStore(ArrayOperationEmitter(CGF, Op, Looper).Emit(Args[0]),
+                  DestLooper.EmitElementPointer(Dest), ElementType);
+    Builder.CreateStore(Builder.CreateAdd(Index,
+                          llvm::ConstantInt::get(CGF.getModule().SizeTy, 1)),
+                        Counter);
+    CGF.EmitBranch(NextBlock);
+    CGF.EmitBlock(NextBlock);
+    Looper.EmitArrayIterationEnd();
+  }
+  EmitLoopEnd();
+
+  // The rest of the result is taken from the vector.
+  if(Args.size() > 2) {
+    ArrayLoopEmitter VectorLooper(CGF);
+    VectorLooper.EmitDimensionIterationBegin(Dest, 0, Builder.CreateLoad(Counter),
+                                             CGF.EmitSectionSize(Dest, 0));
+    CGF.EmitStore(ArrayOperationEmitter(CGF, Op, VectorLooper).Emit(Args[2]),
+                  VectorLooper.EmitElementPointer(Dest), ElementType);
+    VectorLooper.EmitArrayIterationEnd();
+  }
+}
+
+void PackEmitter::EmitUnpack(ArrayOperation &Op, const ArrayValueRef &Shape,
+                             const ArrayValueRef &Dest, const Expr *DestExpr) {
+  auto Args = E->getArguments();
+
+  // The contiguous arrays are unpacked by the runtime library. A scalar
+  // field is passed in memory, with a zero distance between its elements.
+  auto ElementSize = GetKernelElementSize();
+  const Expr *Operands[] = { DestExpr, Args[0], Args[1], Args[2] };
+  if(ElementSize && HasKernelMask() &&
+     EmitKernelBegin(EmitKernelCondition(Op, Operands))) {
+    auto &CGM = CGF.getModule();
+    llvm::Value *Field;
+    uint64_t FieldStride = 1;
+    if(Args[2]->getType()->isArrayType())
+      Field = Op.getArrayValue(Args[2]).Ptr;
+    else {
+      Field = CGF.CreateTempAlloca(CGF.ConvertTypeForMem(ElementType), "unpack-field");
+      CGF.EmitStore(Op.getScalarValue(Args[2]), Field, ElementType);
+      FieldStride = 0;
+    }
+    llvm::Value *CallArgs[] = {
+      Builder.CreateBitCast(Dest.Ptr, CGM.Int8PtrTy),
+      Builder.CreateBitCast(Op.getArrayValue(Args[0]).Ptr, CGM.Int8PtrTy),
+      GetMaskPointer(CGF, Shape),
+      Builder.CreateBitCast(Field, CGM.Int8PtrTy),
+      llvm::ConstantInt::get(CGM.SizeTy, FieldStride),
+      CGF.EmitArraySize(Shape)
+    };
+    EmitPackRuntimeCall(CGF, ElementSize == 4? "unpack_4" : "unpack_8", CallArgs);
+    if(!EmitKernelEnd())
+      return;
+  }
+
+  auto Counter = CGF.CreateTempAlloca(CGF.getModule().SizeTy, "unpack-counter");
+  Builder.CreateStore(llvm::ConstantInt::get(CGF.getModule().SizeTy, 0), Counter);
+
+  // The selected elements are loaded from the vector at the
+  // counter, and the other elements are taken from the field.
+  ArrayLoopEmitter Looper(CGF);
+  Looper.EmitArrayIterationBegin(Shape);
+  auto DestPtr = Looper.EmitElementPointer(Dest);
+  auto VectorBlock = CGF.createBasicBlock("unpack-vector");
+  auto FieldBlock = CGF.createBasicBlock("unpack-field");
+  auto NextBlock = CGF.createBasicBlock("unpack-next");
+  Builder.CreateCondBr(EmitMaskElement(Op, Looper), VectorBlock, FieldBlock);
+  CGF.EmitBlock(VectorBlock);
+  auto Index = Builder.CreateLoad(Counter);
+  ArrayLoopEmitter VectorLooper(CGF);
+  VectorLooper.setElement(0, Index);
+  CGF.EmitStore(ArrayOperationEmitter(CGF, Op, VectorLooper).Emit(Args[0]),
+                DestPtr, ElementType);
+  Builder.CreateStore(Builder.CreateAdd(Index,
+                        llvm::ConstantInt::get(CGF.getModule().SizeTy, 1)),
+                      Counter);
+  CGF.EmitBranch(NextBlock);
+  CGF.EmitBlock(FieldBlock);
+  CGF.EmitStore(ArrayOperationEmitter(CGF, Op, Looper).Emit(Args[2]),
+                DestPtr, ElementType);
+  CGF.EmitBranch(NextBlock);
+  CGF.EmitBlock(NextBlock);
+  Looper.EmitArrayIterationEnd();
+  EmitLoopEnd();
+}
+
+llvm::Value *PackEmitter::EmitTemporary(SmallVectorImpl<ArrayDimensionValueTy> &Dims) {
+  auto Args = E->getArguments();
+  ArrayOperation OP;
+  EmitArguments(OP);
+
+  if(Func == intrinsic::UNPACK) {
+    auto Shape = OP.EmitArrayExpr(CGF, Args[1]);
+    llvm::Value *Stride = nullptr;
+    for(auto Dim : Shape.Dimensions) {
+      auto Size = CGF.EmitDimSize(Dim);
+      Dims.push_back(ArrayDimensionValueTy(nullptr, Size, Stride));
+      Stride = Stride? Builder.CreateMul(Stride, Size) : Size;
+    }
+    auto Ptr = CGF.CreateTempHeapArrayAlloca(E->getType(), Shape);
+    EmitUnpack(OP, Shape, ArrayValueRef(Dims, Ptr), nullptr);
+    OP.FreeTemporaries(CGF);
+    return Ptr;
+  }
+
+  // The size of the result is either given by the vector, or
+  // it's the number of the selected elements, which are counted
+  // before they are stored.
+  llvm::Value *Size = nullptr;
+  if(Args.size() > 2)
+    Size = CGF.EmitArraySize(OP.EmitArrayExpr(CGF, Args[2]));
+  auto Shape = OP.EmitArrayExpr(CGF, Args[0]);
+  if(!Size)
+    Size = EmitCount(OP, Shape);
+  Dims.push_back(ArrayDimensionValueTy(nullptr, Size));
+  auto Ptr = CGF.CreateTempHeapArrayAlloca(E->getType(), Size);
+  EmitPack(OP, Shape, ArrayValueRef(Dims, Ptr), nullptr);
+  OP.FreeTemporaries(CGF);
+  return Ptr;
+}
+
+void PackEmitter::EmitAssignment(const Expr *LHS) {
+  auto Args = E->getArguments();
+  ArrayOperation OP;
+  OP.EmitArrayExpr(CGF, LHS);
+  EmitArguments(OP);
+  auto Dest = OP.getArrayValue(LHS);
+  if(Func == intrinsic::UNPACK)
+    EmitUnpack(OP, OP.EmitArrayExpr(CGF, Args[1]), Dest, LHS);
+  else
+    EmitPack(OP, OP.EmitArrayExpr(CGF, Args[0]), Dest, LHS);
+  OP.FreeTemporaries(CGF);
 }
 
 }
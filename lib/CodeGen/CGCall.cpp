@@ -102,6 +102,12 @@ void CodeGenTypes::ConvertArgumentType(SmallVectorImpl<llvm::Type*> &ArgTypes,
     ArgTypes.push_back(GetComplexTypeAsVector(
                          ConvertType(Context.getComplexTypeElementType(T))));
     break;
+
+  case ABIArgInfo::ArrayDescriptor:
+    assert(T->isArrayType());
+    ArgTypes.push_back(llvm::PointerType::get(
+                         GetArrayDescriptorType(T->asArrayType()), 0));
+    break;
   }
 }
 
@@ -190,6 +196,7 @@ RValueTy CodeGenFunction::EmitCall(llvm::Value *Callee,
   auto  Result = Builder.CreateCall(Callee,
                                     ArgList.createValues());
   Result->setCallingConv(FuncInfo->getCallingConv());
+  EmitArrayArgumentWritebacks(ArgList);
 
   if(ReturnsNothing ||
      RetABIKind == ABIRetInfo::Nothing)
@@ -244,13 +251,41 @@ RValueTy CodeGenFunction::EmitCall(CGFunction Func,
   return Result;
 }
 
+RValueTy CodeGenFunction::EmitElementalCall(const FunctionDecl *Function,
+                                            ArrayRef<RValueTy> Arguments) {
+  auto CGFunc = CGM.GetFunction(Function);
+  auto Callee = CGFunc.getFunction();
+  auto FuncInfo = CGFunc.getInfo();
+  auto ArgumentInfo = FuncInfo->getArguments();
+  auto FuncArgs = Function->getArguments();
+
+  CallArgList ArgList;
+  for(size_t I = 0; I < Arguments.size(); ++I) {
+    if(Arguments[I].isCharacter()) {
+      EmitCallArg(ArgList, Arguments[I].asCharacter(), ArgumentInfo[I]);
+      continue;
+    }
+    // The elements are passed by reference using a temporary,
+    // which can't be modified by the pure function.
+    assert(ArgumentInfo[I].ABIInfo.getKind() == ABIArgInfo::Reference);
+    auto T = FuncArgs[I]->getType();
+    auto Temp = CreateTempAlloca(ConvertTypeForMem(T), "elemental-arg");
+    EmitStore(Arguments[I], LValueTy(Temp), T);
+    auto ParamType = Callee->getFunctionType()->getParamType(ArgList.getOffset());
+    ArgList.add(Temp->getType() != ParamType?
+                  Builder.CreatePointerCast(Temp, ParamType) : Temp);
+  }
+  return EmitCall(Callee, FuncInfo, ArgList);
+}
+
 void CodeGenFunction::EmitCallArg(llvm::Type *T, CallArgList &Args,
                                   const Expr *E, CGFunctionInfo::ArgInfo ArgInfo) {
   EmitCallArg(Args, E, ArgInfo);
 
   // NB: cast pointer types when different argument types are used in source code
   // for the same function.
-  if(ArgInfo.ABIInfo.getKind() == ABIArgInfo::Reference) {
+  if(ArgInfo.ABIInfo.getKind() == ABIArgInfo::Reference ||
+     ArgInfo.ABIInfo.getKind() == ABIArgInfo::ArrayDescriptor) {
     auto Ptr = Args.getLast();
     if(Ptr->getType() != T)
       Args.setLast(Builder.CreatePointerCast(Ptr, T));
@@ -289,7 +324,14 @@ void CodeGenFunction::EmitArrayCallArg(CallArgList &Args,
                                        const Expr *E, CGFunctionInfo::ArgInfo ArgInfo) {
   switch(ArgInfo.ABIInfo.getKind()) {
   case ABIArgInfo::Reference:
-    Args.add(EmitArrayArgumentPointerValueABI(E));
+    if(auto Pack = dyn_cast<ImplicitArrayPackExpr>(E))
+      Args.add(EmitArrayArgumentPackABI(Args, Pack));
+    else
+      Args.add(EmitArrayArgumentPointerValueABI(E));
+    break;
+
+  case ABIArgInfo::ArrayDescriptor:
+    Args.add(EmitArrayArgumentDescriptorABI(E));
     break;
 
   default:
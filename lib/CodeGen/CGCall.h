@@ -19,8 +19,26 @@ namespace flang   {
 namespace CodeGen {
 
 class CallArgList {
+public:
+  /// ArrayWriteback - a strided array argument which is packed
+  /// into a contiguous temporary array when it isn't contiguous
+  /// at runtime. The temporary is unpacked and freed after the call.
+  struct ArrayWriteback {
+    SmallVector<ArrayDimensionValueTy, 8> Dimensions;
+    llvm::Value *Ptr;
+    llvm::Value *Temp;
+    llvm::Value *IsContiguous;
+    QualType ElementType;
+    bool Unpack;
+
+    ArrayValueRef getSection() const {
+      return ArrayValueRef(Dimensions, Ptr);
+    }
+  };
+private:
   SmallVector<llvm::Value*, 16> Values;
   SmallVector<llvm::Value*, 4>  AdditionalValues;
+  SmallVector<ArrayWriteback, 2> Writebacks;
   RValueTy ReturnValue;
 public:
 
@@ -48,6 +66,14 @@ public:
     return ReturnValue;
   }
 
+  void addWriteback(const ArrayWriteback &Writeback) {
+    Writebacks.push_back(Writeback);
+  }
+
+  ArrayRef<ArrayWriteback> getWritebacks() const {
+    return Writebacks;
+  }
+
   ArrayRef<llvm::Value*> createValues() {
     for(auto I : AdditionalValues)
       Values.push_back(I);
@@ -55,12 +55,38 @@ void CodeGenFunction::EmitVarDecl(const VarDecl *D) {
 
   llvm::Value *Ptr;
   auto Type = D->getType();
+  if(Type->isArrayType() && Type->asArrayType()->isAllocatable()) {
+    EmitAllocatableArray(D);
+    return;
+  }
   if(Type.hasAttributeSpec(Qualifiers::AS_save) && !IsMainProgram) {
-    Ptr = CGM.EmitGlobalVariable(CurFn->getName(), D);
-    HasSavedVariables = true;
+    auto Init = D->hasInit()? EmitStaticVarInitializer(D) : nullptr;
+    Ptr = CGM.EmitGlobalVariable(GetSavedVariablePrefix(), D, Init);
+    if(Init)
+      StaticallyInitializedVars.insert(D);
+    else if(D->hasInit())
+      HasSavedVarInitializers = true;
+  } else if(IsMainProgram && Type->isArrayType() && D->hasInit()) {
+    // The main program is only entered once, so the constant
+    // tables can be placed in the data section.
+    if(auto Init = EmitStaticVarInitializer(D)) {
+      Ptr = CGM.EmitGlobalVariable(GetSavedVariablePrefix(), D, Init);
+      StaticallyInitializedVars.insert(D);
+    } else {
+      Ptr = CreateArrayAlloca(Type, D->getName());
+      if(!Ptr) {
+        AutomaticArrays.push_back(D);
+        return;
+      }
+    }
   } else {
-    if(Type->isArrayType())
+    if(Type->isArrayType()) {
       Ptr = CreateArrayAlloca(Type, D->getName());
+      if(!Ptr) {
+        AutomaticArrays.push_back(D);
+        return;
+      }
+    }
     else Ptr = Builder.CreateAlloca(ConvertTypeForMem(Type),
                                     nullptr, D->getName());
   }
@@ -96,15 +122,69 @@ void CodeGenFunction::EmitSavedVarInitializers(const DeclContext *DC) {
   DV.Visit(DC);
 }
 
+/// \brief Returns the initializer of the given variable folded to
+/// a constant of the variable's memory type, or null when the
+/// initializer has to be evaluated at run time.
+llvm::Constant *CodeGenFunction::EmitStaticVarInitializer(const VarDecl *D) {
+  auto T = D->getType();
+  auto ElementType = T.getSelfOrArrayElementType();
+  if(ElementType->isCharacterType() || ElementType->isRecordType())
+    return nullptr;
+  auto MemTy = ConvertTypeForMem(T);
+  if(!T->isArrayType())
+    return EmitStaticScalarInitializer(D->getInit(), ElementType, MemTy);
+
+  auto ArrTy = cast<llvm::ArrayType>(MemTy);
+  auto Items = cast<ArrayConstructorExpr>(D->getInit())->getItems();
+  if(Items.size() != ArrTy->getNumElements())
+    return nullptr;
+  SmallVector<llvm::Constant*, 32> Values(Items.size());
+  for(size_t I = 0; I < Items.size(); ++I) {
+    // The elements which aren't initialized by a DATA statement are zero.
+    if(!Items[I]) {
+      Values[I] = llvm::Constant::getNullValue(ArrTy->getElementType());
+      continue;
+    }
+    Values[I] = EmitStaticScalarInitializer(Items[I], ElementType,
+                                            ArrTy->getElementType());
+    if(!Values[I])
+      return nullptr;
+  }
+  return llvm::ConstantArray::get(ArrTy, Values);
+}
+
+llvm::Constant *CodeGenFunction::EmitStaticScalarInitializer(const Expr *E, QualType T,
+                                                             llvm::Type *MemTy) {
+  if(!E->isEvaluatable(getContext()))
+    return nullptr;
+  llvm::Value *Val = EmitConstantExpr(E);
+  if(Val->getType() == CGM.Int1Ty)
+    Val = ConvertLogicalValueToLogicalMemoryValue(Val, T);
+  auto Result = dyn_cast<llvm::Constant>(Val);
+  return Result && Result->getType() == MemTy? Result : nullptr;
+}
+
 void CodeGenFunction::EmitVarInitializer(const VarDecl *D) {
   assert(D->hasInit());
+  if(StaticallyInitializedVars.count(D))
+    return;
 
   auto T = D->getType();
   if(T->isArrayType()) {
+    // Copy the constant initializers from a private constant global.
+    if(auto Init = EmitStaticVarInitializer(D)) {
+      auto &DL = CGM.getDataLayout();
+      auto ETy = cast<llvm::ArrayType>(Init->getType())->getElementType();
+      Builder.CreateMemCpy(GetVarPtr(D), CGM.EmitConstantArray(Init),
+                           DL.getTypeAllocSize(Init->getType()),
+                           DL.getABITypeAlignment(ETy));
+      return;
+    }
     auto Dest = Builder.CreateConstInBoundsGEP2_32(ConvertTypeForMem(T),
                                                    GetVarPtr(D), 0, 0);
     auto Init = cast<ArrayConstructorExpr>(D->getInit())->getItems();
     for(size_t I = 0; I < Init.size(); ++I) {
+      if(!Init[I]) continue;
       auto Val = EmitRValue(Init[I]);
       EmitStoreCharSameLength(Val, Builder.CreateConstInBoundsGEP1_64(Dest, I), T.getSelfOrArrayElementType());
     }
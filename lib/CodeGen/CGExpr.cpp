@@ -21,6 +21,7 @@
 #include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/MDBuilder.h"
+#include "llvm/IR/Operator.h"
 
 namespace flang {
 namespace CodeGen {
@@ -49,8 +50,9 @@ RValueTy CodeGenFunction::EmitRValue(const Expr *E) {
 RValueTy CodeGenFunction::EmitLoad(llvm::Value *Ptr, QualType T, bool IsVolatile) {
   if(T->isComplexType())
     return EmitComplexLoad(Ptr, IsVolatile);
-  else
-    return Builder.CreateLoad(Ptr, IsVolatile);
+  auto Load = Builder.CreateLoad(Ptr, IsVolatile);
+  DecorateAccessWithTBAA(Load, T);
+  return Load;
 }
 
 void CodeGenFunction::EmitStore(RValueTy Val, LValueTy Dest, QualType T) {
@@ -60,7 +62,7 @@ void CodeGenFunction::EmitStore(RValueTy Val, LValueTy Dest, QualType T) {
     if(Val.asScalar()->getType() == CGM.Int1Ty)
       Val = ConvertLogicalValueToLogicalMemoryValue(Val.asScalar(),
                                                     T->isArrayType()? T->asArrayType()->getElementType() : T);
-    Builder.CreateStore(Val.asScalar(), Ptr, IsVolatile);
+    DecorateAccessWithTBAA(Builder.CreateStore(Val.asScalar(), Ptr, IsVolatile), T);
   } else if(Val.isComplex())
     EmitComplexStore(Val.asComplex(), Ptr, IsVolatile);
   else if(Val.isAggregate()) {
@@ -69,6 +71,48 @@ void CodeGenFunction::EmitStore(RValueTy Val, LValueTy Dest, QualType T) {
   }
 }
 
+bool CodeGenFunction::IsStorageAssociated(llvm::Value *Ptr) {
+  // Find the object which contains the accessed storage.
+  while(true) {
+    if(auto GEP = dyn_cast<llvm::GEPOperator>(Ptr))
+      Ptr = GEP->getPointerOperand();
+    else if(auto Cast = dyn_cast<llvm::BitCastOperator>(Ptr))
+      Ptr = Cast->getOperand(0);
+    else
+      break;
+  }
+
+  // COMMON blocks are global variables with common linkage, and EQUIVALENCE
+  // sets are allocated as untyped local storage. The pointers which are
+  // loaded from memory or returned by calls point to allocated arrays or
+  // to the arrays of the array descriptors, which aren't storage associated.
+  // Any other pointer may point to any storage.
+  if(auto Var = dyn_cast<llvm::GlobalVariable>(Ptr))
+    return Var->hasCommonLinkage();
+  if(isa<llvm::AllocaInst>(Ptr)) {
+    for(auto I : EquivSets) {
+      if(I.second.Ptr == Ptr)
+        return true;
+    }
+    return false;
+  }
+  if(auto Select = dyn_cast<llvm::SelectInst>(Ptr))
+    return IsStorageAssociated(Select->getTrueValue()) ||
+           IsStorageAssociated(Select->getFalseValue());
+  return !isa<llvm::Argument>(Ptr) && !isa<llvm::LoadInst>(Ptr) &&
+         !isa<llvm::CallInst>(Ptr);
+}
+
+void CodeGenFunction::DecorateAccessWithTBAA(llvm::Instruction *Access,
+                                             llvm::MDNode *TBAAInfo) {
+  if(!TBAAInfo)
+    return;
+  auto Ptr = isa<llvm::LoadInst>(Access)? cast<llvm::LoadInst>(Access)->getPointerOperand() :
+                                          cast<llvm::StoreInst>(Access)->getPointerOperand();
+  if(!IsStorageAssociated(Ptr))
+    CGM.DecorateInstructionWithTBAA(Access, TBAAInfo);
+}
+
 void CodeGenFunction::EmitStoreCharSameLength(RValueTy Val, LValueTy Dest, QualType T) {
   if(!Val.isCharacter())
     return EmitStore(Val, Dest, T);
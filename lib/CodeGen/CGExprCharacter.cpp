@@ -15,9 +15,11 @@
 #include "CodeGenModule.h"
 #include "flang/AST/ASTContext.h"
 #include "flang/AST/ExprVisitor.h"
+#include "flang/AST/StorageSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/Function.h"
+#include <algorithm>
 #include <string.h>
 
 namespace flang {
@@ -88,17 +90,67 @@ CharacterValueTy CharacterExprEmitter::VisitVarExpr(const VarExpr *E) {
   return CGF.GetCharacterValueFromPtr(CGF.GetVarPtr(VD), VD->getType());
 }
 
-// FIXME could be optimized by folding consecutive concats to one destination
+/// \brief Collects the operands of a chain of concatenations.
+static void GatherConcatOperands(const Expr *E,
+                                 SmallVectorImpl<const Expr*> &Operands) {
+  if(auto Concat = dyn_cast<BinaryExpr>(E)) {
+    if(Concat->getOperator() == BinaryExpr::Concat) {
+      GatherConcatOperands(Concat->getLHS(), Operands);
+      GatherConcatOperands(Concat->getRHS(), Operands);
+      return;
+    }
+  }
+  Operands.push_back(E);
+}
+
+static bool IsZeroLength(llvm::Value *Len) {
+  auto Const = dyn_cast<llvm::ConstantInt>(Len);
+  return Const && Const->isZero();
+}
+
+/// \brief Returns the part of the given string which starts at the
+/// given offset.
+static CharacterValueTy GetCharacterSuffix(CGBuilderTy &Builder,
+                                           CharacterValueTy Value,
+                                           llvm::Value *Offset) {
+  if(IsZeroLength(Offset))
+    return Value;
+  return CharacterValueTy(Builder.CreateGEP(Value.Ptr, Offset),
+                          Builder.CreateSub(Value.Len, Offset));
+}
+
+/// \brief Copies as much of the source string as fits into the destination
+/// and returns the number of the copied characters.
+static llvm::Value *EmitCharacterCopy(CGBuilderTy &Builder,
+                                      CharacterValueTy Dest,
+                                      CharacterValueTy Src) {
+  auto Size = Builder.CreateSelect(Builder.CreateICmpULT(Src.Len, Dest.Len),
+                                   Src.Len, Dest.Len);
+  if(!IsZeroLength(Size))
+    Builder.CreateMemMove(Dest.Ptr, Src.Ptr, Size, 1);
+  return Size;
+}
+
+/// \brief Fills the destination with blanks starting at the given offset.
+static void EmitCharacterPadding(CGBuilderTy &Builder, CharacterValueTy Dest,
+                                 llvm::Value *Offset) {
+  auto Tail = GetCharacterSuffix(Builder, Dest, Offset);
+  if(!IsZeroLength(Tail.Len))
+    Builder.CreateMemSet(Tail.Ptr, Builder.getInt8(' '), Tail.Len, 1);
+}
+
 CharacterValueTy CharacterExprEmitter::VisitBinaryExprConcat(const BinaryExpr *E) {
-  auto CharType = CGF.getContext().CharacterTy;
+  SmallVector<const Expr*, 8> Operands;
+  GatherConcatOperands(E, Operands);
+
   CharacterValueTy Dest;
   if(hasDestination()) {
     Dest = takeDestination();
   } else {
     // FIXME temp size overflow checking.
-    auto CharTyLHS = E->getLHS()->getType()->asCharacterType();
-    auto CharTyRHS = E->getRHS()->getType()->asCharacterType();
-    auto Size = CharTyLHS->getLength() + CharTyRHS->getLength();
+    uint64_t Size = 0;
+    for(auto Operand : Operands)
+      Size += Operand->getType()->asCharacterType()->getLength();
     auto Storage = CGF.CreateTempAlloca(llvm::ArrayType::get(CGF.getModule().Int8Ty, Size), "concat-result");
     Dest = CharacterValueTy(Builder.CreateConstInBoundsGEP2_32(
         llvm::ArrayType::get(CGF.getModule().Int8Ty, Size),
@@ -106,12 +158,16 @@ CharacterValueTy CharacterExprEmitter::VisitBinaryExprConcat(const BinaryExpr *E
         llvm::ConstantInt::get(CGF.getModule().SizeTy, Size));
   }
 
-  // a = b // c
-  auto Src1 = EmitExpr(E->getLHS());
-  auto Src2 = EmitExpr(E->getRHS());
-  auto Func = CGF.getModule().GetRuntimeFunction3(MANGLE_CHAR_FUNCTION("concat", CharType),
-                                                  CharType, CharType, CharType);
-  CGF.EmitCall3(Func, Dest, Src1, Src2);
+  // a = b // c // d is written piece by piece into a.
+  llvm::Value *Offset = llvm::ConstantInt::get(CGF.getModule().SizeTy, 0);
+  for(auto Operand : Operands) {
+    auto Src = EmitExpr(Operand);
+    Offset = Builder.CreateAdd(Offset,
+                               EmitCharacterCopy(Builder,
+                                                 GetCharacterSuffix(Builder, Dest, Offset),
+                                                 Src));
+  }
+  EmitCharacterPadding(Builder, Dest, Offset);
   return Dest;
 }
 
@@ -164,21 +220,57 @@ CharacterValueTy CharacterExprEmitter::VisitMemberExpr(const MemberExpr *E) {
                                       E->getType());
 }
 
+/// \brief Returns the variable whose storage is used by the given string.
+static const VarDecl *GetCharacterBaseVar(const Expr *E) {
+  if(auto Substring = dyn_cast<SubstringExpr>(E))
+    E = Substring->getTarget();
+  if(auto Element = dyn_cast<ArrayElementExpr>(E))
+    E = Element->getTarget();
+  if(auto Var = dyn_cast<VarExpr>(E))
+    return Var->getVarDecl();
+  return nullptr;
+}
+
+static bool IsEquivalenced(const VarDecl *VD) {
+  return VD->hasStorageSet() && isa<EquivalenceSet>(VD->getStorageSet());
+}
+
+/// \brief Returns true if the operands of the given concatenation
+/// may read the memory which is used by the destination string.
+static bool MayConcatReadDestination(const Expr *Dest, const Expr *Concat) {
+  auto DestVar = GetCharacterBaseVar(Dest);
+  if(!DestVar || IsEquivalenced(DestVar))
+    return true;
+  SmallVector<const Expr*, 8> Operands;
+  GatherConcatOperands(Concat, Operands);
+  for(auto Operand : Operands) {
+    if(isa<CharacterConstantExpr>(Operand))
+      continue;
+    auto Var = GetCharacterBaseVar(Operand);
+    if(!Var || Var == DestVar || IsEquivalenced(Var))
+      return true;
+  }
+  return false;
+}
+
 void CodeGenFunction::EmitCharacterAssignment(const Expr *LHS, const Expr *RHS) {
   auto Dest = EmitCharacterExpr(LHS);
   CharacterExprEmitter EV(*this);
-  EV.setDestination(Dest);
+  auto Concat = dyn_cast<BinaryExpr>(RHS);
+  bool UseDestination = !Concat || Concat->getOperator() != BinaryExpr::Concat ||
+                        !MayConcatReadDestination(LHS, RHS);
+  if(UseDestination)
+    EV.setDestination(Dest);
   auto Src = EV.EmitExpr(RHS);
 
-  if(EV.hasDestination())
+  if(!UseDestination || EV.hasDestination())
     EmitCharacterAssignment(Dest, Src);
 }
 
+/// \brief Copies the source string into the destination and pads
+/// the remaining characters with blanks. The copy may overlap.
 void CodeGenFunction::EmitCharacterAssignment(CharacterValueTy LHS, CharacterValueTy RHS) {
-  auto CharType = getContext().CharacterTy;
-  auto Func = CGM.GetRuntimeFunction2(MANGLE_CHAR_FUNCTION("assignment", CharType),
-                                      CharType, CharType);
-  EmitCall2(Func, LHS, RHS);
+  EmitCharacterPadding(Builder, LHS, EmitCharacterCopy(Builder, LHS, RHS));
 }
 
 llvm::Value *CodeGenFunction::GetCharacterTypeLength(QualType T) {
@@ -210,17 +302,76 @@ llvm::Value *CodeGenFunction::CreateCharacterAggregate(CharacterValueTy Value) {
   return Builder.CreateInsertValue(Result, Value.Len, 1, "len");
 }
 
+/// MaxInlineCompareTail - the maximum number of the trailing characters
+/// of the longer string which are compared against blanks inline.
+static const uint64_t MaxInlineCompareTail = 256;
+
+/// \brief Emits a relational comparison of two strings. The shorter string
+/// is treated as if it was padded with blanks.
 llvm::Value *CodeGenFunction::EmitCharacterRelationalExpr(BinaryExpr::Operator Op, CharacterValueTy LHS,
                                                           CharacterValueTy RHS) {
-  auto CharType = getContext().CharacterTy;
-  auto Func = CGM.GetRuntimeFunction2(MANGLE_CHAR_FUNCTION("compare", CharType),
-                                      CharType, CharType, CGM.Int32Ty);
-  auto Result = EmitCall2(Func, LHS, RHS).asScalar();
+  auto LHSLen = dyn_cast<llvm::ConstantInt>(LHS.Len);
+  auto RHSLen = dyn_cast<llvm::ConstantInt>(RHS.Len);
+  uint64_t Size = 0, TailSize = 0;
+  if(LHSLen && RHSLen) {
+    Size = std::min(LHSLen->getZExtValue(), RHSLen->getZExtValue());
+    TailSize = std::max(LHSLen->getZExtValue(), RHSLen->getZExtValue()) - Size;
+  }
+  if(!LHSLen || !RHSLen || TailSize > MaxInlineCompareTail) {
+    auto CharType = getContext().CharacterTy;
+    auto Func = CGM.GetRuntimeFunction2(MANGLE_CHAR_FUNCTION("compare", CharType),
+                                        CharType, CharType, CGM.Int32Ty);
+    auto Result = EmitCall2(Func, LHS, RHS).asScalar();
+    return ConvertComparisonResultToRelationalOp(Op, Result);
+  }
+
+  llvm::Type *MemcmpArgTypes[] = { CGM.VoidPtrTy, CGM.VoidPtrTy, CGM.SizeTy };
+  auto Memcmp = CGM.GetCFunction("memcmp", MemcmpArgTypes, CGM.Int32Ty);
+  llvm::Value *Result = nullptr;
+  if(Size) {
+    llvm::Value *Args[] = {
+      Builder.CreateBitCast(LHS.Ptr, CGM.VoidPtrTy),
+      Builder.CreateBitCast(RHS.Ptr, CGM.VoidPtrTy),
+      llvm::ConstantInt::get(CGM.SizeTy, Size)
+    };
+    Result = Builder.CreateCall(Memcmp, Args);
+  }
+  if(TailSize) {
+    // The tail of the longer string is compared against blanks.
+    bool IsLHSLonger = LHSLen->getZExtValue() > Size;
+    auto Longer = IsLHSLonger? LHS : RHS;
+    llvm::Value *Args[] = {
+      Builder.CreateBitCast(Builder.CreateGEP(Longer.Ptr,
+                                              llvm::ConstantInt::get(CGM.SizeTy, Size)),
+                            CGM.VoidPtrTy),
+      Builder.CreateGlobalStringPtr(std::string(TailSize, ' ')),
+      llvm::ConstantInt::get(CGM.SizeTy, TailSize)
+    };
+    llvm::Value *TailResult = Builder.CreateCall(Memcmp, Args);
+    if(!IsLHSLonger)
+      TailResult = Builder.CreateNeg(TailResult);
+    Result = Result? Builder.CreateSelect(Builder.CreateICmpNE(Result, Builder.getInt32(0)),
+                                          Result, TailResult) :
+                     TailResult;
+  }
+  if(!Result)
+    Result = Builder.getInt32(0);
   return ConvertComparisonResultToRelationalOp(Op, Result);
 }
 
 llvm::Value *CodeGenFunction::EmitCharacterDereference(CharacterValueTy Value) {
-  return Builder.CreateLoad(Value.Ptr);
+  auto Load = Builder.CreateLoad(Value.Ptr);
+  DecorateAccessWithTBAA(Load, getContext().CharacterTy);
+  return Load;
+}
+
+/// \brief Returns the length of the given string without
+/// the trailing blanks as a size integer.
+llvm::Value *CodeGenFunction::EmitCharacterLenTrim(CharacterValueTy Value) {
+  auto CharType = getContext().CharacterTy;
+  auto Func = CGM.GetRuntimeFunction1(MANGLE_CHAR_FUNCTION("lentrim", CharType),
+                                      CharType, CGM.SizeTy);
+  return EmitCall1(Func, Value).asScalar();
 }
 
 RValueTy CodeGenFunction::EmitIntrinsicCallCharacter(intrinsic::FunctionKind Func,
@@ -232,9 +383,7 @@ RValueTy CodeGenFunction::EmitIntrinsicCallCharacter(intrinsic::FunctionKind Fun
     return EmitSizeIntToIntConversion(Value.Len);
     break;
   case intrinsic::LEN_TRIM:
-    RuntimeFunc = CGM.GetRuntimeFunction1(MANGLE_CHAR_FUNCTION("lentrim", CharType),
-                                          CharType, CGM.SizeTy);
-    return EmitSizeIntToIntConversion(EmitCall1(RuntimeFunc, Value).asScalar());
+    return EmitSizeIntToIntConversion(EmitCharacterLenTrim(Value));
     break;
   default:
     llvm_unreachable("invalid character intrinsic");
@@ -258,14 +407,16 @@ static BinaryExpr::Operator GetLexicalComparisonOp(intrinsic::FunctionKind Func)
 
 RValueTy CodeGenFunction::EmitIntrinsicCallCharacter(intrinsic::FunctionKind Func,
                                                      CharacterValueTy A1,
-                                                     CharacterValueTy A2) {
+                                                     CharacterValueTy A2,
+                                                     llvm::Value *Back) {
   auto CharType = getContext().CharacterTy;
   CGFunction RuntimeFunc;
   switch(Func) {
   case intrinsic::INDEX: {
     RuntimeFunc = CGM.GetRuntimeFunction3(MANGLE_CHAR_FUNCTION("index", CharType),
                                           CharType, CharType, CGM.Int32Ty, CGM.SizeTy);
-    return EmitScalarToScalarConversion(EmitCall3(RuntimeFunc, A1, A2, Builder.getInt32(0)).asScalar(),
+    Back = Back? Builder.CreateZExt(Back, CGM.Int32Ty) : Builder.getInt32(0);
+    return EmitScalarToScalarConversion(EmitCall3(RuntimeFunc, A1, A2, Back).asScalar(),
                                         getContext().IntegerTy);
   }
 
@@ -68,15 +68,19 @@ ComplexValueTy CodeGenFunction::EmitComplexLoad(llvm::Value *Ptr, bool IsVolatil
   auto Im = Builder.CreateLoad(Builder.CreateStructGEP(nullptr,
                                                        Ptr,
                                                        1), IsVolatile);
+  DecorateAccessWithTBAA(Re, CGM.getTBAAComplexInfo());
+  DecorateAccessWithTBAA(Im, CGM.getTBAAComplexInfo());
   return ComplexValueTy(Re, Im);
 }
 
 void CodeGenFunction::EmitComplexStore(ComplexValueTy Value, llvm::Value *Ptr,
                                        bool IsVolatile) {
-  Builder.CreateStore(Value.Re, Builder.CreateStructGEP(nullptr,
-                                                        Ptr,0), IsVolatile);
-  Builder.CreateStore(Value.Im, Builder.CreateStructGEP(nullptr,
-                                                        Ptr,1), IsVolatile);
+  auto Re = Builder.CreateStore(Value.Re, Builder.CreateStructGEP(nullptr,
+                                                                  Ptr,0), IsVolatile);
+  auto Im = Builder.CreateStore(Value.Im, Builder.CreateStructGEP(nullptr,
+                                                                  Ptr,1), IsVolatile);
+  DecorateAccessWithTBAA(Re, CGM.getTBAAComplexInfo());
+  DecorateAccessWithTBAA(Im, CGM.getTBAAComplexInfo());
 }
 
 ComplexValueTy ComplexExprEmitter::VisitVarExpr(const VarExpr *E) {
@@ -136,8 +140,8 @@ ComplexValueTy CodeGenFunction::EmitComplexBinaryExpr(BinaryExpr::Operator Op, C
   }
 
   case BinaryExpr::Divide: {
-    // FIXME: if (not fast maths)
-    return EmitComplexDivSmiths(LHS, RHS);
+    if(CGM.getCodeGenOpts().getComplexArithmetic() != CodeGenOptions::CAK_Fast)
+      return EmitComplexDivSmiths(LHS, RHS);
 
     // (a+ib) / (c+id) = ((ac+bd)/(cc+dd)) + i((bc-ad)/(cc+dd))
     auto Tmp1 = Builder.CreateFMul(LHS.Re, RHS.Re); // a*c
@@ -146,69 +150,75 @@ ComplexValueTy CodeGenFunction::EmitComplexBinaryExpr(BinaryExpr::Operator Op, C
 
     auto Tmp4 = Builder.CreateFMul(RHS.Re, RHS.Re); // c*c
     auto Tmp5 = Builder.CreateFMul(RHS.Im, RHS.Im); // d*d
-    auto Tmp6 = Builder.CreateFAdd(Tmp4, Tmp5); // cc+dd
+    auto Tmp6 = Builder.CreateFDiv(llvm::ConstantFP::get(Tmp4->getType(), 1.0),
+                                   Builder.CreateFAdd(Tmp4, Tmp5)); // 1/(cc+dd)
 
     auto Tmp7 = Builder.CreateFMul(LHS.Im, RHS.Re); // b*c
     auto Tmp8 = Builder.CreateFMul(LHS.Re, RHS.Im); // a*d
     auto Tmp9 = Builder.CreateFSub(Tmp7, Tmp8); // bc-ad
 
-    Result.Re = Builder.CreateFDiv(Tmp3, Tmp6);
-    Result.Im = Builder.CreateFDiv(Tmp9, Tmp6);
+    Result.Re = Builder.CreateFMul(Tmp3, Tmp6);
+    Result.Im = Builder.CreateFMul(Tmp9, Tmp6);
     break;
   }
   }
   return Result;
 }
 
+/// \brief Emits the complex division using Smith's algorithm, which avoids
+/// the overflow of c*c + d*d by dividing by the larger part of the divisor.
+/// The two cases of the algorithm are chosen using selects instead of
+/// branches, so that the division can be vectorized.
 ComplexValueTy CodeGenFunction::EmitComplexDivSmiths(ComplexValueTy LHS, ComplexValueTy RHS) {
   auto ElemTy = RHS.Re->getType();
 
   // if(abs(d) <= abs(c)) then
+  //   r = d / c
+  //   den = c + d * r
+  //   e = (a + b * r) / den
+  //   f = (b - a * r) / den
+  // else
+  //   r = c / d
+  //   den = d + c * r
+  //   e = (b + a * r) / den
+  //   f = (-a + b * r) / den
   auto FabsIntrinsic = GetIntrinsicFunction(llvm::Intrinsic::fabs, ElemTy);
   auto Predicate = Builder.CreateFCmpOLE(Builder.CreateCall(FabsIntrinsic, RHS.Im),
                                          Builder.CreateCall(FabsIntrinsic, RHS.Re));
-  auto ThenBlock = createBasicBlock("compdiv-then");
-  auto ElseBlock = createBasicBlock("compdiv-else");
-  auto MergeBlock = createBasicBlock("compdiv-done");
-  Builder.CreateCondBr(Predicate, ThenBlock, ElseBlock);
-  llvm::Value *R, *Den, *E, *F;
-  auto ResultRe = llvm::PHINode::Create(ElemTy, 2, "compdiv-re");
-  auto ResultIm = llvm::PHINode::Create(ElemTy, 2, "compdiv-im");
-
-  // r = d / c
-  // den = c + d * r
-  // e = (a + b * r) / den
-  // f = (b - a * r) / den
-  EmitBlock(ThenBlock);
-  R = Builder.CreateFDiv(RHS.Im, RHS.Re);
-  Den = Builder.CreateFAdd(RHS.Re, Builder.CreateFMul(RHS.Im, R));
-  E = Builder.CreateFDiv(Builder.CreateFAdd(LHS.Re,
-                         Builder.CreateFMul(LHS.Im, R)), Den);
-  F = Builder.CreateFDiv(Builder.CreateFSub(LHS.Im,
-                         Builder.CreateFMul(LHS.Re, R)), Den);
-  ResultRe->addIncoming(E, ThenBlock);
-  ResultIm->addIncoming(F, ThenBlock);
-  EmitBranch(MergeBlock);
-
-  // r = c / d
-  // den = c * r + d
-  // e = (a * r + b) / den
-  // f = (b * r - a) / den
-  EmitBlock(ElseBlock);
-  R = Builder.CreateFDiv(RHS.Re, RHS.Im);
-  Den = Builder.CreateFAdd(Builder.CreateFMul(RHS.Re, R), RHS.Im);
-  E = Builder.CreateFDiv(Builder.CreateFAdd(
-                         Builder.CreateFMul(LHS.Re, R), LHS.Im), Den);
-  F = Builder.CreateFDiv(Builder.CreateFSub(
-                         Builder.CreateFMul(LHS.Im, R), LHS.Re), Den);
-  ResultRe->addIncoming(E, ElseBlock);
-  ResultIm->addIncoming(F, ElseBlock);
-  EmitBranch(MergeBlock);
-  EmitBlock(MergeBlock);
-  Builder.Insert(ResultRe);
-  Builder.Insert(ResultIm);
-
-  return ComplexValueTy(ResultRe, ResultIm);
+  auto Larger = Builder.CreateSelect(Predicate, RHS.Re, RHS.Im);
+  auto Smaller = Builder.CreateSelect(Predicate, RHS.Im, RHS.Re);
+  auto R = Builder.CreateFDiv(Smaller, Larger);
+  auto Den = Builder.CreateFAdd(Larger, Builder.CreateFMul(Smaller, R));
+
+  auto MinusA = Builder.CreateFNeg(LHS.Re);
+  auto E1 = Builder.CreateSelect(Predicate, LHS.Re, LHS.Im);
+  auto E2 = Builder.CreateSelect(Predicate, LHS.Im, LHS.Re);
+  auto F1 = Builder.CreateSelect(Predicate, LHS.Im, MinusA);
+  auto F2 = Builder.CreateSelect(Predicate, MinusA, LHS.Im);
+  auto E = Builder.CreateFDiv(Builder.CreateFAdd(E1, Builder.CreateFMul(E2, R)), Den);
+  auto F = Builder.CreateFDiv(Builder.CreateFAdd(F1, Builder.CreateFMul(F2, R)), Den);
+  return ComplexValueTy(E, F);
+}
+
+/// \brief Raises the value to a constant positive power using a chain of
+/// complex multiplications which squares the value for every bit of the power.
+static ComplexValueTy EmitComplexPowConstant(CodeGenFunction &CGF,
+                                             ComplexValueTy Base,
+                                             uint64_t Exponent) {
+  ComplexValueTy Result;
+  bool HasResult = false;
+  for(auto Square = Base; ; ) {
+    if(Exponent & 1) {
+      Result = HasResult? CGF.EmitComplexBinaryExpr(BinaryExpr::Multiply, Result, Square) :
+                          Square;
+      HasResult = true;
+    }
+    Exponent >>= 1;
+    if(!Exponent)
+      break;
+    Square = CGF.EmitComplexBinaryExpr(BinaryExpr::Multiply, Square, Square);
+  }
+  return Result;
 }
 
 ComplexValueTy ComplexExprEmitter::VisitBinaryExprPow(const BinaryExpr *E) {
@@ -223,11 +233,18 @@ ComplexValueTy ComplexExprEmitter::VisitBinaryExprPow(const BinaryExpr *E) {
     // (a+ib) ** n =>
     //   ( r*cos(a) + ir*sin(a) )**n =>
     //   r ** n cos(n*a) + ir ** n sin(n*a)
+    // (a+ib) ** -n => 1 / (a+ib) ** n
     if(auto ConstInt = dyn_cast<llvm::ConstantInt>(RHS)) {
-      if(ConstInt->equalsInt(1))
-        return LHS;
-      else if(ConstInt->equalsInt(2))
-        return CGF.EmitComplexBinaryExpr(BinaryExpr::Multiply, LHS, LHS);
+      auto Exponent = ConstInt->getSExtValue();
+      auto ElemTy = LHS.Re->getType();
+      ComplexValueTy One(llvm::ConstantFP::get(ElemTy, 1.0),
+                         llvm::ConstantFP::get(ElemTy, 0.0));
+      if(Exponent == 0)
+        return One;
+      if(Exponent > 0)
+        return EmitComplexPowConstant(CGF, LHS, Exponent);
+      return CGF.EmitComplexBinaryExpr(BinaryExpr::Divide, One,
+                                       EmitComplexPowConstant(CGF, LHS, -uint64_t(Exponent)));
     }
     return CGF.EmitComplexPowi(LHS, RHS);
   }
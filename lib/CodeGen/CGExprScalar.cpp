@@ -111,8 +111,12 @@ llvm::Value *ScalarExprEmitter::VisitVarExpr(const VarExpr *E) {
     return CGF.GetInlinedArgumentValue(VD).asScalar();
   if(VD->isParameter())
     return EmitExpr(VD->getInit());
+  if(auto Val = CGF.GetDoVarValue(VD))
+    return Val;
   auto Ptr = CGF.GetVarPtr(VD);
-  return Builder.CreateLoad(Ptr,VD->getName());
+  auto Load = Builder.CreateLoad(Ptr,VD->getName());
+  CGF.DecorateAccessWithTBAA(Load, VD->getType());
+  return Load;
 }
 
 llvm::Value *ScalarExprEmitter::VisitUnaryExprPlus(const UnaryExpr *E) {
@@ -178,20 +182,14 @@ llvm::Value *CodeGenFunction::EmitScalarBinaryExpr(BinaryExpr::Operator Op,
     Result = IsInt?  Builder.CreateSDiv(LHS, RHS) :
                      Builder.CreateFDiv(LHS, RHS);
     break;
-  case BinaryExpr::Power: {
+  case BinaryExpr::Power:
     if(IsInt)
-      return EmitScalarPowIntInt(LHS, RHS);
-    auto Intrinsic = llvm::Intrinsic::pow;
-    if(RHS->getType()->isIntegerTy()) {
-      Intrinsic = llvm::Intrinsic::powi;
-      RHS = EmitIntToInt32Conversion(RHS);
-    }
-    auto Func = GetIntrinsicFunction(Intrinsic,
-                                     LHS->getType());
-    llvm::Value *PowerArgs[] = {LHS, RHS};
-    Result = Builder.CreateCall(Func, PowerArgs);
+      Result = EmitScalarPowIntInt(LHS, RHS);
+    else if(RHS->getType()->isIntegerTy())
+      Result = EmitScalarPowRealInt(LHS, RHS);
+    else
+      Result = EmitScalarPowRealReal(LHS, RHS);
     break;
-  }
 
   default:
     return EmitScalarRelationalExpr(Op, LHS, RHS);
@@ -362,13 +360,17 @@ llvm::Value *ScalarExprEmitter::VisitIntrinsicCallExpr(const IntrinsicCallExpr *
 }
 
 llvm::Value *ScalarExprEmitter::VisitArrayElementExpr(const ArrayElementExpr *E) {
-  return Builder.CreateLoad(CGF.EmitArrayElementPtr(E));
+  auto Load = Builder.CreateLoad(CGF.EmitArrayElementPtr(E));
+  CGF.DecorateAccessWithTBAA(Load, E->getType());
+  return Load;
 }
 
 llvm::Value *ScalarExprEmitter::VisitMemberExpr(const MemberExpr *E) {
   auto Val = CGF.EmitAggregateExpr(E->getTarget());
-  return Builder.CreateLoad(CGF.EmitAggregateMember(Val.getAggregateAddr(), E->getField()),
-                            Val.isVolatileQualifier());
+  auto Load = Builder.CreateLoad(CGF.EmitAggregateMember(Val.getAggregateAddr(), E->getField()),
+                                 Val.isVolatileQualifier());
+  CGF.DecorateAccessWithTBAA(Load, E->getType());
+  return Load;
 }
 
 llvm::Value *ScalarExprEmitter::VisitFunctionRefExpr(const FunctionRefExpr *E) {
@@ -92,7 +92,9 @@ RValueTy CodeGenFunction::EmitIntrinsicCall(const IntrinsicCallExpr *E) {
       return EmitIntrinsicCallCharacter(Func, EmitCharacterExpr(Args[0]));
     else
       return EmitIntrinsicCallCharacter(Func, EmitCharacterExpr(Args[0]),
-                                        EmitCharacterExpr(Args[1]));
+                                        EmitCharacterExpr(Args[1]),
+                                        Args.size() == 3?
+                                          EmitLogicalConditionExpr(Args[2]) : nullptr);
 
   case GROUP_ARRAY:
     return EmitArrayIntrinsic(Func, Args);
@@ -259,11 +261,18 @@ llvm::Value* CodeGenFunction::EmitIntrinsicCallScalarMath(intrinsic::FunctionKin
   default:
     llvm_unreachable("invalid scalar math intrinsic");
   }
+  llvm::CallInst *Call;
   if(A2) {
     llvm::Value *Args[] = {A1, A2};
-    return Builder.CreateCall(FuncDecl, Args);
-  }
-  return Builder.CreateCall(FuncDecl, A1);
+    Call = Builder.CreateCall(FuncDecl, Args);
+  } else
+    Call = Builder.CreateCall(FuncDecl, A1);
+  // errno is never read, so the math functions of the C library don't
+  // access memory either, which lets the loop vectorizer replace them
+  // with the functions of the vector library (-fveclib).
+  Call->setDoesNotAccessMemory();
+  Call->setDoesNotThrow();
+  return Call;
 }
 
 llvm::Value *CodeGenFunction::EmitIntrinsicMinMax(intrinsic::FunctionKind Func,
@@ -286,26 +295,118 @@ llvm::Value *CodeGenFunction::EmitIntrinsicScalarMinMax(intrinsic::FunctionKind
 }
 
 // Lets pretend ** is an intrinsic
+
+/// \brief Raises the value to a constant positive power using a chain of
+/// multiplications which squares the value for every bit of the power.
+llvm::Value *CodeGenFunction::EmitScalarPowConstant(llvm::Value *Base,
+                                                    uint64_t Exponent) {
+  assert(Exponent > 0);
+  bool IsInt = Base->getType()->isIntegerTy();
+  llvm::Value *Result = nullptr;
+  for(auto Square = Base; ; ) {
+    if(Exponent & 1)
+      Result = !Result? Square :
+               IsInt? Builder.CreateMul(Result, Square) :
+                      Builder.CreateFMul(Result, Square);
+    Exponent >>= 1;
+    if(!Exponent)
+      break;
+    Square = IsInt? Builder.CreateMul(Square, Square) :
+                    Builder.CreateFMul(Square, Square);
+  }
+  return Result;
+}
+
+/// \brief Returns the integer result of the base raised to a negative
+/// power, which is zero unless the base is 1 or -1.
+static llvm::Value *EmitPowIntNegative(CGBuilderTy &Builder, llvm::Value *Base,
+                                       llvm::Value *IsOddExponent) {
+  auto T = Base->getType();
+  auto One = llvm::ConstantInt::get(T, 1);
+  auto MinusOne = llvm::ConstantInt::getSigned(T, -1);
+  auto MinusOneResult = Builder.CreateSelect(IsOddExponent, MinusOne, One);
+  return Builder.CreateSelect(Builder.CreateICmpEQ(Base, One), One,
+           Builder.CreateSelect(Builder.CreateICmpEQ(Base, MinusOne),
+                                MinusOneResult,
+                                llvm::ConstantInt::get(T, 0)));
+}
+
 llvm::Value *CodeGenFunction::EmitScalarPowIntInt(llvm::Value *LHS, llvm::Value *RHS) {
   auto T = cast<llvm::IntegerType>(LHS->getType());
-  StringRef FuncName;
-  switch(T->getBitWidth()) {
-  case 8:
-    FuncName = "pow_i1_i1"; break;
-  case 16:
-    FuncName = "pow_i2_i2"; break;
-  case 32:
-    FuncName = "pow_i4_i4"; break;
-  case 64:
-    FuncName = "pow_i8_i8"; break;
-  default:
-    llvm_unreachable("unsupported integer type");
+  RHS = Builder.CreateSExtOrTrunc(RHS, T);
+  if(auto ConstExponent = dyn_cast<llvm::ConstantInt>(RHS)) {
+    auto Exponent = ConstExponent->getSExtValue();
+    if(Exponent == 0)
+      return llvm::ConstantInt::get(T, 1);
+    if(Exponent > 0)
+      return EmitScalarPowConstant(LHS, Exponent);
+    return EmitPowIntNegative(Builder, LHS, Builder.getInt1(Exponent & 1));
   }
-  auto Func = CGM.GetRuntimeFunction2(FuncName, T, T, T);
-  CallArgList Args;
-  Args.add(LHS);
-  Args.add(RHS);
-  return EmitCall(Func.getFunction(), Func.getInfo(), Args).asScalar();
+
+  // r = 1
+  // while(e != 0) {
+  //   if(e & 1) r = r * b
+  //   b = b * b; e = e >> 1
+  // }
+  auto IsNegative = Builder.CreateICmpSLT(RHS, llvm::ConstantInt::get(T, 0));
+  auto IsOdd = Builder.CreateTrunc(RHS, Builder.getInt1Ty());
+  auto NegativeResult = EmitPowIntNegative(Builder, LHS, IsOdd);
+  auto Exponent = Builder.CreateSelect(IsNegative, llvm::ConstantInt::get(T, 0), RHS);
+  auto EntryBlock = Builder.GetInsertBlock();
+  auto LoopBlock = createBasicBlock("pow-loop");
+  auto BodyBlock = createBasicBlock("pow-body");
+  auto EndBlock = createBasicBlock("pow-end");
+  EmitBlock(LoopBlock);
+  auto Result = Builder.CreatePHI(T, 2, "pow-result");
+  auto Square = Builder.CreatePHI(T, 2, "pow-square");
+  auto Bits = Builder.CreatePHI(T, 2, "pow-exponent");
+  Result->addIncoming(llvm::ConstantInt::get(T, 1), EntryBlock);
+  Square->addIncoming(LHS, EntryBlock);
+  Bits->addIncoming(Exponent, EntryBlock);
+  Builder.CreateCondBr(Builder.CreateICmpEQ(Bits, llvm::ConstantInt::get(T, 0)),
+                       EndBlock, BodyBlock);
+  EmitBlock(BodyBlock);
+  Result->addIncoming(Builder.CreateSelect(Builder.CreateTrunc(Bits, Builder.getInt1Ty()),
+                                           Builder.CreateMul(Result, Square), Result),
+                      BodyBlock);
+  Square->addIncoming(Builder.CreateMul(Square, Square), BodyBlock);
+  Bits->addIncoming(Builder.CreateLShr(Bits, 1), BodyBlock);
+  Builder.CreateBr(LoopBlock);
+  EmitBlock(EndBlock);
+  return Builder.CreateSelect(IsNegative, NegativeResult, Result);
+}
+
+llvm::Value *CodeGenFunction::EmitScalarPowRealInt(llvm::Value *LHS, llvm::Value *RHS) {
+  if(auto ConstExponent = dyn_cast<llvm::ConstantInt>(RHS)) {
+    auto Exponent = ConstExponent->getSExtValue();
+    auto One = llvm::ConstantFP::get(LHS->getType(), 1.0);
+    if(Exponent == 0)
+      return One;
+    if(Exponent > 0)
+      return EmitScalarPowConstant(LHS, Exponent);
+    return Builder.CreateFDiv(One, EmitScalarPowConstant(LHS, -uint64_t(Exponent)));
+  }
+  auto Func = GetIntrinsicFunction(llvm::Intrinsic::powi, LHS->getType());
+  llvm::Value *PowerArgs[] = {LHS, EmitIntToInt32Conversion(RHS)};
+  return Builder.CreateCall(Func, PowerArgs);
+}
+
+llvm::Value *CodeGenFunction::EmitScalarPowRealReal(llvm::Value *LHS, llvm::Value *RHS) {
+  if(auto ConstExponent = dyn_cast<llvm::ConstantFP>(RHS)) {
+    // x ** 0.5 => sqrt(x)
+    // x ** 1.0 => x
+    // x ** 2.0 => x * x
+    if(ConstExponent->isExactlyValue(0.5))
+      return Builder.CreateCall(GetIntrinsicFunction(llvm::Intrinsic::sqrt,
+                                                     LHS->getType()), LHS);
+    if(ConstExponent->isExactlyValue(1.0))
+      return LHS;
+    if(ConstExponent->isExactlyValue(2.0))
+      return Builder.CreateFMul(LHS, LHS);
+  }
+  auto Func = GetIntrinsicFunction(llvm::Intrinsic::pow, LHS->getType());
+  llvm::Value *PowerArgs[] = {LHS, RHS};
+  return Builder.CreateCall(Func, PowerArgs);
 }
 
 ComplexValueTy CodeGenFunction::EmitComplexPowi(ComplexValueTy LHS, llvm::Value *RHS) {
@@ -337,8 +438,57 @@ ComplexValueTy CodeGenFunction::EmitComplexPow(ComplexValueTy LHS, ComplexValueT
   return EmitComplexLoad(Result);
 }
 
+/// \brief Emits the absolute value of a complex number. The full accuracy
+/// uses hypot from the C library, the improved accuracy scales the parts by
+/// the larger one to avoid the overflow, and the fast one doesn't scale them.
+llvm::Value *CodeGenFunction::EmitComplexAbs(ComplexValueTy Value) {
+  auto ElementType = Value.Re->getType();
+  switch(CGM.getCodeGenOpts().getComplexArithmetic()) {
+  case CodeGenOptions::CAK_Full: {
+    llvm::Type *ArgTypes[] = { ElementType, ElementType };
+    auto Func = CGM.GetCFunction(MANGLE_MATH_FUNCTION("hypot", ElementType),
+                                 ArgTypes, ElementType);
+    llvm::Value *Args[] = { Value.Re, Value.Im };
+    return Builder.CreateCall(Func, Args);
+  }
+
+  case CodeGenOptions::CAK_Fast:
+    // sqrt(a*a + b*b)
+    return Builder.CreateCall(GetIntrinsicFunction(llvm::Intrinsic::sqrt, ElementType),
+                              Builder.CreateFAdd(Builder.CreateFMul(Value.Re, Value.Re),
+                                                 Builder.CreateFMul(Value.Im, Value.Im)));
+
+  case CodeGenOptions::CAK_Improved:
+    break;
+  }
+
+  // x = max(|a|, |b|), y = min(|a|, |b|)
+  // x * sqrt(1 + (y/x)**2), or x when y is 0, or infinity when
+  // one of the parts is infinite.
+  auto FabsIntrinsic = GetIntrinsicFunction(llvm::Intrinsic::fabs, ElementType);
+  auto Re = Builder.CreateCall(FabsIntrinsic, Value.Re);
+  auto Im = Builder.CreateCall(FabsIntrinsic, Value.Im);
+  auto IsReLarger = Builder.CreateFCmpOGE(Re, Im);
+  auto Larger = Builder.CreateSelect(IsReLarger, Re, Im);
+  auto Smaller = Builder.CreateSelect(IsReLarger, Im, Re);
+  auto One = llvm::ConstantFP::get(ElementType, 1.0);
+  auto Ratio = Builder.CreateFDiv(Smaller, Larger);
+  auto Result = Builder.CreateFMul(Larger,
+                  Builder.CreateCall(GetIntrinsicFunction(llvm::Intrinsic::sqrt, ElementType),
+                                     Builder.CreateFAdd(One, Builder.CreateFMul(Ratio, Ratio))));
+  auto Zero = llvm::ConstantFP::get(ElementType, 0.0);
+  Result = Builder.CreateSelect(Builder.CreateFCmpOEQ(Smaller, Zero), Larger, Result);
+  auto Infinity = llvm::ConstantFP::getInfinity(ElementType);
+  auto IsInfinite = Builder.CreateOr(Builder.CreateFCmpOEQ(Re, Infinity),
+                                     Builder.CreateFCmpOEQ(Im, Infinity));
+  return Builder.CreateSelect(IsInfinite, Infinity, Result);
+}
+
 RValueTy CodeGenFunction::EmitIntrinsicCallComplexMath(intrinsic::FunctionKind Function,
                                                        ComplexValueTy Value) {
+  if(Function == intrinsic::ABS)
+    return EmitComplexAbs(Value);
+
   auto ElementType = Value.Re->getType();
   auto ValueType = getTypes().GetComplexType(ElementType);
   auto ResultType =  llvm::PointerType::get(ValueType, 0);
@@ -347,10 +497,6 @@ RValueTy CodeGenFunction::EmitIntrinsicCallComplexMath(intrinsic::FunctionKind F
   ArrayRef<CGType> Arg1(Arg1Types, 3);
 
   switch(Function) {
-  case intrinsic::ABS:
-    Func = CGM.GetRuntimeFunction2(MANGLE_MATH_FUNCTION("cabs", ElementType),
-                                   ElementType, ElementType, ElementType);
-    break;
   case intrinsic::SQRT:
     Func = CGM.GetRuntimeFunction(MANGLE_MATH_FUNCTION("csqrt", ElementType),
                                   Arg1);
@@ -381,14 +527,10 @@ RValueTy CodeGenFunction::EmitIntrinsicCallComplexMath(intrinsic::FunctionKind F
 
   CallArgList Args;
   Args.add(Value.Re);Args.add(Value.Im);
-  if(Function != intrinsic::ABS) {
-    auto Result = CreateTempAlloca(ValueType, "libflang_complex_result");
-    Args.add(Result);
-    EmitCall(Func.getFunction(), Func.getInfo(), Args);
-    return EmitComplexLoad(Result);
-  }
-
-  return EmitCall(Func.getFunction(), Func.getInfo(), Args);
+  auto Result = CreateTempAlloca(ValueType, "libflang_complex_result");
+  Args.add(Result);
+  EmitCall(Func.getFunction(), Func.getInfo(), Args);
+  return EmitComplexLoad(Result);
 }
 
 llvm::Value *CodeGenFunction::EmitIntrinsicNumericInquiry(intrinsic::FunctionKind Func,
@@ -15,11 +15,16 @@
 #include "CodeGenModule.h"
 #include "CGIORuntime.h"
 #include "flang/AST/StmtVisitor.h"
+#include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/InlineAsm.h"
 #include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/Metadata.h"
 #include "llvm/IR/CallSite.h"
+#include "llvm/Support/MathExtras.h"
+#include <map>
 
 namespace flang {
 namespace CodeGen {
@@ -31,12 +36,10 @@ public:
   StmtEmmitter(CodeGenFunction &cgf) : CGF(cgf) {}
 
   void VisitCompoundStmt(const CompoundStmt *S) {
-    for(auto I : S->getBody())
-      CGF.EmitStmt(I);
+    CGF.EmitStmts(S->getBody());
   }
   void VisitBlockStmt(const BlockStmt *S) {
-    for(auto I : S->getStatements())
-      CGF.EmitStmt(I);
+    CGF.EmitStmts(S->getStatements());
   }
   void VisitGotoStmt(const GotoStmt *S) {
     CGF.EmitGotoStmt(S);
@@ -80,6 +83,12 @@ public:
   void VisitCallStmt(const CallStmt *S) {
     CGF.EmitCallStmt(S);
   }
+  void VisitAllocateStmt(const AllocateStmt *S) {
+    CGF.EmitAllocateStmt(S);
+  }
+  void VisitDeallocateStmt(const DeallocateStmt *S) {
+    CGF.EmitDeallocateStmt(S);
+  }
   void VisitAssignmentStmt(const AssignmentStmt *S) {
     CGF.EmitAssignmentStmt(S);
   }
@@ -98,6 +107,19 @@ void CodeGenFunction::EmitStmt(const Stmt *S) {
   SV.Visit(S);
 }
 
+void CodeGenFunction::EmitStmts(ArrayRef<Stmt*> Stmts) {
+  for(size_t I = 0; I < Stmts.size();) {
+    if(CGM.getCodeGenOpts().ArrayStmtFusion) {
+      if(auto Count = EmitFusedArrayAssignments(Stmts.slice(I))) {
+        I += Count;
+        continue;
+      }
+    }
+    EmitStmt(Stmts[I]);
+    ++I;
+  }
+}
+
 void CodeGenFunction::EmitBlock(llvm::BasicBlock *BB) {
   auto CurBB = Builder.GetInsertBlock();
   EmitBranch(BB);
@@ -256,85 +278,190 @@ public:
   }
 };
 
+/// \brief Creates the distinct llvm.loop metadata node for a loop
+/// with the given hints.
+llvm::MDNode *CodeGenFunction::CreateLoopID(ArrayRef<llvm::Metadata*> Hints) {
+  SmallVector<llvm::Metadata*, 4> Args;
+  // Reserve the first operand for the self reference.
+  auto TempNode = llvm::MDNode::getTemporary(getLLVMContext(), None);
+  Args.push_back(TempNode.get());
+  Args.append(Hints.begin(), Hints.end());
+  auto LoopID = llvm::MDNode::get(getLLVMContext(), Args);
+  LoopID->replaceOperandWith(0, LoopID);
+  return LoopID;
+}
+
+static llvm::MDNode *CreateLoopHint(llvm::LLVMContext &Ctx, StringRef Name,
+                                    llvm::Constant *Value = nullptr) {
+  SmallVector<llvm::Metadata*, 2> Args;
+  Args.push_back(llvm::MDString::get(Ctx, Name));
+  if(Value)
+    Args.push_back(llvm::ConstantAsMetadata::get(Value));
+  return llvm::MDNode::get(Ctx, Args);
+}
+
+/// \brief Attaches the loop ID with the given directive hints to the
+/// back edge of a loop. For IVDEP, the memory accesses in the blocks
+/// from the header up to the given end block are also marked as parallel,
+/// so that the vectorizer can ignore the dependencies between them.
+void CodeGenFunction::EmitLoopHints(const LoopHints *Hints, llvm::BasicBlock *Header,
+                                    llvm::BasicBlock *LoopEnd, llvm::BranchInst *BackEdge) {
+  if(!Hints)
+    return;
+
+  auto &Ctx = getLLVMContext();
+  SmallVector<llvm::Metadata*, 4> Args;
+  if(Hints->getVectorize() != LoopHints::VectorizeDefault)
+    Args.push_back(CreateLoopHint(Ctx, "llvm.loop.vectorize.enable",
+                                  Builder.getInt1(Hints->getVectorize() ==
+                                                  LoopHints::VectorizeAlways)));
+  auto Unroll = Hints->getUnrollCount();
+  if(Unroll == LoopHints::UnrollDisabled)
+    Args.push_back(CreateLoopHint(Ctx, "llvm.loop.unroll.disable"));
+  else if(Unroll == LoopHints::UnrollWithoutCount)
+    Args.push_back(CreateLoopHint(Ctx, "llvm.loop.unroll.full"));
+  else if(Unroll != LoopHints::UnrollNone)
+    Args.push_back(CreateLoopHint(Ctx, "llvm.loop.unroll.count",
+                                  Builder.getInt32(Unroll)));
+  auto LoopID = CreateLoopID(Args);
+  BackEdge->setMetadata("llvm.loop", LoopID);
+  if(!Hints->isIVDep())
+    return;
+
+  for(auto BB = llvm::Function::iterator(Header), End = CurFn->end();
+      BB != End && &*BB != LoopEnd; ++BB) {
+    for(auto &I : *BB) {
+      if(!I.mayReadOrWriteMemory())
+        continue;
+      auto Access = I.getMetadata("llvm.mem.parallel_loop_access");
+      if(!Access) {
+        I.setMetadata("llvm.mem.parallel_loop_access", LoopID);
+        continue;
+      }
+      // The access is already parallel in an inner loop.
+      SmallVector<llvm::Metadata*, 4> LoopIDs;
+      if(Access->getNumOperands() && Access->getOperand(0).get() == Access)
+        LoopIDs.push_back(Access);
+      else {
+        for(auto &Op : Access->operands())
+          LoopIDs.push_back(Op.get());
+      }
+      LoopIDs.push_back(LoopID);
+      I.setMetadata("llvm.mem.parallel_loop_access", llvm::MDNode::get(Ctx, LoopIDs));
+    }
+  }
+}
+
+/// \brief Emits the prefetches which are requested by the
+/// PREFETCH directives for the current iteration of a loop.
+void CodeGenFunction::EmitPrefetches(const LoopHints *Hints) {
+  if(!Hints || Hints->getPrefetches().empty())
+    return;
+  auto Func = GetIntrinsicFunction(llvm::Intrinsic::prefetch,
+                                   ArrayRef<llvm::Type*>());
+  for(auto Prefetch : Hints->getPrefetches()) {
+    auto Ptr = EmitLValue(Prefetch.Element).getPointer();
+    llvm::Value *Args[] = {
+      Builder.CreateBitCast(Ptr, CGM.Int8PtrTy),
+      Builder.getInt32(0), // read
+      Builder.getInt32(Prefetch.Locality),
+      Builder.getInt32(1)  // data cache
+    };
+    Builder.CreateCall(Func, Args);
+  }
+}
+
+/// \brief Computes the trip count of a DO loop:
+/// IterationCount = MAX( INT( (m2 - m1 + m3)/m3), 0)
+llvm::Value *CodeGenFunction::EmitDoIterationCount(llvm::Value *InitValue,
+                                                   llvm::Value *EndValue,
+                                                   llvm::Value *IncValue,
+                                                   bool HasIncrement) {
+  auto Zero = llvm::ConstantInt::get(CGM.SizeTy, 0);
+  llvm::Value *Val;
+  if(InitValue->getType()->isIntegerTy()) {
+    // Compute the count in the size type so that it can't overflow
+    // for the loops with the default integer kind.
+    InitValue = Builder.CreateSExtOrTrunc(InitValue, CGM.SizeTy);
+    EndValue = Builder.CreateSExtOrTrunc(EndValue, CGM.SizeTy);
+    Val = Builder.CreateSub(EndValue, InitValue);
+    if(HasIncrement) {
+      IncValue = Builder.CreateSExtOrTrunc(IncValue, CGM.SizeTy);
+      Val = Builder.CreateSDiv(Builder.CreateAdd(Val, IncValue), IncValue);
+    } else
+      Val = Builder.CreateAdd(Val, llvm::ConstantInt::get(CGM.SizeTy, 1));
+  } else {
+    Val = EmitScalarBinaryExpr(BinaryExpr::Minus,
+                               EndValue, InitValue);
+    Val = EmitScalarBinaryExpr(BinaryExpr::Plus,
+                               Val, IncValue);
+    Val = EmitScalarBinaryExpr(BinaryExpr::Divide,
+                               Val, IncValue);
+    Val = Builder.CreateFPToSI(Val, CGM.SizeTy);
+  }
+  return Builder.CreateSelect(Builder.CreateICmpSGE(Val, Zero),
+                              Val, Zero, "iteration-count");
+}
+
 void CodeGenFunction::EmitDoStmt(const DoStmt *S) {
   // Init
-  auto VarPtr = GetVarPtr(cast<VarExpr>(S->getDoVar())->getVarDecl());
+  auto DoVar = cast<VarExpr>(S->getDoVar())->getVarDecl();
+  auto VarPtr = GetVarPtr(DoVar);
   auto InitValue = EmitScalarExpr(S->getInitialParameter());
-  Builder.CreateStore(InitValue, VarPtr);  
+  DecorateAccessWithTBAA(Builder.CreateStore(InitValue, VarPtr), DoVar->getType());
   auto EndValue = EmitScalarExpr(S->getTerminalParameter());
   llvm::Value *IncValue;
-  bool UseIterationCount = true;
   if(S->getIncrementationParameter())
     IncValue = EmitScalarExpr(S->getIncrementationParameter());
-  else {
-    IncValue = GetConstantOne(S->getDoVar()->getType());
-    if(S->getDoVar()->getType()->isIntegerType())
-      UseIterationCount = false;
-  }
+  else
+    IncValue = GetConstantOne(DoVar->getType());
+  auto IterationCount = EmitDoIterationCount(InitValue, EndValue, IncValue,
+                                             S->getIncrementationParameter() != nullptr);
 
-  auto Loop = createBasicBlock("do");
   auto LoopBody = createBasicBlock("loop");
   auto LoopIncrement = createBasicBlock("loop-inc");
   auto EndLoop = createBasicBlock("end-do");
 
-  // IterationCount = MAX( INT( (m2 - m1 + m3)/m3), 0)
-  llvm::Value *IterationCountVar;
+  // DO i = -1, -5 => IterationCount is 0 => don't run
   auto Zero = llvm::ConstantInt::get(CGM.SizeTy, 0);
-  if(UseIterationCount) {
-    IterationCountVar = CreateTempAlloca(CGM.SizeTy,
-                                         "iteration-count");
-    auto Val = EmitScalarBinaryExpr(BinaryExpr::Minus,
-                                    EndValue, InitValue);
-    Val = EmitScalarBinaryExpr(BinaryExpr::Plus,
-                               Val, IncValue);
-    Val = EmitScalarBinaryExpr(BinaryExpr::Divide,
-                               Val, IncValue);
-    if(Val->getType()->isFloatingPointTy())
-      Val = Builder.CreateFPToSI(Val, CGM.SizeTy);
-    else
-      Val = Builder.CreateSExtOrTrunc(Val, CGM.SizeTy);
-    Val = Builder.CreateSelect(Builder.CreateICmpSGE(Val, Zero),
-                               Val, Zero, "max");
-    Builder.CreateStore(Val, IterationCountVar);
-  } else {
-    // DO i = -1, -5 => IterationCount is 0 => don't run
-    auto Cond = EmitScalarRelationalExpr(
-                  BinaryExpr::GreaterThanEqual,
-                  EndValue, InitValue);
-    Builder.CreateCondBr(Cond, Loop, EndLoop);
-  }
+  auto Preheader = Builder.GetInsertBlock();
+  Builder.CreateCondBr(Builder.CreateICmpSGT(IterationCount, Zero),
+                       LoopBody, EndLoop);
 
   LoopScope Scope(this, S, LoopIncrement, EndLoop);
 
-  EmitBlock(Loop);
-  // Check condition
-  llvm::Value *Cond;
-  if(UseIterationCount)
-    Cond = Builder.CreateICmpNE(Builder.CreateLoad(IterationCountVar),
-                                Zero);
-  else
-    Cond = EmitScalarRelationalExpr(
-             BinaryExpr::LessThanEqual,
-             Builder.CreateLoad(VarPtr), EndValue);
-  Builder.CreateCondBr(Cond, LoopBody, EndLoop);
-
+  // The loop is emitted in the rotated form with a counter and the
+  // value of the do variable as its induction variables. The body
+  // reads the do variable from the induction variable, while the
+  // memory is only updated to keep the variable defined when it
+  // escapes the loop.
   EmitBlock(LoopBody);
+  auto Counter = Builder.CreatePHI(CGM.SizeTy, 2, "do-counter");
+  auto CurVal = Builder.CreatePHI(InitValue->getType(), 2, DoVar->getName());
+  Counter->addIncoming(Zero, Preheader);
+  CurVal->addIncoming(InitValue, Preheader);
+  auto PrevDoVarValue = SetDoVarValue(DoVar, CurVal);
+  EmitPrefetches(S->getLoopHints());
   EmitStmt(S->getBody());
+  SetDoVarValue(DoVar, PrevDoVarValue);
 
   EmitBlock(LoopIncrement);
-  // increment the do variable
-  llvm::Value *CurVal = Builder.CreateLoad(VarPtr);
-  CurVal = EmitScalarBinaryExpr(BinaryExpr::Plus,
-                                CurVal, IncValue);
-  Builder.CreateStore(CurVal, VarPtr);
-  // decrement loop counter if its used.
-  if(UseIterationCount) {
-    Builder.CreateStore(Builder.CreateSub(
-                        Builder.CreateLoad(IterationCountVar),
-                        llvm::ConstantInt::get(CGM.SizeTy, 1)), IterationCountVar);
-  }
+  // increment the do variable and the loop counter
+  auto NextVal = CurVal->getType()->isIntegerTy()?
+                   Builder.CreateNSWAdd(CurVal, IncValue) :
+                   Builder.CreateFAdd(CurVal, IncValue);
+  DecorateAccessWithTBAA(Builder.CreateStore(NextVal, VarPtr), DoVar->getType());
+  auto NextCounter = Builder.CreateAdd(Counter, llvm::ConstantInt::get(CGM.SizeTy, 1),
+                                       "", true, true);
+  auto BackEdge = Builder.CreateCondBr(Builder.CreateICmpSLT(NextCounter, IterationCount),
+                                       LoopBody, EndLoop);
+  if(S->getLoopHints())
+    EmitLoopHints(S->getLoopHints(), LoopBody, EndLoop, BackEdge);
+  else
+    BackEdge->setMetadata("llvm.loop", CreateLoopID());
+  Counter->addIncoming(NextCounter, LoopIncrement);
+  CurVal->addIncoming(NextVal, LoopIncrement);
 
-  EmitBranch(Loop);
   EmitBlock(EndLoop);
 }
 
@@ -444,24 +571,294 @@ static void EmitCases(CodeGenFunction &CGF,
   }
 }
 
-void CodeGenFunction::EmitSelectCaseStmt(const SelectCaseStmt *S) {
-  // FIXME: many integer selects can be emitted into a switch.
+/// SwitchCaseValue - a constant value or a range of values of an integer
+/// or a logical case. The values are kept in the order of the cases, as
+/// the first case which matches the operand is selected.
+struct SwitchCaseValue {
+  int64_t Low, High;
+  bool HasLow, HasHigh;
+  unsigned Case;
+
+  /// isExpanded - Returns true if the values are added
+  /// to the switch, instead of being tested by comparisons.
+  bool isExpanded() const {
+    return HasLow && HasHigh &&
+           uint64_t(High) - uint64_t(Low) < MaxExpandedRange;
+  }
+  bool contains(int64_t Value) const {
+    return (!HasLow || Value >= Low) && (!HasHigh || Value <= High);
+  }
+
+  /// MaxExpandedRange - the largest range which is expanded
+  /// into the values of a switch.
+  enum { MaxExpandedRange = 64 };
+};
+
+static bool EvaluateSwitchCaseValue(const ASTContext &Ctx, const Expr *E,
+                                    int64_t &Result) {
+  if(auto Var = dyn_cast<VarExpr>(E)) {
+    if(Var->getVarDecl()->isParameter())
+      return EvaluateSwitchCaseValue(Ctx, Var->getVarDecl()->getInit(), Result);
+  }
+  if(auto Logical = dyn_cast<LogicalConstantExpr>(E)) {
+    Result = Logical->isTrue()? 1 : 0;
+    return true;
+  }
+  return E->getType()->isIntegerType() && E->EvaluateAsInt(Result, Ctx);
+}
+
+/// \brief Evaluates the values of the cases of an integer or a logical
+/// select, returning false if any value isn't a constant.
+static bool EvaluateSwitchCases(const ASTContext &Ctx, const SelectCaseStmt *S,
+                                SmallVectorImpl<SwitchCaseValue> &Values) {
+  unsigned CaseIndex = 0;
+  for(auto Case = S->getFirstCase(); Case; Case = Case->getNextCase(), ++CaseIndex) {
+    for(auto E : Case->getValues()) {
+      SwitchCaseValue Value;
+      Value.Case = CaseIndex;
+      if(auto Range = dyn_cast<RangeExpr>(E)) {
+        Value.HasLow = Range->hasFirstExpr();
+        Value.HasHigh = Range->hasSecondExpr();
+        if((Value.HasLow &&
+            !EvaluateSwitchCaseValue(Ctx, Range->getFirstExpr(), Value.Low)) ||
+           (Value.HasHigh &&
+            !EvaluateSwitchCaseValue(Ctx, Range->getSecondExpr(), Value.High)))
+          return false;
+        // An empty range never matches.
+        if(Value.HasLow && Value.HasHigh && Value.High < Value.Low)
+          continue;
+      } else {
+        if(!EvaluateSwitchCaseValue(Ctx, E, Value.Low))
+          return false;
+        Value.High = Value.Low;
+        Value.HasLow = Value.HasHigh = true;
+      }
+      Values.push_back(Value);
+    }
+  }
+  return true;
+}
 
+/// \brief Emits the cases of an integer or a logical select as a switch,
+/// which is lowered by LLVM into jump tables, bit tests or a binary search.
+/// The large and the open ranges are tested by comparisons when the operand
+/// doesn't match any of the values in the switch.
+static void EmitSwitchCases(CodeGenFunction &CGF, CGBuilderTy &Builder,
+                            llvm::Value *Operand, ArrayRef<SwitchCaseValue> Values,
+                            ArrayRef<llvm::BasicBlock*> MatchBlocks,
+                            llvm::BasicBlock *DefaultBlock) {
+  auto Type = cast<llvm::IntegerType>(Operand->getType());
+  bool HasRangeTests = false;
+  for(auto Value : Values) {
+    if(!Value.isExpanded())
+      HasRangeTests = true;
+  }
+  auto RangeTestBlock = HasRangeTests? CGF.createBasicBlock("case-ranges") :
+                                       DefaultBlock;
+  auto Switch = Builder.CreateSwitch(Operand, RangeTestBlock);
+
+  llvm::SmallSet<int64_t, 32> Added;
+  for(size_t I = 0; I < Values.size(); ++I) {
+    if(!Values[I].isExpanded())
+      continue;
+    auto Count = uint64_t(Values[I].High) - uint64_t(Values[I].Low) + 1;
+    for(uint64_t N = 0; N < Count; ++N) {
+      auto V = int64_t(uint64_t(Values[I].Low) + N);
+      if(Type->getBitWidth() > 1 && !llvm::isIntN(Type->getBitWidth(), V))
+        continue;
+      if(!Added.insert(V).second)
+        continue;
+      // The value is matched by an earlier range which is tested later.
+      bool IsCovered = false;
+      for(size_t J = 0; J < I; ++J) {
+        if(!Values[J].isExpanded() && Values[J].contains(V)) {
+          IsCovered = true;
+          break;
+        }
+      }
+      if(!IsCovered)
+        Switch->addCase(llvm::ConstantInt::get(Type, V, true),
+                        MatchBlocks[Values[I].Case]);
+    }
+  }
+  if(!HasRangeTests)
+    return;
+
+  CGF.EmitBlock(RangeTestBlock);
+  SmallVector<size_t, 8> Ranges;
+  for(size_t I = 0; I < Values.size(); ++I) {
+    if(!Values[I].isExpanded())
+      Ranges.push_back(I);
+  }
+  for(size_t I = 0; I < Ranges.size(); ++I) {
+    auto Value = Values[Ranges[I]];
+    llvm::Value *Condition = nullptr;
+    if(Value.HasLow)
+      Condition = Builder.CreateICmpSGE(Operand, llvm::ConstantInt::get(Type, Value.Low, true));
+    if(Value.HasHigh) {
+      auto C = Builder.CreateICmpSLE(Operand, llvm::ConstantInt::get(Type, Value.High, true));
+      Condition = Condition? Builder.CreateAnd(Condition, C) : C;
+    }
+    if(!Condition)
+      Condition = Builder.getTrue();
+    bool IsLast = (I + 1) == Ranges.size();
+    auto NextBlock = IsLast? DefaultBlock : CGF.createBasicBlock("case-test-next-range");
+    Builder.CreateCondBr(Condition, MatchBlocks[Value.Case], NextBlock);
+    if(!IsLast)
+      CGF.EmitBlock(NextBlock);
+  }
+}
+
+/// CharacterCaseValue - a constant value of a character case
+/// without the trailing blanks.
+struct CharacterCaseValue {
+  StringRef Value;
+  unsigned Case;
+};
+
+static bool EvaluateCharacterCaseValue(const Expr *E, StringRef &Result) {
+  if(auto Var = dyn_cast<VarExpr>(E)) {
+    if(Var->getVarDecl()->isParameter())
+      return EvaluateCharacterCaseValue(Var->getVarDecl()->getInit(), Result);
+  }
+  if(auto Char = dyn_cast<CharacterConstantExpr>(E)) {
+    Result = Char->getValue();
+    return true;
+  }
+  return false;
+}
+
+/// \brief Evaluates the values of the cases of a character select,
+/// returning false if any value isn't a constant or is a range.
+static bool EvaluateCharacterCases(const SelectCaseStmt *S,
+                                   SmallVectorImpl<CharacterCaseValue> &Values) {
+  llvm::StringSet<> Added;
+  unsigned CaseIndex = 0;
+  for(auto Case = S->getFirstCase(); Case; Case = Case->getNextCase(), ++CaseIndex) {
+    for(auto E : Case->getValues()) {
+      CharacterCaseValue Value;
+      if(!EvaluateCharacterCaseValue(E, Value.Value))
+        return false;
+      // The strings are compared as if the shorter one was padded with blanks.
+      Value.Value = Value.Value.rtrim(' ');
+      Value.Case = CaseIndex;
+      if(Added.insert(Value.Value).second)
+        Values.push_back(Value);
+    }
+  }
+  return true;
+}
+
+/// \brief Emits the cases of a character select as a decision tree which
+/// switches on the length of the operand without the trailing blanks, then
+/// on its first character, and then compares the remaining candidates
+/// using memcmp.
+static void EmitCharacterSwitchCases(CodeGenFunction &CGF, CGBuilderTy &Builder,
+                                     CharacterValueTy Operand,
+                                     ArrayRef<CharacterCaseValue> Values,
+                                     ArrayRef<llvm::BasicBlock*> MatchBlocks,
+                                     llvm::BasicBlock *DefaultBlock) {
+  auto &CGM = CGF.getModule();
+  std::map<size_t, std::map<unsigned char, SmallVector<CharacterCaseValue, 2>>> Tree;
+  for(auto Value : Values) {
+    auto FirstChar = Value.Value.empty()? 0 : (unsigned char)Value.Value[0];
+    Tree[Value.Value.size()][FirstChar].push_back(Value);
+  }
+
+  llvm::Type *MemcmpArgTypes[] = { CGM.VoidPtrTy, CGM.VoidPtrTy, CGM.SizeTy };
+  auto Memcmp = CGM.GetCFunction("memcmp", MemcmpArgTypes, CGM.Int32Ty);
+  auto LengthSwitch = Builder.CreateSwitch(CGF.EmitCharacterLenTrim(Operand),
+                                           DefaultBlock, Tree.size());
+  for(auto &Length : Tree) {
+    auto LengthBlock = CGF.createBasicBlock("case-length");
+    LengthSwitch->addCase(llvm::ConstantInt::get(CGM.SizeTy, Length.first),
+                          LengthBlock);
+    CGF.EmitBlock(LengthBlock);
+    if(Length.first == 0) {
+      Builder.CreateBr(MatchBlocks[Length.second.begin()->second[0].Case]);
+      continue;
+    }
+
+    auto CharSwitch = Builder.CreateSwitch(CGF.EmitCharacterDereference(Operand),
+                                           DefaultBlock, Length.second.size());
+    for(auto &FirstChar : Length.second) {
+      auto CharBlock = CGF.createBasicBlock("case-char");
+      CharSwitch->addCase(Builder.getInt8(FirstChar.first), CharBlock);
+      CGF.EmitBlock(CharBlock);
+      if(Length.first == 1) {
+        Builder.CreateBr(MatchBlocks[FirstChar.second[0].Case]);
+        continue;
+      }
+      auto Candidates = FirstChar.second;
+      for(size_t I = 0; I < Candidates.size(); ++I) {
+        llvm::Value *Args[] = {
+          Builder.CreateBitCast(Operand.Ptr, CGM.VoidPtrTy),
+          Builder.CreateGlobalStringPtr(Candidates[I].Value),
+          llvm::ConstantInt::get(CGM.SizeTy, Length.first)
+        };
+        auto Result = Builder.CreateCall(Memcmp, Args);
+        bool IsLast = (I + 1) == Candidates.size();
+        auto NextBlock = IsLast? DefaultBlock : CGF.createBasicBlock("case-test-next-value");
+        Builder.CreateCondBr(Builder.CreateICmpEQ(Result, Builder.getInt32(0)),
+                             MatchBlocks[Candidates[I].Case], NextBlock);
+        if(!IsLast)
+          CGF.EmitBlock(NextBlock);
+      }
+    }
+  }
+}
+
+static void CreateMatchBlocks(CodeGenFunction &CGF, const SelectCaseStmt *S,
+                              SmallVectorImpl<llvm::BasicBlock*> &MatchBlocks) {
+  for(auto Case = S->getFirstCase(); Case; Case = Case->getNextCase())
+    MatchBlocks.push_back(CGF.createBasicBlock("case-match"));
+}
+
+static void EmitCaseBodies(CodeGenFunction &CGF, const SelectCaseStmt *S,
+                           ArrayRef<llvm::BasicBlock*> MatchBlocks,
+                           llvm::BasicBlock *ContinueBlock) {
+  unsigned CaseIndex = 0;
+  for(auto Case = S->getFirstCase(); Case; Case = Case->getNextCase(), ++CaseIndex) {
+    CGF.EmitBlock(MatchBlocks[CaseIndex]);
+    CGF.EmitStmt(Case->getBody());
+    CGF.EmitBranch(ContinueBlock);
+  }
+}
+
+void CodeGenFunction::EmitSelectCaseStmt(const SelectCaseStmt *S) {
   auto E = S->getOperand();
 
   auto ContinueBlock = createBasicBlock("after-select-case");
   auto DefaultBlock  = S->hasDefaultCase()? createBasicBlock("case-default") :
                                             ContinueBlock;
 
-  if(E->getType()->isIntegerType()) {
+  // The selects with constant case values are emitted as switches.
+  SmallVector<llvm::BasicBlock*, 16> MatchBlocks;
+  SmallVector<SwitchCaseValue, 16> SwitchValues;
+  SmallVector<CharacterCaseValue, 16> CharacterValues;
+
+  if(E->getType()->isCharacterType()) {
+    if(EvaluateCharacterCases(S, CharacterValues)) {
+      CreateMatchBlocks(*this, S, MatchBlocks);
+      EmitCharacterSwitchCases(*this, Builder, EmitCharacterExpr(E), CharacterValues,
+                               MatchBlocks, DefaultBlock);
+      EmitCaseBodies(*this, S, MatchBlocks, ContinueBlock);
+    } else {
+      auto Val = EmitCharacterExpr(E);
+      EmitCases<CharCaseStmtEmitter>(*this, Builder, Val, S, DefaultBlock, ContinueBlock);
+    }
+  } else if(EvaluateSwitchCases(getContext(), S, SwitchValues)) {
+    CreateMatchBlocks(*this, S, MatchBlocks);
+    auto Val = E->getType()->isLogicalType()? EmitLogicalConditionExpr(E) :
+                                              EmitScalarExpr(E);
+    EmitSwitchCases(*this, Builder, Val, SwitchValues, MatchBlocks, DefaultBlock);
+    EmitCaseBodies(*this, S, MatchBlocks, ContinueBlock);
+  } else if(E->getType()->isIntegerType()) {
     auto Val = EmitScalarExpr(E);
     EmitCases<IntegerCaseStmtEmitter>(*this, Builder, Val, S, DefaultBlock, ContinueBlock);
-  } else if(E->getType()->isLogicalType()) {
+  } else {
     auto Val = EmitScalarExpr(E);
     EmitCases<LogicalCaseStmtEmitter>(*this, Builder, Val, S, DefaultBlock, ContinueBlock);
-  } else {
-    auto Val = EmitCharacterExpr(E);
-    EmitCases<CharCaseStmtEmitter>(*this, Builder, Val, S, DefaultBlock, ContinueBlock);
   }
 
   if(S->hasDefaultCase()) {
@@ -490,17 +887,19 @@ void CodeGenFunction::EmitAssignmentStmt(const AssignmentStmt *S) {
   auto RHSType = RHS->getType();
 
   if(S->getLHS()->getType()->isArrayType()) {
-    EmitArrayAssignment(S->getLHS(), S->getRHS());
+    EmitArrayAssignment(S->getLHS(), S->getRHS(), S->getLoopHints());
     return;
   }
   auto Destination = EmitLValue(S->getLHS());
 
   if(RHSType->isIntegerType() || RHSType->isRealType()) {
     auto Value = EmitScalarExpr(RHS);
-    Builder.CreateStore(Value, Destination.getPointer());
+    DecorateAccessWithTBAA(Builder.CreateStore(Value, Destination.getPointer()),
+                           S->getLHS()->getType());
   } else if(RHSType->isLogicalType()) {
     auto Value = EmitLogicalValueExpr(RHS);
-    Builder.CreateStore(Value, Destination.getPointer());
+    DecorateAccessWithTBAA(Builder.CreateStore(Value, Destination.getPointer()),
+                           S->getLHS()->getType());
   } else if(RHSType->isComplexType()) {
     auto Value = EmitComplexExpr(RHS);
     EmitComplexStore(Value, Destination.getPointer());
@@ -512,7 +911,8 @@ void CodeGenFunction::EmitAssignmentStmt(const AssignmentStmt *S) {
 
 void CodeGenFunction::EmitAssignment(LValueTy LHS, RValueTy RHS) {
   if(RHS.isScalar())
-    Builder.CreateStore(RHS.asScalar(), LHS.getPointer());
+    DecorateAccessWithTBAA(Builder.CreateStore(RHS.asScalar(), LHS.getPointer()),
+                           LHS.getType());
   else if(RHS.isComplex())
     EmitComplexStore(RHS.asComplex(), LHS.getPointer());
   else if(RHS.isCharacter())
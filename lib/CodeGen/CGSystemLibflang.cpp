@@ -25,6 +25,9 @@ public:
   llvm::Value *EmitMalloc(CodeGenFunction &CGF, llvm::Value *Size);
   void EmitFree(CodeGenFunction &CGF, llvm::Value *Ptr);
 
+  llvm::Value *EmitAllocate(CodeGenFunction &CGF, llvm::Value *Size);
+  void EmitDeallocate(CodeGenFunction &CGF, llvm::Value *Ptr, llvm::Value *Size);
+
   llvm::Value *EmitETIME(CodeGenFunction &CGF, ArrayRef<Expr*> Arguments);
 };
 
@@ -50,6 +53,25 @@ void CGLibflangSystemRuntime::EmitFree(CodeGenFunction &CGF, llvm::Value *Ptr) {
   CGF.EmitCall(Func.getFunction(), Func.getInfo(), ArgList);
 }
 
+llvm::Value *CGLibflangSystemRuntime::EmitAllocate(CodeGenFunction &CGF, llvm::Value *Size) {
+  auto Func = CGM.GetRuntimeFunction1("allocate", CGM.SizeTy, CGM.VoidPtrTy);
+  CallArgList ArgList;
+  CGF.EmitCallArg(ArgList, Size, Func.getInfo()->getArguments()[0]);
+  return CGF.EmitCall(Func.getFunction(), Func.getInfo(), ArgList).asScalar();
+}
+
+void CGLibflangSystemRuntime::EmitDeallocate(CodeGenFunction &CGF, llvm::Value *Ptr,
+                                             llvm::Value *Size) {
+  // The size selects the cache, so the blocks don't need a header.
+  auto Func = CGM.GetRuntimeFunction2("deallocate", CGM.VoidPtrTy, CGM.SizeTy);
+  CallArgList ArgList;
+  CGF.EmitCallArg(ArgList, Ptr->getType() == CGM.VoidPtrTy?
+                           Ptr : CGF.getBuilder().CreateBitCast(Ptr, CGM.VoidPtrTy),
+                  Func.getInfo()->getArguments()[0]);
+  CGF.EmitCallArg(ArgList, Size, Func.getInfo()->getArguments()[1]);
+  CGF.EmitCall(Func.getFunction(), Func.getInfo(), ArgList);
+}
+
 llvm::Value *CGLibflangSystemRuntime::EmitETIME(CodeGenFunction &CGF, ArrayRef<Expr*> Arguments) {
   auto RealTy = CGM.getContext().RealTy;
   auto RealPtrTy = llvm::PointerType::get(CGF.ConvertTypeForMem(RealTy) ,0);
@@ -41,6 +41,17 @@ public:
   llvm::Value *EmitMalloc(CodeGenFunction &CGF, llvm::Type *T, llvm::Value *Size);
   virtual void EmitFree(CodeGenFunction &CGF, llvm::Value *Ptr) = 0;
 
+  /// EmitAllocate - Allocates the memory of an allocatable array.
+  /// The memory is aligned to 64 bytes, and the freed blocks are kept in
+  /// per-thread size class caches, so that the arrays which are allocated
+  /// and deallocated repeatedly don't reach the system allocator.
+  virtual llvm::Value *EmitAllocate(CodeGenFunction &CGF, llvm::Value *Size) = 0;
+
+  /// EmitDeallocate - Returns the memory of an allocatable array
+  /// with the given size to the runtime.
+  virtual void EmitDeallocate(CodeGenFunction &CGF, llvm::Value *Ptr,
+                              llvm::Value *Size) = 0;
+
   virtual llvm::Value *EmitETIME(CodeGenFunction &CGF, ArrayRef<Expr*> Arguments) = 0;
 };
 
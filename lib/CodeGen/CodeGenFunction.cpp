@@ -23,6 +23,7 @@
 #include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Operator.h"
+#include <algorithm>
 
 namespace flang {
 namespace CodeGen {
@@ -33,8 +34,9 @@ CodeGenFunction::CodeGenFunction(CodeGenModule &cgm, llvm::Function *Fn)
     UnreachableBlock(nullptr), CurFn(Fn), IsMainProgram(false),
     ReturnValuePtr(nullptr), AllocaInsertPt(nullptr),
     AssignedGotoVarPtr(nullptr), AssignedGotoDispatchBlock(nullptr),
+    ContiguousVersion(nullptr), ContiguousVersionOf(nullptr),
     CurLoopScope(nullptr), CurInlinedStmtFunc(nullptr) {
-  HasSavedVariables = false;
+  HasSavedVarInitializers = false;
 }
 
 CodeGenFunction::~CodeGenFunction() {
@@ -56,6 +58,63 @@ void CodeGenFunction::EmitMainProgramBody(const DeclContext *DC, const Stmt *S)
     EmitAssignedGotoDispatcher();
 }
 
+/// \brief Returns true if the given dummy argument has the given attribute,
+/// which can be attached to the element type of an array.
+static bool HasAttributeSpec(const VarDecl *Arg, Qualifiers::AS AS) {
+  auto T = Arg->getType();
+  if(T.hasAttributeSpec(AS))
+    return true;
+  if(auto ATy = T->asArrayType())
+    return ATy->getElementType().hasAttributeSpec(AS);
+  return false;
+}
+
+/// \brief Returns true if the given dummy argument is declared with INTENT(IN).
+static bool IsIntentInArgument(const VarDecl *Arg) {
+  auto T = Arg->getType();
+  if(T.getQualifiers().getIntentAttr() == Qualifiers::IS_in)
+    return true;
+  if(auto ATy = T->asArrayType())
+    return ATy->getElementType().getQualifiers().getIntentAttr() == Qualifiers::IS_in;
+  return false;
+}
+
+/// \brief Returns true if the given dummy argument can be associated with
+/// the same object as another dummy argument or a variable which is
+/// accessible by the procedure.
+static bool MayBeAliased(const VarDecl *Arg) {
+  return HasAttributeSpec(Arg, Qualifiers::AS_target) ||
+         HasAttributeSpec(Arg, Qualifiers::AS_pointer) ||
+         HasAttributeSpec(Arg, Qualifiers::AS_volatile) ||
+         HasAttributeSpec(Arg, Qualifiers::AS_asynchronous);
+}
+
+/// \brief Adds the attributes which describe the aliasing of the given
+/// dummy argument.
+static void GetArgumentAttributes(const VarDecl *Arg, ABIArgInfo::Kind ABI,
+                                  llvm::AttrBuilder &Attributes) {
+  // The descriptors of the assumed-shape arguments are never modified.
+  if(ABI == ABIArgInfo::ArrayDescriptor) {
+    Attributes.addAttribute(llvm::Attribute::NoCapture);
+    Attributes.addAttribute(llvm::Attribute::ReadOnly);
+    return;
+  }
+  if(ABI != ABIArgInfo::Reference &&
+     ABI != ABIArgInfo::ExpandCharacterPutLengthToAdditionalArgsAsInt &&
+     !Arg->getType()->isArrayType())
+    return;
+
+  // A dummy argument which is defined by the procedure can't be
+  // accessed through any other name during the call, and can't
+  // be referenced after the call unless it's a target.
+  if(MayBeAliased(Arg))
+    return;
+  Attributes.addAttribute(llvm::Attribute::NoAlias);
+  Attributes.addAttribute(llvm::Attribute::NoCapture);
+  if(IsIntentInArgument(Arg))
+    Attributes.addAttribute(llvm::Attribute::ReadOnly);
+}
+
 void CodeGenFunction::EmitFunctionArguments(const FunctionDecl *Func,
                                             const CGFunctionInfo *Info) {
   ArgsList = Func->getArguments();
@@ -75,16 +134,21 @@ void CodeGenFunction::EmitFunctionArguments(const FunctionDecl *Func,
       AArg.A1 = Arg;
       ExpandedArgs.push_back(AArg);
     }
+    else if(ABI == ABIArgInfo::ArrayDescriptor) {
+      AssumedShapeArg AArg;
+      AArg.Decl = ArgDecl;
+      AArg.Descriptor = Arg;
+      AssumedShapeArgs.push_back(AArg);
+    }
     else
       LocalVariables.insert(std::make_pair(ArgDecl, Arg));
 
     Arg->setName(ArgDecl->getName());
-    if(ArgDecl->getType()->isArrayType() ||
-       ABI == ABIArgInfo::Reference) {
-      llvm::AttrBuilder Attributes;
-      Attributes.addAttribute(llvm::Attribute::NoAlias);
-      Arg->addAttr(llvm::AttributeSet::get(CGM.getLLVMContext(), 0, Attributes));
-    }
+    llvm::AttrBuilder Attributes;
+    GetArgumentAttributes(ArgDecl, ABI, Attributes);
+    if(Attributes.hasAttributes())
+      Arg->addAttr(llvm::AttributeSet::get(CGM.getLLVMContext(), Arg->getArgNo() + 1,
+                                           Attributes));
   }
 
   // Extra argument for the returned data.
@@ -112,6 +176,8 @@ void CodeGenFunction::EmitFunctionPrologue(const FunctionDecl *Func,
     if(Arg->getType()->isCharacterType())
       GetCharacterArg(Arg);
   }
+  for(auto &Arg : AssumedShapeArgs)
+    EmitAssumedShapeArg(Arg);
 
   // Create return value and lbock
   auto RetABI = Info->getReturnInfo().ABIInfo.getKind();
@@ -122,12 +188,88 @@ void CodeGenFunction::EmitFunctionPrologue(const FunctionDecl *Func,
   ReturnBlock = createBasicBlock("return");
 }
 
+void CodeGenFunction::EmitAssumedShapeArg(AssumedShapeArg &Arg) {
+  auto ATy = Arg.Decl->getType()->asArrayType();
+  auto Base = Builder.CreateLoad(Builder.CreateStructGEP(nullptr, Arg.Descriptor, 0),
+                                 llvm::Twine(Arg.Decl->getName()) + ".base");
+  DecorateAccessWithTBAA(Base, CGM.getTBAADescriptorInfo());
+  LocalVariables.insert(std::make_pair(Arg.Decl, Base));
+
+  // The byte strides are converted to the element strides
+  // using the element size of the declared type.
+  auto ElementSize = llvm::ConstantInt::get(CGM.SizeTy,
+                       CGM.getDataLayout().getTypeStoreSize(ConvertTypeForMem(ATy->getElementType())));
+  auto DimsPtr = Builder.CreateStructGEP(nullptr, Arg.Descriptor, 2);
+  auto Dims = ATy->getDimensions();
+  llvm::Value *Stride = nullptr;
+  for(size_t I = 0; I < Dims.size(); ++I) {
+    llvm::Value *ExtentIdx[] = { Builder.getInt32(0), Builder.getInt32(I), Builder.getInt32(1) };
+    llvm::Value *StrideIdx[] = { Builder.getInt32(0), Builder.getInt32(I), Builder.getInt32(2) };
+    auto Extent = Builder.CreateLoad(Builder.CreateInBoundsGEP(DimsPtr, ExtentIdx));
+    DecorateAccessWithTBAA(Extent, CGM.getTBAADescriptorInfo());
+    auto LowerBound = Dims[I]->getLowerBoundOrNull();
+    auto LB = LowerBound? EmitSizeIntExpr(LowerBound) : nullptr;
+    auto UB = LB? Builder.CreateSub(Builder.CreateAdd(LB, Extent),
+                                    llvm::ConstantInt::get(CGM.SizeTy, 1)) :
+                  Extent;
+    if(ContiguousVersionOf) {
+      Arg.Dimensions.push_back(ArrayDimensionValueTy(LB, UB, Stride));
+      Stride = Stride? Builder.CreateMul(Stride, Extent) : Extent;
+    } else {
+      auto ByteStride = Builder.CreateLoad(Builder.CreateInBoundsGEP(DimsPtr, StrideIdx));
+      DecorateAccessWithTBAA(ByteStride, CGM.getTBAADescriptorInfo());
+      Arg.Dimensions.push_back(ArrayDimensionValueTy(LB, UB,
+                                                     Builder.CreateExactSDiv(ByteStride, ElementSize)));
+    }
+  }
+}
+
+bool CodeGenFunction::IsStridedArrayArg(const VarDecl *Arg) const {
+  return !ContiguousVersionOf && GetAssumedShapeArg(Arg);
+}
+
+void CodeGenFunction::GetAssumedShapeArgDimensions(const VarDecl *Arg,
+                                                   SmallVectorImpl<ArrayDimensionValueTy> &Dims) const {
+  auto AArg = GetAssumedShapeArg(Arg);
+  assert(AArg && "invalid assumed-shape argument");
+  Dims.append(AArg->Dimensions.begin(), AArg->Dimensions.end());
+}
+
+/// \brief Calls the contiguous version of the current function
+/// and returns when all the assumed-shape arguments are contiguous.
+void CodeGenFunction::EmitContiguousVersionCall() {
+  llvm::Value *IsContiguous = nullptr;
+  for(auto &Arg : AssumedShapeArgs) {
+    auto Cond = EmitArrayIsContiguous(ArrayValueRef(Arg.Dimensions, GetVarPtr(Arg.Decl)));
+    IsContiguous = IsContiguous? Builder.CreateAnd(IsContiguous, Cond) : Cond;
+  }
+  auto ContiguousBB = createBasicBlock("contiguous-call");
+  auto StridedBB = createBasicBlock("strided-body");
+  Builder.CreateCondBr(IsContiguous, ContiguousBB, StridedBB);
+  EmitBlock(ContiguousBB);
+  SmallVector<llvm::Value*, 8> Args;
+  for(auto Arg = CurFn->arg_begin(); Arg != CurFn->arg_end(); ++Arg)
+    Args.push_back(Arg);
+  auto Result = Builder.CreateCall(ContiguousVersion, Args);
+  Result->setCallingConv(ContiguousVersion->getCallingConv());
+  Result->setTailCall();
+  if(CurFn->getReturnType()->isVoidTy())
+    Builder.CreateRetVoid();
+  else
+    Builder.CreateRet(Result);
+  EmitBlock(StridedBB);
+}
+
 void CodeGenFunction::EmitFunctionBody(const DeclContext *DC, const Stmt *S) {
   EmitFunctionDecls(DC);
   auto BodyBB = createBasicBlock("body");
   AllocaInsertPt = Builder.CreateBr(BodyBB);
   EmitBlock(BodyBB);
-  if(HasSavedVariables)
+  if(ContiguousVersion)
+    EmitContiguousVersionCall();
+  if(!AutomaticArrays.empty())
+    EmitAutomaticArrays();
+  if(HasSavedVarInitializers)
     EmitFirstInvocationBlock(DC, S);
   EmitVarInitializers(DC);
   if(S)
@@ -136,7 +278,7 @@ void CodeGenFunction::EmitFunctionBody(const DeclContext *DC, const Stmt *S) {
 
 void CodeGenFunction::EmitFirstInvocationBlock(const DeclContext *DC,
                                                const Stmt *S) {
-  auto GlobalFirstInvocationFlag = CGM.EmitGlobalVariable(CurFn->getName(), "FIRST_INVOCATION",
+  auto GlobalFirstInvocationFlag = CGM.EmitGlobalVariable(GetSavedVariablePrefix(), "FIRST_INVOCATION",
                                                           CGM.Int1Ty, Builder.getTrue());
   auto FirstInvocationBB = createBasicBlock("first-invocation");
   auto EndBB = createBasicBlock("first-invocation-end");
@@ -151,6 +293,7 @@ void CodeGenFunction::EmitFirstInvocationBlock(const DeclContext *DC,
 void CodeGenFunction::EmitCleanup() {
   for(auto I : TempHeapAllocations)
     CGM.getSystemRuntime().EmitFree(*this, I);
+  EmitAllocatableArraysCleanup();
 }
 
 void CodeGenFunction::EmitFunctionEpilogue(const FunctionDecl *Func,
@@ -181,6 +324,13 @@ llvm::Value *CodeGenFunction::GetVarPtr(const VarDecl *D) {
   return LocalVariables[D];
 }
 
+llvm::Value *CodeGenFunction::SetVarPtr(const VarDecl *D, llvm::Value *Ptr) {
+  auto &Storage = LocalVariables[D];
+  auto Prev = Storage;
+  Storage = Ptr;
+  return Prev;
+}
+
 llvm::Value *CodeGenFunction::GetRetVarPtr() {
   return ReturnValuePtr;
 }
@@ -216,6 +366,14 @@ llvm::Value *CodeGenFunction::CreateTempHeapAlloca(llvm::Value *Size, llvm::Type
   return P->getType() != PtrType? Builder.CreateBitCast(P, PtrType) : P;
 }
 
+void CodeGenFunction::FreeTempHeapAlloca(llvm::Value *Ptr) {
+  Ptr = Ptr->stripPointerCasts();
+  auto I = std::find(TempHeapAllocations.begin(), TempHeapAllocations.end(), Ptr);
+  assert(I != TempHeapAllocations.end() && "not a temporary heap allocation");
+  TempHeapAllocations.erase(I);
+  CGM.getSystemRuntime().EmitFree(*this, Ptr);
+}
+
 llvm::Value *CodeGenFunction::GetIntrinsicFunction(int FuncID,
                                                    ArrayRef<llvm::Type*> ArgTypes) const {
   return llvm::Intrinsic::getDeclaration(&CGM.getModule(),
@@ -24,6 +24,7 @@
 #include "flang/Frontend/CodeGenOptions.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/IR/ValueHandle.h"
@@ -32,6 +33,7 @@ namespace llvm {
   class BasicBlock;
   class LLVMContext;
   class MDNode;
+  class Metadata;
   class Module;
   class SwitchInst;
   class Twine;
@@ -90,6 +92,30 @@ class CodeGenFunction {
     return ExpandedArg();
   }
 
+  /// AssumedShapeArg - the descriptor and the dimensions
+  /// of an assumed-shape array argument.
+  struct AssumedShapeArg {
+    const VarDecl *Decl;
+    llvm::Value *Descriptor;
+    SmallVector<ArrayDimensionValueTy, 4> Dimensions;
+  };
+  llvm::SmallVector<AssumedShapeArg, 4> AssumedShapeArgs;
+
+  const AssumedShapeArg *GetAssumedShapeArg(const VarDecl *Arg) const {
+    for(auto &I : AssumedShapeArgs) {
+      if(I.Decl == Arg) return &I;
+    }
+    return nullptr;
+  }
+
+  /// ContiguousVersion - the version of the current function which
+  /// is called when all the assumed-shape arguments are contiguous.
+  llvm::Function *ContiguousVersion;
+
+  /// ContiguousVersionOf - the function which calls the current
+  /// function when all the assumed-shape arguments are contiguous.
+  llvm::Function *ContiguousVersionOf;
+
   llvm::DenseMap<const VarDecl*, llvm::Value*>   LocalVariables;
   llvm::DenseMap<const VarDecl*, CharacterValueTy> CharacterArgs;
   struct EquivSet {
@@ -102,7 +128,13 @@ class CodeGenFunction {
   llvm::Value *ReturnValuePtr;
   llvm::Instruction *AllocaInsertPt;
 
-  bool HasSavedVariables;
+  /// HasSavedVarInitializers - true if some saved variables have
+  /// initializers which are evaluated on the first invocation.
+  bool HasSavedVarInitializers;
+
+  /// StaticallyInitializedVars - the variables whose initializers
+  /// are emitted as the initializers of their global variables.
+  llvm::SmallPtrSet<const VarDecl*, 8> StaticallyInitializedVars;
 
   llvm::DenseMap<const Stmt*, llvm::BasicBlock*> GotoTargets;
   llvm::SmallVector<const Stmt*, 8> AssignedGotoTargets;
@@ -111,8 +143,20 @@ class CodeGenFunction {
 
   llvm::SmallVector<llvm::Value*, 8> TempHeapAllocations;
 
+  /// AutomaticArrays - the local arrays which have a variable size or
+  /// are too large for the stack. They are allocated after the declarations.
+  llvm::SmallVector<const VarDecl*, 4> AutomaticArrays;
+
+  /// AllocatableArrays - the local allocatable arrays, which are
+  /// deallocated when the function returns.
+  llvm::SmallVector<const VarDecl*, 4> AllocatableArrays;
+
   bool IsMainProgram;
 
+  /// DoVarValues - the induction variables of the DO loops
+  /// which are used to read the loops' DO variables.
+  llvm::SmallDenseMap<const VarDecl*, llvm::Value*, 4> DoVarValues;
+
 protected:
   const LoopScope *CurLoopScope;
   friend class LoopScope;
@@ -184,6 +228,27 @@ public:
   }
 
   llvm::Value *GetVarPtr(const VarDecl *D);
+
+  /// \brief Sets the storage of the given variable and returns the
+  /// previous storage. The variable of an implied do in an array
+  /// constructor uses its own storage inside of the implied do.
+  llvm::Value *SetVarPtr(const VarDecl *D, llvm::Value *Ptr);
+
+  /// \brief Returns the value of the given DO variable inside of
+  /// its DO loop, or null if the variable has to be loaded.
+  llvm::Value *GetDoVarValue(const VarDecl *D) const {
+    auto Result = DoVarValues.find(D);
+    return Result != DoVarValues.end()? Result->second : nullptr;
+  }
+
+  /// \brief Sets the value of the given DO variable and returns
+  /// the previous value.
+  llvm::Value *SetDoVarValue(const VarDecl *D, llvm::Value *Val) {
+    auto Prev = GetDoVarValue(D);
+    if(Val) DoVarValues[D] = Val;
+    else DoVarValues.erase(D);
+    return Prev;
+  }
   llvm::Value *GetRetVarPtr();
   const VarDecl *GetExternalFunctionArgument(const FunctionDecl *Func);
 
@@ -193,12 +258,40 @@ public:
   /// \brief Returns the value of the given character argument.
   CharacterValueTy GetCharacterArg(const VarDecl *Arg);
 
+  /// \brief Returns true if the elements of the given assumed-shape
+  /// argument may be strided in the current function.
+  bool IsStridedArrayArg(const VarDecl *Arg) const;
+
+  /// \brief Gets the dimensions of the given assumed-shape argument
+  /// from its descriptor.
+  void GetAssumedShapeArgDimensions(const VarDecl *Arg,
+                                    SmallVectorImpl<ArrayDimensionValueTy> &Dims) const;
+
+  /// \brief Sets the version of the current function which is called
+  /// when all the assumed-shape arguments are contiguous.
+  void setContiguousVersion(llvm::Function *Fn) {
+    ContiguousVersion = Fn;
+  }
+
+  /// \brief Marks the current function as the version of the given
+  /// function which assumes that the assumed-shape arguments are contiguous.
+  void setContiguousVersionOf(llvm::Function *Fn) {
+    ContiguousVersionOf = Fn;
+  }
+
+  /// \brief Returns the prefix of the names of the saved variables.
+  StringRef GetSavedVariablePrefix() const {
+    return ContiguousVersionOf? ContiguousVersionOf->getName() : CurFn->getName();
+  }
+
   void EmitFunctionDecls(const DeclContext *DC);
   void EmitMainProgramBody(const DeclContext *DC, const Stmt *S);
   void EmitFunctionArguments(const FunctionDecl *Func,
                              const CGFunctionInfo *Info);
   void EmitFunctionPrologue(const FunctionDecl *Func,
                             const CGFunctionInfo *Info);
+  void EmitAssumedShapeArg(AssumedShapeArg &Arg);
+  void EmitContiguousVersionCall();
   void EmitFunctionBody(const DeclContext *DC, const Stmt *S);
   void EmitFunctionEpilogue(const FunctionDecl *Func,
                             const CGFunctionInfo *Info);
@@ -209,6 +302,9 @@ public:
   void EmitVarInitializers(const DeclContext *DC);
   void EmitSavedVarInitializers(const DeclContext *DC);
   void EmitVarInitializer(const VarDecl *D);
+  llvm::Constant *EmitStaticVarInitializer(const VarDecl *D);
+  llvm::Constant *EmitStaticScalarInitializer(const Expr *E, QualType T,
+                                              llvm::Type *MemTy);
   void EmitFirstInvocationBlock(const DeclContext *DC, const Stmt *S);
 
   std::pair<int64_t, int64_t> GetObjectBounds(const VarDecl *Var, const Expr *E);
@@ -218,10 +314,40 @@ public:
   void EmitCommonBlock(const CommonBlockSet *S);
 
 
+  /// CreateArrayAlloca - Allocates an array with a constant size on the
+  /// stack. Returns null when the size isn't constant, or when the
+  /// array is larger than the maximum size of a stack variable.
   llvm::Value *CreateArrayAlloca(QualType T,
                                  const llvm::Twine &Name = "",
                                  bool IsTemp = false);
 
+  /// EmitAutomaticArrays - Allocates the local arrays which couldn't be
+  /// allocated by CreateArrayAlloca. The arrays which fit below the maximum
+  /// size of a stack variable are allocated on the stack, and the others
+  /// share a single heap allocation, which is freed at the function's exit.
+  void EmitAutomaticArrays();
+
+  /// EmitAllocatableArray - Creates the descriptor of an allocatable
+  /// array. The array is unallocated until an ALLOCATE statement.
+  void EmitAllocatableArray(const VarDecl *D);
+
+  /// GetAllocatableArrayDimensions - Loads the dimensions of an
+  /// allocatable array from its descriptor.
+  void GetAllocatableArrayDimensions(const VarDecl *D,
+                                     SmallVectorImpl<ArrayDimensionValueTy> &Dims);
+
+  /// EmitAllocatableArrayPtr - Returns the pointer to the first element
+  /// of an allocatable array, which is null when it isn't allocated.
+  llvm::Value *EmitAllocatableArrayPtr(const VarDecl *D);
+
+  /// EmitArrayDeallocation - Returns the memory of an allocatable array
+  /// to the runtime.
+  void EmitArrayDeallocation(const VarDecl *D);
+
+  /// EmitAllocatableArraysCleanup - Deallocates the local allocatable
+  /// arrays which are still allocated.
+  void EmitAllocatableArraysCleanup();
+
   /// CreateTempAlloca - This creates a alloca and inserts it into the entry
   /// block. The caller is responsible for setting an appropriate alignment on
   /// the alloca.
@@ -234,6 +360,11 @@ public:
 
   llvm::Value *CreateTempHeapAlloca(llvm::Value *Size, llvm::Type *PtrType);
 
+  /// FreeTempHeapAlloca - This frees an object which was allocated using
+  /// CreateTempHeapAlloca before the function returns, so that the
+  /// temporaries which are allocated in a loop don't accumulate.
+  void FreeTempHeapAlloca(llvm::Value *Ptr);
+
   llvm::Value *CreateTempHeapArrayAlloca(QualType T,
                                          llvm::Value *Size);
 
@@ -246,6 +377,10 @@ public:
                                llvm::BasicBlock *ElseBB);
 
   void EmitStmt(const Stmt *S);
+
+  /// EmitStmts - Emits a list of statements, fusing the adjacent
+  /// array assignments when -farray-fusion is enabled.
+  void EmitStmts(ArrayRef<Stmt*> Stmts);
   void EmitStmtLabel(const Stmt *S);
   llvm::BasicBlock *GetGotoTarget(const Stmt *S);
 
@@ -255,6 +390,12 @@ public:
   void EmitAssignedGotoDispatcher();
   void EmitComputedGotoStmt(const ComputedGotoStmt *S);
   void EmitIfStmt(const IfStmt *S);
+  llvm::MDNode *CreateLoopID(ArrayRef<llvm::Metadata*> Hints = None);
+  void EmitLoopHints(const LoopHints *Hints, llvm::BasicBlock *Header,
+                     llvm::BasicBlock *LoopEnd, llvm::BranchInst *BackEdge);
+  void EmitPrefetches(const LoopHints *Hints);
+  llvm::Value *EmitDoIterationCount(llvm::Value *InitValue, llvm::Value *EndValue,
+                                    llvm::Value *IncValue, bool HasIncrement);
   void EmitDoStmt(const DoStmt *S);
   void EmitDoWhileStmt(const DoWhileStmt *S);
   void EmitCycleStmt(const CycleStmt *S);
@@ -264,6 +405,8 @@ public:
   void EmitStopStmt(const StopStmt *S);
   void EmitReturnStmt(const ReturnStmt *S);
   void EmitCallStmt(const CallStmt *S);
+  void EmitAllocateStmt(const AllocateStmt *S);
+  void EmitDeallocateStmt(const DeallocateStmt *S);
   void EmitAssignmentStmt(const AssignmentStmt *S);
   void EmitAssignment(const Expr *LHS, const Expr *RHS);
   void EmitAssignment(LValueTy LHS, RValueTy RHS);
@@ -279,6 +422,18 @@ public:
   RValueTy EmitUnaryExpr(UnaryExpr::Operator Op, RValueTy Val);
   RValueTy EmitImplicitConversion(RValueTy Val, QualType T);
 
+  /// IsStorageAssociated - Returns true if the given pointer may point to
+  /// the storage of a COMMON block or an EQUIVALENCE set, whose objects can
+  /// be accessed using different types.
+  bool IsStorageAssociated(llvm::Value *Ptr);
+
+  /// DecorateAccessWithTBAA - Attaches the TBAA access tag to the given load
+  /// or store unless it accesses storage associated objects.
+  void DecorateAccessWithTBAA(llvm::Instruction *Access, llvm::MDNode *TBAAInfo);
+  void DecorateAccessWithTBAA(llvm::Instruction *Access, QualType T) {
+    DecorateAccessWithTBAA(Access, CGM.getTBAAInfo(T));
+  }
+
   llvm::Constant *EmitConstantExpr(const Expr *E);
 
   // scalar expressions.
@@ -297,7 +452,10 @@ public:
   llvm::Value *EmitScalarBinaryExpr(BinaryExpr::Operator Op,
                                     llvm::Value *LHS,
                                     llvm::Value *RHS);
+  llvm::Value *EmitScalarPowConstant(llvm::Value *Base, uint64_t Exponent);
   llvm::Value *EmitScalarPowIntInt(llvm::Value *LHS, llvm::Value *RHS);
+  llvm::Value *EmitScalarPowRealInt(llvm::Value *LHS, llvm::Value *RHS);
+  llvm::Value *EmitScalarPowRealReal(llvm::Value *LHS, llvm::Value *RHS);
   llvm::Value *EmitIntToInt32Conversion(llvm::Value *Value);
   llvm::Value *EmitSizeIntToIntConversion(llvm::Value *Value);
   llvm::Value *EmitScalarToScalarConversion(llvm::Value *Value, QualType Target);
@@ -337,6 +495,7 @@ public:
   ComplexValueTy EmitComplexBinaryExpr(BinaryExpr::Operator Op, ComplexValueTy LHS,
                                        ComplexValueTy RHS);
   ComplexValueTy EmitComplexDivSmiths(ComplexValueTy LHS, ComplexValueTy RHS);
+  llvm::Value *EmitComplexAbs(ComplexValueTy Value);
   ComplexValueTy EmitComplexPowi(ComplexValueTy LHS, llvm::Value *RHS);
   ComplexValueTy EmitComplexPow(ComplexValueTy LHS, ComplexValueTy RHS);
   ComplexValueTy EmitComplexToComplexConversion(ComplexValueTy Value, QualType Target);
@@ -359,8 +518,10 @@ public:
   RValueTy EmitIntrinsicCallCharacter(intrinsic::FunctionKind Func,
                                       CharacterValueTy Value);
   RValueTy EmitIntrinsicCallCharacter(intrinsic::FunctionKind Func,
-                                      CharacterValueTy A1, CharacterValueTy A2);
+                                      CharacterValueTy A1, CharacterValueTy A2,
+                                      llvm::Value *Back = nullptr);
   llvm::Value *EmitCharacterDereference(CharacterValueTy Value);
+  llvm::Value *EmitCharacterLenTrim(CharacterValueTy Value);
 
   // aggregate expressions
 
@@ -396,8 +557,8 @@ public:
   RValueTy EmitArrayIntrinsic(intrinsic::FunctionKind Func,
                               ArrayRef<Expr*> Arguments);
 
-  RValueTy EmitVectorDimReturningScalarArrayIntrinsic(intrinsic::FunctionKind Func,
-                                                      Expr *Arr);
+  RValueTy EmitMergeIntrinsic(QualType ElementType, llvm::Value *Mask,
+                              RValueTy TSource, RValueTy FSource);
 
 
   // calls
@@ -414,6 +575,11 @@ public:
   RValueTy EmitCall(CGFunction Func,
                     ArrayRef<RValueTy> Arguments);
 
+  /// EmitElementalCall - Emits a call to an elemental function
+  /// for the given elements of the arguments.
+  RValueTy EmitElementalCall(const FunctionDecl *Function,
+                             ArrayRef<RValueTy> Arguments);
+
   RValueTy EmitCall1(CGFunction Func,
                      RValueTy Arg) {
     return EmitCall(Func, Arg);
@@ -483,6 +649,15 @@ public:
   /// EmitArraySize - Emits the number of elements in the given array.
   llvm::Value *EmitArraySize(const ArrayValueRef &Value);
 
+  /// EmitArrayIsContiguous - Emits an i1 value which is true when
+  /// the elements of the given array are stored contiguously.
+  llvm::Value *EmitArrayIsContiguous(const ArrayValueRef &Value);
+
+  /// EmitArrayOperandIsContiguous - Emits the contiguity check for
+  /// the given array operand, which is constant for whole arrays.
+  llvm::Value *EmitArrayOperandIsContiguous(const Expr *E,
+                                            const ArrayValueRef &Value);
+
   ArrayDimensionValueTy EmitArrayRangeSection(const ArrayDimensionValueTy &Dim,
                                               llvm::Value *&Ptr, llvm::Value *&Offset,
                                               llvm::Value *LB, llvm::Value *UB,
@@ -497,11 +672,38 @@ public:
   void GetArrayDimensionsInfo(QualType T, SmallVectorImpl<ArrayDimensionValueTy> &Dims);
 
   llvm::Value *EmitArrayArgumentPointerValueABI(const Expr *E);
+
+  /// EmitArrayArgumentDescriptorABI - Emits the descriptor
+  /// for an assumed-shape array argument.
+  llvm::Value *EmitArrayArgumentDescriptorABI(const Expr *E);
+
+  /// EmitArrayArgumentPackABI - Emits the pointer to a strided array
+  /// argument, which is packed into a contiguous temporary array unless
+  /// the section is contiguous at runtime.
+  llvm::Value *EmitArrayArgumentPackABI(CallArgList &Args,
+                                        const ImplicitArrayPackExpr *E);
+
+  /// EmitArrayArgumentWritebacks - Unpacks and frees the temporary
+  /// arrays created for the strided array arguments of a call.
+  void EmitArrayArgumentWritebacks(const CallArgList &Args);
   llvm::Constant *EmitConstantArrayExpr(const ArrayConstructorExpr *E);
   llvm::Value *EmitConstantArrayConstructor(const ArrayConstructorExpr *E);
   ArrayVectorValueTy EmitTempArrayConstructor(const ArrayConstructorExpr *E);
   ArrayVectorValueTy EmitArrayConstructor(const ArrayConstructorExpr *E);
-  void EmitArrayAssignment(const Expr *LHS, const Expr *RHS);
+  void EmitArrayAssignment(const Expr *LHS, const Expr *RHS,
+                           const LoopHints *Hints = nullptr);
+
+  /// EmitFusedArrayAssignments - Emits the leading array assignments
+  /// from the given statements in a single multidimensional loop.
+  /// Returns the number of emitted statements, or 0 if less than
+  /// two statements can be fused.
+  size_t EmitFusedArrayAssignments(ArrayRef<Stmt*> Stmts);
+
+  /// DumpFusedArrayLoops - Prints the IR of a fused loop nest,
+  /// for -fdump-array-fusion.
+  void DumpFusedArrayLoops(size_t Count, ArrayRef<uint64_t> Shape,
+                           llvm::BasicBlock *PreheaderBB,
+                           llvm::BasicBlock *EndBB);
 };
 
 }  // end namespace CodeGen
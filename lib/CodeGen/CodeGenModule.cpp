@@ -15,6 +15,7 @@
 #include "CodeGenFunction.h"
 #include "CGIORuntime.h"
 #include "CGSystemRuntime.h"
+#include "CodeGenTBAA.h"
 #include "flang/AST/ASTContext.h"
 #include "flang/AST/Decl.h"
 #include "flang/AST/DeclVisitor.h"
@@ -41,7 +42,7 @@ CodeGenModule::CodeGenModule(ASTContext &C, const CodeGenOptions &CGO,
                              DiagnosticsEngine &diags)
   : Context(C), LangOpts(C.getLangOpts()), CodeGenOpts(CGO), TheModule(M),
     Diags(diags), TheDataLayout(TD), VMContext(M.getContext()), Types(*this),
-    TheTargetCodeGenInfo(nullptr) {
+    TheTargetCodeGenInfo(nullptr), TBAA(nullptr) {
 
   llvm::LLVMContext &LLVMContext = M.getContext();
   VoidTy = llvm::Type::getVoidTy(LLVMContext);
@@ -60,11 +61,39 @@ CodeGenModule::CodeGenModule(ASTContext &C, const CodeGenOptions &CGO,
 
   IORuntime = CreateLibflangIORuntime(*this);
   SystemRuntime = CreateLibflangSystemRuntime(*this);
+
+  // Enable TBAA unless it's suppressed.
+  if(CodeGenOpts.OptimizationLevel > 0 && !CodeGenOpts.RelaxedAliasing)
+    TBAA = new CodeGenTBAA(LLVMContext);
 }
 
 CodeGenModule::~CodeGenModule() {
   if(IORuntime)
     delete IORuntime;
+  delete TBAA;
+}
+
+llvm::MDNode *CodeGenModule::getTBAAInfo(QualType T) {
+  if(!TBAA || T.isNull())
+    return nullptr;
+  return TBAA->getAccessTagInfo(TBAA->getTypeInfo(T));
+}
+
+llvm::MDNode *CodeGenModule::getTBAAComplexInfo() {
+  if(!TBAA)
+    return nullptr;
+  return TBAA->getAccessTagInfo(TBAA->getComplexTypeInfo());
+}
+
+llvm::MDNode *CodeGenModule::getTBAADescriptorInfo() {
+  if(!TBAA)
+    return nullptr;
+  return TBAA->getAccessTagInfo(TBAA->getDescriptorTypeInfo());
+}
+
+void CodeGenModule::DecorateInstructionWithTBAA(llvm::Instruction *Inst,
+                                                llvm::MDNode *TBAAInfo) {
+  Inst->setMetadata(llvm::LLVMContext::MD_tbaa, TBAAInfo);
 }
 
 void CodeGenModule::Release() {
@@ -118,6 +147,26 @@ CodeGenModule::GetRuntimeFunction(StringRef Name,
   return Result;
 }
 
+/// \brief Returns true if a pure function can't modify any memory which
+/// is visible to the caller, i.e. when the result is returned by value
+/// and all the dummy arguments are declared with INTENT(IN).
+static bool IsReadOnlyFunction(const FunctionDecl *Function,
+                               const CGFunctionInfo *Info) {
+  if(Function->isSubroutine() ||
+     Info->getReturnInfo().ABIInfo.getKind() != ABIRetInfo::Value)
+    return false;
+  for(auto Arg : Function->getArguments()) {
+    auto T = Arg->getType();
+    if(T.getQualifiers().getIntentAttr() == Qualifiers::IS_in)
+      continue;
+    auto ATy = T->asArrayType();
+    if(!ATy ||
+       ATy->getElementType().getQualifiers().getIntentAttr() != Qualifiers::IS_in)
+      return false;
+  }
+  return true;
+}
+
 CGFunction CodeGenModule::GetFunction(const FunctionDecl *Function) {
   auto SearchResult = Functions.find(Function);
   if(SearchResult != Functions.end())
@@ -131,6 +180,22 @@ CGFunction CodeGenModule::GetFunction(const FunctionDecl *Function) {
                                      &TheModule);
 
   Func->setCallingConv(FunctionInfo->getCallingConv());
+
+  // A pure procedure has no side effects, so the calls of a pure function
+  // can be eliminated, hoisted out of loops and vectorized. Sema rejects
+  // the pure procedures which modify the variables in common blocks or
+  // the INTENT(IN) arguments, have saved variables or call impure
+  // procedures, so a pure function only reads the memory which isn't
+  // local to it. The elemental functions are called for each element
+  // of an array expression, so they are inlined into its loop when possible.
+  if(Function->isPure()) {
+    Func->addFnAttr(llvm::Attribute::NoUnwind);
+    if(IsReadOnlyFunction(Function, FunctionInfo))
+      Func->setOnlyReadsMemory();
+  }
+  if(Function->isElemental())
+    Func->addFnAttr(llvm::Attribute::InlineHint);
+
   auto Result = CGFunction(FunctionInfo, Func);
   Functions.insert(std::make_pair(Function, Result));
   return Result;
@@ -164,30 +229,69 @@ void CodeGenModule::EmitMainProgramDecl(const MainProgramDecl *Program) {
   CGF.EmitMainProgramBody(Program, Program->getBody());
 }
 
+static bool HasAssumedShapeArguments(const FunctionDecl *Function) {
+  for(auto Arg : Function->getArguments()) {
+    auto ATy = Arg->getType()->asArrayType();
+    if(ATy && ATy->isAssumedShape())
+      return true;
+  }
+  return false;
+}
+
 void CodeGenModule::EmitFunctionDecl(const FunctionDecl *Function) {
   auto FuncInfo = GetFunction(Function);
+  auto Func = FuncInfo.getFunction();
 
-  CodeGenFunction CGF(*this, FuncInfo.getFunction());
+  // The body of a function with assumed-shape arguments is emitted
+  // once more in a function which assumes that all these arguments
+  // are contiguous. The function is called when the runtime
+  // check of the strides passes.
+  llvm::Function *ContiguousFunc = nullptr;
+  if(HasAssumedShapeArguments(Function)) {
+    ContiguousFunc = llvm::Function::Create(Func->getFunctionType(),
+                                            llvm::GlobalValue::InternalLinkage,
+                                            llvm::Twine(Func->getName()) + ".contiguous",
+                                            &TheModule);
+    ContiguousFunc->setCallingConv(Func->getCallingConv());
+    ContiguousFunc->setAttributes(Func->getAttributes());
+  }
+
+  CodeGenFunction CGF(*this, Func);
+  CGF.setContiguousVersion(ContiguousFunc);
   CGF.EmitFunctionArguments(Function, FuncInfo.getInfo());
   CGF.EmitFunctionPrologue(Function, FuncInfo.getInfo());
   CGF.EmitFunctionBody(Function, Function->getBody());
   CGF.EmitFunctionEpilogue(Function, FuncInfo.getInfo());
+
+  if(ContiguousFunc) {
+    CodeGenFunction ContiguousCGF(*this, ContiguousFunc);
+    ContiguousCGF.setContiguousVersionOf(Func);
+    ContiguousCGF.EmitFunctionArguments(Function, FuncInfo.getInfo());
+    ContiguousCGF.EmitFunctionPrologue(Function, FuncInfo.getInfo());
+    ContiguousCGF.EmitFunctionBody(Function, Function->getBody());
+    ContiguousCGF.EmitFunctionEpilogue(Function, FuncInfo.getInfo());
+  }
 }
 
 llvm::GlobalVariable *CodeGenModule::EmitGlobalVariable(StringRef FuncName, const VarDecl *Var,
                                                         llvm::Constant *Initializer) {
   auto T = getTypes().ConvertTypeForMem(Var->getType());
-  return new llvm::GlobalVariable(TheModule, T,
-                                  false, llvm::GlobalValue::InternalLinkage,
-                                  llvm::Constant::getNullValue(T),
-                                  llvm::Twine(FuncName) + Var->getName() + "_");
+  return EmitGlobalVariable(FuncName, Var->getName(), T,
+                            Initializer? Initializer :
+                                         llvm::Constant::getNullValue(T));
 }
 
 llvm::GlobalVariable *CodeGenModule::EmitGlobalVariable(StringRef FuncName, StringRef VarName,
                                                         llvm::Type *Type, llvm::Constant *Initializer) {
+  // The saved variables are shared by the versions of a function.
+  llvm::SmallString<32> Name(FuncName);
+  Name.append(VarName);
+  Name.push_back('_');
+  if(auto Var = TheModule.getGlobalVariable(Name, true))
+    return Var;
   return new llvm::GlobalVariable(TheModule, Type,
                                   false, llvm::GlobalValue::InternalLinkage, Initializer,
-                                  llvm::Twine(FuncName) + VarName + "_");
+                                  llvm::Twine(Name));
 }
 
 llvm::Value *CodeGenModule::EmitConstantArray(llvm::Constant *Array) {
@@ -35,6 +35,8 @@ namespace llvm {
   class Function;
   class GlobalValue;
   class DataLayout;
+  class Instruction;
+  class MDNode;
   class FunctionType;
   class LLVMContext;
 }
@@ -55,6 +57,7 @@ namespace CodeGen {
 
   class CGIORuntime;
   class CGSystemRuntime;
+  class CodeGenTBAA;
 
 struct CodeGenTypeCache {
   /// void
@@ -124,6 +127,7 @@ class CodeGenModule : public CodeGenTypeCache {
   const TargetCodeGenInfo *TheTargetCodeGenInfo;
   CGIORuntime *IORuntime;
   CGSystemRuntime *SystemRuntime;
+  CodeGenTBAA *TBAA;
 
   /// RuntimeFunctions - contains all the runtime functions
   /// used in this module.
@@ -146,6 +150,8 @@ public:
 
   llvm::LLVMContext &getLLVMContext() const { return VMContext; }
 
+  const CodeGenOptions &getCodeGenOpts() const { return CodeGenOpts; }
+
   const llvm::DataLayout &getDataLayout() const {
     return TheDataLayout;
   }
@@ -172,6 +178,23 @@ public:
     return *SystemRuntime;
   }
 
+  /// getTBAAInfo - Returns the TBAA access tag for the storage of the given
+  /// type, or null when the type based alias analysis is disabled.
+  llvm::MDNode *getTBAAInfo(QualType T);
+
+  /// getTBAAComplexInfo - Returns the TBAA access tag for the parts of the
+  /// complex values.
+  llvm::MDNode *getTBAAComplexInfo();
+
+  /// getTBAADescriptorInfo - Returns the TBAA access tag for the fields of the
+  /// array descriptors.
+  llvm::MDNode *getTBAADescriptorInfo();
+
+  /// DecorateInstructionWithTBAA - Attaches the given TBAA access tag to the
+  /// load or store.
+  void DecorateInstructionWithTBAA(llvm::Instruction *Inst,
+                                   llvm::MDNode *TBAAInfo);
+
   /// getTargetCodeGenInfo - Retun a reference to the configured
   /// target code gen information.
   const TargetCodeGenInfo &getTargetCodeGenInfo();
@@ -0,0 +1,66 @@
+//===--- CodeGenTBAA.cpp - TBAA information for LLVM CodeGen --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This is the code that manages TBAA information and defines the TBAA policy
+// for the optimizer to use.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeGenTBAA.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Metadata.h"
+
+namespace flang {
+namespace CodeGen {
+
+CodeGenTBAA::CodeGenTBAA(llvm::LLVMContext &VMContext)
+  : VMContext(VMContext), MDHelper(VMContext) {
+  Root = MDHelper.createTBAARoot("Flang Type TBAA");
+  AnyData = MDHelper.createTBAAScalarTypeNode("any data", Root);
+  Integer = createTypeNode("integer");
+  Real = createTypeNode("real");
+  Complex = createTypeNode("complex");
+  Logical = createTypeNode("logical");
+  Character = createTypeNode("character");
+  Descriptor = createTypeNode("descriptor");
+}
+
+CodeGenTBAA::~CodeGenTBAA() {
+}
+
+llvm::MDNode *CodeGenTBAA::createTypeNode(StringRef Name) {
+  return MDHelper.createTBAAScalarTypeNode(Name, AnyData);
+}
+
+llvm::MDNode *CodeGenTBAA::getTypeInfo(QualType T) {
+  auto Ty = T.getSelfOrArrayElementType();
+  if(Ty->isIntegerType())
+    return Integer;
+  if(Ty->isRealType())
+    return Real;
+  if(Ty->isComplexType())
+    return Complex;
+  if(Ty->isLogicalType())
+    return Logical;
+  if(Ty->isCharacterType())
+    return Character;
+  return nullptr;
+}
+
+llvm::MDNode *CodeGenTBAA::getAccessTagInfo(llvm::MDNode *TypeInfo) {
+  if(!TypeInfo)
+    return nullptr;
+  auto &Tag = AccessTags[TypeInfo];
+  if(!Tag)
+    Tag = MDHelper.createTBAAStructTagNode(TypeInfo, TypeInfo, 0);
+  return Tag;
+}
+
+}  // end namespace CodeGen
+}  // end namespace flang
@@ -0,0 +1,85 @@
+//===--- CodeGenTBAA.h - TBAA information for LLVM CodeGen ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This is the code that manages TBAA information and defines the TBAA policy
+// for the optimizer to use.
+//
+// Fortran doesn't allow storage of one intrinsic type to be accessed as
+// another type, except through storage association (COMMON and EQUIVALENCE),
+// so the type tree separates INTEGER, REAL, COMPLEX, LOGICAL and CHARACTER
+// storage, and the fields of the array descriptors:
+//
+//   Flang Type TBAA
+//     any data
+//       integer, real, complex, logical, character, descriptor
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef FLANG_CODEGEN_CODEGENTBAA_H
+#define FLANG_CODEGEN_CODEGENTBAA_H
+
+#include "flang/AST/Type.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/MDBuilder.h"
+
+namespace llvm {
+  class LLVMContext;
+  class MDNode;
+}
+
+namespace flang {
+namespace CodeGen {
+
+/// CodeGenTBAA - This class creates the TBAA type nodes and access tags of a
+/// module.
+class CodeGenTBAA {
+  llvm::LLVMContext &VMContext;
+
+  /// MDHelper - Helper for creating metadata.
+  llvm::MDBuilder MDHelper;
+
+  /// Root - This is the mdnode for the root of the metadata type graph.
+  llvm::MDNode *Root;
+
+  /// AnyData - This is the mdnode for "any data", which is the parent of
+  /// every type node.
+  llvm::MDNode *AnyData;
+
+  llvm::MDNode *Integer, *Real, *Complex, *Logical, *Character, *Descriptor;
+
+  /// AccessTags - The access tags for every type node.
+  llvm::DenseMap<llvm::MDNode*, llvm::MDNode*> AccessTags;
+
+  llvm::MDNode *createTypeNode(StringRef Name);
+
+public:
+  CodeGenTBAA(llvm::LLVMContext &VMContext);
+  ~CodeGenTBAA();
+
+  /// getTypeInfo - Returns the type node for the storage of the given type,
+  /// or the element type for array types, or null when the type has no node.
+  llvm::MDNode *getTypeInfo(QualType T);
+
+  /// getComplexTypeInfo - Returns the type node for the parts of the complex
+  /// values.
+  llvm::MDNode *getComplexTypeInfo() { return Complex; }
+
+  /// getDescriptorTypeInfo - Returns the type node for the fields of the array
+  /// descriptors.
+  llvm::MDNode *getDescriptorTypeInfo() { return Descriptor; }
+
+  /// getAccessTagInfo - Returns the access tag for a load or store of the
+  /// given type.
+  llvm::MDNode *getAccessTagInfo(llvm::MDNode *TypeInfo);
+};
+
+}  // end namespace CodeGen
+}  // end namespace flang
+
+#endif
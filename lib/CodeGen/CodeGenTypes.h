@@ -102,6 +102,12 @@ public:
   llvm::ArrayType *GetFixedSizeArrayType(const ArrayType *T,
                                          uint64_t Size);
 
+  /// GetArrayDescriptorType - Returns the type of the descriptor
+  /// which is used to pass an assumed-shape array:
+  /// { T* base, size element size, [rank x [3 x size]] }, where each
+  /// dimension stores the lower bound, the extent and the byte stride.
+  llvm::StructType *GetArrayDescriptorType(const ArrayType *T);
+
   llvm::Type *ConvertRecordType(const RecordType *T);
 
   llvm::Type *ConvertFunctionType(const FunctionType *T);
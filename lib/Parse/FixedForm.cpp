@@ -141,7 +141,9 @@ static const tok::TokenKind AmbiguousTopLvlDeclKeywords[] = {
   tok::kw_SUBROUTINE,
   tok::kw_FUNCTION,
   // RECURSIVEfunctionFOO
-  tok::kw_RECURSIVE
+  tok::kw_RECURSIVE,
+  tok::kw_PURE,
+  tok::kw_ELEMENTAL
 };
 
 AmbiguousTopLevelDeclarationStatements::AmbiguousTopLevelDeclarationStatements()
@@ -153,7 +155,7 @@ CommonAmbiguities::CommonAmbiguities() {
       AmbiguousTypeStatements(),
       KeywordFilter(tok::kw_FUNCTION, tok::kw_SUBROUTINE)
     };
-    MatcherForKeywordsAfterRECURSIVE = llvm::makeArrayRef(Filters);
+    MatcherForKeywordsAfterPrefix = llvm::makeArrayRef(Filters);
   }
   {
     const KeywordFilter Filters[] = {
@@ -108,8 +108,22 @@ void Lexer::LineOfText::SetState(const State &S) {
   CurPtr = S.CurPtr;
 }
 
+/// isDirectiveSentinel - Returns true if the comment text which follows
+/// the comment character starts with a directive sentinel (DIR$ or $FLANG).
+static bool isDirectiveSentinel(const char *Ptr) {
+  static const char *const Sentinels[] = { "dir$", "$flang" };
+  for(auto Sentinel : Sentinels) {
+    auto P = Ptr;
+    for(; *Sentinel && ::tolower(*P) == *Sentinel; ++Sentinel, ++P) ;
+    if(!*Sentinel)
+      return true;
+  }
+  return false;
+}
+
 /// SkipBlankLinesAndComments - Helper function that skips blank lines and lines
-/// with only comments.
+/// with only comments. The lines with directives aren't skipped when they
+/// start a new statement, as the comment handlers must see them.
 bool Lexer::LineOfText::
 SkipBlankLinesAndComments(unsigned &I, const char *&LineBegin, bool IgnoreContinuationChar) {
   // Skip blank lines and lines with only comments.
@@ -119,7 +133,8 @@ SkipBlankLinesAndComments(unsigned &I, const char *&LineBegin, bool IgnoreContin
   while (I != 132 && isHorizontalWhitespace(*BufPtr) && *BufPtr != '\0')
     ++I, ++BufPtr;
 
-  if (I != 132 && *BufPtr == '!') {
+  if (I != 132 && *BufPtr == '!' &&
+      !(Atoms.empty() && isDirectiveSentinel(BufPtr + 1))) {
     do {
       ++BufPtr;
     } while (!isVerticalWhitespace(*BufPtr));
@@ -159,7 +174,8 @@ SkipFixedFormBlankLinesAndComments(unsigned &I, const char *&LineBegin) {
     ++BufPtr;
   }
 
-  if(I == 0 && (*BufPtr == 'C' || *BufPtr == 'c' || *BufPtr == '*')) {
+  if(I == 0 && (*BufPtr == 'C' || *BufPtr == 'c' || *BufPtr == '*') &&
+     !isDirectiveSentinel(BufPtr + 1)) {
     do {
       ++BufPtr;
     } while (!isVerticalWhitespace(*BufPtr));
@@ -1260,6 +1276,13 @@ void Lexer::LexComment(Token &Result) {
   }
 }
 
+bool Lexer::isAtStartOfLine(SourceLocation Loc) const {
+  auto Ptr = Text.GetLineBegin();
+  while(Ptr < Loc.getPointer() && isHorizontalWhitespace(*Ptr))
+    ++Ptr;
+  return Ptr == Loc.getPointer();
+}
+
 void Lexer::ReLexStatement(SourceLocation StmtStart) {
   LastTokenWasSemicolon = true;
   setBuffer(CurBuf, StmtStart.getPointer(), false);
@@ -1299,6 +1322,17 @@ void Lexer::LexTokenInternal(Token &Result, bool IsPeekAhead) {
   TokStart = getCurrentPtr();
   tok::TokenKind Kind;
 
+  // The fixed form directives start with a comment character
+  // in the first column, e.g. CDIR$ IVDEP.
+  if(Features.FixedForm && TokStart == getLineBegin() &&
+     (Char == 'C' || Char == 'c' || Char == '*') &&
+     isDirectiveSentinel(TokStart + 1)) {
+    LexComment(Result);
+    if (Features.ReturnComments)
+      return;
+    return LexTokenInternal(Result, IsPeekAhead);
+  }
+
   switch (Char) {
   case 0:  // Null.
     // Found end of file?
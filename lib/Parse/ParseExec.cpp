@@ -45,6 +45,161 @@ void Parser::CheckStmtOrder(SourceLocation Loc, StmtResult SR) {
     PrevStmtWasSelectCase = true;
 }
 
+bool Parser::DirectiveHandler::HandleComment(Lexer &L, const SourceLocation &Loc,
+                                             const llvm::StringRef &Comment) {
+  if(L.isAtStartOfLine(Loc))
+    P.ParseDirective(Loc, Comment);
+  return false;
+}
+
+/// The default number of iterations that the data is prefetched ahead of.
+static const int64_t DefaultPrefetchDistance = 8;
+
+static bool isDirectiveIdentifierChar(char C) {
+  return isalnum(C) || C == '_';
+}
+
+static StringRef LexDirectiveWord(StringRef &Text) {
+  Text = Text.ltrim(" \t");
+  size_t I = 0;
+  while(I < Text.size() && isDirectiveIdentifierChar(Text[I]))
+    ++I;
+  auto Word = Text.substr(0, I);
+  Text = Text.substr(I);
+  return Word;
+}
+
+static bool LexDirectiveInteger(StringRef &Text, uint64_t &Value) {
+  Text = Text.ltrim(" \t");
+  size_t I = 0;
+  while(I < Text.size() && isdigit(Text[I]))
+    ++I;
+  if(!I || Text.substr(0, I).getAsInteger(10, Value))
+    return false;
+  Text = Text.substr(I);
+  return true;
+}
+
+static bool ConsumeDirectiveChar(StringRef &Text, char C) {
+  Text = Text.ltrim(" \t");
+  if(Text.empty() || Text[0] != C)
+    return false;
+  Text = Text.substr(1);
+  return true;
+}
+
+/// ParseDirective - Parse a directive in a comment.
+///
+///   directive :=
+///         !DIR$ IVDEP
+///      or !DIR$ VECTOR [ ALWAYS ]
+///      or !DIR$ NOVECTOR
+///      or !DIR$ UNROLL [ (n) | =n | n ]
+///      or !DIR$ NOUNROLL
+///      or !DIR$ PREFETCH var [ :hint [ :distance ] ] [, var ...]
+///
+/// The sentinel can also be $FLANG, and the fixed form directives
+/// start with a comment character in the first column, e.g. CDIR$.
+void Parser::ParseDirective(SourceLocation Loc, StringRef Text) {
+  // A statement can be lexed more than once, but its
+  // directives must be parsed only once.
+  if(LastDirectiveLoc.isValid() &&
+     Loc.getPointer() <= LastDirectiveLoc.getPointer())
+    return;
+
+  Text = Text.substr(1);
+  if(Text.substr(0, 4).equals_lower("dir$"))
+    Text = Text.substr(4);
+  else if(Text.substr(0, 6).equals_lower("$flang"))
+    Text = Text.substr(6);
+  else return;
+  LastDirectiveLoc = Loc;
+
+  auto Name = LexDirectiveWord(Text);
+  auto NameLoc = SourceLocation::getFromPointer(Name.data());
+  SmallVector<LoopDirective, 2> Parsed;
+  LoopDirective D = LoopDirective();
+  D.Loc = Loc;
+  bool IsValid = true;
+
+  if(Name.equals_lower("ivdep")) {
+    D.Kind = LoopHints::IVDep;
+    Parsed.push_back(D);
+  } else if(Name.equals_lower("vector")) {
+    auto Clause = LexDirectiveWord(Text);
+    IsValid = Clause.empty() || Clause.equals_lower("always");
+    D.Kind = LoopHints::VectorAlways;
+    Parsed.push_back(D);
+  } else if(Name.equals_lower("novector")) {
+    D.Kind = LoopHints::NoVector;
+    Parsed.push_back(D);
+  } else if(Name.equals_lower("unroll")) {
+    uint64_t Count = 0;
+    bool HasCount;
+    if(ConsumeDirectiveChar(Text, '('))
+      HasCount = IsValid = LexDirectiveInteger(Text, Count) &&
+                           ConsumeDirectiveChar(Text, ')');
+    else if(ConsumeDirectiveChar(Text, '='))
+      HasCount = IsValid = LexDirectiveInteger(Text, Count);
+    else HasCount = LexDirectiveInteger(Text, Count);
+    if(Count > 1024)
+      IsValid = false;
+    // UNROLL(0) and UNROLL(1) disable the unrolling.
+    D.Kind = HasCount && Count <= 1? LoopHints::NoUnroll : LoopHints::Unroll;
+    D.Count = unsigned(Count);
+    Parsed.push_back(D);
+  } else if(Name.equals_lower("nounroll")) {
+    D.Kind = LoopHints::NoUnroll;
+    Parsed.push_back(D);
+  } else if(Name.equals_lower("prefetch")) {
+    do {
+      auto Var = LexDirectiveWord(Text);
+      uint64_t Hint = 0, Distance = DefaultPrefetchDistance;
+      if(Var.empty() || !isalpha(Var[0])) {
+        IsValid = false;
+        break;
+      }
+      if(ConsumeDirectiveChar(Text, ':')) {
+        if(!LexDirectiveInteger(Text, Hint) || Hint > 3 ||
+           (ConsumeDirectiveChar(Text, ':') &&
+            !LexDirectiveInteger(Text, Distance))) {
+          IsValid = false;
+          break;
+        }
+      }
+      std::string VarName = Var;
+      D.Var = getIdentifierInfo(VarName);
+      D.Hint = unsigned(Hint);
+      D.Distance = int64_t(Distance);
+      Parsed.push_back(D);
+    } while(ConsumeDirectiveChar(Text, ','));
+  } else {
+    Diag.Report(NameLoc, diag::warn_unknown_directive) << Name;
+    return;
+  }
+
+  if(!IsValid || !Text.trim().empty()) {
+    Diag.Report(NameLoc, diag::warn_invalid_directive) << Name;
+    return;
+  }
+  PendingLoopDirectives.append(Parsed.begin(), Parsed.end());
+}
+
+/// ActOnPendingLoopDirectives - Passes the directives which precede
+/// the current statement to Sema.
+void Parser::ActOnPendingLoopDirectives() {
+  auto StmtStart = Tok.getLocation().getPointer();
+  auto I = PendingLoopDirectives.begin();
+  for(; I != PendingLoopDirectives.end() &&
+        I->Loc.getPointer() < StmtStart; ++I) {
+    if(I->Var)
+      Actions.ActOnPrefetchDirective(I->Loc, I->Var, I->Hint, I->Distance);
+    else
+      Actions.ActOnLoopDirective(I->Loc, I->Kind, I->Count);
+  }
+  PendingLoopDirectives.erase(PendingLoopDirectives.begin(), I);
+}
+
 /// ParseExecutableConstruct - Parse the executable construct.
 ///
 ///   [R213]:
@@ -60,6 +215,7 @@ void Parser::CheckStmtOrder(SourceLocation Loc, StmtResult SR) {
 ///      or select-type-construct
 ///      or where-construct
 StmtResult Parser::ParseExecutableConstruct() {
+  ActOnPendingLoopDirectives();
   ParseStatementLabel();
   ParseConstructNameLabel();
   LookForExecutableStmtKeyword(StmtLabel || StmtConstructName.isUsable()?
@@ -67,6 +223,7 @@ StmtResult Parser::ParseExecutableConstruct() {
 
   auto Loc = Tok.getLocation();
   StmtResult SR = ParseActionStmt();
+  Actions.DiscardLoopHints();
   CheckStmtOrder(Loc, SR);
   if (SR.isInvalid()) return StmtError();
   if (!SR.isUsable()) return StmtResult();
@@ -167,6 +324,10 @@ Parser::StmtResult Parser::ParseActionStmt() {
     return ParseReturnStmt();
   case tok::kw_CALL:
     return ParseCallStmt();
+  case tok::kw_ALLOCATE:
+    return ParseALLOCATEStmt();
+  case tok::kw_DEALLOCATE:
+    return ParseDEALLOCATEStmt();
   case tok::kw_WHERE:
     return ParseWhereStmt();
   case tok::kw_ELSEWHERE:
@@ -682,8 +843,23 @@ Parser::StmtResult Parser::ParseWhereStmt() {
   return Actions.ActOnWhereStmt(Context, Loc, Mask, StmtLabel);
 }
 
+/// ParseElseWhereStmt - Parse the ELSEWHERE statement.
+///
+///   [R749]:
+///     masked-elsewhere-stmt :=
+///         ELSEWHERE ( mask-expr )
+///   [R750]:
+///     elsewhere-stmt :=
+///         ELSEWHERE
 StmtResult Parser::ParseElseWhereStmt() {
   auto Loc = ConsumeToken();
+  if(ConsumeIfPresent(tok::l_paren)) {
+    auto Mask = ParseExpectedExpression();
+    if(!Mask.isInvalid())
+      ExpectAndConsume(tok::r_paren);
+    else SkipUntil(tok::r_paren);
+    return Actions.ActOnElseWhereStmt(Context, Loc, Mask, StmtLabel);
+  }
   return Actions.ActOnElseWhereStmt(Context, Loc, StmtLabel);
 }
 
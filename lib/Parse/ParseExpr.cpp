@@ -428,8 +428,18 @@ Parser::ExprResult Parser::ParsePrimaryExpr(bool IsLvalue) {
     // complex constant.
     if(ConsumeIfPresent(tok::comma)) {
       if(E.isInvalid()) return E;
+      SmallVector<ExprResult, 8> Body;
+      Body.push_back(E);
+      if(InArrayConstructor && IsPresent(tok::identifier) &&
+         IsNextToken(tok::equal))
+        return ParseArrayConstructorImpliedDo(Loc, Body);
       auto ImPart = ParseExpectedFollowupExpression(",");
       if(ImPart.isInvalid()) return ImPart;
+      // implied-do in an array constructor.
+      if(InArrayConstructor && ConsumeIfPresent(tok::comma)) {
+        Body.push_back(ImPart);
+        return ParseArrayConstructorImpliedDo(Loc, Body);
+      }
       E = Actions.ActOnComplexConstantExpr(Context, Loc,
                                            getMaxLocationOfCurrentToken(),
                                            E, ImPart);
@@ -954,14 +964,24 @@ ExprResult Parser::ParsePartReference() {
   return E;
 }
 
-/// FIXME: todo implied-do
+/// ParseArrayConstructor - Parses an array constructor.
+///
+///   R468:
+///     array-constructor :=
+///         (/ ac-spec /)
+///   R472:
+///     ac-value :=
+///         expr
+///      or ac-implied-do
 ExprResult Parser::ParseArrayConstructor() {
   auto Loc = ConsumeParenSlash();
   SourceLocation EndLoc = Tok.getLocation();
+  auto PrevInArrayConstructor = InArrayConstructor;
 
   SmallVector<Expr*, 16> ExprList;
   if(ConsumeIfPresent(tok::slashr_paren))
     return Actions.ActOnArrayConstructorExpr(Context, Loc, EndLoc, ExprList);
+  InArrayConstructor = true;
   do {
     auto E = ParseExpectedExpression();
     if(E.isInvalid())
@@ -969,6 +989,7 @@ ExprResult Parser::ParseArrayConstructor() {
     if(E.isUsable())
       ExprList.push_back(E.get());
   } while(ConsumeIfPresent(tok::comma));
+  InArrayConstructor = PrevInArrayConstructor;
 
   EndLoc = Tok.getLocation();
   if(!ExpectAndConsume(tok::slashr_paren))
@@ -976,11 +997,57 @@ ExprResult Parser::ParseArrayConstructor() {
 
   return Actions.ActOnArrayConstructorExpr(Context, Loc, EndLoc, ExprList);
 error:
+  InArrayConstructor = PrevInArrayConstructor;
   EndLoc = Tok.getLocation();
   SkipUntil(tok::slashr_paren);
   return Actions.ActOnArrayConstructorExpr(Context, Loc, EndLoc, ExprList);
 }
 
+/// ParseArrayConstructorImpliedDo - Parses the rest of an implied do
+/// in an array constructor, after the first items of its body.
+///
+///   R473:
+///     ac-implied-do :=
+///         ( ac-value-list, ac-implied-do-control )
+///   R474:
+///     ac-implied-do-control :=
+///         ac-do-variable = scalar-int-expr, scalar-int-expr
+///         [, scalar-int-expr]
+ExprResult Parser::ParseArrayConstructorImpliedDo(SourceLocation Loc,
+                                                  SmallVectorImpl<ExprResult> &Body) {
+  while(!(IsPresent(tok::identifier) && IsNextToken(tok::equal))) {
+    auto E = ParseExpectedFollowupExpression(",");
+    if(E.isInvalid()) return E;
+    Body.push_back(E);
+    if(!ExpectAndConsume(tok::comma))
+      return ExprError();
+  }
+
+  auto IDLoc = Tok.getLocation();
+  auto IDInfo = Tok.getIdentifierInfo();
+  ConsumeToken();
+  if(!ExpectAndConsume(tok::equal))
+    return ExprError();
+
+  ExprResult E1, E2, E3;
+  E1 = ParseExpectedFollowupExpression("=");
+  if(E1.isInvalid()) return E1;
+  if(!ExpectAndConsume(tok::comma))
+    return ExprError();
+  E2 = ParseExpectedFollowupExpression(",");
+  if(E2.isInvalid()) return E2;
+  if(ConsumeIfPresent(tok::comma)) {
+    E3 = ParseExpectedFollowupExpression(",");
+    if(E3.isInvalid()) return E3;
+  }
+
+  if(!ExpectAndConsume(tok::r_paren))
+    return ExprError();
+
+  return Actions.ActOnArrayConstructorImpliedDoExpr(Context, Loc, IDLoc, IDInfo,
+                                                    Body, E1, E2, E3);
+}
+
 /// ParseTypeConstructorExpression - Parses a type constructor.
 ExprResult Parser::ParseTypeConstructor(SourceLocation IDLoc, RecordDecl *Record) {
   SmallVector<Expr*, 8> Arguments;
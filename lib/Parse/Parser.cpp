@@ -63,8 +63,10 @@ Parser::Parser(llvm::SourceMgr &SM, const LangOptions &Opts, DiagnosticsEngine
     Context(actions.Context), Diag(D), Actions(actions),
     Identifiers(Opts), DontResolveIdentifiers(false),
     DontResolveIdentifiersInSubExpressions(false),
-    LexFORMATTokens(false), StmtConstructName(SourceLocation(),nullptr) {
+    InArrayConstructor(false), LexFORMATTokens(false),
+    StmtConstructName(SourceLocation(),nullptr), Directives(*this) {
   CurBufferIndex.push_back(SrcMgr.getMainFileID());
+  TheLexer.addCommentHandler(&Directives);
   getLexer().setBuffer(SrcMgr.getMemoryBuffer(CurBufferIndex.back()));
   Tok.startToken();
   NextTok.startToken();
@@ -613,7 +615,9 @@ bool Parser::ParseProgramUnit() {
       ParseMainProgram();
     break;
   case tok::kw_RECURSIVE:
-    ParseRecursiveExternalSubprogram();
+  case tok::kw_PURE:
+  case tok::kw_ELEMENTAL:
+    ParsePrefixedExternalSubprogram();
     break;
   case tok::kw_FUNCTION:
   case tok::kw_SUBROUTINE:
@@ -820,23 +824,65 @@ bool Parser::ParseExternalSubprogram() {
   return ParseExternalSubprogram(ReturnType, FunctionDecl::NoAttributes);
 }
 
+/// \brief Returns the function attribute which is specified by the
+/// given prefix keyword.
+static int GetPrefixAttribute(tok::TokenKind Kind) {
+  switch(Kind) {
+  case tok::kw_RECURSIVE: return FunctionDecl::Recursive;
+  case tok::kw_PURE:      return FunctionDecl::Pure;
+  case tok::kw_ELEMENTAL: return FunctionDecl::Elemental;
+  default: break;
+  }
+  return FunctionDecl::NoAttributes;
+}
+
+static const char *GetPrefixSpelling(tok::TokenKind Kind) {
+  switch(Kind) {
+  case tok::kw_PURE:      return "pure";
+  case tok::kw_ELEMENTAL: return "elemental";
+  default: break;
+  }
+  return "recursive";
+}
+
+/// ParsePrefixSpec - Parses the prefix keywords which weren't given
+/// yet, and adds their attributes to the given attributes. Returns the
+/// last parsed prefix keyword.
+///
+///   [R1226]:
+///     prefix-spec :=
+///         declaration-type-spec
+///      or ELEMENTAL
+///      or PURE
+///      or RECURSIVE
+tok::TokenKind Parser::ParsePrefixSpec(int &Attr) {
+  static const tok::TokenKind PrefixKeywords[] = {
+    tok::kw_RECURSIVE, tok::kw_PURE, tok::kw_ELEMENTAL,
+    tok::kw_FUNCTION, tok::kw_SUBROUTINE
+  };
+  auto LastPrefix = tok::unknown;
+  while(!Tok.isAtStartOfStatement()) {
+    if(Features.FixedForm && Tok.getIdentifierInfo())
+      ReLexAmbiguousIdentifier(fixedForm::KeywordMatcher(fixedForm::KeywordFilter(PrefixKeywords)));
+    auto Prefix = GetPrefixAttribute(Tok.getKind());
+    if(!Prefix || (Attr & Prefix))
+      break;
+    Attr |= Prefix;
+    LastPrefix = Tok.getKind();
+    ConsumeToken();
+  }
+  return LastPrefix;
+}
+
 bool Parser::ParseTypedExternalSubprogram(int Attr) {
   auto ReparseLoc = LocFirstStmtToken;
   DeclSpec ReturnType;
   ParseDeclarationTypeSpec(ReturnType);
-  bool IsRecursive = (Attr & FunctionDecl::Recursive) != 0;
+  bool HasPrefix = Attr != FunctionDecl::NoAttributes;
 
   if(Tok.isAtStartOfStatement())
     goto err;
-  if(!IsRecursive) {
-    if(Features.FixedForm)
-      ReLexAmbiguousIdentifier(fixedForm::KeywordMatcher(fixedForm::KeywordFilter(tok::kw_RECURSIVE,
-                                                                                  tok::kw_FUNCTION)));
-    if(Tok.is(tok::kw_RECURSIVE)) {
-      ConsumeToken();
-      Attr |= FunctionDecl::Recursive;
-    }
-  }
+  ParsePrefixSpec(Attr);
 
   if(Tok.isAtStartOfStatement())
     goto err;
@@ -847,7 +893,7 @@ bool Parser::ParseTypedExternalSubprogram(int Attr) {
     return false;
   }
 err:
-  if(IsRecursive) {
+  if(HasPrefix) {
     Diag.Report(getExpectedLoc(), diag::err_expected_kw)
       << "function";
     SkipUntilNextStatement();
@@ -855,27 +901,29 @@ err:
   return true;
 }
 
-bool Parser::ParseRecursiveExternalSubprogram() {
-  ConsumeToken();
+bool Parser::ParsePrefixedExternalSubprogram() {
+  int Attr = FunctionDecl::NoAttributes;
+  auto LastPrefix = ParsePrefixSpec(Attr);
   if(Tok.isAtStartOfStatement())
     goto err;
 
   if(Features.FixedForm)
-    ReLexAmbiguousIdentifier(FixedFormAmbiguities.getMatcherForKeywordsAfterRECURSIVE());
+    ReLexAmbiguousIdentifier(FixedFormAmbiguities.getMatcherForKeywordsAfterPrefix());
   if(Tok.is(tok::kw_SUBROUTINE) ||
      Tok.is(tok::kw_FUNCTION)) {
     DeclSpec ReturnType;
-    return ParseExternalSubprogram(ReturnType, FunctionDecl::Recursive);
+    return ParseExternalSubprogram(ReturnType, Attr);
   }
 
   if(Tok.is(tok::kw_INTEGER) || Tok.is(tok::kw_REAL) || Tok.is(tok::kw_COMPLEX) ||
      Tok.is(tok::kw_DOUBLEPRECISION) || Tok.is(tok::kw_DOUBLECOMPLEX) ||
      Tok.is(tok::kw_LOGICAL) || Tok.is(tok::kw_CHARACTER) ||
      Tok.is(tok::kw_BYTE) || Tok.is(tok::kw_TYPE) || Tok.is(tok::kw_RECORD))
-    return ParseTypedExternalSubprogram(FunctionDecl::Recursive);
+    return ParseTypedExternalSubprogram(Attr);
 
 err:
-  Diag.Report(getExpectedLoc(), diag::err_expected_after_recursive);
+  Diag.Report(getExpectedLoc(), diag::err_expected_after_prefix)
+    << GetPrefixSpelling(LastPrefix);
   SkipUntilNextStatement();
   return true;
 }
@@ -1210,9 +1258,15 @@ bool Parser::ParseArraySpec(SmallVectorImpl<ArraySpec*> &Dims) {
   //       expr
   //
   //   C708: int-expr shall be of type integer.
+  //
+  // [R519]:
+  //   assumed-shape-spec :=
+  //       [ lower-bound ] :
   do {
     if(IsPresent(tok::star))
       Dims.push_back(ImpliedShapeSpec::Create(Context, ConsumeToken()));
+    else if(ConsumeIfPresent(tok::colon))
+      Dims.push_back(AssumedShapeSpec::Create(Context));
     else {
       ExprResult E = ParseExpression();
       if (E.isInvalid()) goto error;
@@ -1220,6 +1274,8 @@ bool Parser::ParseArraySpec(SmallVectorImpl<ArraySpec*> &Dims) {
         if(IsPresent(tok::star))
           Dims.push_back(ImpliedShapeSpec::Create(Context, ConsumeToken(),
                                                   E.take()));
+        else if(IsPresent(tok::comma) || IsPresent(tok::r_paren))
+          Dims.push_back(AssumedShapeSpec::Create(Context, E.take()));
         else {
           ExprResult E2 = ParseExpression();
           if(E2.isInvalid()) goto error;
@@ -1848,8 +1904,40 @@ Parser::StmtResult Parser::ParseVOLATILEStmt() {
 ///   [R623]:
 ///     allocate-stmt :=
 ///         ALLOCATE ( [ type-spec :: ] alocation-list [ , alloc-opt-list ] )
+///
+///   [R631]:
+///     allocation :=
+///         allocate-object [ ( allocate-shape-spec-list ) ]
+///
+///   [R633]:
+///     allocate-shape-spec :=
+///         [ lower-bound-expr : ] upper-bound-expr
 Parser::StmtResult Parser::ParseALLOCATEStmt() {
-  return StmtResult();
+  auto Loc = ConsumeToken();
+  if(!ExpectAndConsume(tok::l_paren))
+    return StmtError();
+
+  SmallVector<Expr*, 8> Objects;
+  SmallVector<ArraySpec*, 8> Shapes;
+  SmallVector<ArraySpec*, 4> Shape;
+  do {
+    auto IDLoc = Tok.getLocation();
+    auto IDInfo = Tok.getIdentifierInfo();
+    if(!ExpectAndConsume(tok::identifier))
+      return StmtError();
+    Shape.clear();
+    if(ParseArraySpec(Shape))
+      return StmtError();
+    auto E = Actions.ActOnAllocation(Context, IDLoc, IDInfo, Shape);
+    if(E.isUsable()) {
+      Objects.push_back(E.get());
+      Shapes.append(Shape.begin(), Shape.end());
+    }
+  } while(ConsumeIfPresent(tok::comma));
+
+  if(!ExpectAndConsume(tok::r_paren))
+    return StmtError();
+  return Actions.ActOnAllocateStmt(Context, Loc, Objects, Shapes, StmtLabel);
 }
 
 /// ParseNULLIFYStmt - Parse the NULLIFY statement.
@@ -1867,7 +1955,24 @@ Parser::StmtResult Parser::ParseNULLIFYStmt() {
 ///     deallocate-stmt :=
 ///         DEALLOCATE ( allocate-object-list [ , dealloc-op-list ] )
 Parser::StmtResult Parser::ParseDEALLOCATEStmt() {
-  return StmtResult();
+  auto Loc = ConsumeToken();
+  if(!ExpectAndConsume(tok::l_paren))
+    return StmtError();
+
+  SmallVector<Expr*, 8> Objects;
+  do {
+    auto IDLoc = Tok.getLocation();
+    auto IDInfo = Tok.getIdentifierInfo();
+    if(!ExpectAndConsume(tok::identifier))
+      return StmtError();
+    auto E = Actions.ActOnAllocateObject(Context, IDLoc, IDInfo);
+    if(E.isUsable())
+      Objects.push_back(E.get());
+  } while(ConsumeIfPresent(tok::comma));
+
+  if(!ExpectAndConsume(tok::r_paren))
+    return StmtError();
+  return Actions.ActOnDeallocateStmt(Context, Loc, Objects, StmtLabel);
 }
 
 /// ParseFORALLStmt - Parse the FORALL construct statement.
@@ -73,6 +73,15 @@ bool Sema::IsInsideFunctionOrSubroutine() const {
   return FD && (FD->isNormalFunction() || FD->isSubroutine());
 }
 
+/// \brief Returns true if the current function or subroutine is pure.
+/// The statement functions are a part of their parent procedure.
+bool Sema::IsInsidePureSubprogram() const {
+  auto FD = dyn_cast<FunctionDecl>(CurContext);
+  if(FD && FD->isStatementFunction())
+    FD = dyn_cast<FunctionDecl>(FD->getParent());
+  return FD && FD->isPure();
+}
+
 FunctionDecl *Sema::CurrentContextAsFunction() const {
   return dyn_cast<FunctionDecl>(CurContext);
 }
@@ -424,6 +433,11 @@ void Sema::ActOnSubProgramArgumentList(ASTContext &C, ArrayRef<VarDecl*> Argumen
 }
 
 void Sema::ActOnEndSubProgram(ASTContext &C, SourceLocation Loc) {
+  auto Func = CurrentContextAsFunction();
+  if(Func && Func->isPure())
+    CheckPureSubprogram(Func);
+  if(Func && Func->isElemental())
+    CheckElementalSubprogram(Func);
   PopExecutableProgramUnit(Loc);
   PopDeclContext();
 }
@@ -996,6 +1010,8 @@ StmtResult Sema::ActOnAssignmentStmt(ASTContext &C, SourceLocation Loc,
   }
   if(auto Var = dyn_cast<VarExpr>(LHS.get()))
     CheckVarIsAssignable(Var);
+  if(IsInsidePureSubprogram())
+    CheckPureDefinition(LHS.get());
   if(!RHS.isUsable())
     return StmtError();
   if(LHS.get()->getType().isNull() ||
@@ -1007,6 +1023,8 @@ StmtResult Sema::ActOnAssignmentStmt(ASTContext &C, SourceLocation Loc,
   if(RHS.isInvalid()) return StmtError();
 
   auto Result = AssignmentStmt::Create(C, Loc, LHS.take(), RHS.take(), StmtLabel);
+  if(Result->getLHS()->getType()->isArrayType())
+    Result->setLoopHints(TakeLoopHints(C, nullptr));
   getCurrentBody()->Append(Result);
   if(StmtLabel) DeclareStatementLabel(StmtLabel, Result);
   return Result;
@@ -1023,6 +1041,9 @@ QualType Sema::ActOnArraySpec(ASTContext &C, QualType ElemTy,
         CheckArrayBoundValue(Lower);
         // FIXME: check lower bound <= upper bound
       }
+    } else if(auto Assumed = dyn_cast<AssumedShapeSpec>(Shape)) {
+      if(Assumed->getLowerBound())
+        CheckArrayBoundValue(Assumed->getLowerBound());
     } else {
       auto Implied = cast<ImpliedShapeSpec>(Shape);
       if(I != (Dims.size() - 1)) {
@@ -1063,8 +1084,44 @@ bool Sema::CheckArrayBoundValue(Expr *E) {
 bool Sema::CheckArrayTypeDeclarationCompability(const ArrayType *T, VarDecl *VD) {
   if(VD->isParameter())
     return false;
+  if(T->getElementType().hasAttributeSpec(Qualifiers::AS_allocatable) &&
+     !VD->isArgument()) {
+    // The shape of an allocatable array is deferred until it's allocated.
+    SmallVector<ArraySpec*, 8> Dims;
+    for(auto I = T->begin(); I != T->end(); ++I) {
+      auto Assumed = dyn_cast<AssumedShapeSpec>(*I);
+      if(!Assumed || Assumed->getLowerBound()) {
+        Diags.Report(VD->getLocation(), diag::err_array_allocatable_requires_deferred_shape)
+          << VD->getIdentifier() << VD->getSourceRange();
+        return false;
+      }
+      Dims.push_back(DeferredShapeSpec::Create(Context));
+    }
+    VD->setType(Context.getArrayType(T->getElementType(), Dims));
+    return true;
+  }
+  if(T->isAssumedShape()) {
+    if(!VD->isArgument()) {
+      Diags.Report(VD->getLocation(), diag::err_array_assumed_shape_incompatible)
+        << VD->getIdentifier() << VD->getSourceRange();
+      return false;
+    }
+    for(auto I = T->begin(); I != T->end(); ++I) {
+      if(!isa<AssumedShapeSpec>(*I)) {
+        Diags.Report(VD->getLocation(), diag::err_array_assumed_shape_must_be_used_in_all_dimensions)
+          << VD->getSourceRange();
+        return false;
+      }
+    }
+    return true;
+  }
   for(auto I = T->begin(); I != T->end(); ++I) {
     auto Shape = *I;
+    if(isa<AssumedShapeSpec>(Shape)) {
+      Diags.Report(VD->getLocation(), diag::err_array_assumed_shape_must_be_used_in_all_dimensions)
+        << VD->getSourceRange();
+      return false;
+    }
     auto Explicit = dyn_cast<ExplicitShapeSpec>(Shape);
     if(!Explicit) {
       // implied
@@ -60,7 +60,6 @@ ArraySpec *DimensionConstructor::CreateDimension() {
   return DeferredShapeSpec::Create(Context);
 }
 
-// FIXME: Items can be implied do.
 bool Sema::CheckArrayConstructorItems(ArrayRef<Expr*> Items,
                                       QualType &ResultingArrayType) {
   bool Result = true;
@@ -108,4 +107,67 @@ ExprResult Sema::ActOnArrayConstructorExpr(ASTContext &C, SourceLocation Loc,
   return ArrayConstructorExpr::Create(C, Loc, Elements, ReturnType);
 }
 
+/// \brief Evaluates the number of iterations of an implied do.
+static bool EvaluateImpliedDoIterationCount(ASTContext &C, const Expr *E1,
+                                            const Expr *E2, const Expr *E3,
+                                            uint64_t &Result) {
+  int64_t Init, End, Inc = 1;
+  if(!E1->EvaluateAsInt(Init, C) || !E2->EvaluateAsInt(End, C))
+    return false;
+  if(E3 && (!E3->EvaluateAsInt(Inc, C) || Inc == 0))
+    return false;
+  // MAX((E2 - E1 + E3) / E3, 0)
+  auto Count = (End - Init + Inc) / Inc;
+  Result = Count > 0? uint64_t(Count) : 0;
+  return true;
+}
+
+ExprResult Sema::ActOnArrayConstructorImpliedDoExpr(ASTContext &C, SourceLocation Loc,
+                                                    SourceLocation IDLoc,
+                                                    const IdentifierInfo *IDInfo,
+                                                    ArrayRef<ExprResult> Body,
+                                                    ExprResult E1, ExprResult E2,
+                                                    ExprResult E3) {
+  auto VD = ExpectVarRefOrDeclImplicitVar(IDLoc, IDInfo);
+  if(!VD)
+    return ExprError();
+  auto Var = VarExpr::Create(C, SourceRange(IDLoc, IDLoc), VD);
+
+  // The do variable has the scope of the implied do, and
+  // the parameters are converted to its type.
+  if(StmtRequiresIntegerVar(IDLoc, Var)) {
+    auto VarType = VD->getType();
+    if(CheckIntegerExpression(E1.get()))
+      E1 = CheckAndApplyAssignmentConstraints(Loc, VarType, E1.get(),
+                                              AssignmentAction::Converting);
+    if(CheckIntegerExpression(E2.get()))
+      E2 = CheckAndApplyAssignmentConstraints(Loc, VarType, E2.get(),
+                                              AssignmentAction::Converting);
+    if(E3.isUsable() && CheckIntegerExpression(E3.get()))
+      E3 = CheckAndApplyAssignmentConstraints(Loc, VarType, E3.get(),
+                                              AssignmentAction::Converting);
+  }
+
+  SmallVector<Expr*, 8> BodyExprs(Body.size());
+  for(size_t I = 0; I < BodyExprs.size(); ++I)
+    BodyExprs[I] = Body[I].get();
+
+  // The implied do produces a one dimensional array, whose size
+  // is known when the body and the parameters are constant.
+  QualType BodyType;
+  CheckArrayConstructorItems(BodyExprs, BodyType);
+  auto BodyArrayType = BodyType->asArrayType();
+  uint64_t BodySize, IterationCount;
+  ArraySpec *Dim;
+  if(BodyArrayType->EvaluateSize(BodySize, C) &&
+     EvaluateImpliedDoIterationCount(C, E1.get(), E2.get(), E3.get(), IterationCount))
+    Dim = ExplicitShapeSpec::Create(C, IntegerConstantExpr::Create(C, BodySize *
+                                                                      IterationCount));
+  else
+    Dim = DeferredShapeSpec::Create(C);
+
+  return ImpliedDoExpr::Create(C, Loc, VD, BodyExprs, E1.get(), E2.get(), E3.get(),
+                               C.getArrayType(BodyArrayType->getElementType(), Dim));
+}
+
 } // namespace flang
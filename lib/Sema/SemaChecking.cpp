@@ -14,6 +14,7 @@
 #include "flang/AST/Decl.h"
 #include "flang/AST/Expr.h"
 #include "flang/AST/ExprVisitor.h"
+#include "flang/AST/StorageSet.h"
 #include "flang/Basic/Diagnostic.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -530,6 +531,20 @@ bool Sema::CheckIntegerOrRealOrComplexArgument(const Expr *E, bool AllowArrays)
   return false;
 }
 
+bool Sema::CheckIntegerOrRealOrComplexArrayArgument(const Expr *E, StringRef ArgName) {
+  auto T = E->getType()->asArrayType();
+  if(T) {
+    auto Element = getBuiltinType(T->getElementType());
+    if(Element && Element->isIntegerOrRealOrComplexType())
+      return false;
+  }
+
+  Diags.Report(E->getLocation(), diag::err_typecheck_passing_incompatible_named_arg)
+    << E->getType() << ArgName << "'integer array' or 'real array' or 'complex array'"
+    << E->getSourceRange();
+  return true;
+}
+
 bool Sema::CheckRealOrComplexArgument(const Expr *E, bool AllowArrays) {
   auto Type = getBuiltinType(E, AllowArrays);
   if(!Type || !Type->isRealOrComplexType())
@@ -547,6 +562,14 @@ bool Sema::IsLogicalArray(const Expr *E) {
   return false;
 }
 
+bool Sema::CheckLogicalArgument(const Expr *E, bool AllowArrays,
+                                StringRef ArgName) {
+  auto Type = getBuiltinType(E, AllowArrays);
+  if(!Type || !Type->isLogicalType())
+    return DiagnoseIncompatiblePassing(E, Context.LogicalTy, AllowArrays, ArgName);
+  return false;
+}
+
 bool Sema::CheckLogicalArrayArgument(const Expr *E, StringRef ArgName) {
   if(IsLogicalArray(E)) return false;
 
@@ -556,6 +579,36 @@ bool Sema::CheckLogicalArrayArgument(const Expr *E, StringRef ArgName) {
   return true;
 }
 
+bool Sema::CheckVectorArgument(const Expr *E, StringRef ArgName) {
+  auto T = E->getType()->asArrayType();
+  if(T && T->getDimensionCount() == 1) {
+    auto Element = getBuiltinType(T->getElementType());
+    if(Element && (Element->isIntegerOrRealOrComplexType() ||
+                   Element->isLogicalType()))
+      return false;
+  }
+
+  Diags.Report(E->getLocation(), diag::err_typecheck_passing_incompatible_named_arg)
+    << E->getType() << ArgName << "'numeric vector' or 'logical vector'"
+    << E->getSourceRange();
+  return true;
+}
+
+bool Sema::CheckMatrixArgument(const Expr *E, StringRef ArgName) {
+  auto T = E->getType()->asArrayType();
+  if(T && (T->getDimensionCount() == 1 || T->getDimensionCount() == 2)) {
+    auto Element = getBuiltinType(T->getElementType());
+    if(Element && (Element->isIntegerOrRealOrComplexType() ||
+                   Element->isLogicalType()))
+      return false;
+  }
+
+  Diags.Report(E->getLocation(), diag::err_typecheck_passing_incompatible_named_arg)
+    << E->getType() << ArgName << "'numeric matrix' or 'logical matrix'"
+    << E->getSourceRange();
+  return true;
+}
+
 bool Sema::CheckIntegerArgumentOrLogicalArrayArgument(const Expr *E, StringRef ArgName1,
                                                       StringRef ArgName2) {
   if(E->getType()->isIntegerType() || IsLogicalArray(E))
@@ -741,6 +794,114 @@ bool Sema::CheckVarIsAssignable(const VarExpr *E) {
   return true;
 }
 
+bool Sema::CheckElementalCallArguments(FunctionDecl *Function,
+                                       ArrayRef<Expr*> Arguments,
+                                       SourceLocation Loc) {
+  const Expr *Shape = nullptr;
+  for(auto Arg : Arguments) {
+    if(!Arg->getType()->isArrayType())
+      continue;
+    if(!Shape) {
+      Shape = Arg;
+      continue;
+    }
+    if(!CheckArrayDimensionsCompability(Shape->getType()->asArrayType(),
+                                        Arg->getType()->asArrayType(),
+                                        Arg->getLocation(),
+                                        Shape->getSourceRange(),
+                                        Arg->getSourceRange()))
+      return false;
+  }
+  // FIXME: elemental subroutines and character functions.
+  if(Shape && (Function->isSubroutine() ||
+               (!Function->getType().isNull() &&
+                Function->getType()->isCharacterType()))) {
+    Diags.Report(Loc, diag::err_unsupported_elemental_call)
+      << (Function->isSubroutine()? 1: 0)
+      << Function->getIdentifier()
+      << Shape->getSourceRange();
+    return false;
+  }
+  return true;
+}
+
+void Sema::CheckElementalSubprogram(const FunctionDecl *Function) {
+  for(auto Arg : Function->getArguments()) {
+    if(!Arg->getType().isNull() && Arg->getType()->isArrayType())
+      Diags.Report(Arg->getLocation(), diag::err_elemental_array_argument)
+        << Arg->getIdentifier();
+  }
+}
+
+/// \brief Returns the intent of the given dummy argument, which can
+/// be attached to the element type of an array.
+static Qualifiers::IS GetArgumentIntent(const VarDecl *Arg) {
+  auto T = Arg->getType();
+  auto Intent = T.getQualifiers().getIntentAttr();
+  if(Intent == Qualifiers::IS_unspecified) {
+    if(auto ATy = T->asArrayType())
+      return ATy->getElementType().getQualifiers().getIntentAttr();
+  }
+  return Intent;
+}
+
+void Sema::CheckPureSubprogram(const FunctionDecl *Function) {
+  if(!Function->isSubroutine()) {
+    for(auto Arg : Function->getArguments()) {
+      if(!Arg->getType().isNull() &&
+         GetArgumentIntent(Arg) != Qualifiers::IS_in)
+        Diags.Report(Arg->getLocation(), diag::err_pure_function_argument)
+          << Arg->getIdentifier();
+    }
+  }
+  for(auto I = Function->decls_begin(), End = Function->decls_end();
+      I != End; ++I) {
+    auto VD = dyn_cast<VarDecl>(*I);
+    if(VD && VD->isLocalVariable() && !VD->getType().isNull() &&
+       VD->getType().hasAttributeSpec(Qualifiers::AS_save))
+      Diags.Report(VD->getLocation(), diag::err_pure_saved_variable)
+        << VD->getIdentifier();
+  }
+}
+
+bool Sema::CheckPureDefinition(const Expr *E) {
+  while(auto Designator = dyn_cast<DesignatorExpr>(E))
+    E = Designator->getTarget();
+  auto Var = dyn_cast<VarExpr>(E);
+  if(!Var)
+    return true;
+  auto VD = Var->getVarDecl();
+  int Reason;
+  if(VD->hasStorageSet() && isa<CommonBlockSet>(VD->getStorageSet()))
+    Reason = 0;
+  else if(VD->isArgument() && !VD->getType().isNull() &&
+          GetArgumentIntent(VD) == Qualifiers::IS_in)
+    Reason = 1;
+  else
+    return true;
+  Diags.Report(E->getLocation(), diag::err_pure_definition)
+    << Reason << VD->getIdentifier()
+    << E->getSourceRange();
+  return false;
+}
+
+bool Sema::CheckPureCall(const FunctionDecl *Function, SourceLocation Loc) {
+  if(Function->isPure() || Function->isStatementFunction())
+    return true;
+  Diags.Report(Loc, diag::err_pure_impure_call)
+    << (Function->isSubroutine()? 1: 0)
+    << Function->getIdentifier()
+    << getTokenRange(Loc);
+  return false;
+}
+
+bool Sema::CheckPureStmt(const char *StmtString, SourceLocation Loc) {
+  if(!IsInsidePureSubprogram())
+    return true;
+  Diags.Report(Loc, diag::err_pure_stmt) << StmtString;
+  return false;
+}
+
 bool Sema::CheckRecursiveFunction(SourceLocation Loc) {
   auto Function = cast<FunctionDecl>(CurContext);
   if(!Function->isRecursive()) {
@@ -397,8 +397,13 @@ Decl *Sema::ActOnEntityDecl(ASTContext &C, const QualType &T,
       SubT = T->asArrayType()->getElementType();
       VD->MarkUsedAsVariable(IDLoc);
     }
-    else if(SubT->isCharacterType())
-      CheckCharacterLengthDeclarationCompability(SubT, VD);
+    else {
+      if(SubT->isCharacterType())
+        CheckCharacterLengthDeclarationCompability(SubT, VD);
+      if(Quals.hasAttributeSpec(Qualifiers::AS_allocatable))
+        Diags.Report(IDLoc, diag::err_allocatable_scalar)
+          << IDInfo << getTokenRange(IDLoc);
+    }
   }
 
   return VD;
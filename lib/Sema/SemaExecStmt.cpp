@@ -162,6 +162,88 @@ void StmtLabelResolver::VisitDoStmt(DoStmt *S) {
   S->setTerminatingStmt(StmtLabelReference(StmtLabelDecl));
 }
 
+void Sema::ActOnLoopDirective(SourceLocation Loc, LoopHints::DirectiveKind Kind,
+                              unsigned Count) {
+  if(!CurLoopHints.Loc.isValid())
+    CurLoopHints.Loc = Loc;
+  switch(Kind) {
+  case LoopHints::IVDep:
+    CurLoopHints.IVDep = true;
+    break;
+  case LoopHints::VectorAlways:
+    CurLoopHints.Vectorize = LoopHints::VectorizeAlways;
+    break;
+  case LoopHints::NoVector:
+    CurLoopHints.Vectorize = LoopHints::VectorizeNever;
+    break;
+  case LoopHints::Unroll:
+    CurLoopHints.UnrollCount = Count? Count : unsigned(LoopHints::UnrollWithoutCount);
+    break;
+  case LoopHints::NoUnroll:
+    CurLoopHints.UnrollCount = LoopHints::UnrollDisabled;
+    break;
+  }
+}
+
+void Sema::ActOnPrefetchDirective(SourceLocation Loc, const IdentifierInfo *IDInfo,
+                                  unsigned Hint, int64_t Distance) {
+  if(!CurLoopHints.Loc.isValid())
+    CurLoopHints.Loc = Loc;
+  PendingLoopHints::PrefetchDirective Prefetch = { Loc, IDInfo, Hint, Distance };
+  CurLoopHints.Prefetches.push_back(Prefetch);
+}
+
+void Sema::DiscardLoopHints() {
+  if(!CurLoopHints.Loc.isValid())
+    return;
+  Diags.Report(CurLoopHints.Loc, diag::warn_loop_directive_ignored);
+  CurLoopHints.clear();
+}
+
+/// The prefetched element is A(DoVar + Distance), which means that the
+/// data which is used by the later iterations of the loop is loaded
+/// into the cache in advance.
+LoopHints *Sema::TakeLoopHints(ASTContext &C, VarExpr *DoVar) {
+  if(!CurLoopHints.Loc.isValid())
+    return nullptr;
+
+  SmallVector<LoopHints::Prefetch, 2> Prefetches;
+  for(auto Directive : CurLoopHints.Prefetches) {
+    if(!DoVar || !DoVar->getType()->isIntegerType()) {
+      Diags.Report(Directive.Loc, diag::warn_prefetch_directive_requires_do_loop);
+      continue;
+    }
+    auto Var = dyn_cast_or_null<VarDecl>(ResolveIdentifier(Directive.IDInfo));
+    auto ATy = Var? Var->getType()->asArrayType() : nullptr;
+    if(!ATy || ATy->getDimensionCount() != 1) {
+      Diags.Report(Directive.Loc, diag::warn_prefetch_directive_requires_vector)
+        << Directive.IDInfo;
+      continue;
+    }
+    auto Subscript = ActOnBinaryExpr(C, Directive.Loc, BinaryExpr::Plus, DoVar,
+                                     IntegerConstantExpr::Create(C, Directive.Distance));
+    if(!Subscript.isUsable())
+      continue;
+    Expr *Subscripts[] = { Subscript.get() };
+    auto Element = ActOnSubscriptExpr(C, Directive.Loc, Directive.Loc,
+                                      VarExpr::Create(C, Directive.Loc, Var),
+                                      Subscripts);
+    if(!Element.isUsable())
+      continue;
+    LoopHints::Prefetch Prefetch = { Element.get(), 3 - Directive.Hint };
+    Prefetches.push_back(Prefetch);
+  }
+
+  LoopHints *Result = nullptr;
+  if(CurLoopHints.IVDep || CurLoopHints.Vectorize != LoopHints::VectorizeDefault ||
+     CurLoopHints.UnrollCount != LoopHints::UnrollNone || !Prefetches.empty())
+    Result = LoopHints::Create(C, CurLoopHints.Loc, CurLoopHints.IVDep,
+                               CurLoopHints.Vectorize, CurLoopHints.UnrollCount,
+                               Prefetches);
+  CurLoopHints.clear();
+  return Result;
+}
+
 /// FIXME: TODO Transfer of control into the range of a DO-loop from outside the range is not permitted.
 StmtResult Sema::ActOnDoStmt(ASTContext &C, SourceLocation Loc, SourceLocation EqualLoc,
                              ExprResult TerminatingStmt,
@@ -174,6 +256,8 @@ StmtResult Sema::ActOnDoStmt(ASTContext &C, SourceLocation Loc, SourceLocation E
   if(DoVar) {
     StmtRequiresScalarNumericVar(Loc, DoVar, diag::err_typecheck_stmt_requires_int_var);
     CheckVarIsAssignable(DoVar);
+    if(IsInsidePureSubprogram())
+      CheckPureDefinition(DoVar);
     auto DoVarType = DoVar->getType();
     if(E1.isUsable()) {
       if(CheckScalarNumericExpression(E1.get()))
@@ -208,6 +292,7 @@ StmtResult Sema::ActOnDoStmt(ASTContext &C, SourceLocation Loc, SourceLocation E
   auto Result = DoStmt::Create(C, Loc, StmtLabelReference(),
                                DoVar, E1.get(), E2.get(),
                                E3.get(), StmtLabel, Name);
+  Result->setLoopHints(TakeLoopHints(C, DoVar));
   if(DoVar)
     AddLoopVar(DoVar);
   if(AddToBody)
@@ -293,7 +378,7 @@ bool Sema::InsideWhereConstruct(Stmt *S) {
 }
 
 bool Sema::CheckValidWhereStmtPart(Stmt *S) {
-  if(isa<AssignmentStmt>(S))
+  if(isa<AssignmentStmt>(S) || isa<WhereStmt>(S))
     return true;
   if(auto Part = dyn_cast<ConstructPartStmt>(S)) {
     if(Part->getConstructStmtClass() == ConstructPartStmt::ElseWhereStmtClass ||
@@ -773,6 +858,29 @@ StmtResult Sema::ActOnElseWhereStmt(ASTContext &C, SourceLocation Loc, Expr *Stm
   return Result;
 }
 
+StmtResult Sema::ActOnElseWhereStmt(ASTContext &C, SourceLocation Loc,
+                                    ExprResult Mask, Expr *StmtLabel) {
+  auto WhereConstruct = LeaveBlocksUntilWhere(Loc);
+  if(!WhereConstruct)
+    Diags.Report(Loc, diag::err_stmt_not_in_where) << "else where";
+
+  // typecheck
+  if(Mask.isUsable())
+    StmtRequiresLogicalArrayExpression(Loc, Mask.get());
+
+  // The masked else where is a where construct
+  // which is the else part of the previous one.
+  auto Result = WhereStmt::Create(C, Loc, Mask.get(), StmtLabel);
+  if(WhereConstruct) {
+    LeaveLastBlock();
+    if(Mask.isUsable())
+      WhereConstruct->setElseStmt(Result);
+  }
+  if(StmtLabel) DeclareStatementLabel(StmtLabel, Result);
+  getCurrentBody()->Enter(Result);
+  return Result;
+}
+
 StmtResult Sema::ActOnEndWhereStmt(ASTContext &C, SourceLocation Loc, Expr *StmtLabel) {
   auto WhereConstruct = LeaveBlocksUntilWhere(Loc);
   if(!WhereConstruct)
@@ -794,6 +902,8 @@ StmtResult Sema::ActOnContinueStmt(ASTContext &C, SourceLocation Loc, Expr *Stmt
 }
 
 StmtResult Sema::ActOnStopStmt(ASTContext &C, SourceLocation Loc, ExprResult StopCode, Expr *StmtLabel) {
+  if(!CheckPureStmt("STOP", Loc))
+    return StmtError();
   auto Result = StopStmt::Create(C, Loc, StopCode.take(), StmtLabel);
   getCurrentBody()->Append(Result);
   if(StmtLabel) DeclareStatementLabel(StmtLabel, Result);
@@ -849,4 +959,71 @@ StmtResult Sema::ActOnCallStmt(ASTContext &C, SourceLocation Loc, SourceLocation
   return Result;
 }
 
+ExprResult Sema::ActOnAllocateObject(ASTContext &C, SourceLocation IDLoc,
+                                     const IdentifierInfo *IDInfo) {
+  auto D = ResolveIdentifier(IDInfo);
+  if(!D) {
+    Diags.Report(IDLoc, diag::err_undeclared_var_use)
+      << IDInfo;
+    return ExprError();
+  }
+  auto VD = dyn_cast<VarDecl>(D);
+  if(!VD || !VD->getType()->isArrayType() ||
+     !VD->getType()->asArrayType()->isAllocatable()) {
+    Diags.Report(IDLoc, diag::err_expected_allocatable_array)
+      << getTokenRange(IDLoc);
+    return ExprError();
+  }
+  return VarExpr::Create(C, getTokenRange(IDLoc), VD);
+}
+
+ExprResult Sema::ActOnAllocation(ASTContext &C, SourceLocation IDLoc,
+                                 const IdentifierInfo *IDInfo,
+                                 ArrayRef<ArraySpec*> Shape) {
+  auto E = ActOnAllocateObject(C, IDLoc, IDInfo);
+  if(!E.isUsable())
+    return E;
+  auto Rank = E.get()->getType()->asArrayType()->getDimensionCount();
+  if(Shape.size() != Rank) {
+    Diags.Report(IDLoc, diag::err_allocate_shape_dimension_count_mismatch)
+      << IDInfo << unsigned(Rank) << getTokenRange(IDLoc);
+    return ExprError();
+  }
+
+  // The bounds can be any scalar integer expressions.
+  bool IsValid = true;
+  for(auto Dim : Shape) {
+    auto Explicit = dyn_cast<ExplicitShapeSpec>(Dim);
+    if(!Explicit) {
+      Diags.Report(IDLoc, diag::err_allocate_requires_explicit_shape)
+        << getTokenRange(IDLoc);
+      return ExprError();
+    }
+    if(Explicit->hasLowerBound() &&
+       !CheckIntegerExpression(Explicit->getLowerBound()))
+      IsValid = false;
+    if(!CheckIntegerExpression(Explicit->getUpperBound()))
+      IsValid = false;
+  }
+  return IsValid? E : ExprError();
+}
+
+StmtResult Sema::ActOnAllocateStmt(ASTContext &C, SourceLocation Loc,
+                                   ArrayRef<Expr*> Objects,
+                                   ArrayRef<ArraySpec*> Shapes,
+                                   Expr *StmtLabel) {
+  auto Result = AllocateStmt::Create(C, Loc, Objects, Shapes, StmtLabel);
+  getCurrentBody()->Append(Result);
+  if(StmtLabel) DeclareStatementLabel(StmtLabel, Result);
+  return Result;
+}
+
+StmtResult Sema::ActOnDeallocateStmt(ASTContext &C, SourceLocation Loc,
+                                     ArrayRef<Expr*> Objects, Expr *StmtLabel) {
+  auto Result = DeallocateStmt::Create(C, Loc, Objects, StmtLabel);
+  getCurrentBody()->Append(Result);
+  if(StmtLabel) DeclareStatementLabel(StmtLabel, Result);
+  return Result;
+}
+
 } // end namespace flang
@@ -675,6 +675,16 @@ ExprResult Sema::ActOnSubscriptExpr(ASTContext &C, SourceLocation Loc, SourceLoc
   return ArraySectionExpr::Create(C, Loc, Target, Subscripts, T);
 }
 
+/// \brief Returns true if the given argument is declared with INTENT(IN).
+static bool IsIntentInArgument(const VarDecl *Arg) {
+  auto T = Arg->getType();
+  if(T.getQualifiers().getIntentAttr() == Qualifiers::IS_in)
+    return true;
+  if(auto ATy = T->asArrayType())
+    return ATy->getElementType().getQualifiers().getIntentAttr() == Qualifiers::IS_in;
+  return false;
+}
+
 bool Sema::CheckCallArguments(FunctionDecl *Function, llvm::MutableArrayRef<Expr*> Arguments,
                               SourceLocation Loc, SourceLocation IDLoc) {
   if(Function->isExternal()) {
@@ -720,6 +730,23 @@ bool Sema::CheckCallArguments(FunctionDecl *Function, llvm::MutableArrayRef<Expr
 
   // FIXME: Typecheck arguments
 
+  // A pure procedure can only call pure procedures, and it can't
+  // pass the variables it isn't allowed to modify to the dummy
+  // arguments which can be modified by the callee.
+  if(IsInsidePureSubprogram()) {
+    if(!CheckPureCall(Function, IDLoc))
+      return false;
+    for(size_t I = 0; I < Arguments.size(); ++I) {
+      if(Arguments[I] && !IsIntentInArgument(FunctionArgs[I]))
+        CheckPureDefinition(Arguments[I]);
+    }
+  }
+
+  // The elemental procedures are applied to the elements
+  // of the array arguments.
+  if(Function->isElemental())
+    return CheckElementalCallArguments(Function, Arguments, Loc);
+
   for(size_t I = 0; I < Arguments.size(); ++I) {
     auto T = Arguments[I]->getType();
     if(T->isArrayType())
@@ -743,12 +770,16 @@ bool Sema::ArrayExprNeedsTemp(const Expr *E) {
   return !IsDirectArrayExpr(E);
 }
 
-/// FIXME: ':' array spec interface declared arguments don't need strides
 Expr *Sema::ActOnArrayArgument(VarDecl *Arg, Expr *E) {
   if(ArrayExprNeedsTemp(E))
     return ImplicitTempArrayExpr::Create(Context, E);
-  else if(!E->IsArrayExprContiguous())
-    E = ImplicitArrayPackExpr::Create(Context, E);
+  // The assumed-shape arguments are passed using a descriptor,
+  // so the strided arrays don't have to be packed.
+  auto ATy = Arg->getType()->asArrayType();
+  if(ATy && ATy->isAssumedShape())
+    return E;
+  if(!E->IsArrayExprContiguous())
+    E = ImplicitArrayPackExpr::Create(Context, E, !IsIntentInArgument(Arg));
   return E;
 }
 
@@ -757,8 +788,20 @@ ExprResult Sema::ActOnCallExpr(ASTContext &C, SourceLocation Loc, SourceLocation
                                FunctionDecl *Function, llvm::MutableArrayRef<Expr*> Arguments) {
   assert(!Function->isSubroutine());
 
-  CheckCallArguments(Function, Arguments, RParenLoc, IDLoc);
-  return CallExpr::Create(C, Loc, Function, Arguments);
+  if(!CheckCallArguments(Function, Arguments, RParenLoc, IDLoc) ||
+     !Function->isElemental() || Function->getType().isNull())
+    return CallExpr::Create(C, Loc, Function, Arguments);
+
+  // The result of an elemental function has the shape
+  // of its array arguments.
+  auto Result = CallExpr::Create(C, Loc, Function, Arguments);
+  for(auto Arg : Arguments) {
+    if(auto ATy = Arg->getType()->asArrayType()) {
+      Result->setType(C.getArrayType(Function->getType(), ATy->getDimensions()));
+      break;
+    }
+  }
+  return Result;
 }
 
 ExprResult Sema::ActOnIntrinsicFunctionCallExpr(ASTContext &C, SourceLocation Loc,
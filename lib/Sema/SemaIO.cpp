@@ -87,6 +87,8 @@ UnitSpec *Sema::ActOnUnitSpec(ASTContext &C, ExprResult Value, SourceLocation Lo
 StmtResult Sema::ActOnPrintStmt(ASTContext &C, SourceLocation Loc, FormatSpec *FS,
                                 ArrayRef<ExprResult> OutputItemList,
                                 Expr *StmtLabel) {
+  if(!CheckPureStmt("PRINT", Loc))
+    return StmtError();
   SmallVector<Expr *, 8> OutputList;
   for(auto I : OutputItemList) OutputList.push_back(I.take());
 
@@ -100,6 +102,8 @@ StmtResult Sema::ActOnWriteStmt(ASTContext &C, SourceLocation Loc,
                                 UnitSpec *US, FormatSpec *FS,
                                 ArrayRef<ExprResult> OutputItemList,
                                 Expr *StmtLabel) {
+  if(!CheckPureStmt("WRITE", Loc))
+    return StmtError();
   // FIXME: TODO
   SmallVector<Expr *, 8> OutputList;
   for(auto I : OutputItemList) OutputList.push_back(I.take());
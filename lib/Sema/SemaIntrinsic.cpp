@@ -56,6 +56,41 @@ bool Sema::CheckIntrinsicCallArgumentCount(intrinsic::FunctionKind Function,
     else if(Args.size() > 2)
       ArgCountDiag = diag::err_typecheck_call_too_many_args;
     break;
+  case ArgumentCount1to3:
+    ExpectedString = "1 to 3";
+    if(Args.size() < 1)
+      ArgCountDiag = diag::err_typecheck_call_too_few_args;
+    else if(Args.size() > 3)
+      ArgCountDiag = diag::err_typecheck_call_too_many_args;
+    break;
+  case ArgumentCount1to4:
+    ExpectedString = "1 to 4";
+    if(Args.size() < 1)
+      ArgCountDiag = diag::err_typecheck_call_too_few_args;
+    else if(Args.size() > 4)
+      ArgCountDiag = diag::err_typecheck_call_too_many_args;
+    break;
+  case ArgumentCount2or3:
+    ExpectedString = "2 or 3";
+    if(Args.size() < 2)
+      ArgCountDiag = diag::err_typecheck_call_too_few_args;
+    else if(Args.size() > 3)
+      ArgCountDiag = diag::err_typecheck_call_too_many_args;
+    break;
+  case ArgumentCount2to4:
+    ExpectedString = "2 to 4";
+    if(Args.size() < 2)
+      ArgCountDiag = diag::err_typecheck_call_too_few_args;
+    else if(Args.size() > 4)
+      ArgCountDiag = diag::err_typecheck_call_too_many_args;
+    break;
+  case ArgumentCount2to5:
+    ExpectedString = "2 to 5";
+    if(Args.size() < 2)
+      ArgCountDiag = diag::err_typecheck_call_too_few_args;
+    else if(Args.size() > 5)
+      ArgCountDiag = diag::err_typecheck_call_too_many_args;
+    break;
   case ArgumentCount2orMore:
     ExpectedCount = 2;
     if(Args.size() < 2)
@@ -385,12 +420,15 @@ bool Sema::CheckIntrinsicCharacterFunc(intrinsic::FunctionKind Function,
                                        QualType &ReturnType) {
   auto FirstArg = Args[0];
   auto SecondArg = Args.size() > 1? Args[1] : nullptr;
+  auto ThirdArg = Args.size() > 2? Args[2] : nullptr;
 
   CheckCharacterArgument(FirstArg);
   if(SecondArg) {
     if(!CheckCharacterArgument(SecondArg))
-      CheckExpressionListSameTypeKind(Args);
+      CheckExpressionListSameTypeKind(Args.slice(0, 2));
   }
+  if(ThirdArg)
+    CheckLogicalArgument(ThirdArg, false, "back");
 
   switch(Function) {
   case LEN:
@@ -412,46 +450,430 @@ bool Sema::CheckIntrinsicArrayFunc(intrinsic::FunctionKind Function,
   auto FirstArg = Args[0];
   auto SecondArg = Args.size() > 1? Args[1] : nullptr;
   auto ThirdArg = Args.size() > 2? Args[2] : nullptr;
-  size_t ArrayDimCount = 0;
 
   switch(Function) {
   case MAXLOC:
   case MINLOC:
-    // FIXME: Optional DIM (when array has more than one dim)
-    // FIXME: Third argument mask
+  case FINDLOC: {
+    // FIXME: kind argument.
+    ReturnType = Context.IntegerTy;
+    if(Function == FINDLOC) {
+      if(!FirstArg->getType()->isArrayType()) {
+        Diags.Report(FirstArg->getLocation(), diag::err_typecheck_passing_incompatible_named_arg)
+          << FirstArg->getType() << "array" << "'array'"
+          << FirstArg->getSourceRange();
+        break;
+      }
+      if(SecondArg->getType()->isArrayType()) {
+        Diags.Report(SecondArg->getLocation(), diag::err_typecheck_passing_incompatible_named_arg)
+          << SecondArg->getType() << "value" << "'scalar'"
+          << SecondArg->getSourceRange();
+        break;
+      }
+      // FIXME: character arrays.
+      if(FirstArg->getType().getSelfOrArrayElementType()->isCharacterType()) {
+        Diags.Report(FirstArg->getLocation(), diag::err_unsupported_intrinsic_character_array)
+          << getFunctionName(Function) << FirstArg->getSourceRange();
+        break;
+      }
+      if(CheckArgumentsTypeCompability(FirstArg, SecondArg, "array", "value", true))
+        break;
+    } else if(CheckIntegerOrRealArrayArgument(FirstArg, "array"))
+      break;
+
+    // The optional arguments are distinguished by their types.
+    const Expr *Dim = nullptr;
+    const Expr *Mask = nullptr;
+    const Expr *Back = nullptr;
+    bool Invalid = false;
+    for(auto Arg : Args.slice(Function == FINDLOC? 2 : 1)) {
+      if(!Dim && !Mask && !Back && Arg->getType()->isIntegerType())
+        Dim = Arg;
+      else if(!Mask && !Back && IsLogicalArray(Arg))
+        Mask = Arg;
+      else if(!Back && Arg->getType()->isLogicalType())
+        Back = Arg;
+      else {
+        if(Dim || Mask || Back)
+          Diags.Report(Arg->getLocation(), diag::err_typecheck_passing_incompatible_named_arg)
+            << Arg->getType() << "back" << "'logical'"
+            << Arg->getSourceRange();
+        else
+          CheckIntegerArgumentOrLogicalArrayArgument(Arg, "dim", "mask");
+        Invalid = true;
+        break;
+      }
+    }
+    if(Invalid)
+      break;
+    if(Mask)
+      CheckArrayArgumentsDimensionCompability(FirstArg, Mask, "array", "mask");
 
-    if(!CheckIntegerOrRealArrayArgument(FirstArg, "array")) {
-      ArrayDimCount = FirstArg->getType()->asArrayType()->getDimensionCount();
-      ReturnType = GetSingleDimArrayType(Context.IntegerTy, ArrayDimCount);
-    } else ReturnType = Context.IntegerTy;
+    // Result: the indices of the element, or an array
+    // of the indices along the given dimension.
+    if(Dim)
+      ReturnType = GetArrayReductionReturnType(Context.IntegerTy, FirstArg, Dim);
+    else
+      ReturnType = GetSingleDimArrayType(Context.IntegerTy,
+                     FirstArg->getType()->asArrayType()->getDimensionCount());
+    break;
+  }
+
+  case SUM:
+  case PRODUCT:
+  case MAXVAL:
+  case MINVAL: {
+    bool Invalid = (Function == SUM || Function == PRODUCT)?
+                     CheckIntegerOrRealOrComplexArrayArgument(FirstArg, "array") :
+                     CheckIntegerOrRealArrayArgument(FirstArg, "array");
+    if(Invalid)
+      break;
+    const Expr *Dim = nullptr;
+    const Expr *Mask = ThirdArg;
     if(SecondArg) {
+      if(!ThirdArg && IsLogicalArray(SecondArg))
+        Mask = SecondArg;
+      else if(!CheckIntegerArgument(SecondArg, false, "dim"))
+        Dim = SecondArg;
+    }
+    if(Mask) {
+      if(!CheckLogicalArrayArgument(Mask, "mask"))
+        CheckArrayArgumentsDimensionCompability(FirstArg, Mask, "array", "mask");
+    }
+    ReturnType = GetArrayReductionReturnType(FirstArg->getType()->asArrayType()->getElementType(),
+                                             FirstArg, Dim);
+    break;
+  }
 
-      if(SecondArg->getType()->isIntegerType()) {
-        if(ArrayDimCount == 1) {
-          ReturnType = Context.IntegerTy;
-        } else {
-          // Result: array with a dimension
-          assert(false && "FIXME");
-        }
+  case COUNT:
+  case ANY:
+  case ALL: {
+    QualType ElementType = Function == COUNT? Context.IntegerTy : Context.LogicalTy;
+    if(CheckLogicalArrayArgument(FirstArg, "mask")) {
+      ReturnType = ElementType;
+      break;
+    }
+    if(Function != COUNT)
+      ElementType = FirstArg->getType()->asArrayType()->getElementType();
+    if(SecondArg && CheckIntegerArgument(SecondArg, false, "dim"))
+      SecondArg = nullptr;
+    ReturnType = GetArrayReductionReturnType(ElementType, FirstArg, SecondArg);
+    break;
+  }
+
+  case DOT_PRODUCT: {
+    ReturnType = FirstArg->getType().getSelfOrArrayElementType();
+    if(CheckVectorArgument(FirstArg, "vector_a") ||
+       CheckVectorArgument(SecondArg, "vector_b"))
+      break;
+    if(!CheckArgumentsTypeCompability(FirstArg, SecondArg,
+                                      "vector_a", "vector_b", true))
+      CheckArrayArgumentsDimensionCompability(FirstArg, SecondArg,
+                                              "vector_a", "vector_b");
+    break;
+  }
+
+  case MATMUL: {
+    ReturnType = FirstArg->getType().getSelfOrArrayElementType();
+    if(CheckMatrixArgument(FirstArg, "matrix_a") ||
+       CheckMatrixArgument(SecondArg, "matrix_b"))
+      break;
+    auto AT1 = FirstArg->getType()->asArrayType();
+    auto AT2 = SecondArg->getType()->asArrayType();
+    if(AT1->getDimensionCount() == 1 && AT2->getDimensionCount() == 1) {
+      Diags.Report(SecondArg->getLocation(), diag::err_typecheck_passing_incompatible_named_arg)
+        << SecondArg->getType() << "matrix_b" << "'numeric matrix' or 'logical matrix'"
+        << SecondArg->getSourceRange();
+      break;
+    }
+    if(CheckArgumentsTypeCompability(FirstArg, SecondArg,
+                                     "matrix_a", "matrix_b", true))
+      break;
+
+    // The last dimension of matrix_a is multiplied with
+    // the first dimension of matrix_b.
+    EvaluatedArraySpec SizeA, SizeB;
+    if(AT1->getDimensions().back()->Evaluate(SizeA, Context) &&
+       AT2->getDimensions().front()->Evaluate(SizeB, Context) &&
+       SizeA.Size != SizeB.Size) {
+      Diags.Report(SecondArg->getLocation(), diag::err_typecheck_args_conflict_matmul_size)
+        << int(SizeA.Size) << int(SizeB.Size) << "matrix_a" << "matrix_b"
+        << FirstArg->getSourceRange() << SecondArg->getSourceRange();
+      break;
+    }
+
+    // Result: (n,m) x (m,k) -> (n,k), (m) x (m,k) -> (k), (n,m) x (m) -> (n)
+    SmallVector<ArraySpec*, 2> Dims;
+    if(AT1->getDimensionCount() == 2)
+      Dims.push_back(AT1->getDimensions()[0]);
+    if(AT2->getDimensionCount() == 2)
+      Dims.push_back(AT2->getDimensions()[1]);
+    ReturnType = Context.getArrayType(ReturnType, Dims);
+    break;
+  }
+
+  case TRANSPOSE: {
+    ReturnType = FirstArg->getType();
+    auto AT = FirstArg->getType()->asArrayType();
+    if(!AT || AT->getDimensionCount() != 2) {
+      Diags.Report(FirstArg->getLocation(), diag::err_typecheck_passing_incompatible_named_arg)
+        << FirstArg->getType() << "matrix" << "'two dimensional array'"
+        << FirstArg->getSourceRange();
+      break;
+    }
+    ArraySpec *Dims[] = { AT->getDimensions()[1], AT->getDimensions()[0] };
+    ReturnType = Context.getArrayType(AT->getElementType(), Dims);
+    break;
+  }
+
+  case RESHAPE: {
+    ReturnType = FirstArg->getType().getSelfOrArrayElementType();
+    auto AT = FirstArg->getType()->asArrayType();
+    if(!AT) {
+      Diags.Report(FirstArg->getLocation(), diag::err_typecheck_passing_incompatible_named_arg)
+        << FirstArg->getType() << "source" << "'array'"
+        << FirstArg->getSourceRange();
+      break;
+    }
+    // The rank of the result has to be known, so the
+    // shape is given by the items of an array constructor.
+    auto Shape = SecondArg;
+    if(auto Var = dyn_cast<VarExpr>(Shape)) {
+      if(Var->getVarDecl()->isParameter())
+        Shape = Var->getVarDecl()->getInit();
+    }
+    auto Constructor = dyn_cast<ArrayConstructorExpr>(Shape);
+    if(!Constructor || Constructor->getItems().empty() ||
+       Constructor->getItems().size() > 7) {
+      Diags.Report(SecondArg->getLocation(), diag::err_intrinsic_reshape_shape)
+        << SecondArg->getSourceRange();
+      break;
+    }
+    SmallVector<ArraySpec*, 8> Dims;
+    uint64_t ResultSize = 1;
+    bool IsResultSizeConstant = true;
+    for(auto Item : Constructor->getItems()) {
+      if(!Item->getType()->isIntegerType()) {
+        Diags.Report(SecondArg->getLocation(), diag::err_intrinsic_reshape_shape)
+          << SecondArg->getSourceRange();
+        return false;
       }
+      int64_t Size;
+      if(Item->EvaluateAsInt(Size, Context))
+        ResultSize *= Size < 0? 0 : uint64_t(Size);
+      else IsResultSizeConstant = false;
+      Dims.push_back(ExplicitShapeSpec::Create(Context, Item));
+    }
+    uint64_t SourceSize;
+    if(IsResultSizeConstant && AT->EvaluateSize(SourceSize, Context) &&
+       ResultSize > SourceSize) {
+      Diags.Report(SecondArg->getLocation(), diag::err_intrinsic_reshape_size)
+        << int(ResultSize) << int(SourceSize)
+        << FirstArg->getSourceRange() << SecondArg->getSourceRange();
+      break;
+    }
+    ReturnType = Context.getArrayType(ReturnType, Dims);
+    break;
+  }
 
-      else if(IsLogicalArray(SecondArg))
-        CheckArrayArgumentsDimensionCompability(FirstArg, SecondArg,
-                                                "array", "mask");
-      else {
-        if(ArrayDimCount == 1) {
-          ReturnType = Context.IntegerTy;
-        }
-        CheckIntegerArgumentOrLogicalArrayArgument(SecondArg, "dim", "mask");
+  case SPREAD: {
+    ReturnType = FirstArg->getType().getSelfOrArrayElementType();
+    if(CheckIntegerArgument(SecondArg, false, "dim") ||
+       CheckIntegerArgument(ThirdArg, false, "ncopies"))
+      break;
+    SmallVector<ArraySpec*, 8> Dims;
+    if(auto AT = FirstArg->getType()->asArrayType())
+      Dims.append(AT->getDimensions().begin(), AT->getDimensions().end());
+    int64_t DimValue;
+    if(!SecondArg->EvaluateAsInt(DimValue, Context)) {
+      // The rank of the result has to be known.
+      Diags.Report(SecondArg->getLocation(), diag::err_expected_integer_constant_expr)
+        << SecondArg->getSourceRange();
+      break;
+    }
+    if(DimValue < 1 || DimValue > int64_t(Dims.size() + 1)) {
+      Diags.Report(SecondArg->getLocation(), diag::err_intrinsic_dim_out_of_range)
+        << int(DimValue) << int(Dims.size() + 1)
+        << SecondArg->getSourceRange();
+      break;
+    }
+    // Result: the source with the copies along the given dimension.
+    // A negative number of copies gives an empty array, so the extent
+    // is MAX(NCOPIES, 0), which is folded when NCOPIES is constant.
+    Expr *Copies;
+    int64_t CopiesValue;
+    if(ThirdArg->EvaluateAsInt(CopiesValue, Context))
+      Copies = IntegerConstantExpr::Create(Context, ThirdArg->getSourceRange(),
+                                           APInt(64, CopiesValue < 0? 0 : CopiesValue, true));
+    else {
+      Expr *Zero = IntegerConstantExpr::Create(Context, 0);
+      if(!AreTypesOfSameKind(Zero->getType(), ThirdArg->getType()))
+        Zero = ImplicitCastExpr::Create(Context, ThirdArg->getLocation(),
+                                        ThirdArg->getType(), Zero);
+      Expr *MaxArgs[] = { ThirdArg, Zero };
+      Copies = IntrinsicCallExpr::Create(Context, ThirdArg->getLocation(), intrinsic::MAX,
+                                         MaxArgs, ThirdArg->getType());
+    }
+    Dims.insert(Dims.begin() + (DimValue - 1),
+                ExplicitShapeSpec::Create(Context, Copies));
+    ReturnType = Context.getArrayType(ReturnType, Dims);
+    break;
+  }
+
+  case CSHIFT:
+  case EOSHIFT: {
+    ReturnType = FirstArg->getType();
+    auto AT = FirstArg->getType()->asArrayType();
+    if(!AT) {
+      Diags.Report(FirstArg->getLocation(), diag::err_typecheck_passing_incompatible_named_arg)
+        << FirstArg->getType() << "array" << "'array'"
+        << FirstArg->getSourceRange();
+      break;
+    }
+    // FIXME: character arrays.
+    if(AT->getElementType()->isCharacterType()) {
+      Diags.Report(FirstArg->getLocation(), diag::err_unsupported_intrinsic_character_array)
+        << getFunctionName(Function) << FirstArg->getSourceRange();
+      break;
+    }
+    // FIXME: array shift and boundary arguments.
+    if(CheckIntegerArgument(SecondArg, false, "shift"))
+      break;
+    auto Boundary = Function == EOSHIFT? ThirdArg : nullptr;
+    auto Dim = Function == EOSHIFT? (Args.size() > 3? Args[3] : nullptr) : ThirdArg;
+    if(Boundary) {
+      if(Boundary->getType()->isArrayType()) {
+        Diags.Report(Boundary->getLocation(), diag::err_typecheck_passing_incompatible_named_arg)
+          << Boundary->getType() << "boundary" << "'scalar'"
+          << Boundary->getSourceRange();
+        break;
+      }
+      if(CheckArgumentsTypeCompability(FirstArg, Boundary, "array", "boundary", true))
+        break;
+    }
+    if(Dim) {
+      if(CheckIntegerArgument(Dim, false, "dim"))
+        break;
+      int64_t DimValue;
+      if(!Dim->EvaluateAsInt(DimValue, Context)) {
+        Diags.Report(Dim->getLocation(), diag::err_expected_integer_constant_expr)
+          << Dim->getSourceRange();
+        break;
+      }
+      if(DimValue < 1 || DimValue > int64_t(AT->getDimensionCount())) {
+        Diags.Report(Dim->getLocation(), diag::err_intrinsic_dim_out_of_range)
+          << int(DimValue) << int(AT->getDimensionCount())
+          << Dim->getSourceRange();
+        break;
       }
     }
+    break;
+  }
 
+  case MERGE: {
+    ReturnType = FirstArg->getType().getSelfOrArrayElementType();
+    if(CheckArgumentsTypeCompability(FirstArg, SecondArg, "tsource", "fsource", true) ||
+       CheckLogicalArgument(ThirdArg, true, "mask"))
+      break;
+    // Result: the shape of the array arguments, which have to conform.
+    const Expr *Shape = nullptr;
+    for(auto Arg : Args) {
+      if(!Arg->getType()->isArrayType())
+        continue;
+      if(Shape) {
+        if(!CheckArrayArgumentsDimensionCompability(Shape, Arg,
+                                                    Shape == FirstArg? "tsource" : "fsource",
+                                                    Arg == SecondArg? "fsource" : "mask"))
+          return false;
+      } else Shape = Arg;
+    }
+    // FIXME: character arrays.
+    if(Shape && ReturnType->isCharacterType()) {
+      Diags.Report(Shape->getLocation(), diag::err_unsupported_intrinsic_character_array)
+        << getFunctionName(Function) << Shape->getSourceRange();
+      break;
+    }
+    if(Shape)
+      ReturnType = Context.getArrayType(ReturnType,
+                                        Shape->getType()->asArrayType()->getDimensions());
     break;
   }
 
+  case PACK: {
+    ReturnType = FirstArg->getType().getSelfOrArrayElementType();
+    auto AT = FirstArg->getType()->asArrayType();
+    if(!AT) {
+      Diags.Report(FirstArg->getLocation(), diag::err_typecheck_passing_incompatible_named_arg)
+        << FirstArg->getType() << "array" << "'array'"
+        << FirstArg->getSourceRange();
+      break;
+    }
+    if(CheckLogicalArgument(SecondArg, true, "mask") ||
+       !CheckArrayArgumentsDimensionCompability(FirstArg, SecondArg, "array", "mask"))
+      break;
+    // Result: a vector with the size of the vector argument, or with
+    // the number of the true elements in the mask, which is only
+    // known at runtime.
+    ArraySpec *Dim = DeferredShapeSpec::Create(Context);
+    if(ThirdArg) {
+      if(CheckVectorArgument(ThirdArg, "vector") ||
+         CheckArgumentsTypeCompability(FirstArg, ThirdArg, "array", "vector", true))
+        break;
+      Dim = ThirdArg->getType()->asArrayType()->getDimensions().front();
+    }
+    ReturnType = Context.getArrayType(ReturnType, Dim);
+    break;
+  }
+
+  case UNPACK: {
+    ReturnType = FirstArg->getType().getSelfOrArrayElementType();
+    if(CheckVectorArgument(FirstArg, "vector") ||
+       CheckLogicalArrayArgument(SecondArg, "mask") ||
+       CheckArgumentsTypeCompability(FirstArg, ThirdArg, "vector", "field", true) ||
+       !CheckArrayArgumentsDimensionCompability(SecondArg, ThirdArg, "mask", "field"))
+      break;
+    // Result: the shape of the mask.
+    ReturnType = Context.getArrayType(ReturnType,
+                                      SecondArg->getType()->asArrayType()->getDimensions());
+    break;
+  }
+  }
+
   return false;
 }
 
+QualType Sema::GetArrayReductionReturnType(QualType ElementType, const Expr *Array,
+                                           const Expr *Dim) {
+  auto ATy = Array->getType()->asArrayType();
+  if(!Dim)
+    return ElementType;
+
+  int64_t DimValue;
+  if(!Dim->EvaluateAsInt(DimValue, Context)) {
+    // The rank of the result has to be known.
+    if(ATy->getDimensionCount() != 1)
+      Diags.Report(Dim->getLocation(), diag::err_expected_integer_constant_expr)
+        << Dim->getSourceRange();
+    return ElementType;
+  }
+  if(DimValue < 1 || DimValue > int64_t(ATy->getDimensionCount())) {
+    Diags.Report(Dim->getLocation(), diag::err_intrinsic_dim_out_of_range)
+      << int(DimValue) << int(ATy->getDimensionCount())
+      << Dim->getSourceRange();
+    return ElementType;
+  }
+  if(ATy->getDimensionCount() == 1)
+    return ElementType;
+
+  // Result: array without the given dimension
+  SmallVector<ArraySpec*, 8> Dims;
+  for(size_t I = 0; I < ATy->getDimensionCount(); ++I) {
+    if(I != size_t(DimValue - 1))
+      Dims.push_back(ATy->getDimensions()[I]);
+  }
+  return Context.getArrayType(ElementType, Dims);
+}
+
 bool Sema::CheckIntrinsicNumericInquiryFunc(intrinsic::FunctionKind Function,
                                             ArrayRef<Expr*> Args,
                                             QualType &ReturnType) {
@@ -0,0 +1,186 @@
+//===--- Allocate.cpp - Allocatable array memory allocator ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the caching allocator of the allocatable arrays.
+// The small blocks are rounded up to a power of two size class, and every
+// thread keeps a free list for each class. The large blocks are rounded
+// up to whole pages and the last few freed ones are kept by every thread,
+// so that they can be reused by an allocation of the same size.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Allocate.h"
+#include <stdlib.h>
+
+namespace flang {
+namespace runtime {
+
+/// The number of the small size classes, from 64 bytes up to 64 KB.
+static const unsigned NumSizeClasses = 11;
+static const size_t MaxSmallBlockSize = AllocationAlignment << (NumSizeClasses - 1);
+
+/// The large blocks are allocated in whole pages.
+static const size_t PageSize = 4096;
+
+/// The number of blocks which are kept by a thread in every small size
+/// class and for the large blocks.
+static const unsigned MaxCachedSmallBlocks = 64;
+static const unsigned MaxCachedLargeBlocks = 8;
+
+namespace {
+
+/// FreeBlock - A cached small block, which is linked to the next
+/// free block of the same size class.
+struct FreeBlock {
+  FreeBlock *Next;
+};
+
+/// LargeBlock - A cached large block with its page rounded size.
+struct LargeBlock {
+  void *Ptr;
+  size_t Size;
+};
+
+/// ThreadCache - The blocks which were freed by a thread. The cached
+/// blocks are returned to the system when the thread exits.
+class ThreadCache {
+  FreeBlock *FreeLists[NumSizeClasses];
+  unsigned FreeListSizes[NumSizeClasses];
+  LargeBlock LargeBlocks[MaxCachedLargeBlocks];
+  unsigned NumLargeBlocks;
+  size_t SystemAllocations;
+
+  void *SystemAllocate(size_t Size);
+
+public:
+  ThreadCache();
+  ~ThreadCache();
+
+  void *Allocate(size_t Size);
+  void Deallocate(void *Ptr, size_t Size);
+
+  size_t getSystemAllocationCount() const { return SystemAllocations; }
+};
+
+} // end anonymous namespace
+
+/// \brief Returns the size class of a small block.
+static unsigned GetSizeClass(size_t Size) {
+  unsigned Class = 0;
+  for(auto BlockSize = AllocationAlignment; BlockSize < Size; BlockSize <<= 1)
+    ++Class;
+  return Class;
+}
+
+static size_t GetLargeBlockSize(size_t Size) {
+  return (Size + PageSize - 1) & ~(PageSize - 1);
+}
+
+ThreadCache::ThreadCache() : NumLargeBlocks(0), SystemAllocations(0) {
+  for(unsigned I = 0; I < NumSizeClasses; ++I) {
+    FreeLists[I] = nullptr;
+    FreeListSizes[I] = 0;
+  }
+}
+
+ThreadCache::~ThreadCache() {
+  for(unsigned I = 0; I < NumSizeClasses; ++I) {
+    for(auto Block = FreeLists[I]; Block;) {
+      auto Next = Block->Next;
+      free(Block);
+      Block = Next;
+    }
+  }
+  for(unsigned I = 0; I < NumLargeBlocks; ++I)
+    free(LargeBlocks[I].Ptr);
+}
+
+void *ThreadCache::SystemAllocate(size_t Size) {
+  void *Ptr;
+  if(posix_memalign(&Ptr, AllocationAlignment, Size))
+    return nullptr;
+  ++SystemAllocations;
+  return Ptr;
+}
+
+void *ThreadCache::Allocate(size_t Size) {
+  if(Size <= MaxSmallBlockSize) {
+    auto Class = GetSizeClass(Size);
+    if(auto Block = FreeLists[Class]) {
+      FreeLists[Class] = Block->Next;
+      --FreeListSizes[Class];
+      return Block;
+    }
+    return SystemAllocate(AllocationAlignment << Class);
+  }
+
+  // Reuse the most recently freed large block with the same size.
+  Size = GetLargeBlockSize(Size);
+  for(auto I = NumLargeBlocks; I; --I) {
+    if(LargeBlocks[I - 1].Size != Size)
+      continue;
+    auto Ptr = LargeBlocks[I - 1].Ptr;
+    for(; I < NumLargeBlocks; ++I)
+      LargeBlocks[I - 1] = LargeBlocks[I];
+    --NumLargeBlocks;
+    return Ptr;
+  }
+  return SystemAllocate(Size);
+}
+
+void ThreadCache::Deallocate(void *Ptr, size_t Size) {
+  if(!Ptr)
+    return;
+  if(Size <= MaxSmallBlockSize) {
+    auto Class = GetSizeClass(Size);
+    if(FreeListSizes[Class] == MaxCachedSmallBlocks) {
+      free(Ptr);
+      return;
+    }
+    auto Block = static_cast<FreeBlock*>(Ptr);
+    Block->Next = FreeLists[Class];
+    FreeLists[Class] = Block;
+    ++FreeListSizes[Class];
+    return;
+  }
+
+  // Release the least recently freed large block when the cache is full.
+  if(NumLargeBlocks == MaxCachedLargeBlocks) {
+    free(LargeBlocks[0].Ptr);
+    for(unsigned I = 1; I < NumLargeBlocks; ++I)
+      LargeBlocks[I - 1] = LargeBlocks[I];
+    --NumLargeBlocks;
+  }
+  LargeBlocks[NumLargeBlocks].Ptr = Ptr;
+  LargeBlocks[NumLargeBlocks].Size = GetLargeBlockSize(Size);
+  ++NumLargeBlocks;
+}
+
+static thread_local ThreadCache Cache;
+
+size_t getSystemAllocationCount() {
+  return Cache.getSystemAllocationCount();
+}
+
+} // end namespace runtime
+} // end namespace flang
+
+using namespace flang::runtime;
+
+extern "C" {
+
+void *libflang_allocate(size_t Size) {
+  return Cache.Allocate(Size);
+}
+
+void libflang_deallocate(void *Ptr, size_t Size) {
+  Cache.Deallocate(Ptr, Size);
+}
+
+} // end extern "C"
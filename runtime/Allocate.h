@@ -0,0 +1,47 @@
+//===--- Allocate.h - Allocatable array memory allocator --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the allocator which provides the memory of the
+// allocatable arrays. The freed blocks are cached by every thread, so
+// that the arrays which are allocated and deallocated with the same
+// shape in every iteration of a loop don't reach the system allocator.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef FLANG_RUNTIME_ALLOCATE_H
+#define FLANG_RUNTIME_ALLOCATE_H
+
+#include <stddef.h>
+
+namespace flang {
+namespace runtime {
+
+/// AllocationAlignment - The alignment of every allocated block, which
+/// allows the vectorized loops to use aligned accesses.
+const size_t AllocationAlignment = 64;
+
+/// \brief Returns the number of blocks which the current thread has
+/// obtained from the system allocator.
+size_t getSystemAllocationCount();
+
+} // end namespace runtime
+} // end namespace flang
+
+extern "C" {
+
+/// libflang_allocate - Allocates a block of at least the given size.
+void *libflang_allocate(size_t Size);
+
+/// libflang_deallocate - Returns a block to the cache of the current
+/// thread. The size must be the size which was used to allocate it.
+void libflang_deallocate(void *Ptr, size_t Size);
+
+} // end extern "C"
+
+#endif
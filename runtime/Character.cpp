@@ -0,0 +1,166 @@
+//===--- Character.cpp - Character runtime library ------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the character operations which are called by the
+// generated code, and the portable versions of the character kernels.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Character.h"
+#include <string.h>
+
+namespace flang {
+namespace runtime {
+
+static size_t ScalarLenTrim(const char *Str, size_t Length) {
+  for(; Length && Str[Length - 1] == ' '; --Length) ;
+  return Length;
+}
+
+static size_t ScalarFindNonBlank(const char *Str, size_t Length) {
+  size_t I = 0;
+  for(; I < Length && Str[I] == ' '; ++I) ;
+  return I;
+}
+
+static size_t ScalarMismatch(const char *LHS, const char *RHS, size_t Length) {
+  size_t I = 0;
+  for(; I < Length && LHS[I] == RHS[I]; ++I) ;
+  return I;
+}
+
+static size_t ScalarIndex(const char *Str, size_t Length,
+                          const char *Sub, size_t SubLength, bool Back) {
+  auto Positions = Length - SubLength + 1;
+  if(!Back) {
+    for(size_t I = 0; I < Positions; ++I) {
+      if(memcmp(Str + I, Sub, SubLength) == 0)
+        return I + 1;
+    }
+    return 0;
+  }
+  for(auto I = Positions; I; --I) {
+    if(memcmp(Str + I - 1, Sub, SubLength) == 0)
+      return I;
+  }
+  return 0;
+}
+
+static void ScalarFill(char *Str, size_t Length, char C) {
+  memset(Str, C, Length);
+}
+
+static const CharacterKernels ScalarKernels = {
+  "scalar", ScalarLenTrim, ScalarFindNonBlank, ScalarMismatch,
+  ScalarIndex, ScalarFill
+};
+
+const CharacterKernels *getScalarCharacterKernels() {
+  return &ScalarKernels;
+}
+
+static const CharacterKernels &SelectCharacterKernels() {
+  if(auto Kernels = getAVX2CharacterKernels())
+    return *Kernels;
+  if(auto Kernels = getSSE2CharacterKernels())
+    return *Kernels;
+  return ScalarKernels;
+}
+
+const CharacterKernels &getCharacterKernels() {
+  static const CharacterKernels &Kernels = SelectCharacterKernels();
+  return Kernels;
+}
+
+int32_t CompareCharacters(const CharacterKernels &Kernels,
+                          const char *LHS, size_t LHSLength,
+                          const char *RHS, size_t RHSLength) {
+  auto Length = LHSLength < RHSLength? LHSLength : RHSLength;
+  auto I = Kernels.Mismatch(LHS, RHS, Length);
+  if(I < Length)
+    return (unsigned char)LHS[I] < (unsigned char)RHS[I]? -1 : 1;
+
+  // The remaining characters of the longer string are compared with blanks.
+  if(LHSLength > Length) {
+    I = Length + Kernels.FindNonBlank(LHS + Length, LHSLength - Length);
+    if(I < LHSLength)
+      return (unsigned char)LHS[I] < ' '? -1 : 1;
+  } else if(RHSLength > Length) {
+    I = Length + Kernels.FindNonBlank(RHS + Length, RHSLength - Length);
+    if(I < RHSLength)
+      return (unsigned char)RHS[I] < ' '? 1 : -1;
+  }
+  return 0;
+}
+
+size_t IndexCharacters(const CharacterKernels &Kernels,
+                       const char *Str, size_t Length,
+                       const char *Sub, size_t SubLength, bool Back) {
+  if(SubLength > Length)
+    return 0;
+  if(SubLength == 0)
+    return Back? Length + 1 : 1;
+  return Kernels.Index(Str, Length, Sub, SubLength, Back);
+}
+
+} // end namespace runtime
+} // end namespace flang
+
+using namespace flang::runtime;
+
+extern "C" {
+
+void libflang_assignment_char1(char *LHS, size_t LHSLength,
+                               const char *RHS, size_t RHSLength) {
+  if(RHSLength >= LHSLength) {
+    memmove(LHS, RHS, LHSLength);
+    return;
+  }
+  memmove(LHS, RHS, RHSLength);
+  getCharacterKernels().Fill(LHS + RHSLength, LHSLength - RHSLength, ' ');
+}
+
+void libflang_concat_char1(char *Dest, size_t DestLength,
+                           const char *LHS, size_t LHSLength,
+                           const char *RHS, size_t RHSLength) {
+  if(LHSLength >= DestLength) {
+    memmove(Dest, LHS, DestLength);
+    return;
+  }
+  memmove(Dest, LHS, LHSLength);
+  libflang_assignment_char1(Dest + LHSLength, DestLength - LHSLength,
+                            RHS, RHSLength);
+}
+
+int32_t libflang_compare_char1(const char *LHS, size_t LHSLength,
+                               const char *RHS, size_t RHSLength) {
+  return CompareCharacters(getCharacterKernels(), LHS, LHSLength,
+                           RHS, RHSLength);
+}
+
+/// The lexical comparison uses the ASCII collating sequence, which
+/// is the collating sequence of the processor as well.
+int32_t libflang_lexcompare_char1(const char *LHS, size_t LHSLength,
+                                  const char *RHS, size_t RHSLength) {
+  return CompareCharacters(getCharacterKernels(), LHS, LHSLength,
+                           RHS, RHSLength);
+}
+
+size_t libflang_lentrim_char1(const char *Str, size_t Length) {
+  return getCharacterKernels().LenTrim(Str, Length);
+}
+
+size_t libflang_index_char1(const char *Str, size_t Length,
+                            const char *Sub, size_t SubLength,
+                            int32_t Back) {
+  return IndexCharacters(getCharacterKernels(), Str, Length,
+                         Sub, SubLength, Back != 0);
+}
+
+} // end extern "C"
@@ -0,0 +1,78 @@
+//===--- Character.h - Character runtime kernels ----------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the kernels which implement the character operations
+// of the runtime library. Every instruction set provides its own set of
+// kernels, and the best one which is supported by the host is selected
+// once when the first character operation is performed.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef FLANG_RUNTIME_CHARACTER_H
+#define FLANG_RUNTIME_CHARACTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace flang {
+namespace runtime {
+
+/// CharacterKernels - The implementations of the character operations
+/// for a specific instruction set.
+struct CharacterKernels {
+  const char *Name;
+
+  /// LenTrim - Returns the length of the string without the trailing blanks.
+  size_t (*LenTrim)(const char *Str, size_t Length);
+
+  /// FindNonBlank - Returns the offset of the first character which isn't
+  /// a blank, or the length of the string if all characters are blanks.
+  size_t (*FindNonBlank)(const char *Str, size_t Length);
+
+  /// Mismatch - Returns the offset of the first character which is
+  /// different in the two strings, or the length if they are equal.
+  size_t (*Mismatch)(const char *LHS, const char *RHS, size_t Length);
+
+  /// Index - Returns the offset of the first (or the last when Back is set)
+  /// occurrence of the substring plus one, or zero when it isn't found.
+  /// The substring can't be empty or longer than the string.
+  size_t (*Index)(const char *Str, size_t Length,
+                  const char *Sub, size_t SubLength, bool Back);
+
+  /// Fill - Sets every character of the string to the given character.
+  void (*Fill)(char *Str, size_t Length, char C);
+};
+
+/// \brief Returns the portable kernels.
+const CharacterKernels *getScalarCharacterKernels();
+
+/// \brief Returns the SSE2 kernels, or null if the host doesn't support them.
+const CharacterKernels *getSSE2CharacterKernels();
+
+/// \brief Returns the AVX2 kernels, or null if the host doesn't support them.
+const CharacterKernels *getAVX2CharacterKernels();
+
+/// \brief Returns the fastest kernels which are supported by the host.
+const CharacterKernels &getCharacterKernels();
+
+/// \brief Compares two strings using the given kernels. The shorter string
+/// is treated as if it was padded with blanks.
+int32_t CompareCharacters(const CharacterKernels &Kernels,
+                          const char *LHS, size_t LHSLength,
+                          const char *RHS, size_t RHSLength);
+
+/// \brief Implements the INDEX intrinsic using the given kernels.
+size_t IndexCharacters(const CharacterKernels &Kernels,
+                       const char *Str, size_t Length,
+                       const char *Sub, size_t SubLength, bool Back);
+
+} // end namespace runtime
+} // end namespace flang
+
+#endif
@@ -0,0 +1,62 @@
+//===--- CharacterAVX2.cpp - AVX2 character kernels -----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the character kernels using AVX2 instructions. The
+// kernels are only built when the file is compiled with AVX2 enabled.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Character.h"
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__AVX2__)
+#include <immintrin.h>
+
+namespace {
+
+class V {
+public:
+  typedef __m256i Type;
+  static const size_t Width = 32;
+  static const uint32_t AllMask = 0xFFFFFFFF;
+
+  static Type splat(char C) {
+    return _mm256_set1_epi8(C);
+  }
+  static Type load(const char *Ptr) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Ptr));
+  }
+  static void store(char *Ptr, Type Value) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(Ptr), Value);
+  }
+  static uint32_t equalMask(Type A, Type B) {
+    return uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(A, B)));
+  }
+};
+
+#include "CharacterKernels.inc"
+
+const flang::runtime::CharacterKernels Kernels = {
+  "avx2", LenTrim, FindNonBlank, Mismatch, Index, Fill
+};
+
+} // end anonymous namespace
+
+const flang::runtime::CharacterKernels *flang::runtime::getAVX2CharacterKernels() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2")? &Kernels : nullptr;
+}
+
+#else
+
+const flang::runtime::CharacterKernels *flang::runtime::getAVX2CharacterKernels() {
+  return nullptr;
+}
+
+#endif
@@ -0,0 +1,61 @@
+//===--- CharacterSSE2.cpp - SSE2 character kernels -----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the character kernels using SSE2 instructions.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Character.h"
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#include <emmintrin.h>
+
+namespace {
+
+class V {
+public:
+  typedef __m128i Type;
+  static const size_t Width = 16;
+  static const uint32_t AllMask = 0xFFFF;
+
+  static Type splat(char C) {
+    return _mm_set1_epi8(C);
+  }
+  static Type load(const char *Ptr) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(Ptr));
+  }
+  static void store(char *Ptr, Type Value) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(Ptr), Value);
+  }
+  static uint32_t equalMask(Type A, Type B) {
+    return uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(A, B)));
+  }
+};
+
+#include "CharacterKernels.inc"
+
+const flang::runtime::CharacterKernels Kernels = {
+  "sse2", LenTrim, FindNonBlank, Mismatch, Index, Fill
+};
+
+} // end anonymous namespace
+
+const flang::runtime::CharacterKernels *flang::runtime::getSSE2CharacterKernels() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse2")? &Kernels : nullptr;
+}
+
+#else
+
+const flang::runtime::CharacterKernels *flang::runtime::getSSE2CharacterKernels() {
+  return nullptr;
+}
+
+#endif
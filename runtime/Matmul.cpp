@@ -0,0 +1,134 @@
+//===--- Matmul.cpp - Matrix multiplication runtime library ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the matrix multiplication which is called by the
+// generated code, the selection of the kernels and the portable kernels.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Matmul.h"
+#include "Allocate.h"
+#include <string.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+#include "MatmulKernels.inc"
+
+const flang::runtime::MatmulKernels ScalarKernels = {
+  "scalar", Multiply<float, float, 4, 4>, Multiply<double, double, 4, 4>
+};
+
+/// MatmulThreadWork - The number of multiply-adds which is computed by
+/// every thread, so that the cost of starting the thread is negligible.
+const double MatmulThreadWork = double(1 << 24);
+
+/// MatmulThreadColumns - The smallest number of the columns of the result
+/// which are computed by a thread.
+const size_t MatmulThreadColumns = 16;
+
+/// \brief Computes the columns of the result in the given number of threads.
+/// Every thread computes a range of the columns, which only depends on the
+/// same columns of B. The last range is computed by the calling thread.
+template<typename T>
+void MultiplyInThreads(void (*Kernel)(T *, size_t, const T *, size_t,
+                                      const T *, size_t, size_t, size_t, size_t),
+                       unsigned Threads, T *C, size_t LDC, const T *A, size_t LDA,
+                       const T *B, size_t LDB, size_t N, size_t M, size_t K) {
+  if(Threads > K)
+    Threads = unsigned(K);
+  if(Threads <= 1) {
+    Kernel(C, LDC, A, LDA, B, LDB, N, M, K);
+    return;
+  }
+  std::vector<std::thread> Workers;
+  size_t Begin = 0;
+  for(unsigned I = 1; I < Threads; ++I) {
+    auto End = K * I / Threads;
+    Workers.push_back(std::thread(Kernel, C + Begin * LDC, LDC, A, LDA,
+                                  B + Begin * LDB, LDB, N, M, End - Begin));
+    Begin = End;
+  }
+  Kernel(C + Begin * LDC, LDC, A, LDA, B + Begin * LDB, LDB, N, M, K - Begin);
+  for(auto &Worker : Workers)
+    Worker.join();
+}
+
+} // end anonymous namespace
+
+namespace flang {
+namespace runtime {
+
+const MatmulKernels *getScalarMatmulKernels() {
+  return &ScalarKernels;
+}
+
+static const MatmulKernels &SelectMatmulKernels() {
+  if(auto Kernels = getAVX512MatmulKernels())
+    return *Kernels;
+  if(auto Kernels = getAVX2MatmulKernels())
+    return *Kernels;
+  if(auto Kernels = getSSE2MatmulKernels())
+    return *Kernels;
+  return ScalarKernels;
+}
+
+const MatmulKernels &getMatmulKernels() {
+  static const MatmulKernels &Kernels = SelectMatmulKernels();
+  return Kernels;
+}
+
+unsigned getMatmulThreadCount(size_t N, size_t M, size_t K) {
+  static const unsigned HostThreads = std::thread::hardware_concurrency();
+  auto Work = double(N) * double(M) * double(K);
+  if(HostThreads <= 1 || Work < 2 * MatmulThreadWork)
+    return 1;
+  auto Threads = Work / MatmulThreadWork;
+  if(Threads > double(K / MatmulThreadColumns))
+    Threads = double(K / MatmulThreadColumns);
+  if(Threads > double(HostThreads))
+    Threads = double(HostThreads);
+  return Threads < 1.0? 1 : unsigned(Threads);
+}
+
+void MultiplyMatrices(const MatmulKernels &Kernels, unsigned Threads,
+                      float *C, size_t LDC, const float *A, size_t LDA,
+                      const float *B, size_t LDB, size_t N, size_t M, size_t K) {
+  MultiplyInThreads(Kernels.Float, Threads, C, LDC, A, LDA, B, LDB, N, M, K);
+}
+
+void MultiplyMatrices(const MatmulKernels &Kernels, unsigned Threads,
+                      double *C, size_t LDC, const double *A, size_t LDA,
+                      const double *B, size_t LDB, size_t N, size_t M, size_t K) {
+  MultiplyInThreads(Kernels.Double, Threads, C, LDC, A, LDA, B, LDB, N, M, K);
+}
+
+} // end namespace runtime
+} // end namespace flang
+
+using namespace flang::runtime;
+
+extern "C" {
+
+void libflang_matmul_f4(float *C, size_t LDC, const float *A, size_t LDA,
+                        const float *B, size_t LDB,
+                        size_t N, size_t M, size_t K) {
+  MultiplyMatrices(getMatmulKernels(), getMatmulThreadCount(N, M, K),
+                   C, LDC, A, LDA, B, LDB, N, M, K);
+}
+
+void libflang_matmul_f8(double *C, size_t LDC, const double *A, size_t LDA,
+                        const double *B, size_t LDB,
+                        size_t N, size_t M, size_t K) {
+  MultiplyMatrices(getMatmulKernels(), getMatmulThreadCount(N, M, K),
+                   C, LDC, A, LDA, B, LDB, N, M, K);
+}
+
+} // end extern "C"
@@ -0,0 +1,100 @@
+//===--- Matmul.h - Matrix multiplication runtime kernels -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the kernels which multiply the REAL matrices for
+// MATMUL when the matrices are too large to be multiplied by the inline
+// code. The blocks of the matrices are packed into panels which are
+// traversed by a register blocked micro kernel. Every instruction set
+// provides its own micro kernel, and the best one which is supported by
+// the host is selected once when the first matrices are multiplied. The
+// columns of the result are split between several threads when the
+// product is large enough.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef FLANG_RUNTIME_MATMUL_H
+#define FLANG_RUNTIME_MATMUL_H
+
+#include <stddef.h>
+
+namespace flang {
+namespace runtime {
+
+/// MatmulBlockRows - The number of rows of the first matrix which are
+/// packed together, so that the packed block stays in the L2 cache.
+const size_t MatmulBlockRows = 128;
+
+/// MatmulBlockDepth - The number of inner products which are accumulated
+/// from a packed block before the next block is packed.
+const size_t MatmulBlockDepth = 256;
+
+/// MatmulBlockColumns - The number of columns of the second matrix which
+/// are packed together, so that the packed block stays in the L3 cache.
+const size_t MatmulBlockColumns = 2048;
+
+/// MatmulKernels - The matrix multiplication for a specific instruction set.
+/// The kernels compute C = A * B, where A is a N x M matrix, B is a M x K
+/// matrix and C is a N x K matrix. The matrices are stored in the column
+/// major order, with the given distance between the columns. C can't
+/// share memory with A or B.
+struct MatmulKernels {
+  const char *Name;
+
+  void (*Float)(float *C, size_t LDC, const float *A, size_t LDA,
+                const float *B, size_t LDB, size_t N, size_t M, size_t K);
+  void (*Double)(double *C, size_t LDC, const double *A, size_t LDA,
+                 const double *B, size_t LDB, size_t N, size_t M, size_t K);
+};
+
+/// \brief Returns the portable kernels.
+const MatmulKernels *getScalarMatmulKernels();
+
+/// \brief Returns the SSE2 kernels, or null if the host doesn't support them.
+const MatmulKernels *getSSE2MatmulKernels();
+
+/// \brief Returns the AVX2 kernels, or null if the host doesn't support them.
+const MatmulKernels *getAVX2MatmulKernels();
+
+/// \brief Returns the AVX-512 kernels, or null if the host doesn't
+/// support them.
+const MatmulKernels *getAVX512MatmulKernels();
+
+/// \brief Returns the fastest kernels which are supported by the host.
+const MatmulKernels &getMatmulKernels();
+
+/// \brief Returns the number of threads which are used to multiply the
+/// matrices of the given shape.
+unsigned getMatmulThreadCount(size_t N, size_t M, size_t K);
+
+/// \brief Multiplies the matrices using the given kernels, with the columns
+/// of the result split between the given number of threads.
+void MultiplyMatrices(const MatmulKernels &Kernels, unsigned Threads,
+                      float *C, size_t LDC, const float *A, size_t LDA,
+                      const float *B, size_t LDB, size_t N, size_t M, size_t K);
+void MultiplyMatrices(const MatmulKernels &Kernels, unsigned Threads,
+                      double *C, size_t LDC, const double *A, size_t LDA,
+                      const double *B, size_t LDB, size_t N, size_t M, size_t K);
+
+} // end namespace runtime
+} // end namespace flang
+
+extern "C" {
+
+/// libflang_matmul_f4, libflang_matmul_f8 - Implement MATMUL for the
+/// REAL matrices whose columns are contiguous.
+void libflang_matmul_f4(float *C, size_t LDC, const float *A, size_t LDA,
+                        const float *B, size_t LDB,
+                        size_t N, size_t M, size_t K);
+void libflang_matmul_f8(double *C, size_t LDC, const double *A, size_t LDA,
+                        const double *B, size_t LDB,
+                        size_t N, size_t M, size_t K);
+
+} // end extern "C"
+
+#endif
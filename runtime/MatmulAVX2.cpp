@@ -0,0 +1,47 @@
+//===--- MatmulAVX2.cpp - AVX2 matrix multiplication ----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the matrix multiplication using AVX2 instructions.
+// The kernels are only built when the file is compiled with AVX2 enabled.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Matmul.h"
+#include "Allocate.h"
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__AVX2__)
+
+typedef float FloatV __attribute__((vector_size(32)));
+typedef double DoubleV __attribute__((vector_size(32)));
+
+namespace {
+
+#include "MatmulKernels.inc"
+
+/// The micro tile has 16x6 float or 8x6 double accumulators,
+/// which use 12 of the 16 vector registers.
+const flang::runtime::MatmulKernels Kernels = {
+  "avx2", Multiply<float, FloatV, 2, 6>, Multiply<double, DoubleV, 2, 6>
+};
+
+} // end anonymous namespace
+
+const flang::runtime::MatmulKernels *flang::runtime::getAVX2MatmulKernels() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")? &Kernels : nullptr;
+}
+
+#else
+
+const flang::runtime::MatmulKernels *flang::runtime::getAVX2MatmulKernels() {
+  return nullptr;
+}
+
+#endif
@@ -0,0 +1,47 @@
+//===--- MatmulAVX512.cpp - AVX-512 matrix multiplication -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the matrix multiplication using AVX-512 instructions.
+// The kernels are only built when the file is compiled with AVX-512 enabled.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Matmul.h"
+#include "Allocate.h"
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__AVX512F__)
+
+typedef float FloatV __attribute__((vector_size(64)));
+typedef double DoubleV __attribute__((vector_size(64)));
+
+namespace {
+
+#include "MatmulKernels.inc"
+
+/// The micro tile has 32x12 float or 16x12 double accumulators,
+/// which use 24 of the 32 vector registers.
+const flang::runtime::MatmulKernels Kernels = {
+  "avx512", Multiply<float, FloatV, 2, 12>, Multiply<double, DoubleV, 2, 12>
+};
+
+} // end anonymous namespace
+
+const flang::runtime::MatmulKernels *flang::runtime::getAVX512MatmulKernels() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx512f")? &Kernels : nullptr;
+}
+
+#else
+
+const flang::runtime::MatmulKernels *flang::runtime::getAVX512MatmulKernels() {
+  return nullptr;
+}
+
+#endif
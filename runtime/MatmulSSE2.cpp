@@ -0,0 +1,47 @@
+//===--- MatmulSSE2.cpp - SSE2 matrix multiplication ----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the matrix multiplication using SSE2 instructions.
+// The kernels are only built when the file is compiled with SSE2 enabled.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Matmul.h"
+#include "Allocate.h"
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+
+typedef float FloatV __attribute__((vector_size(16)));
+typedef double DoubleV __attribute__((vector_size(16)));
+
+namespace {
+
+#include "MatmulKernels.inc"
+
+/// The micro tile has 8x4 float or 4x4 double accumulators,
+/// which use 8 of the 16 vector registers.
+const flang::runtime::MatmulKernels Kernels = {
+  "sse2", Multiply<float, FloatV, 2, 4>, Multiply<double, DoubleV, 2, 4>
+};
+
+} // end anonymous namespace
+
+const flang::runtime::MatmulKernels *flang::runtime::getSSE2MatmulKernels() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse2")? &Kernels : nullptr;
+}
+
+#else
+
+const flang::runtime::MatmulKernels *flang::runtime::getSSE2MatmulKernels() {
+  return nullptr;
+}
+
+#endif
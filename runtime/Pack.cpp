@@ -0,0 +1,89 @@
+//===--- Pack.cpp - PACK and UNPACK runtime library -----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the packing operations which are called by the
+// generated code, and the selection of the kernels.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Pack.h"
+
+namespace {
+
+#include "PackKernels.inc"
+
+const flang::runtime::PackKernels ScalarKernels = {
+  "scalar", ScalarCount, ScalarPack<uint32_t>, ScalarPack<uint64_t>,
+  ScalarUnpack<uint32_t>, ScalarUnpack<uint64_t>
+};
+
+} // end anonymous namespace
+
+namespace flang {
+namespace runtime {
+
+const PackKernels *getScalarPackKernels() {
+  return &ScalarKernels;
+}
+
+static const PackKernels &SelectPackKernels() {
+  if(auto Kernels = getAVX512PackKernels())
+    return *Kernels;
+  if(auto Kernels = getAVX2PackKernels())
+    return *Kernels;
+  return ScalarKernels;
+}
+
+const PackKernels &getPackKernels() {
+  static const PackKernels &Kernels = SelectPackKernels();
+  return Kernels;
+}
+
+} // end namespace runtime
+} // end namespace flang
+
+using namespace flang::runtime;
+
+extern "C" {
+
+size_t libflang_pack_count(const int32_t *Mask, size_t Size) {
+  return getPackKernels().Count(Mask, Size);
+}
+
+size_t libflang_pack_4(void *Dest, const void *Array,
+                       const int32_t *Mask, size_t Size) {
+  return getPackKernels().Pack4(reinterpret_cast<uint32_t*>(Dest),
+                                reinterpret_cast<const uint32_t*>(Array),
+                                Mask, Size);
+}
+
+size_t libflang_pack_8(void *Dest, const void *Array,
+                       const int32_t *Mask, size_t Size) {
+  return getPackKernels().Pack8(reinterpret_cast<uint64_t*>(Dest),
+                                reinterpret_cast<const uint64_t*>(Array),
+                                Mask, Size);
+}
+
+void libflang_unpack_4(void *Dest, const void *Vector, const int32_t *Mask,
+                       const void *Field, size_t FieldStride, size_t Size) {
+  getPackKernels().Unpack4(reinterpret_cast<uint32_t*>(Dest),
+                           reinterpret_cast<const uint32_t*>(Vector), Mask,
+                           reinterpret_cast<const uint32_t*>(Field),
+                           FieldStride, Size);
+}
+
+void libflang_unpack_8(void *Dest, const void *Vector, const int32_t *Mask,
+                       const void *Field, size_t FieldStride, size_t Size) {
+  getPackKernels().Unpack8(reinterpret_cast<uint64_t*>(Dest),
+                           reinterpret_cast<const uint64_t*>(Vector), Mask,
+                           reinterpret_cast<const uint64_t*>(Field),
+                           FieldStride, Size);
+}
+
+} // end extern "C"
@@ -0,0 +1,72 @@
+//===--- Pack.h - PACK and UNPACK runtime kernels ---------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the kernels which implement the PACK and UNPACK
+// intrinsics for contiguous arrays of 4 and 8 byte elements and a default
+// LOGICAL mask, whose elements are true when their lowest bit is set. Every
+// instruction set provides its own set of kernels, and the best one which
+// is supported by the host is selected once when the first array is packed.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef FLANG_RUNTIME_PACK_H
+#define FLANG_RUNTIME_PACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace flang {
+namespace runtime {
+
+/// PackKernels - The implementations of the packing operations
+/// for a specific instruction set.
+struct PackKernels {
+  const char *Name;
+
+  /// Count - Returns the number of the true elements of the mask.
+  size_t (*Count)(const int32_t *Mask, size_t Size);
+
+  /// Pack4, Pack8 - Store the elements of the array which are selected
+  /// by the mask to the consecutive elements of Dest, and return their
+  /// number. Dest isn't written after the last selected element.
+  size_t (*Pack4)(uint32_t *Dest, const uint32_t *Array,
+                  const int32_t *Mask, size_t Size);
+  size_t (*Pack8)(uint64_t *Dest, const uint64_t *Array,
+                  const int32_t *Mask, size_t Size);
+
+  /// Unpack4, Unpack8 - Store the consecutive elements of the vector to
+  /// the elements of Dest which are selected by the mask, and the elements
+  /// of the field to the other ones. The field is a single value when
+  /// FieldStride is zero. Return the number of the elements which are
+  /// taken from the vector, and the vector isn't read after the last one.
+  size_t (*Unpack4)(uint32_t *Dest, const uint32_t *Vector,
+                    const int32_t *Mask, const uint32_t *Field,
+                    size_t FieldStride, size_t Size);
+  size_t (*Unpack8)(uint64_t *Dest, const uint64_t *Vector,
+                    const int32_t *Mask, const uint64_t *Field,
+                    size_t FieldStride, size_t Size);
+};
+
+/// \brief Returns the portable kernels.
+const PackKernels *getScalarPackKernels();
+
+/// \brief Returns the AVX2 kernels, or null if the host doesn't support them.
+const PackKernels *getAVX2PackKernels();
+
+/// \brief Returns the AVX-512 kernels, or null if the host doesn't
+/// support them.
+const PackKernels *getAVX512PackKernels();
+
+/// \brief Returns the fastest kernels which are supported by the host.
+const PackKernels &getPackKernels();
+
+} // end namespace runtime
+} // end namespace flang
+
+#endif
@@ -0,0 +1,199 @@
+//===--- PackAVX2.cpp - AVX2 PACK and UNPACK kernels ----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the packing kernels using AVX2 instructions. AVX2
+// has no compress and expand instructions, so the elements are moved by a
+// permutation which is looked up for every combination of the mask bits,
+// and the partial vectors are accessed with masked loads and stores. The
+// kernels are only built when the file is compiled with AVX2 enabled.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Pack.h"
+
+#if defined(__GNUC__) && defined(__AVX2__)
+#include <immintrin.h>
+
+namespace {
+
+#include "PackKernels.inc"
+
+/// PermutationTables - The lanes of the 8 x 32 bit permutations which
+/// compress the selected elements to the start of the vector, or expand
+/// the elements at the start to the selected lanes. The 64 bit elements
+/// are moved as pairs of 32 bit lanes.
+struct PermutationTables {
+  int32_t Compress4[256][8], Expand4[256][8];
+  int32_t Compress8[16][8], Expand8[16][8];
+
+  PermutationTables() {
+    for(unsigned M = 0; M < 256; ++M) {
+      unsigned N = 0;
+      for(unsigned L = 0; L < 8; ++L) {
+        Compress4[M][L] = 0;
+        Expand4[M][L] = int32_t(N);
+        if(M & (1 << L))
+          Compress4[M][N++] = int32_t(L);
+      }
+    }
+    for(unsigned M = 0; M < 16; ++M) {
+      unsigned N = 0;
+      for(unsigned L = 0; L < 4; ++L) {
+        Compress8[M][L * 2] = Compress8[M][L * 2 + 1] = 0;
+        Expand8[M][L * 2] = int32_t(N * 2);
+        Expand8[M][L * 2 + 1] = int32_t(N * 2 + 1);
+        if(M & (1 << L)) {
+          Compress8[M][N * 2] = int32_t(L * 2);
+          Compress8[M][N * 2 + 1] = int32_t(L * 2 + 1);
+          ++N;
+        }
+      }
+    }
+  }
+};
+
+const PermutationTables &getTables() {
+  static const PermutationTables Tables;
+  return Tables;
+}
+
+inline __m256i Load(const void *Ptr) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Ptr));
+}
+
+inline void Store(void *Ptr, __m256i Value) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(Ptr), Value);
+}
+
+/// \brief Returns the mask elements with their lowest bit moved
+/// to the sign bit.
+inline __m256i LoadSignMask(const int32_t *Mask) {
+  return _mm256_slli_epi32(Load(Mask), 31);
+}
+
+/// \brief Returns the bits of the 8 mask elements.
+inline unsigned MaskBits(__m256i SignMask) {
+  return unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(SignMask)));
+}
+
+/// \brief Returns the mask of the first Count 32 bit lanes.
+inline __m256i FirstLanes(unsigned Count) {
+  return _mm256_cmpgt_epi32(_mm256_set1_epi32(int(Count)),
+                            _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+size_t Count(const int32_t *Mask, size_t Size) {
+  size_t Count = 0, I = 0;
+  for(; I + 8 <= Size; I += 8)
+    Count += __builtin_popcount(MaskBits(LoadSignMask(Mask + I)));
+  return Count + ScalarCount(Mask + I, Size - I);
+}
+
+size_t Pack4(uint32_t *Dest, const uint32_t *Array, const int32_t *Mask,
+             size_t Size) {
+  auto &Tables = getTables();
+  size_t Count = 0, I = 0;
+  for(; I + 8 <= Size; I += 8) {
+    auto M = MaskBits(LoadSignMask(Mask + I));
+    auto N = unsigned(__builtin_popcount(M));
+    auto Packed = _mm256_permutevar8x32_epi32(Load(Array + I),
+                                              Load(Tables.Compress4[M]));
+    _mm256_maskstore_epi32(reinterpret_cast<int*>(Dest + Count),
+                           FirstLanes(N), Packed);
+    Count += N;
+  }
+  return Count + ScalarPack(Dest + Count, Array + I, Mask + I, Size - I);
+}
+
+size_t Pack8(uint64_t *Dest, const uint64_t *Array, const int32_t *Mask,
+             size_t Size) {
+  auto &Tables = getTables();
+  size_t Count = 0, I = 0;
+  for(; I + 8 <= Size; I += 8) {
+    auto M = MaskBits(LoadSignMask(Mask + I));
+    for(unsigned Half = 0; Half < 2; ++Half) {
+      auto HM = (M >> (Half * 4)) & 15;
+      auto N = unsigned(__builtin_popcount(HM));
+      auto Packed = _mm256_permutevar8x32_epi32(Load(Array + I + Half * 4),
+                                                Load(Tables.Compress8[HM]));
+      _mm256_maskstore_epi32(reinterpret_cast<int*>(Dest + Count),
+                             FirstLanes(N * 2), Packed);
+      Count += N;
+    }
+  }
+  return Count + ScalarPack(Dest + Count, Array + I, Mask + I, Size - I);
+}
+
+size_t Unpack4(uint32_t *Dest, const uint32_t *Vector, const int32_t *Mask,
+               const uint32_t *Field, size_t FieldStride, size_t Size) {
+  auto &Tables = getTables();
+  size_t Count = 0, I = 0;
+  auto FieldValue = FieldStride? _mm256_setzero_si256() :
+                                 _mm256_set1_epi32(int(Field[0]));
+  for(; I + 8 <= Size; I += 8) {
+    auto SignMask = LoadSignMask(Mask + I);
+    auto M = MaskBits(SignMask);
+    auto N = unsigned(__builtin_popcount(M));
+    auto Packed = _mm256_maskload_epi32(reinterpret_cast<const int*>(Vector + Count),
+                                        FirstLanes(N));
+    auto Expanded = _mm256_permutevar8x32_epi32(Packed, Load(Tables.Expand4[M]));
+    auto F = FieldStride? Load(Field + I) : FieldValue;
+    Store(Dest + I, _mm256_castps_si256(
+                      _mm256_blendv_ps(_mm256_castsi256_ps(F),
+                                       _mm256_castsi256_ps(Expanded),
+                                       _mm256_castsi256_ps(SignMask))));
+    Count += N;
+  }
+  return Count + ScalarUnpack(Dest + I, Vector + Count, Mask + I,
+                              Field + I * FieldStride, FieldStride, Size - I);
+}
+
+size_t Unpack8(uint64_t *Dest, const uint64_t *Vector, const int32_t *Mask,
+               const uint64_t *Field, size_t FieldStride, size_t Size) {
+  auto &Tables = getTables();
+  size_t Count = 0, I = 0;
+  auto FieldValue = FieldStride? _mm256_setzero_si256() :
+                                 _mm256_set1_epi64x((long long)Field[0]);
+  for(; I + 4 <= Size; I += 4) {
+    auto MaskElements = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Mask + I));
+    auto SignMask = _mm256_slli_epi64(_mm256_cvtepi32_epi64(MaskElements), 63);
+    auto M = unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(SignMask)));
+    auto N = unsigned(__builtin_popcount(M));
+    auto Packed = _mm256_maskload_epi32(reinterpret_cast<const int*>(Vector + Count),
+                                        FirstLanes(N * 2));
+    auto Expanded = _mm256_permutevar8x32_epi32(Packed, Load(Tables.Expand8[M]));
+    auto F = FieldStride? Load(Field + I) : FieldValue;
+    Store(Dest + I, _mm256_castpd_si256(
+                      _mm256_blendv_pd(_mm256_castsi256_pd(F),
+                                       _mm256_castsi256_pd(Expanded),
+                                       _mm256_castsi256_pd(SignMask))));
+    Count += N;
+  }
+  return Count + ScalarUnpack(Dest + I, Vector + Count, Mask + I,
+                              Field + I * FieldStride, FieldStride, Size - I);
+}
+
+const flang::runtime::PackKernels Kernels = {
+  "avx2", Count, Pack4, Pack8, Unpack4, Unpack8
+};
+
+} // end anonymous namespace
+
+const flang::runtime::PackKernels *flang::runtime::getAVX2PackKernels() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2")? &Kernels : nullptr;
+}
+
+#else
+
+const flang::runtime::PackKernels *flang::runtime::getAVX2PackKernels() {
+  return nullptr;
+}
+
+#endif
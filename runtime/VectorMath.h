@@ -0,0 +1,79 @@
+//===--- VectorMath.h - Vector math runtime kernels -------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the vector versions of the elemental math intrinsics.
+// The generated code calls them directly when the loop vectorizer replaces
+// calls to the scalar functions (-fveclib=libflang), e.g. a loop which
+// computes SIN of eight REAL values at once calls libflang_vsinf8. Every
+// instruction set provides a function for the width of its vectors:
+//
+//   SSE2    - libflang_v<name>f4,  libflang_v<name>2
+//   AVX2    - libflang_v<name>f8,  libflang_v<name>4
+//   AVX-512 - libflang_v<name>f16, libflang_v<name>8
+//
+// where <name> is sin, cos, tan, exp, log or atan2. The vector functions
+// differ from the correctly rounded results by at most MaxFloatULPError and
+// MaxDoubleULPError units in the last place.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef FLANG_RUNTIME_VECTORMATH_H
+#define FLANG_RUNTIME_VECTORMATH_H
+
+namespace flang {
+namespace runtime {
+
+enum VectorMathFunction {
+  VMF_Sin,
+  VMF_Cos,
+  VMF_Tan,
+  VMF_Exp,
+  VMF_Log,
+  VMF_Atan2,
+  VMF_NumFunctions
+};
+
+/// \brief The largest error of the single precision vector functions.
+const double MaxFloatULPError = 4.0;
+
+/// \brief The largest error of the double precision vector functions.
+const double MaxDoubleULPError = 4.0;
+
+/// VectorMathKernels - The vector math functions for a specific instruction
+/// set, which operate on arrays so that they can be called without the
+/// instruction set being enabled.
+struct VectorMathKernels {
+  const char *Name;
+
+  /// FloatLanes, DoubleLanes - The number of values which are computed by
+  /// one call.
+  unsigned FloatLanes, DoubleLanes;
+
+  /// Float, Double - Compute the function for the values in X, and Y for
+  /// ATAN2, and store the results in Result.
+  void (*Float[VMF_NumFunctions])(float *Result, const float *X,
+                                  const float *Y);
+  void (*Double[VMF_NumFunctions])(double *Result, const double *X,
+                                   const double *Y);
+};
+
+/// \brief Returns the SSE2 functions, or null if the host doesn't support them.
+const VectorMathKernels *getSSE2VectorMathKernels();
+
+/// \brief Returns the AVX2 functions, or null if the host doesn't support them.
+const VectorMathKernels *getAVX2VectorMathKernels();
+
+/// \brief Returns the AVX-512 functions, or null if the host doesn't
+/// support them.
+const VectorMathKernels *getAVX512VectorMathKernels();
+
+} // end namespace runtime
+} // end namespace flang
+
+#endif
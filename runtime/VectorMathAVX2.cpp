@@ -0,0 +1,71 @@
+//===--- VectorMathAVX2.cpp - AVX2 vector math functions ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the vector math functions using AVX2 instructions. The
+// functions are only built when the file is compiled with AVX2 enabled.
+//
+//===----------------------------------------------------------------------===//
+
+#include "VectorMath.h"
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__AVX2__)
+
+typedef float FloatV __attribute__((vector_size(32)));
+typedef int32_t FloatI __attribute__((vector_size(32)));
+typedef double DoubleV __attribute__((vector_size(32)));
+typedef int64_t DoubleI __attribute__((vector_size(32)));
+
+namespace {
+
+#include "VectorMathKernels.inc"
+
+const flang::runtime::VectorMathKernels Kernels = {
+  "avx2", 8, 4,
+  { FloatUnary<SinF>, FloatUnary<CosF>, FloatUnary<TanF>,
+    FloatUnary<ExpF>, FloatUnary<LogF>, FloatBinary<Atan2F> },
+  { DoubleUnary<SinD>, DoubleUnary<CosD>, DoubleUnary<TanD>,
+    DoubleUnary<ExpD>, DoubleUnary<LogD>, DoubleBinary<Atan2D> }
+};
+
+} // end anonymous namespace
+
+extern "C" {
+
+FloatV libflang_vsinf8(FloatV X) { return SinF(X); }
+FloatV libflang_vcosf8(FloatV X) { return CosF(X); }
+FloatV libflang_vtanf8(FloatV X) { return TanF(X); }
+FloatV libflang_vexpf8(FloatV X) { return ExpF(X); }
+FloatV libflang_vlogf8(FloatV X) { return LogF(X); }
+FloatV libflang_vatan2f8(FloatV Y, FloatV X) { return Atan2F(Y, X); }
+
+DoubleV libflang_vsin4(DoubleV X) { return SinD(X); }
+DoubleV libflang_vcos4(DoubleV X) { return CosD(X); }
+DoubleV libflang_vtan4(DoubleV X) { return TanD(X); }
+DoubleV libflang_vexp4(DoubleV X) { return ExpD(X); }
+DoubleV libflang_vlog4(DoubleV X) { return LogD(X); }
+DoubleV libflang_vatan24(DoubleV Y, DoubleV X) { return Atan2D(Y, X); }
+
+} // end extern "C"
+
+const flang::runtime::VectorMathKernels *flang::runtime::getAVX2VectorMathKernels() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")?
+           &Kernels : nullptr;
+}
+
+#else
+
+const flang::runtime::VectorMathKernels *flang::runtime::getAVX2VectorMathKernels() {
+  return nullptr;
+}
+
+#endif
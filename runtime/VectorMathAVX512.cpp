@@ -0,0 +1,71 @@
+//===--- VectorMathAVX512.cpp - AVX-512 vector math functions -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the vector math functions using AVX-512 instructions.
+// The functions are only built when the file is compiled with AVX-512
+// enabled.
+//
+//===----------------------------------------------------------------------===//
+
+#include "VectorMath.h"
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__AVX512F__)
+
+typedef float FloatV __attribute__((vector_size(64)));
+typedef int32_t FloatI __attribute__((vector_size(64)));
+typedef double DoubleV __attribute__((vector_size(64)));
+typedef int64_t DoubleI __attribute__((vector_size(64)));
+
+namespace {
+
+#include "VectorMathKernels.inc"
+
+const flang::runtime::VectorMathKernels Kernels = {
+  "avx512", 16, 8,
+  { FloatUnary<SinF>, FloatUnary<CosF>, FloatUnary<TanF>,
+    FloatUnary<ExpF>, FloatUnary<LogF>, FloatBinary<Atan2F> },
+  { DoubleUnary<SinD>, DoubleUnary<CosD>, DoubleUnary<TanD>,
+    DoubleUnary<ExpD>, DoubleUnary<LogD>, DoubleBinary<Atan2D> }
+};
+
+} // end anonymous namespace
+
+extern "C" {
+
+FloatV libflang_vsinf16(FloatV X) { return SinF(X); }
+FloatV libflang_vcosf16(FloatV X) { return CosF(X); }
+FloatV libflang_vtanf16(FloatV X) { return TanF(X); }
+FloatV libflang_vexpf16(FloatV X) { return ExpF(X); }
+FloatV libflang_vlogf16(FloatV X) { return LogF(X); }
+FloatV libflang_vatan2f16(FloatV Y, FloatV X) { return Atan2F(Y, X); }
+
+DoubleV libflang_vsin8(DoubleV X) { return SinD(X); }
+DoubleV libflang_vcos8(DoubleV X) { return CosD(X); }
+DoubleV libflang_vtan8(DoubleV X) { return TanD(X); }
+DoubleV libflang_vexp8(DoubleV X) { return ExpD(X); }
+DoubleV libflang_vlog8(DoubleV X) { return LogD(X); }
+DoubleV libflang_vatan28(DoubleV Y, DoubleV X) { return Atan2D(Y, X); }
+
+} // end extern "C"
+
+const flang::runtime::VectorMathKernels *flang::runtime::getAVX512VectorMathKernels() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx512f")? &Kernels : nullptr;
+}
+
+#else
+
+const flang::runtime::VectorMathKernels *flang::runtime::getAVX512VectorMathKernels() {
+  return nullptr;
+}
+
+#endif
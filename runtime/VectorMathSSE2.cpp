@@ -0,0 +1,70 @@
+//===--- VectorMathSSE2.cpp - SSE2 vector math functions ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the vector math functions using SSE2 instructions. The
+// functions are only built when the file is compiled with SSE2 enabled.
+//
+//===----------------------------------------------------------------------===//
+
+#include "VectorMath.h"
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+
+typedef float FloatV __attribute__((vector_size(16)));
+typedef int32_t FloatI __attribute__((vector_size(16)));
+typedef double DoubleV __attribute__((vector_size(16)));
+typedef int64_t DoubleI __attribute__((vector_size(16)));
+
+namespace {
+
+#include "VectorMathKernels.inc"
+
+const flang::runtime::VectorMathKernels Kernels = {
+  "sse2", 4, 2,
+  { FloatUnary<SinF>, FloatUnary<CosF>, FloatUnary<TanF>,
+    FloatUnary<ExpF>, FloatUnary<LogF>, FloatBinary<Atan2F> },
+  { DoubleUnary<SinD>, DoubleUnary<CosD>, DoubleUnary<TanD>,
+    DoubleUnary<ExpD>, DoubleUnary<LogD>, DoubleBinary<Atan2D> }
+};
+
+} // end anonymous namespace
+
+extern "C" {
+
+FloatV libflang_vsinf4(FloatV X) { return SinF(X); }
+FloatV libflang_vcosf4(FloatV X) { return CosF(X); }
+FloatV libflang_vtanf4(FloatV X) { return TanF(X); }
+FloatV libflang_vexpf4(FloatV X) { return ExpF(X); }
+FloatV libflang_vlogf4(FloatV X) { return LogF(X); }
+FloatV libflang_vatan2f4(FloatV Y, FloatV X) { return Atan2F(Y, X); }
+
+DoubleV libflang_vsin2(DoubleV X) { return SinD(X); }
+DoubleV libflang_vcos2(DoubleV X) { return CosD(X); }
+DoubleV libflang_vtan2(DoubleV X) { return TanD(X); }
+DoubleV libflang_vexp2(DoubleV X) { return ExpD(X); }
+DoubleV libflang_vlog2(DoubleV X) { return LogD(X); }
+DoubleV libflang_vatan22(DoubleV Y, DoubleV X) { return Atan2D(Y, X); }
+
+} // end extern "C"
+
+const flang::runtime::VectorMathKernels *flang::runtime::getSSE2VectorMathKernels() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse2")? &Kernels : nullptr;
+}
+
+#else
+
+const flang::runtime::VectorMathKernels *flang::runtime::getSSE2VectorMathKernels() {
+  return nullptr;
+}
+
+#endif
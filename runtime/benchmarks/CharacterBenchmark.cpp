@@ -0,0 +1,116 @@
+//===--- CharacterBenchmark.cpp - Character runtime benchmarks ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file measures the throughput of every set of character kernels which
+// is supported by the host, for strings from 8 bytes to 1 megabyte.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Character.h"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace flang::runtime;
+
+/// The number of bytes which are processed for every measurement.
+static const size_t BytesPerMeasurement = size_t(1) << 28;
+
+/// The lengths of the benchmarked strings.
+static const size_t Lengths[] = {
+  8, 64, 512, 4096, 32768, 262144, 1048576
+};
+
+/// Prevents the compiler from removing the benchmarked calls.
+static volatile size_t Sink;
+
+namespace {
+
+class Benchmark {
+  const CharacterKernels &Kernels;
+  std::vector<char> Str, Other;
+  size_t Length;
+
+public:
+  Benchmark(const CharacterKernels &K, size_t Len)
+    : Kernels(K), Str(Len * 2), Other(Len * 2), Length(Len) {}
+
+  /// \brief Runs the given operation over the string enough times to
+  /// process BytesPerMeasurement bytes and returns the throughput in GB/s.
+  template<typename Operation>
+  double measure(Operation Op) {
+    auto Iterations = BytesPerMeasurement / Length;
+    auto Start = std::chrono::steady_clock::now();
+    for(size_t I = 0; I < Iterations; ++I)
+      Sink = Op(*this);
+    std::chrono::duration<double> Time = std::chrono::steady_clock::now() - Start;
+    return double(Iterations * Length) / Time.count() / 1e9;
+  }
+
+  static size_t lenTrim(Benchmark &B) {
+    return B.Kernels.LenTrim(B.Str.data(), B.Str.size());
+  }
+  static size_t index(Benchmark &B) {
+    return IndexCharacters(B.Kernels, B.Str.data(), B.Length, "needle", 6, false);
+  }
+  static size_t indexBack(Benchmark &B) {
+    return IndexCharacters(B.Kernels, B.Str.data(), B.Length, "needle", 6, true);
+  }
+  static size_t compare(Benchmark &B) {
+    return size_t(CompareCharacters(B.Kernels, B.Str.data(), B.Length,
+                                    B.Other.data(), B.Length));
+  }
+  static size_t fill(Benchmark &B) {
+    B.Kernels.Fill(B.Other.data() + B.Length, B.Length, ' ');
+    return 0;
+  }
+
+  void run() {
+    // The string is followed by the same number of blanks, and the
+    // needle only occurs at its end for the forward search and at its
+    // start for the backward search.
+    for(size_t I = 0; I < Length; ++I)
+      Str[I] = 'a' + (I % 13);
+    memset(Str.data() + Length, ' ', Length);
+    memcpy(Other.data(), Str.data(), Str.size());
+    auto LenTrimResult = measure(lenTrim);
+    auto CompareResult = measure(compare);
+    auto FillResult = measure(fill);
+    if(Length >= 6)
+      memcpy(Str.data() + Length - 6, "needle", 6);
+    auto IndexResult = measure(index);
+    if(Length >= 6) {
+      memcpy(Str.data() + Length - 6, Other.data() + Length - 6, 6);
+      memcpy(Str.data(), "needle", 6);
+    }
+    auto IndexBackResult = measure(indexBack);
+    printf("%-8s %8u %10.2f %10.2f %10.2f %10.2f %10.2f\n", Kernels.Name,
+           unsigned(Length), LenTrimResult, IndexResult, IndexBackResult,
+           CompareResult, FillResult);
+  }
+};
+
+} // end anonymous namespace
+
+int main() {
+  const CharacterKernels *AllKernels[] = {
+    getScalarCharacterKernels(), getSSE2CharacterKernels(),
+    getAVX2CharacterKernels()
+  };
+  printf("%-8s %8s %10s %10s %10s %10s %10s  (GB/s)\n", "kernels", "length",
+         "lentrim", "index", "index back", "compare", "fill");
+  for(auto Kernels : AllKernels) {
+    if(!Kernels)
+      continue;
+    for(auto Length : Lengths)
+      Benchmark(*Kernels, Length).run();
+  }
+  return 0;
+}
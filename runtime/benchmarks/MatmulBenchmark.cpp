@@ -0,0 +1,98 @@
+//===--- MatmulBenchmark.cpp - Matrix multiplication benchmarks -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file measures the matrix multiplication of every set of kernels which
+// is supported by the host, with one thread and with the number of threads
+// which is chosen for MATMUL, and of the naive triple loop which is used
+// when the runtime library isn't called.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Matmul.h"
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+using namespace flang::runtime;
+
+/// The sizes of the benchmarked square matrices.
+static const size_t Sizes[] = {
+  16, 64, 128, 256, 512, 1024
+};
+
+/// The number of multiply-adds which are computed for every measurement.
+static const double WorkPerMeasurement = double(1ULL << 31);
+
+/// Prevents the compiler from removing the benchmarked products.
+static volatile double Sink;
+
+/// \brief Computes C = A * B with the innermost loop going down the
+/// columns of A and C.
+template<typename T>
+static void NaiveMultiply(T *C, const T *A, const T *B, size_t N) {
+  for(size_t J = 0; J < N; ++J) {
+    for(size_t I = 0; I < N; ++I)
+      C[I + J * N] = T(0);
+    for(size_t L = 0; L < N; ++L) {
+      auto Value = B[L + J * N];
+      for(size_t I = 0; I < N; ++I)
+        C[I + J * N] += A[I + L * N] * Value;
+    }
+  }
+}
+
+/// \brief Multiplies the matrices enough times to compute
+/// WorkPerMeasurement multiply-adds, using the given kernels or the naive
+/// loop when they're null, and returns the speed in GFLOPS.
+template<typename T>
+static double Measure(const MatmulKernels *Kernels, unsigned Threads, size_t N) {
+  std::vector<T> A(N * N), B(N * N), C(N * N);
+  for(size_t I = 0; I < A.size(); ++I) {
+    A[I] = T(I % 17) / T(16);
+    B[I] = T(I % 13) / T(12);
+  }
+  auto Work = double(N) * double(N) * double(N);
+  auto Iterations = size_t(WorkPerMeasurement / Work) + 1;
+  auto Start = std::chrono::steady_clock::now();
+  for(size_t I = 0; I < Iterations; ++I) {
+    if(Kernels)
+      MultiplyMatrices(*Kernels, Threads, C.data(), N, A.data(), N,
+                       B.data(), N, N, N, N);
+    else
+      NaiveMultiply(C.data(), A.data(), B.data(), N);
+    Sink = C[I % C.size()];
+  }
+  std::chrono::duration<double> Time = std::chrono::steady_clock::now() - Start;
+  return 2.0 * Work * double(Iterations) / Time.count() / 1e9;
+}
+
+static void Run(const char *Name, const MatmulKernels *Kernels, bool Threaded) {
+  for(auto N : Sizes) {
+    auto Threads = Threaded? getMatmulThreadCount(N, N, N) : 1;
+    printf("%-8s %7u %7u %10.2f %10.2f\n", Name, unsigned(N), Threads,
+           Measure<float>(Kernels, Threads, N),
+           Measure<double>(Kernels, Threads, N));
+  }
+}
+
+int main() {
+  const MatmulKernels *AllKernels[] = {
+    getScalarMatmulKernels(), getSSE2MatmulKernels(),
+    getAVX2MatmulKernels(), getAVX512MatmulKernels()
+  };
+  printf("%-8s %7s %7s %10s %10s  (GFLOPS)\n", "kernels", "size", "threads",
+         "float", "double");
+  Run("naive", nullptr, false);
+  for(auto Kernels : AllKernels) {
+    if(Kernels)
+      Run(Kernels->Name, Kernels, false);
+  }
+  Run(getMatmulKernels().Name, &getMatmulKernels(), true);
+  return 0;
+}
@@ -0,0 +1,103 @@
+//===--- PackBenchmark.cpp - PACK and UNPACK runtime benchmarks -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file measures the throughput of every set of packing kernels which
+// is supported by the host, for masks with different ratios of the true
+// elements. The portable kernels are the loop which is used when the
+// runtime library isn't called.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Pack.h"
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+using namespace flang::runtime;
+
+/// The number of elements which are processed for every measurement.
+static const size_t ElementsPerMeasurement = size_t(1) << 28;
+
+/// The number of the elements of the packed arrays.
+static const size_t Size = 1 << 16;
+
+/// The percentages of the true elements in the masks.
+static const unsigned Densities[] = { 10, 50, 90 };
+
+/// Prevents the compiler from removing the benchmarked calls.
+static volatile size_t Sink;
+
+enum Operation {
+  Count, Pack4, Pack8, Unpack4, Unpack8
+};
+
+static const char *OperationNames[] = {
+  "count", "pack4", "pack8", "unpack4", "unpack8"
+};
+
+/// \brief Returns the speed of the operation in millions of elements
+/// per second.
+static double Measure(const PackKernels &Kernels, Operation Op,
+                      unsigned Density) {
+  std::vector<int32_t> Mask(Size);
+  std::vector<uint64_t> Array(Size), Dest(Size);
+  uint64_t Seed = 1;
+  for(size_t I = 0; I < Size; ++I) {
+    Seed = Seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    Mask[I] = (Seed >> 33) % 100 < Density;
+    Array[I] = I;
+  }
+  auto Array4 = reinterpret_cast<const uint32_t*>(Array.data());
+  auto Dest4 = reinterpret_cast<uint32_t*>(Dest.data());
+  auto Iterations = ElementsPerMeasurement / Size;
+  auto Start = std::chrono::steady_clock::now();
+  for(size_t I = 0; I < Iterations; ++I) {
+    switch(Op) {
+    case Count:
+      Sink = Kernels.Count(Mask.data(), Size);
+      break;
+    case Pack4:
+      Sink = Kernels.Pack4(Dest4, Array4, Mask.data(), Size);
+      break;
+    case Pack8:
+      Sink = Kernels.Pack8(Dest.data(), Array.data(), Mask.data(), Size);
+      break;
+    case Unpack4:
+      Sink = Kernels.Unpack4(Dest4, Array4, Mask.data(), Array4 + 1, 0, Size);
+      break;
+    case Unpack8:
+      Sink = Kernels.Unpack8(Dest.data(), Array.data(), Mask.data(),
+                             Array.data(), 1, Size);
+      break;
+    }
+  }
+  std::chrono::duration<double> Time = std::chrono::steady_clock::now() - Start;
+  return double(Iterations * Size) / Time.count() / 1e6;
+}
+
+int main() {
+  const PackKernels *AllKernels[] = {
+    getScalarPackKernels(), getAVX2PackKernels(), getAVX512PackKernels()
+  };
+  printf("%-8s %-8s", "kernels", "op");
+  for(auto Density : Densities)
+    printf(" %8u%%", Density);
+  printf("  (million elements/s)\n");
+  for(auto Kernels : AllKernels) {
+    if(!Kernels)
+      continue;
+    for(unsigned Op = Count; Op <= Unpack8; ++Op) {
+      printf("%-8s %-8s", Kernels->Name, OperationNames[Op]);
+      for(auto Density : Densities)
+        printf(" %9.0f", Measure(*Kernels, Operation(Op), Density));
+      printf("\n");
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,101 @@
+//===--- VectorMathBenchmark.cpp - Vector math runtime benchmarks ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file measures the throughput of the vector math functions of every
+// instruction set which is supported by the host, and of the scalar functions
+// of the C library which are called when the loops aren't vectorized.
+//
+//===----------------------------------------------------------------------===//
+
+#include "VectorMath.h"
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+using namespace flang::runtime;
+
+static const char *FunctionNames[VMF_NumFunctions] = {
+  "sin", "cos", "tan", "exp", "log", "atan2"
+};
+
+/// The number of values in the benchmarked arrays.
+static const size_t Length = 4096;
+
+/// The number of times every array is processed.
+static const unsigned Repetitions = 2000;
+
+/// Prevents the compiler from removing the benchmarked calls.
+static volatile double Sink;
+
+template<typename T>
+static T CallLibrary(VectorMathFunction Func, T X, T Y) {
+  switch(Func) {
+  case VMF_Sin:   return sin(X);
+  case VMF_Cos:   return cos(X);
+  case VMF_Tan:   return tan(X);
+  case VMF_Exp:   return exp(X);
+  case VMF_Log:   return log(X);
+  case VMF_Atan2: return atan2(X, Y);
+  default:        return X;
+  }
+}
+
+/// \brief Prints the throughput of the given vector function, or of the
+/// function of the C library when it's null, in millions of values per
+/// second.
+template<typename T>
+static void Run(VectorMathFunction Func,
+                void (*Function)(T *, const T *, const T *), unsigned Lanes) {
+  std::vector<T> X(Length), Y(Length), Results(Length);
+  for(size_t I = 0; I < Length; ++I) {
+    X[I] = T(0.001) + T(I % 1000) / T(100);
+    Y[I] = T(1.5) - T(I % 7);
+  }
+
+  auto Start = std::chrono::steady_clock::now();
+  for(unsigned R = 0; R < Repetitions; ++R) {
+    if(Function) {
+      for(size_t I = 0; I < Length; I += Lanes)
+        Function(&Results[I], &X[I], &Y[I]);
+    } else {
+      for(size_t I = 0; I < Length; ++I)
+        Results[I] = CallLibrary<T>(Func, X[I], Y[I]);
+    }
+    Sink = Results[R % Length];
+  }
+  std::chrono::duration<double> Time = std::chrono::steady_clock::now() - Start;
+  printf(" %8.1f", double(Length) * Repetitions / Time.count() / 1e6);
+}
+
+int main() {
+  const VectorMathKernels *AllKernels[] = {
+    getSSE2VectorMathKernels(), getAVX2VectorMathKernels(),
+    getAVX512VectorMathKernels()
+  };
+  printf("%-8s %-6s %8s %8s  (millions of values per second)\n",
+         "kernels", "func", "float", "double");
+  for(unsigned Func = 0; Func < VMF_NumFunctions; ++Func) {
+    printf("%-8s %-6s", "libm", FunctionNames[Func]);
+    Run<float>(VectorMathFunction(Func), nullptr, 1);
+    Run<double>(VectorMathFunction(Func), nullptr, 1);
+    printf("\n");
+    for(auto Kernels : AllKernels) {
+      if(!Kernels)
+        continue;
+      printf("%-8s %-6s", Kernels->Name, FunctionNames[Func]);
+      Run<float>(VectorMathFunction(Func), Kernels->Float[Func],
+                 Kernels->FloatLanes);
+      Run<double>(VectorMathFunction(Func), Kernels->Double[Func],
+                  Kernels->DoubleLanes);
+      printf("\n");
+    }
+  }
+  return 0;
+}
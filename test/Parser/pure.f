@@ -0,0 +1,21 @@
+C RUN: %flang -fsyntax-only %s
+
+       PU RE SUB ROUTINE SU B()
+       END
+       ELEMEN TAL FUNCTIO N F OO(X)
+         REAL, INTENT(IN) :: X
+         FOO = X
+       END
+
+       RECU RSIVE PU RE INTE GER FU NCTION FUNC()
+         FUNC = 1
+       END
+
+       INTEGER PU RE FU NCTION FUNC2()
+         FUNC2 = 2
+       END
+
+       ELEMEN TAL INTE GER (2) FU NCTION FUNC3(I)
+         INTEGER(2), INTENT(IN) :: I
+         FUNC3 = I
+       END
@@ -157,6 +157,37 @@ namespace {
   cl::opt<bool>
   Fortran77("f77", cl::desc("compile with Fortran77 features"), cl::init(false));
 
+  cl::opt<bool>
+  ArrayFusion("farray-fusion", cl::desc("fuse adjacent array assignments into a single loop nest"), cl::init(false));
+
+  cl::opt<bool>
+  DumpArrayFusion("fdump-array-fusion", cl::desc("print the fused array loop nests"), cl::init(false));
+
+  cl::opt<bool>
+  ReassociateReductions("freassociate-reductions", cl::desc("allow the reordering of floating point array reductions"), cl::init(false));
+
+  cl::opt<bool>
+  NoStrictAliasing("fno-strict-aliasing", cl::desc("assume that the storage of one type can be accessed as another type"), cl::init(false));
+
+  cl::opt<unsigned>
+  MaxStackVarSize("fmax-stack-var-size", cl::desc("the size in bytes of the largest local array which is allocated on the stack"), cl::init(65536));
+
+  cl::opt<CodeGenOptions::ComplexArithmeticKind>
+  ComplexArithmetic("fcomplex-arithmetic", cl::desc("the accuracy of complex division and absolute value"),
+                    cl::values(clEnumValN(CodeGenOptions::CAK_Full, "full", "Smith's division and a correctly scaled hypot"),
+                               clEnumValN(CodeGenOptions::CAK_Improved, "improved", "Smith's division and an inline scaled absolute value"),
+                               clEnumValN(CodeGenOptions::CAK_Fast, "fast", "the textbook formulas without scaling"),
+                               clEnumValEnd),
+                    cl::init(CodeGenOptions::CAK_Full));
+
+  cl::opt<CodeGenOptions::VectorLibrary>
+  VecLib("fveclib", cl::desc("the vector library which is used by the loop vectorizer"),
+         cl::values(clEnumValN(CodeGenOptions::NoLibrary, "none", "don't call any vector functions"),
+                    clEnumValN(CodeGenOptions::Accelerate, "Accelerate", "the Accelerate framework"),
+                    clEnumValN(CodeGenOptions::Libflang, "libflang", "the vector math functions of the runtime library"),
+                    clEnumValEnd),
+         cl::init(CodeGenOptions::NoLibrary));
+
 } // end anonymous namespace
 
 
@@ -336,8 +367,8 @@ static bool LinkFiles(ArrayRef<std::string> OutputFiles) {
   OS << " -l libflang";
   for(const std::string &I : LinkLibraries)
     OS << " -l " << I;
-  // Link with the math library.
-  OS << " -l m";
+  // Link with the math and the thread libraries.
+  OS << " -l m -l pthread";
   if(OutputFile.size())
     OS << " -o " << OutputFile;
   Cmd = OS.str();
@@ -411,8 +442,18 @@ static bool ParseFile(const std::string &Filename,
                                                  TargetTriple;
     TargetOptions.CPU = llvm::sys::getHostCPUName();
 
+    CodeGenOptions CGOpts;
+    CGOpts.OptimizationLevel = OptLevel;
+    CGOpts.ArrayStmtFusion = ArrayFusion;
+    CGOpts.DumpArrayFusion = DumpArrayFusion;
+    CGOpts.ReassociateReductions = ReassociateReductions;
+    CGOpts.RelaxedAliasing = NoStrictAliasing;
+    CGOpts.MaxStackVarSize = MaxStackVarSize;
+    CGOpts.setComplexArithmetic(ComplexArithmetic);
+    CGOpts.setVecLib(VecLib);
+
     auto CG = CreateLLVMCodeGen(Diag, Filename == ""? std::string("module") : Filename,
-                                CodeGenOptions(), TargetOptions, llvm::getGlobalContext());
+                                CGOpts, TargetOptions, llvm::getGlobalContext());
     CG->Initialize(Context);
     CG->HandleTranslationUnit(Context);
 
@@ -443,10 +484,13 @@ static bool ParseFile(const std::string &Filename,
       //FPM->add(new DataLayoutPass());
       //PM->add(new llvm::DataLayoutPass());
       //TM->addAnalysisPasses(*PM);
+      PM->add(createTargetTransformInfoWrapperPass(TM->getTargetIRAnalysis()));
       PM->add(createPromoteMemoryToRegisterPass());
 
       PassManagerBuilder PMBuilder;
       PMBuilder.OptLevel = OptLevel;
+      PMBuilder.LibraryInfo = CreateTargetLibraryInfo(llvm::Triple(TargetOptions.Triple),
+                                                      CGOpts, TargetOptions);
       PMBuilder.SizeLevel = 0;
       PMBuilder.LoopVectorize = true;
       PMBuilder.SLPVectorize = true;
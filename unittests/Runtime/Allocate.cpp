@@ -0,0 +1,89 @@
+//===-- Allocate.cpp - Unittests for the allocatable array allocator ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Allocate.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace flang::runtime;
+
+static const size_t Sizes[] = {
+  0, 1, 8, 63, 64, 65, 100, 1000, 4096, 65535, 65536, 65537, 100000, 1 << 22
+};
+
+bool Check(bool Condition, const char *Message, size_t Size) {
+  if(!Condition) {
+    fprintf(stderr, "size %u: %s\n", unsigned(Size), Message);
+    return true;
+  }
+  return false;
+}
+
+/// \brief Checks that the blocks are aligned and can be written to.
+int testAlignment() {
+  int Result = 0;
+  void *Blocks[sizeof(Sizes) / sizeof(Sizes[0])];
+  for(size_t I = 0; I < sizeof(Sizes) / sizeof(Sizes[0]); ++I) {
+    Blocks[I] = libflang_allocate(Sizes[I]);
+    Result |= Check(Blocks[I] != nullptr, "allocation failed", Sizes[I]);
+    Result |= Check(uintptr_t(Blocks[I]) % AllocationAlignment == 0,
+                    "the block isn't aligned", Sizes[I]);
+    if(Blocks[I])
+      memset(Blocks[I], 0xFF, Sizes[I]);
+  }
+  for(size_t I = 0; I < sizeof(Sizes) / sizeof(Sizes[0]); ++I)
+    libflang_deallocate(Blocks[I], Sizes[I]);
+  return Result;
+}
+
+/// \brief Checks that a freed block is reused by the next allocation
+/// of the same size, or of a size with the same size class.
+int testReuse() {
+  int Result = 0;
+  for(auto Size : Sizes) {
+    auto Block = libflang_allocate(Size);
+    libflang_deallocate(Block, Size);
+    Result |= Check(libflang_allocate(Size) == Block,
+                    "the freed block isn't reused", Size);
+    libflang_deallocate(Block, Size);
+  }
+  auto Block = libflang_allocate(100);
+  libflang_deallocate(Block, 100);
+  Result |= Check(libflang_allocate(120) == Block,
+                  "the freed block isn't reused by its size class", 120);
+  libflang_deallocate(Block, 120);
+  return Result;
+}
+
+/// \brief Checks that the scratch arrays of a time stepping loop
+/// only reach the system allocator in the first step.
+int testSteadyState() {
+  static const size_t ScratchSizes[] = { 800, 8000, 80000, 800000 };
+  static const unsigned NumScratch = sizeof(ScratchSizes) / sizeof(ScratchSizes[0]);
+  size_t FirstStepAllocations = 0;
+  for(unsigned Step = 0; Step < 100; ++Step) {
+    void *Scratch[NumScratch];
+    for(unsigned I = 0; I < NumScratch; ++I)
+      Scratch[I] = libflang_allocate(ScratchSizes[I]);
+    for(unsigned I = 0; I < NumScratch; ++I)
+      libflang_deallocate(Scratch[I], ScratchSizes[I]);
+    if(Step == 0)
+      FirstStepAllocations = getSystemAllocationCount();
+  }
+  return Check(getSystemAllocationCount() == FirstStepAllocations,
+               "the system allocator is used in the steady state", 0);
+}
+
+int main() {
+  int Result = testAlignment();
+  Result |= testReuse();
+  Result |= testSteadyState();
+  return Result;
+}
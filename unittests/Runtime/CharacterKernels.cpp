@@ -0,0 +1,139 @@
+//===-- CharacterKernels.cpp - Unittests for the character runtime --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Character.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+using namespace flang::runtime;
+
+static const size_t MaxLength = 300;
+
+bool Check(const CharacterKernels &Kernels, const char *Op, size_t Length,
+           size_t Value, size_t Expected) {
+  if(Value != Expected) {
+    fprintf(stderr, "%s %s(length %u): expected %u instead of %u\n",
+            Kernels.Name, Op, unsigned(Length), unsigned(Expected),
+            unsigned(Value));
+    return true;
+  }
+  return false;
+}
+
+/// \brief Compares the results of the given kernels with the results
+/// of the portable kernels for strings of different lengths and
+/// alignments.
+int test(const CharacterKernels &Kernels) {
+  auto &Scalar = *getScalarCharacterKernels();
+  char Buffer[MaxLength + 64], Other[MaxLength + 64];
+
+  for(size_t Offset = 0; Offset < 3; ++Offset) {
+    for(size_t Length = 0; Length <= MaxLength; ++Length) {
+      auto Str = Buffer + Offset;
+
+      // blanks with a single non blank character at every position.
+      memset(Str, ' ', Length);
+      if(Check(Kernels, "lentrim", Length, Kernels.LenTrim(Str, Length), 0) ||
+         Check(Kernels, "findnonblank", Length, Kernels.FindNonBlank(Str, Length), Length))
+        return 1;
+      for(size_t I = 0; I < Length; I += 7) {
+        Str[I] = 'x';
+        if(Check(Kernels, "lentrim", Length, Kernels.LenTrim(Str, Length), I + 1) ||
+           Check(Kernels, "findnonblank", Length, Kernels.FindNonBlank(Str, Length),
+                 Scalar.FindNonBlank(Str, Length)))
+          return 1;
+      }
+
+      // strings which differ at a single position.
+      for(size_t I = 0; I < Length; ++I)
+        Str[I] = 'a' + (I * 7) % 26;
+      memcpy(Other, Str, Length);
+      if(Check(Kernels, "mismatch", Length, Kernels.Mismatch(Str, Other, Length), Length))
+        return 1;
+      for(size_t I = 0; I < Length; I += 5) {
+        Other[I] = '#';
+        if(Check(Kernels, "mismatch", Length, Kernels.Mismatch(Str, Other, Length),
+                 Scalar.Mismatch(Str, Other, Length)))
+          return 1;
+        Other[I] = Str[I];
+      }
+
+      // substrings of different lengths, searched forwards and backwards.
+      for(size_t I = 0; I < Length; ++I)
+        Str[I] = 'a' + (I % 3);
+      const char *Subs[] = { "a", "c", "ab", "ca", "abc", "cab", "abca",
+                             "bcabcabcabcabcabca", "x", "ax", "abx" };
+      for(auto Sub : Subs) {
+        auto SubLength = strlen(Sub);
+        if(SubLength > Length)
+          continue;
+        for(int Back = 0; Back < 2; ++Back) {
+          if(Check(Kernels, Back? "index back" : "index", Length,
+                   Kernels.Index(Str, Length, Sub, SubLength, Back),
+                   Scalar.Index(Str, Length, Sub, SubLength, Back)))
+            return 1;
+        }
+      }
+
+      // fill mustn't write past the end of the string.
+      memset(Buffer, '.', sizeof(Buffer));
+      Kernels.Fill(Str, Length, ' ');
+      if(Check(Kernels, "fill", Length, Scalar.FindNonBlank(Str, Length), Length) ||
+         Check(Kernels, "fill", Length, Str[Length], '.') ||
+         (Offset && Check(Kernels, "fill", Length, Str[-1], '.')))
+        return 1;
+    }
+  }
+  return 0;
+}
+
+int testOperations(const CharacterKernels &Kernels) {
+  if(Check(Kernels, "compare", 5, CompareCharacters(Kernels, "abc", 3, "abc  ", 5), 0) ||
+     Check(Kernels, "compare", 5, CompareCharacters(Kernels, "abc  ", 5, "abc", 3), 0) ||
+     Check(Kernels, "compare", 4, CompareCharacters(Kernels, "abc", 3, "abcd", 4), size_t(-1)) ||
+     Check(Kernels, "compare", 4, CompareCharacters(Kernels, "abcd", 4, "abc", 3), 1) ||
+     Check(Kernels, "compare", 4, CompareCharacters(Kernels, "ab\t", 3, "ab", 2), size_t(-1)) ||
+     Check(Kernels, "compare", 3, CompareCharacters(Kernels, "abd", 3, "abc", 3), 1) ||
+     Check(Kernels, "compare", 0, CompareCharacters(Kernels, "", 0, "  ", 2), 0))
+    return 1;
+
+  std::string Str = "Hello World";
+  if(Check(Kernels, "index", 11, IndexCharacters(Kernels, Str.data(), 11, "o", 1, false), 5) ||
+     Check(Kernels, "index", 11, IndexCharacters(Kernels, Str.data(), 11, "o", 1, true), 8) ||
+     Check(Kernels, "index", 11, IndexCharacters(Kernels, Str.data(), 11, "", 0, false), 1) ||
+     Check(Kernels, "index", 11, IndexCharacters(Kernels, Str.data(), 11, "", 0, true), 12) ||
+     Check(Kernels, "index", 3, IndexCharacters(Kernels, "abc", 3, "abcd", 4, false), 0))
+    return 1;
+
+  // Searches in a long string which has a match only near its end.
+  std::string Long(100000, 'a');
+  Long.replace(99990, 3, "abc");
+  if(Check(Kernels, "index", Long.size(),
+           IndexCharacters(Kernels, Long.data(), Long.size(), "abc", 3, false), 99991) ||
+     Check(Kernels, "index", Long.size(),
+           IndexCharacters(Kernels, Long.data(), Long.size(), "abc", 3, true), 99991))
+    return 1;
+  return 0;
+}
+
+int main() {
+  const CharacterKernels *AllKernels[] = {
+    getScalarCharacterKernels(), getSSE2CharacterKernels(),
+    getAVX2CharacterKernels()
+  };
+  for(auto Kernels : AllKernels) {
+    if(!Kernels)
+      continue;
+    if(test(*Kernels) || testOperations(*Kernels))
+      return 1;
+  }
+  return 0;
+}
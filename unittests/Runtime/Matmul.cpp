@@ -0,0 +1,101 @@
+//===-- Matmul.cpp - Unittests for the matrix multiplication runtime ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Matmul.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+using namespace flang::runtime;
+
+/// Shape - The shape (N, M) x (M, K) of the multiplied matrices.
+struct Shape {
+  size_t N, M, K;
+};
+
+/// The shapes cover the empty matrices, the vectors, the partial micro
+/// tiles and the products which span several packed blocks.
+static const Shape Shapes[] = {
+  { 0, 5, 3 }, { 4, 0, 3 }, { 4, 5, 0 }, { 1, 1, 1 }, { 1, 37, 1 },
+  { 1, 20, 33 }, { 33, 20, 1 }, { 7, 3, 5 }, { 16, 16, 16 }, { 31, 17, 13 },
+  { 64, 64, 64 }, { 129, 257, 35 }, { 200, 300, 150 }
+};
+
+static uint64_t Seed = 1;
+
+template<typename T>
+static T Random() {
+  Seed = Seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return T(int((Seed >> 33) % 2001) - 1000) / T(1000);
+}
+
+/// \brief Multiplies the matrices with the given kernels and compares the
+/// result with the naive triple loop. The matrices are stored with a
+/// distance between the columns which is larger than the number of rows,
+/// and the elements outside of the result must stay unchanged.
+template<typename T>
+static bool Test(const MatmulKernels &Kernels, unsigned Threads,
+                 const Shape &S, const char *TypeName) {
+  auto LDA = S.N + 3, LDB = S.M + 1, LDC = S.N + 2;
+  std::vector<T> A(LDA * S.M + 1), B(LDB * S.K + 1), C(LDC * S.K + 1);
+  std::vector<T> Expected(C.size());
+  for(auto &X : A)
+    X = Random<T>();
+  for(auto &X : B)
+    X = Random<T>();
+  for(size_t I = 0; I < C.size(); ++I)
+    C[I] = Expected[I] = T(12345);
+
+  for(size_t J = 0; J < S.K; ++J) {
+    for(size_t I = 0; I < S.N; ++I) {
+      T Sum = T(0);
+      for(size_t L = 0; L < S.M; ++L)
+        Sum += A[I + L * LDA] * B[L + J * LDB];
+      Expected[I + J * LDC] = Sum;
+    }
+  }
+  MultiplyMatrices(Kernels, Threads, C.data(), LDC, A.data(), LDA,
+                   B.data(), LDB, S.N, S.M, S.K);
+
+  // The sums are computed in a different order, so every product
+  // may add a rounding error.
+  auto Tolerance = T(S.M + 1) * (sizeof(T) == 4? T(1e-6) : T(1e-14));
+  for(size_t I = 0; I < C.size(); ++I) {
+    if(fabs(double(C[I] - Expected[I])) > double(Tolerance)) {
+      fprintf(stderr, "%s %s (%u x %u) x (%u x %u) with %u threads: "
+              "element %u is %g instead of %g\n", Kernels.Name, TypeName,
+              unsigned(S.N), unsigned(S.M), unsigned(S.M), unsigned(S.K),
+              Threads, unsigned(I), double(C[I]), double(Expected[I]));
+      return true;
+    }
+  }
+  return false;
+}
+
+int main() {
+  const MatmulKernels *AllKernels[] = {
+    getScalarMatmulKernels(), getSSE2MatmulKernels(),
+    getAVX2MatmulKernels(), getAVX512MatmulKernels()
+  };
+  const unsigned ThreadCounts[] = { 1, 3 };
+  int Result = 0;
+  for(auto Kernels : AllKernels) {
+    if(!Kernels)
+      continue;
+    for(auto Threads : ThreadCounts) {
+      for(auto &S : Shapes) {
+        if(Test<float>(*Kernels, Threads, S, "float") ||
+           Test<double>(*Kernels, Threads, S, "double"))
+          Result = 1;
+      }
+    }
+  }
+  return Result;
+}
@@ -0,0 +1,107 @@
+//===-- Pack.cpp - Unittests for the PACK and UNPACK runtime --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Pack.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+using namespace flang::runtime;
+
+static const size_t MaxSize = 100;
+
+/// The guard elements after the results, which must stay unchanged.
+static const size_t GuardSize = 16;
+static const uint64_t Guard = 0xDEADBEEFDEADBEEFULL;
+
+/// The percentages of the true elements in the tested masks.
+static const unsigned Densities[] = { 0, 10, 50, 90, 100 };
+
+static uint64_t Seed = 1;
+
+static unsigned Random(unsigned Limit) {
+  Seed = Seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return unsigned((Seed >> 33) % Limit);
+}
+
+static bool Fail(const PackKernels &Kernels, const char *Op, size_t Size,
+                 unsigned Density, size_t Index) {
+  fprintf(stderr, "%s %s(size %u, %u%% true): wrong element %u\n",
+          Kernels.Name, Op, unsigned(Size), Density, unsigned(Index));
+  return true;
+}
+
+/// \brief Packs and unpacks the elements with the given kernels, and
+/// compares the results with the naive loops. Only the lowest bit of
+/// the mask elements is significant.
+template<typename T>
+static bool Test(const PackKernels &Kernels,
+                 size_t (*Pack)(T *, const T *, const int32_t *, size_t),
+                 size_t (*Unpack)(T *, const T *, const int32_t *,
+                                  const T *, size_t, size_t),
+                 size_t Size, unsigned Density) {
+  std::vector<int32_t> Mask(Size);
+  std::vector<T> Array(Size), Field(Size + 1), Expected;
+  Field[Size] = T(7);
+  for(size_t I = 0; I < Size; ++I) {
+    Mask[I] = int32_t(Random(100) < Density) | int32_t(Random(4) << 1);
+    Array[I] = T(I * 3 + 1);
+    Field[I] = T(I * 5 + 2);
+    if(Mask[I] & 1)
+      Expected.push_back(Array[I]);
+  }
+  auto Count = Expected.size();
+  if(Kernels.Count(Mask.data(), Size) != Count)
+    return Fail(Kernels, "count", Size, Density, 0);
+
+  std::vector<T> Dest(Count + GuardSize, T(Guard));
+  if(Pack(Dest.data(), Array.data(), Mask.data(), Size) != Count)
+    return Fail(Kernels, "pack", Size, Density, 0);
+  for(size_t I = 0; I < Dest.size(); ++I) {
+    if(Dest[I] != (I < Count? Expected[I] : T(Guard)))
+      return Fail(Kernels, "pack", Size, Density, I);
+  }
+
+  // The vector is unpacked into the field array and into a single value.
+  for(size_t FieldStride = 0; FieldStride < 2; ++FieldStride) {
+    std::vector<T> Result(Size + GuardSize, T(Guard));
+    if(Unpack(Result.data(), Expected.data(), Mask.data(), Field.data(),
+              FieldStride, Size) != Count)
+      return Fail(Kernels, "unpack", Size, Density, 0);
+    size_t J = 0;
+    for(size_t I = 0; I < Result.size(); ++I) {
+      auto Value = I >= Size? T(Guard) :
+                   (Mask[I] & 1)? Expected[J++] : Field[I * FieldStride];
+      if(Result[I] != Value)
+        return Fail(Kernels, "unpack", Size, Density, I);
+    }
+  }
+  return false;
+}
+
+int main() {
+  const PackKernels *AllKernels[] = {
+    getScalarPackKernels(), getAVX2PackKernels(), getAVX512PackKernels()
+  };
+  int Result = 0;
+  for(auto Kernels : AllKernels) {
+    if(!Kernels)
+      continue;
+    for(size_t Size = 0; Size <= MaxSize; ++Size) {
+      for(auto Density : Densities) {
+        if(Test<uint32_t>(*Kernels, Kernels->Pack4, Kernels->Unpack4,
+                          Size, Density) ||
+           Test<uint64_t>(*Kernels, Kernels->Pack8, Kernels->Unpack8,
+                          Size, Density))
+          Result = 1;
+      }
+    }
+  }
+  return Result;
+}
@@ -0,0 +1,163 @@
+//===-- VectorMath.cpp - Unittests for the vector math runtime ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "VectorMath.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+using namespace flang::runtime;
+
+static const char *FunctionNames[VMF_NumFunctions] = {
+  "sin", "cos", "tan", "exp", "log", "atan2"
+};
+
+/// The number of random arguments which are tested in every range.
+static const unsigned Samples = 100000;
+
+/// Range - The arguments of a function are uniformly distributed in
+/// [Min, Max], or logarithmically when Log is set.
+struct Range {
+  double Min, Max;
+  bool Log;
+};
+
+static uint64_t Seed = 1;
+
+static double Random(const Range &R) {
+  Seed = Seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  double Unit = double(Seed >> 11) / double(1ULL << 53);
+  if(R.Log)
+    return exp(log(R.Min) + (log(R.Max) - log(R.Min)) * Unit);
+  return R.Min + (R.Max - R.Min) * Unit;
+}
+
+static void GetRanges(VectorMathFunction Func, bool Float,
+                      std::vector<Range> &Ranges) {
+  switch(Func) {
+  case VMF_Sin: case VMF_Cos: case VMF_Tan:
+    Ranges.push_back({ -10.0, 10.0, false });
+    Ranges.push_back({ -9000.0, 9000.0, false });
+    Ranges.push_back({ 1e-30, 1e-3, true });
+    // The arguments which are computed by the scalar functions.
+    Ranges.push_back({ 1e5, 1e30, true });
+    break;
+  case VMF_Exp:
+    Ranges.push_back({ -1.0, 1.0, false });
+    if(Float)
+      Ranges.push_back({ -104.0, 89.0, false });
+    else
+      Ranges.push_back({ -745.0, 710.0, false });
+    break;
+  case VMF_Log:
+    Ranges.push_back({ 0.5, 2.0, false });
+    if(Float)
+      Ranges.push_back({ 1e-44, 3e38, true });
+    else
+      Ranges.push_back({ 1e-320, 1e308, true });
+    break;
+  case VMF_Atan2:
+    Ranges.push_back({ -10.0, 10.0, false });
+    Ranges.push_back({ -1e30, 1e30, false });
+    break;
+  default:
+    break;
+  }
+}
+
+/// \brief Returns the error of the result in units in the last place of
+/// the result type.
+template<typename T>
+static double ULPError(T Result, long double Expected) {
+  if(isnan(Expected))
+    return isnan(Result)? 0.0 : INFINITY;
+  if(isinf(Expected) || Expected == 0.0L)
+    return Result == Expected? 0.0 : INFINITY;
+  T Rounded = T(Expected);
+  if(isinf(Rounded))
+    return Result == Rounded? 0.0 : INFINITY;
+  T ULP = nextafter(fabs(Rounded), T(INFINITY)) - fabs(Rounded);
+  return double(fabsl(Result - Expected) / ULP);
+}
+
+static long double Reference(VectorMathFunction Func, long double X,
+                             long double Y) {
+  switch(Func) {
+  case VMF_Sin:   return sinl(X);
+  case VMF_Cos:   return cosl(X);
+  case VMF_Tan:   return tanl(X);
+  case VMF_Exp:   return expl(X);
+  case VMF_Log:   return logl(X);
+  case VMF_Atan2: return atan2l(X, Y);
+  default:        return 0.0L;
+  }
+}
+
+/// \brief Returns the largest error of the given function for the
+/// random arguments in every range, and the special arguments.
+template<typename T>
+static double Test(VectorMathFunction Func, unsigned Lanes,
+                   void (*Function)(T *, const T *, const T *)) {
+  std::vector<Range> Ranges;
+  GetRanges(Func, sizeof(T) == sizeof(float), Ranges);
+  std::vector<T> Args;
+  for(auto R : Ranges) {
+    for(unsigned I = 0; I < Samples; ++I) {
+      T Arg = T(Random(R));
+      Args.push_back(Arg);
+      Args.push_back(-Arg);
+    }
+  }
+  T Special[] = { T(0.0), T(-0.0), T(INFINITY), T(-INFINITY), T(NAN), T(1.0) };
+  for(auto Arg : Special)
+    Args.push_back(Arg);
+  while(Args.size() % Lanes)
+    Args.push_back(T(1.0));
+
+  // The second arguments of ATAN2 are the first ones in reverse order.
+  std::vector<T> Others(Args.rbegin(), Args.rend());
+  std::vector<T> Results(Args.size());
+  for(size_t I = 0; I < Args.size(); I += Lanes)
+    Function(&Results[I], &Args[I], &Others[I]);
+
+  double MaxError = 0.0;
+  for(size_t I = 0; I < Args.size(); ++I) {
+    auto Error = ULPError(Results[I], Reference(Func, Args[I], Others[I]));
+    if(Error > MaxError)
+      MaxError = Error;
+  }
+  return MaxError;
+}
+
+int main() {
+  const VectorMathKernels *AllKernels[] = {
+    getSSE2VectorMathKernels(), getAVX2VectorMathKernels(),
+    getAVX512VectorMathKernels()
+  };
+  int Result = 0;
+  for(auto Kernels : AllKernels) {
+    if(!Kernels)
+      continue;
+    for(unsigned Func = 0; Func < VMF_NumFunctions; ++Func) {
+      auto FloatError = Test<float>(VectorMathFunction(Func), Kernels->FloatLanes,
+                                    Kernels->Float[Func]);
+      auto DoubleError = Test<double>(VectorMathFunction(Func), Kernels->DoubleLanes,
+                                      Kernels->Double[Func]);
+      printf("%-8s %-6s float %6.2f ulp  double %6.2f ulp\n", Kernels->Name,
+             FunctionNames[Func], FloatError, DoubleError);
+      if(FloatError > MaxFloatULPError || DoubleError > MaxDoubleULPError) {
+        fprintf(stderr, "%s %s: the error exceeds the bound\n", Kernels->Name,
+                FunctionNames[Func]);
+        Result = 1;
+      }
+    }
+  }
+  return Result;
+}